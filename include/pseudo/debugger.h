@@ -21,30 +21,164 @@ var_info_t* runtime_get_variables(runtime_t* rt, size_t* count);
 // Free variable info array
 void free_var_info_array(var_info_t* vars, size_t count);
 
-// State snapshot for step-back functionality
+// State snapshot for step-back functionality. Snapshots form a journal:
+// each holds the variables written and the frames changed since the one
+// before, with a full keyframe every SNAPSHOT_KEYFRAME_INTERVAL, so
+// taking one costs what the steps in between changed.
 typedef struct runtime_snapshot runtime_snapshot_t;
 
-// Snapshot management
-#define MAX_SNAPSHOTS 100
+#define SNAPSHOT_KEYFRAME_INTERVAL 64
 
-// Create a snapshot of the current runtime state
-// Returns snapshot ID (0 to MAX_SNAPSHOTS-1), or -1 on error
+// History kept before the oldest snapshots are dropped, in bytes
+#define DEFAULT_SNAPSHOT_HISTORY_LIMIT (16 * 1024 * 1024)
+
+// Create a snapshot of the current runtime state. Taken after restoring an
+// earlier snapshot, it drops the snapshots after that one.
+// Returns the snapshot ID (increasing from 0), or -1 on error
 int runtime_create_snapshot(runtime_t* rt);
 
-// Restore runtime to a previously saved snapshot
-// Returns true on success, false if snapshot ID is invalid
+// Restore runtime to a previously saved snapshot; later snapshots stay
+// valid until the next runtime_create_snapshot
+// Returns true on success, false if the ID is unknown or was dropped
 bool runtime_restore_snapshot(runtime_t* rt, int snapshot_id);
 
 // Clear all snapshots (free memory)
 void runtime_clear_snapshots(runtime_t* rt);
 
+// Memory the snapshot history may use (0: no limit). Past it the oldest
+// snapshots are dropped, a keyframe interval at a time.
+void runtime_set_snapshot_history_limit(runtime_t* rt, size_t bytes);
+
 // Get the current line number being executed (before the statement runs)
 uint32_t runtime_get_next_line(runtime_t* rt);
 
 // Get total number of snapshots currently stored
 int runtime_get_snapshot_count(runtime_t* rt);
 
-// Get variables JSON string (caller must free)
+// Bytes the stored snapshots take
+size_t runtime_get_snapshot_bytes(runtime_t* rt);
+
+// Time travel by re-execution. Instead of a snapshot per step, the runtime
+// keeps a full checkpoint every `interval` steps (see runtime_get_step_count)
+// and reaches any step by restoring the checkpoint before it and running
+// forward. The only input to the program, the values citeste reads, is
+// recorded by an io_replay backend, so a re-run takes the same path.
+// Memory grows with steps / interval and the input read.
+
+// Checkpoints apart, in steps
+#define DEFAULT_CHECKPOINT_INTERVAL 1000
+
+// Starts time travel from the current step (the checkpoints are taken
+// again from step 0 at every load). The runtime's io must be an io_replay
+// backend. Returns false if it is not, or out of memory.
+bool runtime_enable_time_travel(runtime_t* rt, uint32_t interval);
+void runtime_disable_time_travel(runtime_t* rt);
+
+// Puts the runtime at the state after `step` steps, back or forward.
+// Output written the first time through is not written again. Returns
+// false if the step is before time travel started, or the program stopped
+// before it (ended, failed, or needs input or output drained: resume and
+// call again).
+bool runtime_goto_step(runtime_t* rt, uint64_t step);
+
+size_t runtime_get_checkpoint_count(runtime_t* rt);
+
+// Packed step record: what a debugger shows after a step, in one block a
+// host can read in place (the web debugger reads it from the WASM heap).
+// A step_record_header_t is followed by var_count step_record_var_t and
+// then the text they point into (offsets from the start of the record, no
+// NUL). Only the variables written since the previous record are listed,
+// so building one costs what the steps in between changed, not how many
+// variables there are. With STEP_RECORD_FULL the list holds every
+// variable instead and replaces what the host had.
+
+#define STEP_RECORD_FULL 1u            // Every variable is listed
+#define STEP_RECORD_CONDITION 2u       // condition_* hold the last condition
+#define STEP_RECORD_CONDITION_TRUE 4u  // And it held
+
+typedef struct {
+    uint32_t size;              // Bytes in the whole record
+    uint32_t state;             // exec_state_t
+    uint32_t line;              // Next line to run (runtime_get_next_line)
+    uint32_t flags;             // STEP_RECORD_*
+    uint32_t condition_offset;
+    uint32_t condition_len;
+    uint32_t var_count;
+    uint32_t reserved;
+    uint64_t step;              // runtime_get_step_count
+} step_record_header_t;
+
+typedef struct {
+    uint32_t name_offset;
+    uint32_t name_len;
+    uint32_t type;              // value_type_t
+    uint32_t text_offset;       // The value as shown (value_to_string)
+    uint32_t text_len;
+    uint32_t reserved;
+    union {
+        int64_t i;              // VALUE_INT
+        double f;               // VALUE_FLOAT
+    } as;
+} step_record_var_t;
+
+// Builds the record of the current state in a buffer the runtime reuses:
+// valid until the next call or runtime_destroy. `full` asks for every
+// variable (the host lost its copy); the first record, and the first after
+// a load, are full anyway. Returns NULL out of memory.
+const step_record_header_t* runtime_get_step_record(runtime_t* rt, bool full);
+
+// Breakpoints, by line (0-based, as runtime_get_next_line reports). A
+// debugger run (runtime_continue and the like) stops where a step onto the
+// line would: right after the action on it. In between the program runs
+// at full speed; lines without a breakpoint cost a bit test.
+//
+// `condition` (NULL or "": none) is a pseudocode expression, compiled here
+// once. The breakpoint counts a hit when it holds (a condition that cannot
+// be evaluated, e.g. on a type mismatch, holds), and the run stops from
+// hit number `hit_target` on (0 or 1: at every hit). Hits count from the
+// load. Replaces any breakpoint on the line. Returns false, with a message
+// in *error (caller frees) if given, if the condition does not compile or
+// out of memory.
+bool runtime_set_breakpoint(runtime_t* rt, uint32_t line, const char* condition,
+                            uint32_t hit_target, string_t** error);
+void runtime_clear_breakpoint(runtime_t* rt, uint32_t line);
+void runtime_clear_breakpoints(runtime_t* rt);
+uint32_t runtime_get_breakpoint_hits(runtime_t* rt, uint32_t line);
+
+// Watchpoints, by variable name: a write to the variable that fires one
+// stops runtime_run and the debugger runs after that step, with
+// runtime_get_stop_reason giving STOP_WATCH. A single step reports it the
+// same way. Only writes by the program count, not restoring a snapshot or
+// replaying to a step. Writes to variables without one cost a flag test.
+typedef enum {
+    WATCH_CHANGE,     // A write that changes the value (or its type)
+    WATCH_VALUE,      // A write that makes it equal `arg`, computed once when set
+    WATCH_CONDITION,  // A write after which `arg` holds where it did not before
+} watch_kind_t;
+
+// `arg` is a pseudocode expression, as for a breakpoint condition; unused
+// for WATCH_CHANGE. Replaces any watch on the variable, which need not
+// exist yet; watches outlast a load. Returns false, with a message in
+// *error (caller frees) if given, if `arg` does not compile or evaluate,
+// or out of memory.
+bool runtime_set_watch(runtime_t* rt, const char* name, watch_kind_t kind, const char* arg,
+                       string_t** error);
+void runtime_clear_watch(runtime_t* rt, const char* name);
+void runtime_clear_watches(runtime_t* rt);
+
+typedef struct {
+    const char* name;
+    const char* old_value;  // As shown (value_to_string); NULL: the write created it
+    const char* new_value;
+    uint32_t line;          // Of the step that wrote it
+} watch_hit_t;
+
+// The last watch that fired since the load. The strings are valid until
+// the next write to a watched variable, load or watch change. Returns
+// false if none fired.
+bool runtime_get_watch_hit(runtime_t* rt, watch_hit_t* hit);
+
+// Get variables JSON string (caller must free; NULL out of memory)
 string_t* runtime_get_variables_json(runtime_t* rt);
 
 #endif // PSEUDO_DEBUGGER_H
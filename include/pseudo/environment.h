@@ -5,6 +5,7 @@
 #include "pseudo/value.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct environment environment_t;
 
@@ -13,9 +14,11 @@ void env_destroy(environment_t* env);
 
 // Set a variable (takes ownership of value)
 void env_set(environment_t* env, const string_t* name, value_t* value);
+void env_set_view(environment_t* env, strview_t name, value_t* value);
 
 // Get a variable (returns NULL if undefined, does not transfer ownership)
 value_t* env_get(environment_t* env, const string_t* name);
+value_t* env_get_view(environment_t* env, strview_t name);
 
 // Check if variable exists
 bool env_has(environment_t* env, const string_t* name);
@@ -30,4 +33,40 @@ size_t env_size(environment_t* env);
 typedef void (*env_iter_fn)(const string_t* name, const value_t* value, void* user_data);
 void env_foreach(environment_t* env, env_iter_fn callback, void* user_data);
 
+// === Change tracking ===
+// Variables are numbered in order of creation until env_clear. A tracker
+// lists each variable written since it was last taken, once; writes to a
+// variable already listed by every tracker only cost a flag check.
+
+#define ENV_MAX_TRACKERS 8
+
+// Returns a tracker id, or -1 if all are in use or out of memory
+int env_tracker_create(environment_t* env);
+void env_tracker_destroy(environment_t* env, int tracker);
+
+// Variables written since the last take (or the tracker's creation), in
+// order of first write, and resets the list. *cleared is set if env_clear
+// ran in between, or a write could not be listed for lack of memory: look
+// at every variable then. The array is valid until the next write.
+size_t env_tracker_take(environment_t* env, int tracker, const uint32_t** vars, bool* cleared);
+
+// Variable number `var`, or NULL if there is none
+value_t* env_var_at(environment_t* env, uint32_t var, const string_t** name);
+
+// === Watches ===
+// Writes to a watched variable go to the watch callback, with the value
+// before (NULL: the write created the variable) and after; the variable
+// already holds the new one. Watches are by name, whether or not the
+// variable exists yet, and outlast env_clear. Each variable has a watched
+// flag, so writes to the others cost one test.
+
+typedef void (*env_watch_fn)(strview_t name, const value_t* old_value, const value_t* new_value,
+                             void* user_data);
+
+void env_set_watch_callback(environment_t* env, env_watch_fn callback, void* user_data);
+
+// Returns false out of memory
+bool env_watch(environment_t* env, strview_t name);
+void env_unwatch(environment_t* env, strview_t name);
+
 #endif // PSEUDO_ENVIRONMENT_H
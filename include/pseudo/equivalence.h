@@ -1,13 +1,19 @@
 #ifndef PSEUDO_EQUIVALENCE_H
 #define PSEUDO_EQUIVALENCE_H
 
+#include "pseudo/parser.h"
 #include <stdint.h>
+#include <stddef.h>
 
 // Returns a malloc'd JSON array of all loops in source:
 //   [{"type":"for","start_line":N,"end_line":N}, ...]
 // Lines are 0-indexed. Caller frees with free().
 char* equiv_get_all_loops(const char* source);
 
+// Same JSON for an already parsed tree, keeping only the loops that start
+// on one of the row spans (sorted by first row). Caller frees with free().
+char* equiv_get_loops_in_rows(TSNode root, const row_span_t* rows, size_t row_count);
+
 // Returns a malloc'd string with the full source, with the innermost loop
 // containing (line, col) [0-indexed] replaced by an equivalent using
 // target_type: "for" | "while" | "do_while" | "repeat".
@@ -0,0 +1,20 @@
+// Read-only view of a whole file. The file is memory-mapped where the
+// platform allows it and read into a heap buffer otherwise.
+
+#ifndef PSEUDO_FILEMAP_H
+#define PSEUDO_FILEMAP_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct {
+    const char* data;  // NULL for an empty file; not NUL-terminated
+    size_t len;
+    bool mapped;       // false: data is a heap copy
+} filemap_t;
+
+// Returns false (and leaves *map empty) if the file cannot be opened or read
+bool filemap_open(filemap_t* map, const char* path);
+void filemap_close(filemap_t* map);
+
+#endif // PSEUDO_FILEMAP_H
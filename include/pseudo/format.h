@@ -0,0 +1,19 @@
+// Number formatting used by scrie. Produces exactly what the printf-based
+// formatting did ("%" PRId64 for integers; "%.0f" for integral doubles below
+// 1e15 and "%g" otherwise) without going through printf or the heap.
+
+#ifndef PSEUDO_FORMAT_H
+#define PSEUDO_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Large enough for any value produced below, including the terminating NUL
+#define FORMAT_NUMBER_MAX 32
+
+// Write the value into buf (at least FORMAT_NUMBER_MAX bytes), NUL-terminated.
+// Returns the number of characters written, excluding the NUL.
+size_t format_i64(char* buf, int64_t value);
+size_t format_f64(char* buf, double value);
+
+#endif // PSEUDO_FORMAT_H
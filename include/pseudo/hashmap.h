@@ -1,5 +1,5 @@
 // Hashmap with string_t keys and string_t values
-// Uses open addressing with linear probing
+// Thin wrapper over table_t (see pseudo/table.h)
 
 #ifndef PSEUDO_HASHMAP_H
 #define PSEUDO_HASHMAP_H
@@ -16,6 +16,9 @@ void hashmap_destroy(hashmap_t* map);
 void hashmap_set(hashmap_t* map, const string_t* key, const string_t* value);
 string_t* hashmap_get(hashmap_t* map, const string_t* key);
 bool hashmap_has(hashmap_t* map, const string_t* key);
+void hashmap_set_view(hashmap_t* map, strview_t key, strview_t value);
+string_t* hashmap_get_view(hashmap_t* map, strview_t key);
+bool hashmap_has_view(hashmap_t* map, strview_t key);
 bool hashmap_delete(hashmap_t* map, const string_t* key);
 
 size_t hashmap_size(hashmap_t* map);
@@ -0,0 +1,59 @@
+// Syntax highlighting from the grammar's highlight query
+// (tree-sitter-pseudo/queries/highlights.scm) run over a parsed tree, so
+// the colors follow the parse instead of a separate regex grammar.
+
+#ifndef PSEUDO_HIGHLIGHT_H
+#define PSEUDO_HIGHLIGHT_H
+
+#include <tree_sitter/api.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// One per capture name of the query; highlight_type_name gives the name
+typedef enum {
+    HL_KEYWORD,
+    HL_KEYWORD_OPERATOR,
+    HL_OPERATOR,
+    HL_PUNCTUATION_BRACKET,
+    HL_PUNCTUATION_DELIMITER,
+    HL_NUMBER,
+    HL_STRING,
+    HL_VARIABLE,
+    HL_VARIABLE_PARAMETER,
+    HL_COMMENT,
+    HL_TYPE_COUNT,
+} highlight_type_t;
+
+// Tokens packed as (start byte, length in bytes, highlight_type_t)
+// triples, sorted by start and not overlapping
+typedef struct {
+    uint32_t* data;
+    size_t count;      // Triples, not integers
+    size_t capacity;
+} highlight_tokens_t;
+
+typedef struct highlighter highlighter_t;
+
+// Compiles the query; keep one highlighter for many calls
+highlighter_t* highlighter_create(void);
+void highlighter_destroy(highlighter_t* highlighter);
+
+// Replaces `tokens` with the tokens of the nodes overlapping
+// [start_byte, end_byte). The query only visits nodes in that range, so a
+// viewport costs about as much as its own text. Returns false out of memory.
+bool highlight_range(highlighter_t* highlighter, TSNode root,
+                     uint32_t start_byte, uint32_t end_byte, highlight_tokens_t* tokens);
+
+// Every token under `root`
+bool highlight_all(highlighter_t* highlighter, TSNode root, highlight_tokens_t* tokens);
+
+void highlight_tokens_free(highlight_tokens_t* tokens);
+
+// Capture name, e.g. "keyword.operator"
+const char* highlight_type_name(highlight_type_t type);
+
+// Text of the query the highlighter runs
+const char* highlight_query_source(void);
+
+#endif // PSEUDO_HIGHLIGHT_H
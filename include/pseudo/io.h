@@ -2,33 +2,146 @@
 #define PSEUDO_IO_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 typedef struct io io_t;
 
-// Virtual function table
+// Virtual function table. write, read and destroy are required; the rest
+// are optional fast paths (NULL falls back to write, see io_write_* below).
 typedef struct {
     void (*write)(io_t* io, const char* text);
     const char* (*read)(io_t* io);  // Returns NULL if input not ready
     void (*destroy)(io_t* io);
+
+    void (*write_buf)(io_t* io, const char* data, size_t len);
+    void (*write_i64)(io_t* io, int64_t value);
+    void (*write_f64)(io_t* io, double value);  // Formatted like format_f64
+    void (*flush)(io_t* io);
 } io_ops_t;
 
+// What the backend asks of the program after a write (or a read that
+// returned NULL)
+typedef enum {
+    IO_OK,
+    IO_HALT,          // End the program (e.g. the checker found a difference)
+    IO_OUTPUT_FULL,   // Pending output reached its capacity: drain, then resume
+    IO_OUTPUT_LIMIT,  // Total output would go over the output limit
+    IO_NO_MEMORY,     // The backend could not allocate: end with a memory error
+} io_status_t;
+
 // Base I/O interface
 struct io {
     io_ops_t ops;
     void* ctx;  // Backend-specific context
+    io_status_t status;
+    size_t output_total;  // Bytes accepted so far
+    size_t output_limit;  // Cap on output_total (0 = unlimited)
 };
 
-// CLI backend - blocking stdio
+// Sets up the common fields; every backend constructor calls this
+void io_init(io_t* io, const io_ops_t* ops, void* ctx);
+
+// Cap on the total bytes a program may write (0 = unlimited). Backends
+// enforce it by calling io_accept_output before taking any bytes: it
+// returns false, and sets IO_OUTPUT_LIMIT, if `len` more bytes would go
+// over the cap, in which case the write is dropped.
+void io_set_output_limit(io_t* io, size_t bytes);
+bool io_accept_output(io_t* io, size_t len);
+
+// CLI backend - blocking stdio. Output is buffered and written in large
+// chunks; it is flushed when the buffer fills, before every read, on
+// io_stdio_flush and on destroy (or after each line when line buffered).
 io_t* io_stdio_create(void);
+void io_stdio_set_line_buffered(io_t* io, bool enabled);
+void io_stdio_flush(io_t* io);
+
+// How citeste splits the input into values
+typedef enum {
+    IO_INPUT_LINES,   // One value per line (default)
+    IO_INPUT_TOKENS,  // One value per whitespace-separated token
+} io_input_mode_t;
+
+// Input is read from stdin in large blocks, or from a file mapped with
+// io_stdio_open_input (returns false if it cannot be opened). Values of
+// any length are returned whole.
+void io_stdio_set_input_mode(io_t* io, io_input_mode_t mode);
+bool io_stdio_open_input(io_t* io, const char* path);
 
 // WASM backend - non-blocking buffered I/O
 io_t* io_buffered_create(void);
-void io_buffered_push_input(io_t* io, const char* value);
-char* io_buffered_pop_output(io_t* io);  // Returns NULL if empty, caller owns
+void io_buffered_push_input(io_t* io, const char* value);  // One value, copied
+// Queues a whole input text (e.g. a pasted file) without copying it. Takes
+// ownership of `data`, which must come from malloc and have room for
+// data[len] = '\0'; it is freed with free() once all its values are read.
+// Values are cut from it lazily according to the input mode and never span
+// two blocks. Returns false (data already freed) on failure.
+bool io_buffered_push_input_block(io_t* io, char* data, size_t len);
+void io_buffered_set_input_mode(io_t* io, io_input_mode_t mode);
+// Undrained output that makes a write report IO_OUTPUT_FULL (0 = unlimited).
+// The status clears once the output is drained.
+void io_buffered_set_output_capacity(io_t* io, size_t bytes);
+// Copies out the whole pending span, as io_buffered_drain_output hands it,
+// into a malloc'd string the caller frees. Returns NULL if nothing is pending.
+char* io_buffered_pop_output(io_t* io);
+// Hands out everything written since the last drain as one contiguous,
+// NUL-terminated span. Valid until the next write.
+bool io_buffered_drain_output(io_t* io, const char** data, size_t* len);
 bool io_buffered_has_output(io_t* io);
 bool io_buffered_needs_input(io_t* io);
 void io_buffered_clear(io_t* io);
 
+// Checker backend - compares the program's output with an expected output
+// as it is produced and halts the program at the first difference. Reads
+// are passed to `input`, which the checker owns.
+typedef enum {
+    IO_CHECK_EXACT,   // Byte for byte
+    IO_CHECK_LINES,   // Ignore trailing whitespace on lines and blank lines at the end
+    IO_CHECK_TOKENS,  // Compare whitespace-separated words only
+} io_check_mode_t;
+
+// Preview length of the expected and actual text in a report
+#define IO_CHECK_PREVIEW 48
+
+typedef struct {
+    bool match;
+    size_t offset;  // Byte offset of the first difference in the expected output
+    size_t line;    // 1-based line of that offset
+    char expected[IO_CHECK_PREVIEW + 1];  // From there to the end of its line
+    char actual[IO_CHECK_PREVIEW + 1];    // What the program wrote instead
+    bool expected_end;                    // Expected output ended there
+    bool actual_end;                      // Program output ended there
+} io_check_report_t;
+
+io_t* io_check_create(io_t* input, io_check_mode_t mode);
+// Opens (maps) the expected output; returns false if it cannot be read
+bool io_check_open_expected(io_t* io, const char* path);
+// Call once the program has ended: checks that nothing expected is missing
+void io_check_finish(io_t* io, io_check_report_t* report);
+
+// Replay backend - lets the debugger re-execute a program (time travel).
+// While recording, values read from `inner` (owned by the replay backend)
+// are kept; after io_replay_seek moves back, reads return the recorded
+// values again until they run out and `inner` is read once more. Writes go
+// to `inner` unless muted, which re-execution uses to not repeat output.
+io_t* io_replay_create(io_t* inner);
+bool io_is_replay(const io_t* io);
+io_t* io_replay_inner(io_t* io);
+// Starts a new recording, or stops and frees it; reads pass through while off
+void io_replay_record(io_t* io, bool enabled);
+size_t io_replay_position(const io_t* io);  // Values read so far
+// Next read returns recorded value `position`. Returns false if that value
+// was not recorded (past the end, or dropped at the memory cap).
+bool io_replay_seek(io_t* io, size_t position);
+void io_replay_set_muted(io_t* io, bool muted);
+
+// Write through the fast paths when the backend has them, otherwise through
+// ops.write. The text written is the same either way.
+void io_write_buf(io_t* io, const char* data, size_t len);
+void io_write_i64(io_t* io, int64_t value);
+void io_write_f64(io_t* io, double value);
+void io_flush(io_t* io);  // No-op for backends without ops.flush
+
 // Generic destroy (calls ops.destroy)
 void io_destroy(io_t* io);
 
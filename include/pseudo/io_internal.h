@@ -0,0 +1,11 @@
+#ifndef PSEUDO_IO_INTERNAL_H
+#define PSEUDO_IO_INTERNAL_H
+
+#include <stdbool.h>
+
+// Separates tokens: the input readers and the token checker must agree
+static inline bool io_is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+#endif // PSEUDO_IO_INTERNAL_H
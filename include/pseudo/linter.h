@@ -2,7 +2,74 @@
 #define PSEUDO_LINTER_H
 
 #include "pseudo/string.h"
+#include <stdbool.h>
+#include <stdint.h>
 
+// Returns the linted text as a new string
 string_t* lint(const string_t* source);
 
+// Lints `len` bytes at `source` (need not be NUL-terminated). When the text
+// is already in linted form nothing is copied: returns NULL and sets
+// *unchanged, and the caller uses `source` as is. Otherwise NULL means out
+// of memory.
+string_t* lint_buf(const char* source, size_t len, bool* unchanged);
+
+// Only the symbol substitution pass of lint: lines are kept as they are,
+// so a range of lines can be substituted on its own
+string_t* lint_substitute(const char* source, size_t len);
+
+// Maps byte offsets in lint_substitute's output back to the text it was
+// given, walking both once: the offsets asked must not decrease. An offset
+// inside a replacement maps to the start of the symbol it replaced.
+typedef struct {
+    const char* source;
+    size_t len;
+    size_t in;    // Source bytes walked
+    size_t out;   // Output bytes they became
+} lint_origin_t;
+
+void lint_origin_init(lint_origin_t* origin, const char* source, size_t len);
+size_t lint_origin_map(lint_origin_t* origin, size_t offset);
+
+// Lint session: an editor document kept in linted form line by line.
+// Each line caches its substituted text and the block depth entering it,
+// so an edit only relints the edited lines and the ones after them whose
+// depth moved, stopping where the depth meets the cached one again.
+typedef struct lint_session lint_session_t;
+
+// Output lines [first, old_end) of the previous text became [first, new_end)
+typedef struct {
+    uint32_t first;
+    uint32_t old_end;
+    uint32_t new_end;
+} lint_change_t;
+
+lint_session_t* lint_session_create(void);
+void lint_session_destroy(lint_session_t* session);
+
+// Replaces the whole document
+bool lint_session_set_text(lint_session_t* session, const char* text, size_t len);
+
+// Lines [start_line, old_end_line) became `text` (the new lines joined by
+// '\n'). Fills *change with the output lines that differ. On false the
+// session is unchanged.
+bool lint_session_replace_lines(lint_session_t* session, uint32_t start_line,
+                                uint32_t old_end_line, const char* text, size_t len,
+                                lint_change_t* change);
+
+uint32_t lint_session_line_count(const lint_session_t* session);
+
+// Appends the linted form of `line`, without its '\n'
+void lint_session_render_line(const lint_session_t* session, uint32_t line, string_t* out);
+
+// True if the line as typed is already its linted form
+bool lint_session_line_linted(const lint_session_t* session, uint32_t line);
+
+// True if the document ends as lint ends it: empty, or with a '\n' after
+// the last line
+bool lint_session_ends_linted(const lint_session_t* session);
+
+// The whole document linted, equal to lint() of the text
+string_t* lint_session_text(const lint_session_t* session);
+
 #endif // PSEUDO_LINTER_H
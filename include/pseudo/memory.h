@@ -0,0 +1,61 @@
+// Accounting allocator used by the runtime and its supporting modules.
+// Every block carries a small header with its size and subsystem so usage
+// can be tracked per subsystem, with a peak watermark and an optional cap.
+
+#ifndef PSEUDO_MEMORY_H
+#define PSEUDO_MEMORY_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum {
+    MEM_VALUES,     // value_t objects
+    MEM_STRINGS,    // string_t objects and their buffers
+    MEM_ENV,        // hash tables (environment, transpiler maps)
+    MEM_PARSER,     // tree-sitter trees and parser state
+    MEM_IO,         // buffered input/output
+    MEM_OTHER,      // everything else (runtime, debugger snapshots)
+    MEM_SUBSYSTEM_COUNT
+} mem_subsystem_t;
+
+typedef struct {
+    size_t current;                         // Bytes currently allocated
+    size_t peak;                            // Highest value of current
+    size_t limit;                           // Cap in bytes (0 = unlimited)
+    size_t allocations;                     // Number of allocation calls
+    size_t subsystem[MEM_SUBSYSTEM_COUNT];  // Current bytes per subsystem
+} mem_stats_t;
+
+// Underlying allocator (defaults to malloc/realloc/free). Only swap it
+// while no accounted blocks are live.
+typedef struct {
+    void* (*malloc)(size_t size);
+    void* (*realloc)(void* ptr, size_t size);
+    void (*free)(void* ptr);
+} mem_backend_t;
+
+void mem_set_backend(const mem_backend_t* backend);
+
+// Allocation. Going over the cap raises the limit_exceeded flag so the
+// runtime can stop the program after the current step; requests that would
+// go past the cap plus a small slack (kept for unwinding) return NULL.
+void* mem_alloc(mem_subsystem_t subsystem, size_t size);
+void* mem_calloc(mem_subsystem_t subsystem, size_t count, size_t size);
+void* mem_realloc(mem_subsystem_t subsystem, void* ptr, size_t size);
+char* mem_strdup(mem_subsystem_t subsystem, const char* str);
+void mem_free(void* ptr);
+
+// Cap on total accounted bytes (0 = unlimited)
+void mem_set_limit(size_t bytes);
+bool mem_limit_exceeded(void);
+void mem_clear_limit_exceeded(void);
+
+void mem_get_stats(mem_stats_t* out);
+void mem_reset_peak(void);
+const char* mem_subsystem_name(mem_subsystem_t subsystem);
+
+// Route tree-sitter allocations through the accounting allocator (counted
+// under MEM_PARSER, never refused). Must run before any tree-sitter call.
+void mem_install_tree_sitter(void);
+
+#endif // PSEUDO_MEMORY_H
@@ -10,6 +10,7 @@ typedef enum {
     PARSER_OK,
     PARSER_ERR_MEMORY,    // Memory allocation failed
     PARSER_ERR_SYNTAX,    // Syntax error in source
+    PARSER_ERR_TIMEOUT,   // Parse stopped at its deadline (see parser_resume)
 } parser_error_type_t;
 
 typedef struct {
@@ -21,20 +22,61 @@ typedef struct {
 
 typedef struct parser parser_t;
 
+// Inclusive range of rows (0-indexed lines)
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+} row_span_t;
+
 parser_t* parser_create(void);
 void parser_destroy(parser_t* parser);
 
-// Parse source code, returns error info
+// Parse source code, returns error info (the parser keeps a copy)
 parser_error_t parser_parse(parser_t* parser, const string_t* source);
 
+// Parse a source the parser takes ownership of, without copying it
+parser_error_t parser_parse_owned(parser_t* parser, string_t* source);
+
+// Parse borrowed text, which must stay valid and unchanged until the next
+// parse or parser_destroy (need not be NUL-terminated)
+parser_error_t parser_parse_borrowed(parser_t* parser, const char* source, size_t len);
+
+// Lint raw source and parse the result. The linted text is handed to the
+// parser without a copy; when linting changes nothing, the parser borrows
+// `source` if `borrow` is set (same rules as parser_parse_borrowed) and
+// copies it otherwise.
+parser_error_t parser_parse_source(parser_t* parser, const char* source, size_t len, bool borrow);
+
+// Limit each parse call to about `micros` microseconds (0: no limit, the
+// default). A parse that runs out of time returns PARSER_ERR_TIMEOUT and
+// has no tree; parser_resume continues it.
+void parser_set_timeout(parser_t* parser, uint64_t micros);
+
+// Continue a parse that returned PARSER_ERR_TIMEOUT, with a fresh time
+// slice. The text must be the one it started on. Any other parse call
+// abandons it.
+parser_error_t parser_resume(parser_t* parser);
+
+// True while a timed-out parse waits for parser_resume
+bool parser_pending(parser_t* parser);
+
+// Describe an edit to the text of the last parse. The next parse (of the
+// edited text) reuses the unchanged parts of the tree; several edits may be
+// applied before it.
+void parser_edit(parser_t* parser, const TSInputEdit* edit);
+
+// Ranges whose syntax differs between the edited tree and the last parse.
+// Empty unless that parse followed parser_edit.
+const TSRange* parser_changed_ranges(parser_t* parser, uint32_t* count);
+
 // Free error message if allocated
 void parser_error_free(parser_error_t* error);
 
 // Get root node of parsed tree
 TSNode parser_root(parser_t* parser);
 
-// Get source text
-const string_t* parser_source(parser_t* parser);
+// Get source text of the last parse (not NUL-terminated)
+strview_t parser_source(parser_t* parser);
 
 // Check if tree has errors
 bool parser_has_error(parser_t* parser);
@@ -42,6 +84,9 @@ bool parser_has_error(parser_t* parser);
 // Get node text as new string (caller frees)
 string_t* parser_node_text(parser_t* parser, TSNode node);
 
+// Get node text as a view into the parsed source (valid until the next parse)
+strview_t parser_node_view(parser_t* parser, TSNode node);
+
 // Get pretty-printed tree (caller frees)
 string_t* parser_pretty_tree(parser_t* parser);
 
@@ -90,4 +135,7 @@ TSNode parser_child_by_field(TSNode node, const char* field_name);
 // Get identifier value (asserts node type == "identifier")
 string_t* parser_get_identifier(parser_t* parser, TSNode node);
 
+// Get identifier value as a view (asserts node type == "identifier")
+strview_t parser_get_identifier_view(parser_t* parser, TSNode node);
+
 #endif // PSEUDO_PARSER_H
@@ -18,7 +18,7 @@ typedef struct {
 void find_first_error(TSNode root, const char* source, error_info_t* info);
 
 // Build a detailed Romanian error message from error info
-string_t* build_error_message(const string_t* source, error_info_t* info);
+string_t* build_error_message(strview_t source, error_info_t* info);
 
 // Helper: translate tree-sitter node types to Romanian
 const char* translate_node_type(const char* type);
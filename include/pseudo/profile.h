@@ -0,0 +1,49 @@
+// Per-line profiler: counts the steps taken on each source line and, when
+// timed, the time they take. A profiled run is its own loop, so runtime_run
+// pays nothing for it.
+
+#ifndef PSEUDO_PROFILE_H
+#define PSEUDO_PROFILE_H
+
+#include "pseudo/runtime.h"
+#include "pseudo/string.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct profile profile_t;
+
+// Lines of the loop listing in the report
+#define PROFILE_HOT_LOOPS 5
+
+typedef struct {
+    uint64_t steps;   // Steps that ended on the line (as runtime_step counts them,
+                      // but not the step that ends the program)
+    uint64_t ns;      // Time from the step before (0 untimed)
+} profile_line_t;
+
+// `timed` reads a monotonic clock after every step
+profile_t* profile_create(bool timed);
+void profile_destroy(profile_t* profile);
+
+// Runs like runtime_run, adding to the profile; call again after the
+// program waits for input or output, as with runtime_run
+exec_state_t runtime_run_profiled(runtime_t* rt, profile_t* profile);
+
+// Counts for 0-based `line` (zero past the last line run)
+profile_line_t profile_get_line(const profile_t* profile, uint32_t line);
+profile_line_t profile_get_total(const profile_t* profile);
+
+// Annotated listing of the program `rt` ran: each line with its steps and
+// time and their share, then the hottest loops. Caller frees; NULL out of
+// memory.
+string_t* profile_report(const profile_t* profile, runtime_t* rt);
+
+// The same as JSON, for the web IDE's heatmap (lines 0-based, only those
+// that ran; loops hottest first, with the steps on their condition's line):
+//   {"timed":true,"steps":N,"ns":N,"lines":[[line,steps,ns],...],
+//    "loops":[{"line":l,"end":l,"steps":N,"ns":N,"checks":N},...]}
+// Caller frees; NULL out of memory.
+string_t* profile_json(const profile_t* profile, runtime_t* rt);
+
+#endif // PSEUDO_PROFILE_H
@@ -2,6 +2,8 @@
 #define PSEUDO_RUNTIME_H
 
 #include "pseudo/io.h"
+#include "pseudo/memory.h"
+#include "pseudo/string.h"
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -11,7 +13,8 @@ typedef enum {
     EXEC_CONTINUE,    // More statements to execute
     EXEC_DONE,        // Program finished successfully
     EXEC_NEEDS_INPUT, // Waiting for input (WASM mode)
-    EXEC_ERROR        // Error occurred
+    EXEC_ERROR,       // Error occurred
+    EXEC_OUTPUT_FULL  // Output buffer full: drain it, then resume (WASM mode)
 } exec_state_t;
 
 // Lifecycle
@@ -21,17 +24,45 @@ void runtime_destroy(runtime_t* rt);
 // Loading source code
 bool runtime_load(runtime_t* rt, const char* source);
 
+// Loads without copying when the source is already linted: it must stay
+// valid and unchanged until the next load or runtime_destroy
+bool runtime_load_view(runtime_t* rt, strview_t source);
+
 // Execution
 exec_state_t runtime_step(runtime_t* rt);       // Execute one visible action
 exec_state_t runtime_step_over(runtime_t* rt);  // Execute until same/lower stack depth
-exec_state_t runtime_run(runtime_t* rt);        // Run until done/input/error (CLI)
-void runtime_resume(runtime_t* rt);             // Resume after input provided (WASM mode)
+exec_state_t runtime_run(runtime_t* rt);        // Run until done/input/error or a watchpoint (CLI)
+// Debugger runs: like runtime_run, but they also stop at breakpoints (see
+// debugger.h) and at their own target, returning EXEC_CONTINUE there.
+// runtime_step_over stops at breakpoints as well.
+exec_state_t runtime_continue(runtime_t* rt);
+exec_state_t runtime_step_out(runtime_t* rt);   // Until the innermost if or loop is left
+exec_state_t runtime_run_to_line(runtime_t* rt, uint32_t line);  // Until a step onto `line`
+// Runs like runtime_run, stopping once `step` steps have been taken
+// (watchpoints do not fire)
+exec_state_t runtime_run_to_step(runtime_t* rt, uint64_t step);
+// Why the last step or run stopped where it did
+typedef enum {
+    STOP_NONE,        // Where it was asked to, or the program stopped running
+    STOP_BREAKPOINT,
+    STOP_WATCH,       // A watchpoint fired (see runtime_get_watch_hit)
+} stop_reason_t;
+stop_reason_t runtime_get_stop_reason(runtime_t* rt);
+void runtime_resume(runtime_t* rt);             // Resume after input provided or output drained
 void runtime_request_stop(runtime_t* rt);       // Request stop (checked in loops)
 int runtime_get_stack_depth(runtime_t* rt);     // Get current execution stack depth
+// Steps taken since the load, where a step is what one runtime_step does.
+// A read that waits for input counts once, when the input arrives.
+uint64_t runtime_get_step_count(runtime_t* rt);
 
 // Error reporting
 const char* runtime_get_error(runtime_t* rt);
 
+// Memory accounting. The cap covers every accounted allocation in the process
+// (0 = unlimited); exceeding it stops the program with EXEC_ERROR.
+void runtime_set_memory_limit(runtime_t* rt, size_t bytes);
+void runtime_get_memory_stats(runtime_t* rt, mem_stats_t* out);
+
 // Debug mode control
 void runtime_set_debug_mode(runtime_t* rt, bool enabled);
 bool runtime_get_debug_mode(runtime_t* rt);
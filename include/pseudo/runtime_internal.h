@@ -6,6 +6,7 @@
 #include "pseudo/parser.h"
 #include "pseudo/environment.h"
 #include "pseudo/string.h"
+#include "pseudo/tree_walk.h"
 #include <tree_sitter/api.h>
 
 // Execution frame types for stack-based stepping
@@ -49,6 +50,7 @@ struct runtime {
     string_t* error_msg;
 
     TSNode program_root;
+    node_index_t node_index;  // Nodes by start byte, built on demand (debugger.c)
 
     // Execution stack for line-by-line stepping
     exec_frame_t exec_stack[MAX_STACK_DEPTH];
@@ -74,10 +76,60 @@ struct runtime {
     bool last_condition_result;
     bool has_condition_info;
 
-    // Debugger state - snapshots stored as circular buffer
-    struct runtime_snapshot* snapshots[MAX_SNAPSHOTS];
-    int snapshot_head;
-    int snapshot_count;
+    // Debugger state - snapshot journal, created at the first snapshot (debugger.c)
+    struct snapshot_history* history;
+    size_t history_limit;
+
+    // Steps taken since the load (runtime_get_step_count)
+    uint64_t step_count;
+
+    // Time travel checkpoints (debugger.c); timeline_on_step runs once
+    // step_count reaches timeline_mark (UINT64_MAX when off)
+    struct timeline* timeline;
+    uint64_t timeline_mark;
+
+    // Packed step record buffer, created at the first record (debugger.c)
+    struct step_record* step_record;
+
+    // Breakpoints (breakpoint.c), with a bit per line that has one: a
+    // debugger run only looks further on the lines whose bit is set
+    struct breakpoints* breakpoints;
+    uint64_t* break_lines;
+    uint32_t break_words;
+
+    // Watchpoints (breakpoint.c); the env calls them on watched writes
+    struct watchpoints* watchpoints;
+    bool watches_muted;       // Writes that are not the program's own
+    stop_reason_t stop_reason;
+
+    // Set while breakpoint.c evaluates a condition: variables are only read
+    // (a missing one is 0 and not created), and `probe_name`, if
+    // `probe_value` is set, reads as that value
+    bool probe;
+    strview_t probe_name;
+    const value_t* probe_value;
 };
 
+// Evaluates an expression of the tree rt->parser holds, in interpreter.c.
+// On a value error it sets EXEC_ERROR and error_msg, and may return NULL.
+value_t* eval_expr(runtime_t* rt, TSNode expr_node);
+
+// Time travel hooks, in debugger.c
+void timeline_on_step(runtime_t* rt);
+void timeline_on_load(runtime_t* rt);  // The program was (re)loaded
+
+void step_record_free(runtime_t* rt);  // In debugger.c, before the env goes
+
+// Breakpoint hooks, in breakpoint.c. breakpoint_hit counts a hit on
+// `line` if its condition holds and says whether the run stops there.
+bool breakpoint_hit(runtime_t* rt, uint32_t line);
+void breakpoints_on_load(runtime_t* rt);  // Hits count from the load
+void watches_on_load(runtime_t* rt);      // Forgets the last hit
+
+// Profiler hooks, in profile.c: profile_note adds a step that ended on
+// `line`, timed from the one before (or from profile_start)
+struct profile;
+void profile_start(struct profile* profile);
+void profile_note(struct profile* profile, uint32_t line);
+
 #endif // PSEUDO_RUNTIME_INTERNAL_H
@@ -0,0 +1,60 @@
+// Parser session for an editor buffer. The session keeps its own copy of
+// the document with symbols substituted line by line (lint without the
+// reindent, which only changes whitespace the grammar ignores), so editor
+// lines map 1:1 onto parsed rows and each edit reparses incrementally.
+
+#ifndef PSEUDO_SESSION_H
+#define PSEUDO_SESSION_H
+
+#include "pseudo/parser.h"
+#include "pseudo/highlight.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct session session_t;
+
+session_t* session_create(void);
+void session_destroy(session_t* session);
+
+// Replaces the whole document
+bool session_set_text(session_t* session, const char* text, size_t len);
+
+// Replaces lines [start_line, old_end_line) with `text`: its lines separated
+// by '\n', without a trailing newline. Takes effect at the next update.
+// Returns false (session unchanged) for a bad range or out of memory.
+bool session_replace_lines(session_t* session, uint32_t start_line, uint32_t old_end_line,
+                           const char* text, size_t len);
+
+// Reparses after edits. *rows gets the rows whose syntax or text changed
+// since the previous update, sorted and disjoint (none if nothing was
+// edited). Returns false if the document could not be parsed.
+// With a parser timeout (parser_set_timeout on session_parser) an update
+// may run out of time: it reports no rows and session_pending is true
+// until a later update finishes the parse where it stopped.
+bool session_update(session_t* session, const row_span_t** rows, size_t* count);
+
+// True while the parse of the current text is unfinished (no tree yet)
+bool session_pending(session_t* session);
+
+// True if edits have not been reparsed yet: positions in the tree are stale
+bool session_dirty(session_t* session);
+
+// Parser holding the last update's tree (its source is only valid until the next edit)
+parser_t* session_parser(session_t* session);
+
+// The document as given, before substitution (valid until the next edit).
+// Its lines are the parsed rows, but columns differ where a symbol was
+// replaced: lint_origin_map converts parsed offsets back.
+strview_t session_source(session_t* session);
+
+// Places highlight tokens in the document as given. `tokens` come from
+// highlight_range over session_parser's tree from byte `start`, where row
+// `first_row` starts; tokens before it are skipped. `out` gets four
+// integers per token, (row, column, length, highlight type), with the
+// column and length in UTF-16 code units, and needs room for all of them.
+// Returns how many were placed.
+size_t session_place_tokens(session_t* session, const highlight_tokens_t* tokens,
+                            uint32_t start, uint32_t first_row, uint32_t* out);
+
+#endif // PSEUDO_SESSION_H
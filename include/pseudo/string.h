@@ -6,11 +6,28 @@
 
 typedef struct string string_t;
 
+// Non-owning view into a byte range (not NUL-terminated)
+typedef struct {
+    const char* data;
+    size_t len;
+} strview_t;
+
+// printf helpers for views: printf(SV_FMT, SV_ARG(view))
+#define SV_FMT "%.*s"
+#define SV_ARG(v) (int)(v).len, (v).data
+
+// Views
+strview_t strview_from_cstr(const char* cstr);
+strview_t string_view(const string_t* str);
+bool strview_equals(strview_t view, const char* cstr);
+bool strview_equals_view(strview_t a, strview_t b);
+
 // Creation and destruction
 string_t* string_create(void);
 string_t* string_create_from(const char* cstr);
 string_t* string_create_from_buf(const char* buf, size_t len);
 string_t* string_create_from_string(const string_t* str);
+string_t* string_create_from_view(strview_t view);
 string_t* string_create_with_capacity(size_t capacity);
 void string_destroy(string_t* str);
 
@@ -24,15 +41,25 @@ void string_shrink_to_fit(string_t* str);
 const char* string_cstr(const string_t* str);
 char string_at(const string_t* str, size_t index);
 
-// Modification
+// Modification. An append the buffer cannot grow for (memory cap reached)
+// is dropped and marks the string failed; check string_failed before using
+// a string built from many appends.
 void string_append(string_t* str, const char* cstr);
 void string_append_buf(string_t* str, const char* buf, size_t len);
 void string_append_char(string_t* str, char c);
 void string_append_string(string_t* str, const string_t* other);
-void string_clear(string_t* str);
+void string_append_view(string_t* str, strview_t view);
+void string_clear(string_t* str);  // Also clears the failed mark
+
+// True once an append was dropped
+bool string_failed(const string_t* str);
+
+// Replaces old_len bytes at start with buf; false (and unchanged) if the buffer cannot grow
+bool string_replace(string_t* str, size_t start, size_t old_len, const char* buf, size_t len);
 
 // Utility
 bool string_equals(const string_t* str, const char* cstr);
 bool string_equals_string(const string_t* a, const string_t* b);
+bool string_equals_view(const string_t* str, strview_t view);
 
 #endif // PSEUDO_STRING_H
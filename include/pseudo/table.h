@@ -0,0 +1,54 @@
+// Open-addressing hash table keyed by strings, shared by hashmap_t and
+// environment_t. Robin Hood probing over a power-of-two slot array with
+// stored hashes; entries live in a dense array kept in insertion order.
+// Lookups take borrowed (ptr, len) keys and never allocate.
+
+#ifndef PSEUDO_TABLE_H
+#define PSEUDO_TABLE_H
+
+#include "pseudo/string.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct table table_t;
+
+typedef void (*table_free_fn)(void* value);
+typedef void (*table_iter_fn)(const string_t* key, void* value, void* user_data);
+
+table_t* table_create(size_t initial_capacity);
+void table_destroy(table_t* table, table_free_fn free_value);
+
+// Find a value (returns NULL if missing)
+void* table_get(const table_t* table, strview_t key);
+bool table_has(const table_t* table, strview_t key);
+
+// Find or insert a key, returning its value slot. A new slot holds NULL and
+// *inserted is set; the key is copied only on insertion. The pointer is valid
+// until the next insertion or removal. Returns NULL if the memory cap refuses
+// the insertion.
+void** table_upsert(table_t* table, strview_t key, bool* inserted);
+
+// Entry index of a slot returned by table_upsert: its place in insertion
+// order. Indexes are stable until a removal or clear.
+size_t table_slot_index(const table_t* table, void** slot);
+
+// Value slot of the entry at `index` (and its key, if `key` is non-NULL),
+// or NULL if there is no live entry there
+void** table_slot_at(const table_t* table, size_t index, const string_t** key);
+
+// Remove a key, freeing its value with free_value (may be NULL)
+bool table_remove(table_t* table, strview_t key, table_free_fn free_value);
+
+size_t table_size(const table_t* table);
+size_t table_capacity(const table_t* table);
+
+// Iterates live entries in insertion order
+void table_foreach(const table_t* table, table_iter_fn callback, void* user_data);
+
+void table_clear(table_t* table, table_free_fn free_value);
+
+// Hash used by the table (word-at-a-time, exposed for tests)
+uint64_t table_hash(const char* data, size_t len);
+
+#endif // PSEUDO_TABLE_H
@@ -0,0 +1,44 @@
+// Trace spans over the pipeline phases (lint, parse, load, run, transpile
+// passes...), written as Chrome trace-event JSON for chrome://tracing or
+// Perfetto. Spans nest by their order, and may carry a count (bytes, nodes,
+// steps) on either end.
+//
+// Spans are compiled in only with PSEUDO_ENABLE_TRACE (make TRACE=1);
+// without it the macros expand to nothing and their arguments are not
+// evaluated (a count is only named in sizeof, so a variable kept for it is
+// not reported unused). Compiled in, they cost a test until trace_open has
+// a file.
+
+#ifndef PSEUDO_TRACE_H
+#define PSEUDO_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef PSEUDO_ENABLE_TRACE
+#define TRACE_ENABLED 1
+#define TRACE_BEGIN(name) trace_begin(name, NULL, 0)
+#define TRACE_BEGIN_COUNT(name, key, value) trace_begin(name, key, (int64_t)(value))
+#define TRACE_END(name) trace_end(name, NULL, 0)
+#define TRACE_END_COUNT(name, key, value) trace_end(name, key, (int64_t)(value))
+#else
+#define TRACE_ENABLED 0
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_BEGIN_COUNT(name, key, value) ((void)sizeof(value))
+#define TRACE_END(name) ((void)0)
+#define TRACE_END_COUNT(name, key, value) ((void)sizeof(value))
+#endif
+
+// Starts writing the trace to `path`. Returns false if it cannot be
+// created, or tracing is not compiled in.
+bool trace_open(const char* path);
+
+// Ends the JSON and closes the file (nothing if none is open)
+void trace_close(void);
+
+// `name` and `key` must be string literals (they are written unescaped);
+// `key` may be NULL
+void trace_begin(const char* name, const char* key, int64_t value);
+void trace_end(const char* name, const char* key, int64_t value);
+
+#endif // PSEUDO_TRACE_H
@@ -0,0 +1,58 @@
+#ifndef PSEUDO_TREE_WALK_H
+#define PSEUDO_TREE_WALK_H
+
+#include <tree_sitter/api.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Linear-time traversals of tree-sitter trees. ts_node_child(node, i)
+// re-walks the siblings before child i, so a loop over it is quadratic in
+// the width of the node (a program's statements, a long expr_list); these
+// move a TSTreeCursor instead.
+
+// Children of a node in order, named and anonymous as with ts_node_child:
+//
+//     child_iter_t it = child_iter_start(parent);
+//     for (TSNode child; child_iter_next(&it, &child); ) { ... }
+//     child_iter_end(&it);
+//
+// child_iter_end frees the cursor and must also run after an early exit.
+typedef struct {
+    TSTreeCursor cursor;
+    bool started;
+    bool done;
+} child_iter_t;
+
+child_iter_t child_iter_start(TSNode parent);
+bool child_iter_next(child_iter_t* it, TSNode* child);
+void child_iter_end(child_iter_t* it);
+
+typedef enum {
+    WALK_CONTINUE,   // Visit the node's children next
+    WALK_SKIP,       // Leave out the node's children
+    WALK_STOP,       // End the walk
+} walk_action_t;
+
+typedef walk_action_t (*walk_visit_t)(TSNode node, void* ctx);
+
+// Visits `root` and its descendants in pre-order (the order of a recursion
+// over ts_node_child). Returns false if a visit stopped the walk.
+bool tree_walk(TSNode root, walk_visit_t visit, void* ctx);
+
+// Start byte -> node lookup, for nodes saved by position. Holds the first
+// node in pre-order starting at each byte, i.e. the outermost one.
+typedef struct {
+    uint32_t* starts;   // Sorted
+    TSNode* nodes;
+    size_t count;
+} node_index_t;
+
+bool node_index_build(node_index_t* index, TSNode root);
+
+// The node starting at `start_byte`, or a null node
+TSNode node_index_find(const node_index_t* index, uint32_t start_byte);
+
+void node_index_free(node_index_t* index);
+
+#endif // PSEUDO_TREE_WALK_H
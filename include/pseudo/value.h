@@ -16,6 +16,7 @@ typedef enum {
     VALUE_ERR_TYPE,         // Type mismatch (e.g., "abc" - 5)
     VALUE_ERR_DIV_ZERO,     // Division by zero
     VALUE_ERR_NEGATIVE_SQRT, // Square root of negative number
+    VALUE_ERR_MEMORY,       // Memory cap reached (see pseudo/memory.h)
 } value_error_t;
 
 typedef struct value value_t;
@@ -26,6 +27,7 @@ value_t* value_create_float(double val);
 value_t* value_create_string(const string_t* val);
 value_t* value_create_string_from(const char* val);
 value_t* value_create_string_buf(const char* val, size_t len);
+value_t* value_parse(const char* text);  // Input token: int, else float, else string
 value_t* value_copy(const value_t* val);
 value_t* value_clone(const value_t* val);  // Alias for value_copy
 void value_destroy(value_t* val);
@@ -1,19 +1,39 @@
 #include "pseudo/linter.h"
+#include "pseudo/filemap.h"
 #include "pseudo/parser.h"
 #include "pseudo/runtime.h"
+#include "pseudo/profile.h"
 #include "pseudo/transpiler.h"
 #include "pseudo/equivalence.h"
 #include "pseudo/io.h"
 #include "pseudo/string.h"
+#include "pseudo/trace.h"
+#include "pseudo/value.h"
 #include <tree_sitter/api.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 
 static void print_usage(const char* prog_name) {
     printf("Usage: %s <command> [options]\n\n", prog_name);
     printf("Commands:\n");
-    printf("  run <file>                    Execute pseudocode file\n");
+    printf("  run [options] <file>          Execute pseudocode file\n");
+    printf("                                --max-memory <N>  stop once N bytes are in use (K/M/G suffix)\n");
+    printf("                                --max-output <N>  stop with an error after N bytes of output\n");
+    printf("                                --mem-stats       print overall peak and current bytes per subsystem to stderr\n");
+    printf("                                --line-buffered   flush output after every line\n");
+    printf("                                --input <file>    read citeste values from a file\n");
+    printf("                                --tokens          one value per word instead of per line\n");
+    printf("  check [options] <file> <expected>  Run and compare the output with a file,\n");
+    printf("                                stopping at the first difference (exit code 2)\n");
+    printf("                                accepts the run options, plus\n");
+    printf("                                --whitespace <exact|lines|tokens>  tolerance (default exact)\n");
+    printf("  profile [options] <file>      Run and print on stderr the steps and time spent\n");
+    printf("                                on each line and the hottest loops\n");
+    printf("                                accepts the run options, plus\n");
+    printf("                                --json            the profile as JSON\n");
+    printf("                                --no-timing       count steps only\n");
     printf("  lint <file>                   Lint pseudocode file\n");
     printf("  parse <file>                  Parse and show syntax tree\n");
     printf("  debug <file>                  Debug tree (shows all nodes + ERROR/MISSING)\n");
@@ -23,28 +43,35 @@ static void print_usage(const char* prog_name) {
     printf("                                line: 0-indexed line of loop keyword\n");
     printf("                                target: for | while | do_while | repeat\n");
     printf("  help                          Show this help message\n");
+    printf("\nAny command:\n");
+    printf("  --trace <file>                Write a Chrome trace of the phases it goes through\n");
+    printf("                                (also PSEUDO_TRACE=<file>; needs a make TRACE=1 build)\n");
     printf("\nExample:\n");
     printf("  %s run program.pseudo\n", prog_name);
+    printf("  %s run --max-memory 64M program.pseudo\n", prog_name);
+    printf("  %s profile program.pseudo < input.txt\n", prog_name);
     printf("  %s transpile c program.pseudo\n", prog_name);
     printf("  %s equivalence program.pseudo 3 while\n", prog_name);
 }
 
-static string_t* read_file(const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
+static bool map_file(filemap_t* map, const char* filename) {
+    if (!filemap_open(map, filename)) {
         fprintf(stderr, "Eroare: Nu se poate deschide fisierul '%s'\n", filename);
-        return NULL;
+        return false;
     }
+    return true;
+}
 
-    string_t* content = string_create();
-    char buffer[4096];
-    size_t bytes_read;
+static strview_t map_view(const filemap_t* map) {
+    return (strview_t){ .data = map->data ? map->data : "", .len = map->len };
+}
 
-    while ((bytes_read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
-        string_append_buf(content, buffer, bytes_read);
-    }
+static string_t* read_file(const char* filename) {
+    filemap_t map;
+    if (!map_file(&map, filename)) return NULL;
 
-    fclose(file);
+    string_t* content = string_create_from_view(map_view(&map));
+    filemap_close(&map);
     return content;
 }
 
@@ -55,15 +82,27 @@ static int cmd_lint(int argc, char** argv) {
         return 1;
     }
 
-    string_t* input = read_file(argv[2]);
-    if (!input) {
+    filemap_t input;
+    if (!map_file(&input, argv[2])) {
         return 1;
     }
 
-    string_t* output = lint(input);
-    printf("%s", string_cstr(output));
+    // Already linted text is printed straight from the mapping
+    strview_t source = map_view(&input);
+    bool unchanged;
+    string_t* output = lint_buf(source.data, source.len, &unchanged);
+    if (!output && !unchanged) {
+        fprintf(stderr, "Eroare: %s\n", value_error_string(VALUE_ERR_MEMORY));
+        filemap_close(&input);
+        return 1;
+    }
+    if (unchanged) {
+        fwrite(source.data, 1, source.len, stdout);
+    } else {
+        fwrite(string_cstr(output), 1, string_length(output), stdout);
+    }
 
-    string_destroy(input);
+    filemap_close(&input);
     string_destroy(output);
 
     return 0;
@@ -76,25 +115,21 @@ static int cmd_parse(int argc, char** argv) {
         return 1;
     }
 
-    // Read file
-    string_t* input = read_file(argv[2]);
-    if (!input) {
+    filemap_t input;
+    if (!map_file(&input, argv[2])) {
         return 1;
     }
 
-    // Lint first
-    string_t* linted = lint(input);
-    string_destroy(input);
-
     // Parse
     parser_t* parser = parser_create();
     if (!parser) {
         fprintf(stderr, "Eroare: Nu s-a putut crea parser-ul\n");
-        string_destroy(linted);
+        filemap_close(&input);
         return 1;
     }
 
-    parser_error_t error = parser_parse(parser, linted);
+    strview_t source = map_view(&input);
+    parser_error_t error = parser_parse_source(parser, source.data, source.len, true);
 
     if (error.type != PARSER_OK) {
         fprintf(stderr, "Eroare de sintaxa la linia %u, coloana %u:\n\n",
@@ -104,7 +139,7 @@ static int cmd_parse(int argc, char** argv) {
         }
         parser_error_free(&error);
         parser_destroy(parser);
-        string_destroy(linted);
+        filemap_close(&input);
         return 1;
     }
 
@@ -114,7 +149,7 @@ static int cmd_parse(int argc, char** argv) {
     string_destroy(tree_str);
 
     parser_destroy(parser);
-    string_destroy(linted);
+    filemap_close(&input);
 
     return 0;
 }
@@ -126,25 +161,21 @@ static int cmd_debug(int argc, char** argv) {
         return 1;
     }
 
-    // Read file
-    string_t* input = read_file(argv[2]);
-    if (!input) {
+    filemap_t input;
+    if (!map_file(&input, argv[2])) {
         return 1;
     }
 
-    // Lint first
-    string_t* linted = lint(input);
-    string_destroy(input);
-
     // Parse (ignore errors - we want to see the tree anyway)
     parser_t* parser = parser_create();
     if (!parser) {
         fprintf(stderr, "Eroare: Nu s-a putut crea parser-ul\n");
-        string_destroy(linted);
+        filemap_close(&input);
         return 1;
     }
 
-    parser_error_t error = parser_parse(parser, linted);
+    strview_t source = map_view(&input);
+    parser_error_t error = parser_parse_source(parser, source.data, source.len, true);
     parser_error_free(&error);  // Ignore errors
 
     // Print debug tree
@@ -153,7 +184,7 @@ static int cmd_debug(int argc, char** argv) {
     string_destroy(tree_str);
 
     parser_destroy(parser);
-    string_destroy(linted);
+    filemap_close(&input);
 
     return 0;
 }
@@ -226,15 +257,192 @@ static int cmd_equivalence(int argc, char** argv) {
     return 0;
 }
 
-static int cmd_run(int argc, char** argv) {
-    if (argc < 3) {
-        fprintf(stderr, "Eroare: comanda run necesita un fisier\n\n");
+// The commands that run a program
+typedef enum {
+    RUN_PLAIN,
+    RUN_CHECK,
+    RUN_PROFILE,
+} run_mode_t;
+
+static const char* const k_run_mode_names[] = { "run", "check", "profile" };
+
+typedef struct {
+    const char* filename;
+    size_t max_memory;  // 0 = unlimited
+    size_t max_output;  // 0 = unlimited
+    bool mem_stats;
+    bool line_buffered;
+    const char* input_file;  // NULL = stdin
+    bool tokens;
+    // check only
+    const char* expected_file;
+    io_check_mode_t check_mode;
+    // profile only
+    bool json;
+    bool timed;
+} run_options_t;
+
+// Parses a byte count with an optional K/M/G suffix (e.g. "512K", "64M")
+static bool parse_size(const char* text, size_t* out) {
+    char* end;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text || text[0] == '-') return false;
+
+    unsigned long long scale = 1;
+    switch (*end) {
+        case 'k': case 'K': scale = 1024ULL; end++; break;
+        case 'm': case 'M': scale = 1024ULL * 1024; end++; break;
+        case 'g': case 'G': scale = 1024ULL * 1024 * 1024; end++; break;
+        default: break;
+    }
+    if (*end == 'B' || *end == 'b') end++;
+    if (*end != '\0' || value > SIZE_MAX / scale) return false;
+
+    *out = (size_t)(value * scale);
+    return true;
+}
+
+// Accepts "--opt value" and "--opt=value"; returns the value or NULL
+static const char* option_value(int argc, char** argv, int* i, const char* name) {
+    size_t len = strlen(name);
+    if (strncmp(argv[*i], name, len) != 0) return NULL;
+    if (argv[*i][len] == '=') return argv[*i] + len + 1;
+    if (argv[*i][len] != '\0' || *i + 1 >= argc) return NULL;
+    return argv[++(*i)];
+}
+
+static bool parse_check_mode(const char* text, io_check_mode_t* out) {
+    if (strcmp(text, "exact") == 0) {
+        *out = IO_CHECK_EXACT;
+    } else if (strcmp(text, "lines") == 0) {
+        *out = IO_CHECK_LINES;
+    } else if (strcmp(text, "tokens") == 0) {
+        *out = IO_CHECK_TOKENS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parse_run_options(int argc, char** argv, run_options_t* opts, run_mode_t mode) {
+    *opts = (run_options_t){ .check_mode = IO_CHECK_EXACT, .timed = true };
+    bool check = mode == RUN_CHECK;
+
+    for (int i = 2; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value;
+
+        if (strncmp(arg, "--", 2) != 0) {
+            if (!opts->filename) {
+                opts->filename = arg;
+            } else if (check && !opts->expected_file) {
+                opts->expected_file = arg;
+            } else {
+                fprintf(stderr, "Eroare: argument neasteptat '%s'\n", arg);
+                return false;
+            }
+        } else if (check && (value = option_value(argc, argv, &i, "--whitespace"))) {
+            if (!parse_check_mode(value, &opts->check_mode)) {
+                fprintf(stderr, "Eroare: valoare invalida pentru --whitespace: '%s'\n", value);
+                return false;
+            }
+        } else if (mode == RUN_PROFILE && strcmp(arg, "--json") == 0) {
+            opts->json = true;
+        } else if (mode == RUN_PROFILE && strcmp(arg, "--no-timing") == 0) {
+            opts->timed = false;
+        } else if ((value = option_value(argc, argv, &i, "--max-memory"))) {
+            if (!parse_size(value, &opts->max_memory) || opts->max_memory == 0) {
+                fprintf(stderr, "Eroare: valoare invalida pentru --max-memory: '%s'\n", value);
+                return false;
+            }
+        } else if ((value = option_value(argc, argv, &i, "--max-output"))) {
+            if (!parse_size(value, &opts->max_output) || opts->max_output == 0) {
+                fprintf(stderr, "Eroare: valoare invalida pentru --max-output: '%s'\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--mem-stats") == 0) {
+            opts->mem_stats = true;
+        } else if (strcmp(arg, "--line-buffered") == 0) {
+            opts->line_buffered = true;
+        } else if ((value = option_value(argc, argv, &i, "--input"))) {
+            opts->input_file = value;
+        } else if (strcmp(arg, "--tokens") == 0) {
+            opts->tokens = true;
+        } else {
+            fprintf(stderr, "Eroare: optiune necunoscuta '%s'\n", arg);
+            return false;
+        }
+    }
+
+    if (!opts->filename) {
+        fprintf(stderr, "Eroare: comanda %s necesita un fisier\n", k_run_mode_names[mode]);
+        return false;
+    }
+    if (check && !opts->expected_file) {
+        fprintf(stderr, "Eroare: comanda check necesita fisierul cu rezultatul asteptat\n");
+        return false;
+    }
+    return true;
+}
+
+static void print_mem_stats(runtime_t* rt) {
+    mem_stats_t stats;
+    runtime_get_memory_stats(rt, &stats);
+
+    fprintf(stderr, "Memorie: varf %zu octeti, curent %zu octeti, %zu alocari\n",
+            stats.peak, stats.current, stats.allocations);
+    for (int i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        fprintf(stderr, "  %-8s %zu\n", mem_subsystem_name((mem_subsystem_t)i), stats.subsystem[i]);
+    }
+}
+
+static void print_check_preview(const char* label, const char* text, bool at_end) {
+    if (at_end) {
+        printf("  %s <sfarsitul rezultatului>\n", label);
+    } else if (text[0] == '\0') {
+        printf("  %s <sfarsitul liniei>\n", label);
+    } else {
+        printf("  %s \"%s\"\n", label, text);
+    }
+}
+
+static void print_check_report(const io_check_report_t* report) {
+    if (report->match) {
+        printf("OK\n");
+        return;
+    }
+
+    printf("Gresit: prima diferenta la octetul %zu (linia %zu)\n", report->offset, report->line);
+    print_check_preview("asteptat:", report->expected, report->expected_end);
+    print_check_preview("obtinut: ", report->actual, report->actual_end);
+}
+
+static void print_profile(const profile_t* profile, runtime_t* rt, bool json) {
+    string_t* report = json ? profile_json(profile, rt) : profile_report(profile, rt);
+    if (!report) {
+        fprintf(stderr, "Eroare: %s\n", value_error_string(VALUE_ERR_MEMORY));
+        return;
+    }
+    fwrite(string_cstr(report), 1, string_length(report), stderr);
+    if (json) fputc('\n', stderr);
+    string_destroy(report);
+}
+
+// run executes the program on stdio; check compares its output with an
+// expected file instead of printing it (exit code 2 on a difference);
+// profile runs it and reports where the steps and time went
+static int run_command(int argc, char** argv, run_mode_t mode) {
+    bool check = mode == RUN_CHECK;
+    run_options_t opts;
+    if (!parse_run_options(argc, argv, &opts, mode)) {
+        fprintf(stderr, "\n");
         print_usage(argv[0]);
         return 1;
     }
 
-    string_t* input = read_file(argv[2]);
-    if (!input) {
+    // The runtime borrows the mapping when the program needs no linting
+    filemap_t input;
+    if (!map_file(&input, opts.filename)) {
         return 1;
     }
 
@@ -242,45 +450,136 @@ static int cmd_run(int argc, char** argv) {
     io_t* io = io_stdio_create();
     if (!io) {
         fprintf(stderr, "Eroare: Nu s-a putut crea interfata I/O\n");
-        string_destroy(input);
+        filemap_close(&input);
+        return 1;
+    }
+    io_stdio_set_line_buffered(io, opts.line_buffered);
+    io_stdio_set_input_mode(io, opts.tokens ? IO_INPUT_TOKENS : IO_INPUT_LINES);
+    if (opts.input_file && !io_stdio_open_input(io, opts.input_file)) {
+        fprintf(stderr, "Eroare: Nu se poate deschide fisierul '%s'\n", opts.input_file);
+        io_destroy(io);
+        filemap_close(&input);
         return 1;
     }
 
+    // The checker reads through the stdio backend and takes ownership of it
+    if (check) {
+        io_t* checker = io_check_create(io, opts.check_mode);
+        if (!checker) {
+            fprintf(stderr, "Eroare: Nu s-a putut crea interfata I/O\n");
+            io_destroy(io);
+            filemap_close(&input);
+            return 1;
+        }
+        io = checker;
+        if (!io_check_open_expected(io, opts.expected_file)) {
+            fprintf(stderr, "Eroare: Nu se poate deschide fisierul '%s'\n", opts.expected_file);
+            io_destroy(io);
+            filemap_close(&input);
+            return 1;
+        }
+    }
+
+    io_set_output_limit(io, opts.max_output);
+
     runtime_t* rt = runtime_create(io);
     if (!rt) {
         fprintf(stderr, "Eroare: Nu s-a putut crea runtime-ul\n");
         io_destroy(io);
-        string_destroy(input);
+        filemap_close(&input);
         return 1;
     }
 
+    runtime_set_memory_limit(rt, opts.max_memory);
+
     // Load and run
-    if (!runtime_load(rt, string_cstr(input))) {
+    if (!runtime_load_view(rt, map_view(&input))) {
         fprintf(stderr, "%s\n", runtime_get_error(rt));
         runtime_destroy(rt);
         io_destroy(io);
-        string_destroy(input);
+        filemap_close(&input);
         return 1;
     }
 
-    exec_state_t state = runtime_run(rt);
-
-    if (state == EXEC_ERROR) {
-        fprintf(stderr, "\nEroare: %s\n", runtime_get_error(rt));
+    profile_t* profile = NULL;
+    if (mode == RUN_PROFILE && !(profile = profile_create(opts.timed))) {
+        fprintf(stderr, "Eroare: %s\n", value_error_string(VALUE_ERR_MEMORY));
         runtime_destroy(rt);
         io_destroy(io);
-        string_destroy(input);
+        filemap_close(&input);
         return 1;
     }
 
+    exec_state_t state = profile ? runtime_run_profiled(rt, profile) : runtime_run(rt);
+
+    // Program output must precede any error or statistics on stderr
+    io_flush(io);
+
+    if (opts.mem_stats) {
+        print_mem_stats(rt);
+    }
+    if (profile) {
+        print_profile(profile, rt, opts.json);
+        profile_destroy(profile);
+    }
+
+    int status = 0;
+    if (state == EXEC_ERROR) {
+        fprintf(stderr, "\nEroare: %s\n", runtime_get_error(rt));
+        status = 1;
+    } else if (check) {
+        io_check_report_t report;
+        io_check_finish(io, &report);
+        print_check_report(&report);
+        status = report.match ? 0 : 2;
+    }
+
     runtime_destroy(rt);
     io_destroy(io);
-    string_destroy(input);
+    filemap_close(&input);
 
-    return 0;
+    return status;
 }
 
-int main(int argc, char** argv) {
+static int cmd_run(int argc, char** argv) {
+    return run_command(argc, argv, RUN_PLAIN);
+}
+
+static int cmd_check(int argc, char** argv) {
+    return run_command(argc, argv, RUN_CHECK);
+}
+
+static int cmd_profile(int argc, char** argv) {
+    return run_command(argc, argv, RUN_PROFILE);
+}
+
+// Takes --trace <file> (or --trace=<file>) out of argv, wherever it is
+static const char* take_trace_option(int* argc, char** argv) {
+    for (int i = 1; i < *argc; i++) {
+        int at = i;
+        const char* value = option_value(*argc, argv, &i, "--trace");
+        if (!value) continue;
+
+        memmove(&argv[at], &argv[i + 1], (size_t)(*argc - i) * sizeof(char*));  // With the NULL
+        *argc -= i - at + 1;
+        return value;
+    }
+    return NULL;
+}
+
+static bool start_trace(const char* path) {
+    if (!TRACE_ENABLED) {
+        fprintf(stderr, "Avertisment: urmarirea nu este inclusa in aceasta compilare (make TRACE=1)\n");
+        return true;
+    }
+    if (!trace_open(path)) {
+        fprintf(stderr, "Eroare: Nu se poate crea fisierul '%s'\n", path);
+        return false;
+    }
+    return true;
+}
+
+static int run_cli(int argc, char** argv) {
     if (argc < 2) {
         print_usage(argv[0]);
         return 1;
@@ -290,6 +589,10 @@ int main(int argc, char** argv) {
 
     if (strcmp(command, "run") == 0) {
         return cmd_run(argc, argv);
+    } else if (strcmp(command, "check") == 0) {
+        return cmd_check(argc, argv);
+    } else if (strcmp(command, "profile") == 0) {
+        return cmd_profile(argc, argv);
     } else if (strcmp(command, "lint") == 0) {
         return cmd_lint(argc, argv);
     } else if (strcmp(command, "parse") == 0) {
@@ -309,3 +612,13 @@ int main(int argc, char** argv) {
         return 1;
     }
 }
+
+int main(int argc, char** argv) {
+    const char* trace_path = take_trace_option(&argc, argv);
+    if (!trace_path) trace_path = getenv("PSEUDO_TRACE");
+    if (trace_path && *trace_path && !start_trace(trace_path)) return 1;
+
+    int status = run_cli(argc, argv);
+    trace_close();
+    return status;
+}
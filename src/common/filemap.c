@@ -0,0 +1,111 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "pseudo/filemap.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Loads the whole stream into a heap buffer
+static bool read_stream(filemap_t* map, FILE* file) {
+    char* data = NULL;
+    size_t len = 0, capacity = 0, n;
+    do {
+        if (capacity - len < 64 * 1024) {
+            capacity = capacity ? capacity * 2 : 128 * 1024;
+            char* grown = realloc(data, capacity);
+            if (!grown) {
+                free(data);
+                return false;
+            }
+            data = grown;
+        }
+        n = fread(data + len, 1, capacity - len, file);
+        len += n;
+    } while (n > 0);
+
+    if (ferror(file)) {
+        free(data);
+        return false;
+    }
+    if (len == 0) {
+        free(data);  // Empty, like a mapped empty file: data stays NULL
+        return true;
+    }
+
+    map->data = data;
+    map->len = len;
+    return true;
+}
+
+#ifdef _WIN32
+// No mmap: load the whole file into a heap buffer instead
+bool filemap_open(filemap_t* map, const char* path) {
+    *map = (filemap_t){ 0 };
+
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+
+    bool ok = read_stream(map, file);
+    fclose(file);
+    return ok;
+}
+#else
+bool filemap_open(filemap_t* map, const char* path) {
+    *map = (filemap_t){ 0 };
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+
+    // Pipes and devices (e.g. /dev/stdin) have no size to map: read them
+    if (!S_ISREG(st.st_mode)) {
+        FILE* file = fdopen(fd, "rb");
+        if (!file) {
+            close(fd);
+            return false;
+        }
+        bool ok = read_stream(map, file);
+        fclose(file);
+        return ok;
+    }
+
+    size_t len = (size_t)st.st_size;
+    if (len > 0) {
+        void* data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        posix_madvise(data, len, POSIX_MADV_SEQUENTIAL);
+        map->data = data;
+        map->len = len;
+        map->mapped = true;
+    }
+    close(fd);
+    return true;
+}
+#endif
+
+void filemap_close(filemap_t* map) {
+    if (!map->data) return;
+#ifndef _WIN32
+    if (map->mapped) {
+        munmap((void*)map->data, map->len);
+        *map = (filemap_t){ 0 };
+        return;
+    }
+#endif
+    free((void*)map->data);
+    *map = (filemap_t){ 0 };
+}
@@ -0,0 +1,165 @@
+#include "pseudo/format.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+
+static const char k_digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Exactly representable powers of ten; multiplying or dividing by one of
+// them rounds only once
+static const double k_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+    1e21, 1e22,
+};
+
+#define POW10_MAX 22
+
+// %g precision
+#define G_DIGITS 6
+
+// Writes the digits of v so that they end just before `end`; returns the start
+static char* write_u64_backwards(char* end, uint64_t v) {
+    while (v >= 100) {
+        size_t pair = (size_t)(v % 100) * 2;
+        v /= 100;
+        end -= 2;
+        memcpy(end, k_digit_pairs + pair, 2);
+    }
+    if (v >= 10) {
+        end -= 2;
+        memcpy(end, k_digit_pairs + v * 2, 2);
+    } else {
+        *--end = (char)('0' + v);
+    }
+    return end;
+}
+
+size_t format_i64(char* buf, int64_t value) {
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+
+    char* start = write_u64_backwards(end, magnitude);
+    if (value < 0) *--start = '-';
+
+    size_t len = (size_t)(end - start);
+    memcpy(buf, start, len);
+    buf[len] = '\0';
+    return len;
+}
+
+// Rounds a (> 0) to G_DIGITS significant digits: *digits gets them as an
+// integer in [100000, 999999] and *exp the decimal exponent of the first.
+// Returns false when the fast path cannot guarantee printf's rounding: the
+// scale is outside the exact powers of ten, or the value sits too close to
+// a rounding tie to decide from one correctly rounded product.
+static bool round_significant(double a, uint32_t* digits, int* exp) {
+    int binary_exp;
+    frexp(a, &binary_exp);
+
+    // Never above floor(log10(a)), and at most one below
+    int e = (int)floor((binary_exp - 1) * 0.30102999566398119521);
+    double scaled = 0;
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        int shift = G_DIGITS - 1 - e;
+        if (shift > POW10_MAX || shift < -POW10_MAX) return false;
+        scaled = shift >= 0 ? a * k_pow10[shift] : a / k_pow10[-shift];
+        if (scaled < 1e6) break;
+        e++;
+    }
+    if (scaled >= 1e6) return false;
+
+    double whole = floor(scaled);
+    double frac = scaled - whole;
+    if (fabs(frac - 0.5) < 1e-7) return false;
+
+    uint32_t rounded = (uint32_t)whole + (frac > 0.5 ? 1 : 0);
+    if (rounded == 1000000) {
+        rounded = 100000;
+        e++;
+    }
+
+    *digits = rounded;
+    *exp = e;
+    return true;
+}
+
+// %g for a finite, non-zero value
+static size_t format_general(char* buf, double value) {
+    uint32_t significant;
+    int e;
+    if (!round_significant(fabs(value), &significant, &e)) {
+        return (size_t)snprintf(buf, FORMAT_NUMBER_MAX, "%g", value);
+    }
+
+    char d[G_DIGITS];
+    write_u64_backwards(d + G_DIGITS, significant);
+    int last = G_DIGITS - 1;
+    while (last > 0 && d[last] == '0') last--;
+
+    char* out = buf;
+    if (value < 0) *out++ = '-';
+
+    if (e < -4 || e >= G_DIGITS) {
+        *out++ = d[0];
+        if (last > 0) {
+            *out++ = '.';
+            memcpy(out, d + 1, (size_t)last);
+            out += last;
+        }
+        *out++ = 'e';
+        *out++ = e < 0 ? '-' : '+';
+        int magnitude = e < 0 ? -e : e;
+        if (magnitude < 10) *out++ = '0';
+        char exp_digits[8];
+        char* exp_end = exp_digits + sizeof(exp_digits);
+        char* exp_start = write_u64_backwards(exp_end, (uint64_t)magnitude);
+        memcpy(out, exp_start, (size_t)(exp_end - exp_start));
+        out += exp_end - exp_start;
+    } else if (e >= 0) {
+        memcpy(out, d, (size_t)e + 1);
+        out += e + 1;
+        if (last > e) {
+            *out++ = '.';
+            memcpy(out, d + e + 1, (size_t)(last - e));
+            out += last - e;
+        }
+    } else {
+        *out++ = '0';
+        *out++ = '.';
+        for (int i = -1; i > e; i--) *out++ = '0';
+        memcpy(out, d, (size_t)last + 1);
+        out += last + 1;
+    }
+
+    *out = '\0';
+    return (size_t)(out - buf);
+}
+
+size_t format_f64(char* buf, double value) {
+    if (value == floor(value) && fabs(value) < 1e15) {
+        // "%.0f" of an integral value below 1e15 is its exact integer
+        if (value == 0 && signbit(value)) {
+            memcpy(buf, "-0", 3);
+            return 2;
+        }
+        return format_i64(buf, (int64_t)value);
+    }
+    if (!isfinite(value)) {
+        return (size_t)snprintf(buf, FORMAT_NUMBER_MAX, "%g", value);
+    }
+    return format_general(buf, value);
+}
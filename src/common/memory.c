@@ -0,0 +1,200 @@
+#include "pseudo/memory.h"
+#include <tree_sitter/api.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+// Bytes allowed past the cap so the runtime can still build its error
+// message and unwind the current step; large requests are refused outright
+#define LIMIT_SLACK (64 * 1024)
+
+typedef struct {
+    size_t size;
+    uint32_t subsystem;
+} mem_header_t;
+
+// Header padded so user blocks keep malloc's alignment
+#define HEADER_ALIGN _Alignof(max_align_t)
+#define HEADER_SIZE ((sizeof(mem_header_t) + HEADER_ALIGN - 1) / HEADER_ALIGN * HEADER_ALIGN)
+
+static const mem_backend_t k_default_backend = { malloc, realloc, free };
+
+static struct {
+    mem_backend_t backend;
+    mem_stats_t stats;
+    bool limit_exceeded;
+    bool ts_installed;
+} g_mem = { .backend = { malloc, realloc, free } };
+
+static const char* const k_subsystem_names[MEM_SUBSYSTEM_COUNT] = {
+    [MEM_VALUES]  = "values",
+    [MEM_STRINGS] = "strings",
+    [MEM_ENV]     = "env",
+    [MEM_PARSER]  = "parser",
+    [MEM_IO]      = "io",
+    [MEM_OTHER]   = "other",
+};
+
+static mem_header_t* header_of(void* ptr) {
+    return (mem_header_t*)((char*)ptr - HEADER_SIZE);
+}
+
+static void* user_of(mem_header_t* header) {
+    return (char*)header + HEADER_SIZE;
+}
+
+// Returns false if growing by `extra` bytes must be refused
+static bool admit(size_t extra, bool enforce) {
+    size_t limit = g_mem.stats.limit;
+    if (!enforce || limit == 0) return true;
+    if (g_mem.stats.current + extra <= limit) return true;
+
+    g_mem.limit_exceeded = true;
+    return g_mem.stats.current + extra <= limit + LIMIT_SLACK;
+}
+
+static void account(mem_subsystem_t subsystem, size_t added, size_t removed) {
+    g_mem.stats.current = g_mem.stats.current + added - removed;
+    g_mem.stats.subsystem[subsystem] = g_mem.stats.subsystem[subsystem] + added - removed;
+    if (g_mem.stats.current > g_mem.stats.peak) {
+        g_mem.stats.peak = g_mem.stats.current;
+    }
+}
+
+static void* alloc_block(mem_subsystem_t subsystem, size_t size, bool enforce) {
+    assert(subsystem < MEM_SUBSYSTEM_COUNT);
+
+    if (size > SIZE_MAX - HEADER_SIZE) return NULL;
+    if (!admit(size, enforce)) return NULL;
+
+    mem_header_t* header = g_mem.backend.malloc(HEADER_SIZE + size);
+    if (!header) return NULL;
+
+    header->size = size;
+    header->subsystem = subsystem;
+    g_mem.stats.allocations++;
+    account(subsystem, size, 0);
+
+    return user_of(header);
+}
+
+static void* realloc_block(mem_subsystem_t subsystem, void* ptr, size_t size, bool enforce) {
+    if (!ptr) return alloc_block(subsystem, size, enforce);
+    if (size > SIZE_MAX - HEADER_SIZE) return NULL;
+
+    mem_header_t* header = header_of(ptr);
+    size_t old_size = header->size;
+    mem_subsystem_t owner = (mem_subsystem_t)header->subsystem;
+
+    if (size > old_size && !admit(size - old_size, enforce)) return NULL;
+
+    mem_header_t* grown = g_mem.backend.realloc(header, HEADER_SIZE + size);
+    if (!grown) return NULL;
+
+    grown->size = size;
+    g_mem.stats.allocations++;
+    account(owner, size, old_size);
+
+    return user_of(grown);
+}
+
+void mem_set_backend(const mem_backend_t* backend) {
+    assert(g_mem.stats.current == 0);
+    g_mem.backend = backend ? *backend : k_default_backend;
+}
+
+void* mem_alloc(mem_subsystem_t subsystem, size_t size) {
+    return alloc_block(subsystem, size, true);
+}
+
+void* mem_calloc(mem_subsystem_t subsystem, size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) return NULL;
+
+    void* ptr = alloc_block(subsystem, count * size, true);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void* mem_realloc(mem_subsystem_t subsystem, void* ptr, size_t size) {
+    return realloc_block(subsystem, ptr, size, true);
+}
+
+char* mem_strdup(mem_subsystem_t subsystem, const char* str) {
+    assert(str != NULL);
+
+    size_t len = strlen(str);
+    char* copy = alloc_block(subsystem, len + 1, true);
+    if (copy) memcpy(copy, str, len + 1);
+    return copy;
+}
+
+void mem_free(void* ptr) {
+    if (!ptr) return;
+
+    mem_header_t* header = header_of(ptr);
+    account((mem_subsystem_t)header->subsystem, 0, header->size);
+    g_mem.backend.free(header);
+}
+
+void mem_set_limit(size_t bytes) {
+    g_mem.stats.limit = bytes;
+    g_mem.limit_exceeded = false;
+}
+
+bool mem_limit_exceeded(void) {
+    return g_mem.limit_exceeded;
+}
+
+void mem_clear_limit_exceeded(void) {
+    g_mem.limit_exceeded = false;
+}
+
+void mem_get_stats(mem_stats_t* out) {
+    assert(out != NULL);
+    *out = g_mem.stats;
+}
+
+void mem_reset_peak(void) {
+    g_mem.stats.peak = g_mem.stats.current;
+}
+
+const char* mem_subsystem_name(mem_subsystem_t subsystem) {
+    if (subsystem >= MEM_SUBSYSTEM_COUNT) return "?";
+    return k_subsystem_names[subsystem];
+}
+
+// === Tree-sitter hooks ===
+
+// Tree-sitter does not check for NULL, so its allocations are never refused
+// and a failing backend aborts like tree-sitter's own default allocator.
+static void* ts_checked(void* ptr, size_t size) {
+    if (!ptr && size > 0) {
+        fprintf(stderr, "tree-sitter: nu s-au putut aloca %zu octeti\n", size);
+        abort();
+    }
+    return ptr;
+}
+
+static void* ts_hook_malloc(size_t size) {
+    return ts_checked(alloc_block(MEM_PARSER, size, false), size);
+}
+
+static void* ts_hook_calloc(size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) return ts_checked(NULL, SIZE_MAX);
+
+    void* ptr = ts_checked(alloc_block(MEM_PARSER, count * size, false), count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+static void* ts_hook_realloc(void* ptr, size_t size) {
+    return ts_checked(realloc_block(MEM_PARSER, ptr, size, false), size);
+}
+
+void mem_install_tree_sitter(void) {
+    if (g_mem.ts_installed) return;
+    ts_set_allocator(ts_hook_malloc, ts_hook_calloc, ts_hook_realloc, mem_free);
+    g_mem.ts_installed = true;
+}
@@ -1,5 +1,5 @@
 #include "pseudo/string.h"
-#include <stdlib.h>
+#include "pseudo/memory.h"
 #include <string.h>
 #include <assert.h>
 
@@ -10,21 +10,44 @@ struct string {
     char* buffer;
     size_t length;
     size_t capacity;
+    bool failed;  // An append was dropped
 };
 
-static void ensure_capacity(string_t* str, size_t min_capacity) {
-    if (str->capacity >= min_capacity + 1) return;
+// Returns false if the buffer could not grow (memory cap reached)
+static bool ensure_capacity(string_t* str, size_t min_capacity) {
+    if (str->capacity >= min_capacity + 1) return true;
 
     size_t new_capacity = str->capacity > 0 ? str->capacity : INITIAL_CAPACITY;
     while (new_capacity < min_capacity + 1) {
         new_capacity *= GROWTH_FACTOR;
     }
 
-    char* new_buffer = realloc(str->buffer, new_capacity);
-    assert(new_buffer != NULL);
+    char* new_buffer = mem_realloc(MEM_STRINGS, str->buffer, new_capacity);
+    if (!new_buffer) return false;
 
     str->buffer = new_buffer;
     str->capacity = new_capacity;
+    return true;
+}
+
+strview_t strview_from_cstr(const char* cstr) {
+    assert(cstr != NULL);
+    return (strview_t){ .data = cstr, .len = strlen(cstr) };
+}
+
+strview_t string_view(const string_t* str) {
+    assert(str != NULL);
+    return (strview_t){ .data = str->buffer, .len = str->length };
+}
+
+bool strview_equals(strview_t view, const char* cstr) {
+    assert(cstr != NULL);
+    return strlen(cstr) == view.len && (view.len == 0 || memcmp(view.data, cstr, view.len) == 0);
+}
+
+bool strview_equals_view(strview_t a, strview_t b) {
+    if (a.len != b.len) return false;
+    return a.len == 0 || memcmp(a.data, b.data, a.len) == 0;
 }
 
 string_t* string_create(void) {
@@ -54,31 +77,36 @@ string_t* string_create_from_string(const string_t* str) {
     return string_create_from_buf(str->buffer, str->length);
 }
 
+string_t* string_create_from_view(strview_t view) {
+    return string_create_from_buf(view.data, view.len);
+}
+
 string_t* string_create_with_capacity(size_t capacity) {
-    string_t* str = malloc(sizeof(string_t));
+    string_t* str = mem_alloc(MEM_STRINGS, sizeof(string_t));
     if (!str) return NULL;
 
     if (capacity < INITIAL_CAPACITY) {
         capacity = INITIAL_CAPACITY;
     }
 
-    str->buffer = malloc(capacity);
+    str->buffer = mem_alloc(MEM_STRINGS, capacity);
     if (!str->buffer) {
-        free(str);
+        mem_free(str);
         return NULL;
     }
 
     str->buffer[0] = '\0';
     str->length = 0;
     str->capacity = capacity;
+    str->failed = false;
 
     return str;
 }
 
 void string_destroy(string_t* str) {
     if (!str) return;
-    free(str->buffer);
-    free(str);
+    mem_free(str->buffer);
+    mem_free(str);
 }
 
 size_t string_length(const string_t* str) {
@@ -95,8 +123,8 @@ void string_reserve(string_t* str, size_t new_capacity) {
     assert(str != NULL);
     if (new_capacity <= string_capacity(str)) return;
 
-    char* new_buffer = realloc(str->buffer, new_capacity + 1);
-    assert(new_buffer != NULL);
+    char* new_buffer = mem_realloc(MEM_STRINGS, str->buffer, new_capacity + 1);
+    if (!new_buffer) return;
 
     str->buffer = new_buffer;
     str->capacity = new_capacity + 1;
@@ -108,8 +136,8 @@ void string_shrink_to_fit(string_t* str) {
     if (str->capacity == str->length + 1) return;
 
     size_t new_capacity = str->length + 1;
-    char* new_buffer = realloc(str->buffer, new_capacity);
-    assert(new_buffer != NULL);
+    char* new_buffer = mem_realloc(MEM_STRINGS, str->buffer, new_capacity);
+    if (!new_buffer) return;
 
     str->buffer = new_buffer;
     str->capacity = new_capacity;
@@ -138,7 +166,10 @@ void string_append_buf(string_t* str, const char* buf, size_t len) {
 
     if (len == 0) return;
 
-    ensure_capacity(str, str->length + len);
+    if (!ensure_capacity(str, str->length + len)) {
+        str->failed = true;
+        return;
+    }
     memcpy(str->buffer + str->length, buf, len);
     str->length += len;
     str->buffer[str->length] = '\0';
@@ -147,7 +178,10 @@ void string_append_buf(string_t* str, const char* buf, size_t len) {
 void string_append_char(string_t* str, char c) {
     assert(str != NULL);
 
-    ensure_capacity(str, str->length + 1);
+    if (!ensure_capacity(str, str->length + 1)) {
+        str->failed = true;
+        return;
+    }
     str->buffer[str->length] = c;
     str->length++;
     str->buffer[str->length] = '\0';
@@ -159,14 +193,41 @@ void string_append_string(string_t* str, const string_t* other) {
     string_append_buf(str, other->buffer, other->length);
 }
 
+void string_append_view(string_t* str, strview_t view) {
+    assert(str != NULL);
+    if (view.len == 0) return;
+    string_append_buf(str, view.data, view.len);
+}
+
+bool string_replace(string_t* str, size_t start, size_t old_len, const char* buf, size_t len) {
+    assert(str != NULL);
+    assert(buf != NULL || len == 0);
+    assert(start <= str->length && old_len <= str->length - start);
+
+    size_t tail = str->length - start - old_len;
+    if (len > old_len && !ensure_capacity(str, str->length + (len - old_len))) return false;
+
+    memmove(str->buffer + start + len, str->buffer + start + old_len, tail);
+    if (len > 0) memcpy(str->buffer + start, buf, len);
+    str->length = start + len + tail;
+    if (str->buffer) str->buffer[str->length] = '\0';
+    return true;
+}
+
 void string_clear(string_t* str) {
     assert(str != NULL);
     str->length = 0;
+    str->failed = false;
     if (str->buffer) {
         str->buffer[0] = '\0';
     }
 }
 
+bool string_failed(const string_t* str) {
+    assert(str != NULL);
+    return str->failed;
+}
+
 bool string_equals(const string_t* str, const char* cstr) {
     assert(str != NULL);
     assert(cstr != NULL);
@@ -180,3 +241,8 @@ bool string_equals_string(const string_t* a, const string_t* b) {
     if (a->length != b->length) return false;
     return memcmp(a->buffer, b->buffer, a->length) == 0;
 }
+
+bool string_equals_view(const string_t* str, strview_t view) {
+    assert(str != NULL);
+    return strview_equals_view(string_view(str), view);
+}
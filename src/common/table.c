@@ -0,0 +1,310 @@
+#include "pseudo/table.h"
+#include "pseudo/memory.h"
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+
+#define MIN_CAPACITY 16
+
+// Slots hold the low 32 bits of the hash so most mismatches are rejected
+// without touching the entry or its key
+typedef struct {
+    uint32_t hash;
+    uint32_t index;  // entry index + 1, 0 = empty slot
+} table_slot_t;
+
+typedef struct {
+    uint64_t hash;
+    string_t* key;   // NULL once removed (hole until the next rebuild)
+    void* value;
+} table_entry_t;
+
+struct table {
+    table_slot_t* slots;
+    size_t mask;            // slot count - 1 (slot count is a power of two)
+    table_entry_t* entries; // dense, insertion ordered, capacity == slot count
+    size_t entry_count;     // entries used, including holes
+    size_t size;            // live entries
+};
+
+uint64_t table_hash(const char* data, size_t len) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (uint64_t)len;
+
+    while (len >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        h = (h ^ word) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+        data += 8;
+        len -= 8;
+    }
+    if (len > 0) {
+        uint64_t word = 0;
+        memcpy(&word, data, len);
+        h = (h ^ word) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+    }
+
+    h ^= h >> 32;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 29;
+    return h;
+}
+
+static size_t slot_count(const table_t* table) {
+    return table->mask + 1;
+}
+
+static size_t probe_distance(const table_t* table, size_t pos, uint32_t hash) {
+    return (pos - (hash & table->mask)) & table->mask;
+}
+
+// Robin Hood insertion: an entry closer to its home slot yields to a poorer one
+static void slot_insert(table_t* table, uint32_t hash, uint32_t index) {
+    table_slot_t cur = { .hash = hash, .index = index };
+    size_t pos = hash & table->mask;
+    size_t dist = 0;
+
+    for (;;) {
+        table_slot_t* slot = &table->slots[pos];
+        if (slot->index == 0) {
+            *slot = cur;
+            return;
+        }
+
+        size_t slot_dist = probe_distance(table, pos, slot->hash);
+        if (slot_dist < dist) {
+            table_slot_t tmp = *slot;
+            *slot = cur;
+            cur = tmp;
+            dist = slot_dist;
+        }
+
+        pos = (pos + 1) & table->mask;
+        dist++;
+    }
+}
+
+static bool find_pos(const table_t* table, strview_t key, uint64_t hash, size_t* out_pos) {
+    uint32_t h32 = (uint32_t)hash;
+    size_t pos = h32 & table->mask;
+
+    for (size_t dist = 0;; dist++) {
+        const table_slot_t* slot = &table->slots[pos];
+        if (slot->index == 0) return false;
+
+        // Robin Hood invariant: the key would have displaced this slot
+        if (probe_distance(table, pos, slot->hash) < dist) return false;
+
+        if (slot->hash == h32) {
+            const table_entry_t* entry = &table->entries[slot->index - 1];
+            if (entry->hash == hash && string_equals_view(entry->key, key)) {
+                *out_pos = pos;
+                return true;
+            }
+        }
+
+        pos = (pos + 1) & table->mask;
+    }
+}
+
+// Compact the entry array and rebuild slots for new_count slots.
+// Returns false (table unchanged) if growing is refused by the memory cap.
+static bool rebuild(table_t* table, size_t new_count) {
+    if (new_count != slot_count(table)) {
+        table_slot_t* slots = mem_calloc(MEM_ENV, new_count, sizeof(table_slot_t));
+        if (!slots) return false;
+        table_entry_t* entries = mem_realloc(MEM_ENV, table->entries, new_count * sizeof(table_entry_t));
+        if (!entries) {
+            mem_free(slots);
+            return false;
+        }
+
+        mem_free(table->slots);
+        table->slots = slots;
+        table->entries = entries;
+        table->mask = new_count - 1;
+    } else {
+        memset(table->slots, 0, new_count * sizeof(table_slot_t));
+    }
+
+    size_t live = 0;
+    for (size_t i = 0; i < table->entry_count; i++) {
+        if (table->entries[i].key) {
+            table->entries[live++] = table->entries[i];
+        }
+    }
+    table->entry_count = live;
+
+    for (size_t i = 0; i < live; i++) {
+        slot_insert(table, (uint32_t)table->entries[i].hash, (uint32_t)(i + 1));
+    }
+    return true;
+}
+
+table_t* table_create(size_t initial_capacity) {
+    table_t* table = mem_alloc(MEM_ENV, sizeof(table_t));
+    if (!table) return NULL;
+
+    size_t count = MIN_CAPACITY;
+    while (count < initial_capacity) {
+        count *= 2;
+    }
+
+    table->slots = mem_calloc(MEM_ENV, count, sizeof(table_slot_t));
+    table->entries = mem_alloc(MEM_ENV, count * sizeof(table_entry_t));
+    if (!table->slots || !table->entries) {
+        mem_free(table->slots);
+        mem_free(table->entries);
+        mem_free(table);
+        return NULL;
+    }
+
+    table->mask = count - 1;
+    table->entry_count = 0;
+    table->size = 0;
+
+    return table;
+}
+
+static void free_entries(table_t* table, table_free_fn free_value) {
+    for (size_t i = 0; i < table->entry_count; i++) {
+        table_entry_t* entry = &table->entries[i];
+        if (!entry->key) continue;
+        string_destroy(entry->key);
+        if (free_value) free_value(entry->value);
+    }
+}
+
+void table_destroy(table_t* table, table_free_fn free_value) {
+    if (!table) return;
+
+    free_entries(table, free_value);
+    mem_free(table->entries);
+    mem_free(table->slots);
+    mem_free(table);
+}
+
+void* table_get(const table_t* table, strview_t key) {
+    assert(table != NULL);
+
+    size_t pos;
+    if (!find_pos(table, key, table_hash(key.data, key.len), &pos)) return NULL;
+    return table->entries[table->slots[pos].index - 1].value;
+}
+
+bool table_has(const table_t* table, strview_t key) {
+    assert(table != NULL);
+
+    size_t pos;
+    return find_pos(table, key, table_hash(key.data, key.len), &pos);
+}
+
+void** table_upsert(table_t* table, strview_t key, bool* inserted) {
+    assert(table != NULL);
+    assert(key.data != NULL);
+
+    uint64_t hash = table_hash(key.data, key.len);
+    size_t pos;
+    if (find_pos(table, key, hash, &pos)) {
+        if (inserted) *inserted = false;
+        return &table->entries[table->slots[pos].index - 1].value;
+    }
+
+    // Keep the load factor under 7/8; reclaim holes when the entry array fills
+    size_t count = slot_count(table);
+    if ((table->size + 1) * 8 > count * 7) {
+        if (!rebuild(table, count * 2)) return NULL;
+    } else if (table->entry_count == count) {
+        rebuild(table, count);
+    }
+
+    string_t* key_copy = string_create_from_view(key);
+    if (!key_copy) return NULL;
+
+    size_t index = table->entry_count++;
+    table_entry_t* entry = &table->entries[index];
+    entry->hash = hash;
+    entry->key = key_copy;
+    entry->value = NULL;
+
+    slot_insert(table, (uint32_t)hash, (uint32_t)(index + 1));
+    table->size++;
+
+    if (inserted) *inserted = true;
+    return &entry->value;
+}
+
+size_t table_slot_index(const table_t* table, void** slot) {
+    assert(table != NULL);
+    const table_entry_t* entry = (const table_entry_t*)((char*)slot - offsetof(table_entry_t, value));
+    assert(entry >= table->entries && entry < table->entries + table->entry_count);
+    return (size_t)(entry - table->entries);
+}
+
+void** table_slot_at(const table_t* table, size_t index, const string_t** key) {
+    assert(table != NULL);
+    if (index >= table->entry_count) return NULL;
+
+    table_entry_t* entry = &table->entries[index];
+    if (!entry->key) return NULL;
+    if (key) *key = entry->key;
+    return &entry->value;
+}
+
+bool table_remove(table_t* table, strview_t key, table_free_fn free_value) {
+    assert(table != NULL);
+
+    size_t pos;
+    if (!find_pos(table, key, table_hash(key.data, key.len), &pos)) return false;
+
+    table_entry_t* entry = &table->entries[table->slots[pos].index - 1];
+    string_destroy(entry->key);
+    if (free_value) free_value(entry->value);
+    entry->key = NULL;
+    entry->value = NULL;
+    table->size--;
+
+    // Backward-shift deletion keeps probe sequences intact without tombstones
+    size_t next = (pos + 1) & table->mask;
+    while (table->slots[next].index != 0 &&
+           probe_distance(table, next, table->slots[next].hash) > 0) {
+        table->slots[pos] = table->slots[next];
+        pos = next;
+        next = (next + 1) & table->mask;
+    }
+    table->slots[pos].index = 0;
+
+    return true;
+}
+
+size_t table_size(const table_t* table) {
+    assert(table != NULL);
+    return table->size;
+}
+
+size_t table_capacity(const table_t* table) {
+    assert(table != NULL);
+    return slot_count(table);
+}
+
+void table_foreach(const table_t* table, table_iter_fn callback, void* user_data) {
+    assert(table != NULL);
+    assert(callback != NULL);
+
+    for (size_t i = 0; i < table->entry_count; i++) {
+        const table_entry_t* entry = &table->entries[i];
+        if (entry->key) {
+            callback(entry->key, entry->value, user_data);
+        }
+    }
+}
+
+void table_clear(table_t* table, table_free_fn free_value) {
+    assert(table != NULL);
+
+    free_entries(table, free_value);
+    memset(table->slots, 0, slot_count(table) * sizeof(table_slot_t));
+    table->entry_count = 0;
+    table->size = 0;
+}
@@ -0,0 +1,81 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "pseudo/trace.h"
+#include <stdio.h>
+#include <time.h>
+
+#ifdef PSEUDO_ENABLE_TRACE
+
+static struct {
+    FILE* file;
+    uint64_t start_ns;
+    bool first;
+} g_trace;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+bool trace_open(const char* path) {
+    trace_close();
+    g_trace.file = fopen(path, "w");
+    if (!g_trace.file) return false;
+
+    g_trace.start_ns = now_ns();
+    g_trace.first = true;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", g_trace.file);
+    return true;
+}
+
+void trace_close(void) {
+    if (!g_trace.file) return;
+    fputs("\n]}\n", g_trace.file);
+    fclose(g_trace.file);
+    g_trace.file = NULL;
+}
+
+// One event; timestamps are microseconds from trace_open
+static void write_event(char phase, const char* name, const char* key, int64_t value) {
+    uint64_t ns = now_ns() - g_trace.start_ns;
+    fprintf(g_trace.file, "%s{\"name\":\"%s\",\"cat\":\"pseudo\",\"ph\":\"%c\",\"ts\":%llu.%03u,"
+            "\"pid\":1,\"tid\":1",
+            g_trace.first ? "" : ",\n", name, phase, (unsigned long long)(ns / 1000),
+            (unsigned)(ns % 1000));
+    if (key) fprintf(g_trace.file, ",\"args\":{\"%s\":%lld}", key, (long long)value);
+    fputc('}', g_trace.file);
+    g_trace.first = false;
+}
+
+void trace_begin(const char* name, const char* key, int64_t value) {
+    if (g_trace.file) write_event('B', name, key, value);
+}
+
+void trace_end(const char* name, const char* key, int64_t value) {
+    if (g_trace.file) write_event('E', name, key, value);
+}
+
+#else
+
+bool trace_open(const char* path) {
+    (void)path;
+    return false;
+}
+
+void trace_close(void) {
+}
+
+void trace_begin(const char* name, const char* key, int64_t value) {
+    (void)name;
+    (void)key;
+    (void)value;
+}
+
+void trace_end(const char* name, const char* key, int64_t value) {
+    (void)name;
+    (void)key;
+    (void)value;
+}
+
+#endif
@@ -1,7 +1,8 @@
 #include "pseudo/equivalence.h"
 #include "pseudo/parser.h"
-#include "pseudo/linter.h"
 #include "pseudo/string.h"
+#include "pseudo/tree_walk.h"
+#include "pseudo/trace.h"
 #include <tree_sitter/api.h>
 #include <string.h>
 #include <stdlib.h>
@@ -22,18 +23,25 @@ static bool is_loop_type(const char* type) {
            strcmp(type, "do_while") == 0 || strcmp(type, "repeat") == 0;
 }
 
+typedef struct {
+    uint32_t target_line;
+    TSNode found;
+} loop_search_t;
+
+static walk_action_t match_loop_at_line(TSNode node, void* ctx) {
+    loop_search_t* search = ctx;
+    if (is_loop_type(ts_node_type(node)) && ts_node_start_point(node).row == search->target_line) {
+        search->found = node;
+        return WALK_STOP;
+    }
+    return WALK_CONTINUE;
+}
+
 // Find the first loop node (DFS order) that starts on target_line (0-indexed).
 static TSNode find_loop_at_line(TSNode node, uint32_t target_line) {
-    if (is_loop_type(ts_node_type(node))) {
-        if (ts_node_start_point(node).row == target_line) return node;
-    }
-    uint32_t count = ts_node_child_count(node);
-    for (uint32_t i = 0; i < count; i++) {
-        TSNode result = find_loop_at_line(ts_node_child(node, i), target_line);
-        if (!ts_node_is_null(result)) return result;
-    }
-    TSNode null_node = {0};
-    return null_node;
+    loop_search_t search = { .target_line = target_line };
+    tree_walk(node, match_loop_at_line, &search);
+    return search.found;
 }
 
 typedef struct { TSNode* nodes; uint32_t count; uint32_t cap; } loop_list_t;
@@ -46,10 +54,35 @@ static void loops_push(loop_list_t* l, TSNode node) {
     l->nodes[l->count++] = node;
 }
 
-static void collect_loops(TSNode node, loop_list_t* list) {
-    if (is_loop_type(ts_node_type(node))) loops_push(list, node);
-    uint32_t count = ts_node_child_count(node);
-    for (uint32_t i = 0; i < count; i++) collect_loops(ts_node_child(node, i), list);
+typedef struct {
+    const row_span_t* rows;   // Sorted
+    size_t row_count;
+    loop_list_t* list;
+} loop_rows_t;
+
+// Collects loops starting on one of the row spans, skipping subtrees that
+// lie outside all of them
+static walk_action_t collect_loop(TSNode node, void* ctx) {
+    loop_rows_t* search = ctx;
+    uint32_t first = ts_node_start_point(node).row;
+    uint32_t last = ts_node_end_point(node).row;
+
+    bool overlaps = false;
+    bool starts_inside = false;
+    bool past_all = true;
+    for (size_t i = 0; i < search->row_count; i++) {
+        const row_span_t* span = &search->rows[i];
+        if (span->last >= first) past_all = false;
+        if (span->first > last) break;
+        if (span->last < first) continue;
+        overlaps = true;
+        if (span->first <= first) starts_inside = true;
+    }
+    if (past_all) return WALK_STOP;  // Every later node starts even further down
+    if (!overlaps) return WALK_SKIP;
+
+    if (starts_inside && is_loop_type(ts_node_type(node))) loops_push(search->list, node);
+    return WALK_CONTINUE;
 }
 
 // ─── Indentation detection ────────────────────────────────────────────────
@@ -98,11 +131,10 @@ typedef struct {
 static body_range_t get_body_range(TSNode loop_node, const char* open_tok,
                                    const char* close_tok) {
     body_range_t r = {0};
-    uint32_t count = ts_node_child_count(loop_node);
     bool past_open = false;
 
-    for (uint32_t i = 0; i < count; i++) {
-        TSNode child = ts_node_child(loop_node, i);
+    child_iter_t it = child_iter_start(loop_node);
+    for (TSNode child; child_iter_next(&it, &child); ) {
         const char* type = ts_node_type(child);
 
         if (!past_open && strcmp(type, open_tok) == 0) {
@@ -115,6 +147,7 @@ static body_range_t get_body_range(TSNode loop_node, const char* open_tok,
             break;
         }
     }
+    child_iter_end(&it);
     return r;
 }
 
@@ -140,19 +173,14 @@ static string_t* convert_for(parser_t* parser, TSNode node,
     TSNode end_n   = parser_child_by_field(node, "end");
     TSNode step_n  = parser_child_by_field(node, "step");
 
-    string_t* var_s   = parser_node_text(parser, var_n);
-    string_t* start_s = parser_node_text(parser, start_n);
-    string_t* end_s   = parser_node_text(parser, end_n);
-    string_t* step_s  = ts_node_is_null(step_n)
-                       ? string_create_from("1")
-                       : parser_node_text(parser, step_n);
+    strview_t var   = parser_node_view(parser, var_n);
+    strview_t start = parser_node_view(parser, start_n);
+    strview_t end   = parser_node_view(parser, end_n);
+    strview_t step  = ts_node_is_null(step_n)
+                     ? strview_from_cstr("1")
+                     : parser_node_view(parser, step_n);
 
-    const char* var   = string_cstr(var_s);
-    const char* start = string_cstr(start_s);
-    const char* end   = string_cstr(end_s);
-    const char* step  = string_cstr(step_s);
-
-    bool step_neg   = (step[0] == '-');
+    bool step_neg   = (step.len > 0 && step.data[0] == '-');
     const char* cmp = step_neg ? ">=" : "<=";
     const char* ex  = step_neg ? "<"  : ">";
 
@@ -167,49 +195,47 @@ static string_t* convert_for(parser_t* parser, TSNode node,
     string_t* r = string_create();
 
     if (strcmp(target, "while") == 0) {
-        string_append(r, var); string_append(r, " <- "); string_append(r, start);
+        string_append_view(r, var); string_append(r, " <- "); string_append_view(r, start);
         string_append_char(r, '\n'); string_append(r, li);
-        string_append(r, "cat timp "); string_append(r, var);
+        string_append(r, "cat timp "); string_append_view(r, var);
         string_append_char(r, ' '); string_append(r, cmp); string_append_char(r, ' ');
-        string_append(r, end); string_append(r, " executa");
+        string_append_view(r, end); string_append(r, " executa");
         string_append_buf(r, bt, bln);
         string_append(r, bi);
-        string_append(r, var); string_append(r, " <- "); string_append(r, var);
-        string_append(r, " + "); string_append(r, step); string_append_char(r, '\n');
+        string_append_view(r, var); string_append(r, " <- "); string_append_view(r, var);
+        string_append(r, " + "); string_append_view(r, step); string_append_char(r, '\n');
         string_append(r, li); string_append(r, "sf");
 
     } else if (strcmp(target, "do_while") == 0) {
-        string_append(r, var); string_append(r, " <- "); string_append(r, start);
+        string_append_view(r, var); string_append(r, " <- "); string_append_view(r, start);
         string_append_char(r, '\n'); string_append(r, li);
         string_append(r, "executa");
         string_append_buf(r, bt, bln);
         string_append(r, bi);
-        string_append(r, var); string_append(r, " <- "); string_append(r, var);
-        string_append(r, " + "); string_append(r, step); string_append_char(r, '\n');
+        string_append_view(r, var); string_append(r, " <- "); string_append_view(r, var);
+        string_append(r, " + "); string_append_view(r, step); string_append_char(r, '\n');
         string_append(r, li);
-        string_append(r, "cat timp "); string_append(r, var);
+        string_append(r, "cat timp "); string_append_view(r, var);
         string_append_char(r, ' '); string_append(r, cmp); string_append_char(r, ' ');
-        string_append(r, end);
+        string_append_view(r, end);
 
     } else if (strcmp(target, "repeat") == 0) {
-        string_append(r, var); string_append(r, " <- "); string_append(r, start);
+        string_append_view(r, var); string_append(r, " <- "); string_append_view(r, start);
         string_append_char(r, '\n'); string_append(r, li);
         string_append(r, "repeta");
         string_append_buf(r, bt, bln);
         string_append(r, bi);
-        string_append(r, var); string_append(r, " <- "); string_append(r, var);
-        string_append(r, " + "); string_append(r, step); string_append_char(r, '\n');
+        string_append_view(r, var); string_append(r, " <- "); string_append_view(r, var);
+        string_append(r, " + "); string_append_view(r, step); string_append_char(r, '\n');
         string_append(r, li);
-        string_append(r, "pana cand "); string_append(r, var);
+        string_append(r, "pana cand "); string_append_view(r, var);
         string_append_char(r, ' '); string_append(r, ex); string_append_char(r, ' ');
-        string_append(r, end);
+        string_append_view(r, end);
 
     } else {
         string_destroy(r); r = NULL;
     }
 
-    string_destroy(var_s); string_destroy(start_s);
-    string_destroy(end_s); string_destroy(step_s);
     return r;
 }
 
@@ -223,8 +249,7 @@ static string_t* convert_for(parser_t* parser, TSNode node,
 static string_t* convert_while(parser_t* parser, TSNode node,
                                 const char* target, const char* src) {
     TSNode cond_n = parser_child_by_field(node, "condition");
-    string_t* cond_s = parser_node_text(parser, cond_n);
-    const char* cond = string_cstr(cond_s);
+    strview_t cond = parser_node_view(parser, cond_n);
 
     body_range_t raw  = get_body_range(node, "executa", "sf");
     uint32_t body_end = trim_body_end(src, raw.start_byte, raw.end_byte);
@@ -237,23 +262,23 @@ static string_t* convert_while(parser_t* parser, TSNode node,
 
     if (strcmp(target, "do_while") == 0) {
         string_append(r, li);
-        string_append(r, "daca "); string_append(r, cond); string_append(r, " atunci\n");
+        string_append(r, "daca "); string_append_view(r, cond); string_append(r, " atunci\n");
         string_append(r, li); string_append_char(r, '\t');
         string_append(r, "executa");
         append_indented_body(r, bt, bln);
         string_append(r, li); string_append_char(r, '\t');
-        string_append(r, "cat timp "); string_append(r, cond); string_append_char(r, '\n');
+        string_append(r, "cat timp "); string_append_view(r, cond); string_append_char(r, '\n');
         string_append(r, li);
         string_append(r, "sf");
 
     } else if (strcmp(target, "repeat") == 0) {
         string_append(r, li);
-        string_append(r, "daca "); string_append(r, cond); string_append(r, " atunci\n");
+        string_append(r, "daca "); string_append_view(r, cond); string_append(r, " atunci\n");
         string_append(r, li); string_append_char(r, '\t');
         string_append(r, "repeta");
         append_indented_body(r, bt, bln);
         string_append(r, li); string_append_char(r, '\t');
-        string_append(r, "pana cand not ("); string_append(r, cond);
+        string_append(r, "pana cand not ("); string_append_view(r, cond);
         string_append_char(r, ')'); string_append_char(r, '\n');
         string_append(r, li);
         string_append(r, "sf");
@@ -262,7 +287,6 @@ static string_t* convert_while(parser_t* parser, TSNode node,
         string_destroy(r); r = NULL;
     }
 
-    string_destroy(cond_s);
     return r;
 }
 
@@ -275,8 +299,7 @@ static string_t* convert_while(parser_t* parser, TSNode node,
 static string_t* convert_do_while(parser_t* parser, TSNode node,
                                    const char* target, const char* src) {
     TSNode cond_n = parser_child_by_field(node, "condition");
-    string_t* cond_s = parser_node_text(parser, cond_n);
-    const char* cond = string_cstr(cond_s);
+    strview_t cond = parser_node_view(parser, cond_n);
 
     body_range_t raw  = get_body_range(node, "executa", "cat");
     uint32_t body_end = trim_body_end(src, raw.start_byte, raw.end_byte);
@@ -293,7 +316,7 @@ static string_t* convert_do_while(parser_t* parser, TSNode node,
         size_t      bln_body = (bln > 0 && bt[0] == '\n') ? bln - 1 : bln;
         string_append_buf(r, bt_body, bln_body);
         string_append(r, li);
-        string_append(r, "cat timp "); string_append(r, cond); string_append(r, " executa");
+        string_append(r, "cat timp "); string_append_view(r, cond); string_append(r, " executa");
         string_append_buf(r, bt, bln);   // second copy with leading '\n'
         string_append(r, li); string_append(r, "sf");
 
@@ -302,14 +325,13 @@ static string_t* convert_do_while(parser_t* parser, TSNode node,
         string_append(r, "repeta");
         string_append_buf(r, bt, bln);
         string_append(r, li);
-        string_append(r, "pana cand not ("); string_append(r, cond);
+        string_append(r, "pana cand not ("); string_append_view(r, cond);
         string_append_char(r, ')');
 
     } else {
         string_destroy(r); r = NULL;
     }
 
-    string_destroy(cond_s);
     return r;
 }
 
@@ -318,8 +340,7 @@ static string_t* convert_do_while(parser_t* parser, TSNode node,
 static string_t* convert_repeat(parser_t* parser, TSNode node,
                                  const char* target, const char* src) {
     TSNode cond_n = parser_child_by_field(node, "condition");
-    string_t* cond_s = parser_node_text(parser, cond_n);
-    const char* cond = string_cstr(cond_s);
+    strview_t cond = parser_node_view(parser, cond_n);
 
     body_range_t raw  = get_body_range(node, "repeta", "pana");
     uint32_t body_end = trim_body_end(src, raw.start_byte, raw.end_byte);
@@ -335,7 +356,7 @@ static string_t* convert_repeat(parser_t* parser, TSNode node,
         size_t      bln_body = (bln > 0 && bt[0] == '\n') ? bln - 1 : bln;
         string_append_buf(r, bt_body, bln_body);
         string_append(r, li);
-        string_append(r, "cat timp not ("); string_append(r, cond); string_append(r, ") executa");
+        string_append(r, "cat timp not ("); string_append_view(r, cond); string_append(r, ") executa");
         string_append_buf(r, bt, bln);
         string_append(r, li); string_append(r, "sf");
 
@@ -344,45 +365,36 @@ static string_t* convert_repeat(parser_t* parser, TSNode node,
         string_append(r, "executa");
         string_append_buf(r, bt, bln);
         string_append(r, li);
-        string_append(r, "cat timp not ("); string_append(r, cond);
+        string_append(r, "cat timp not ("); string_append_view(r, cond);
         string_append_char(r, ')');
 
     } else {
         string_destroy(r); r = NULL;
     }
 
-    string_destroy(cond_s);
     return r;
 }
 
 // ─── Parse helper ─────────────────────────────────────────────────────────
 
-static parser_t* parse_linted(const char* source, string_t** linted_out) {
-    string_t* raw    = string_create_from(source);
-    string_t* linted = lint(raw);
-    string_destroy(raw);
-
+// The parser borrows `source` when it is already linted, so it must be
+// destroyed before the caller's source goes away
+static parser_t* parse_linted(const char* source) {
     parser_t* parser = parser_create();
-    if (!parser) { string_destroy(linted); return NULL; }
+    if (!parser) return NULL;
 
-    parser_error_t err = parser_parse(parser, linted);
+    parser_error_t err = parser_parse_source(parser, source, strlen(source), true);
     parser_error_free(&err);
 
-    *linted_out = linted;
     return parser;
 }
 
 // ─── Public API ───────────────────────────────────────────────────────────
 
-char* equiv_get_all_loops(const char* source) {
-    if (!source) return NULL;
-
-    string_t* linted = NULL;
-    parser_t* parser = parse_linted(source, &linted);
-    if (!parser) return NULL;
-
+char* equiv_get_loops_in_rows(TSNode root, const row_span_t* rows, size_t row_count) {
     loop_list_t list = {0};
-    collect_loops(parser_root(parser), &list);
+    loop_rows_t search = { .rows = rows, .row_count = row_count, .list = &list };
+    tree_walk(root, collect_loop, &search);
 
     string_t* json = string_create();
     string_append(json, "[");
@@ -400,8 +412,6 @@ char* equiv_get_all_loops(const char* source) {
     }
     string_append(json, "]");
 
-    parser_destroy(parser);
-    string_destroy(linted);
     free(list.nodes);
 
     size_t len = string_length(json);
@@ -411,28 +421,41 @@ char* equiv_get_all_loops(const char* source) {
     return result;
 }
 
-char* equiv_convert_loop(const char* source, uint32_t line, uint32_t col,
-                         const char* target_type) {
+char* equiv_get_all_loops(const char* source) {
+    if (!source) return NULL;
+
+    parser_t* parser = parse_linted(source);
+    if (!parser) return NULL;
+
+    const row_span_t all = { .first = 0, .last = UINT32_MAX };
+    char* result = equiv_get_loops_in_rows(parser_root(parser), &all, 1);
+
+    parser_destroy(parser);
+    return result;
+}
+
+static char* convert_loop_at(const char* source, uint32_t line, uint32_t col,
+                             const char* target_type) {
     if (!source || !target_type) return make_error("Argumente lipsa");
 
-    string_t* linted = NULL;
-    parser_t* parser = parse_linted(source, &linted);
+    parser_t* parser = parse_linted(source);
     if (!parser) return make_error("Initializare parser esuata");
 
-    const char* linted_src = string_cstr(linted);
+    strview_t linted = parser_source(parser);
+    const char* linted_src = linted.data;
     (void)col; // col unused: we match by line
 
     TSNode loop_node = find_loop_at_line(parser_root(parser), line);
 
     if (ts_node_is_null(loop_node)) {
-        parser_destroy(parser); string_destroy(linted);
+        parser_destroy(parser);
         return make_error("Nicio bucla la pozitia indicata");
     }
 
     const char* loop_type = ts_node_type(loop_node);
 
     if (strcmp(loop_type, target_type) == 0) {
-        parser_destroy(parser); string_destroy(linted);
+        parser_destroy(parser);
         return make_error("Bucla este deja de tipul ales");
     }
 
@@ -447,13 +470,13 @@ char* equiv_convert_loop(const char* source, uint32_t line, uint32_t col,
         new_loop = convert_repeat(parser, loop_node, target_type, linted_src);
 
     if (!new_loop) {
-        parser_destroy(parser); string_destroy(linted);
+        parser_destroy(parser);
         return make_error("Conversie nesuportata");
     }
 
     uint32_t loop_start = ts_node_start_byte(loop_node);
     uint32_t loop_end   = ts_node_end_byte(loop_node);
-    size_t   src_len    = strlen(linted_src);
+    size_t   src_len    = linted.len;
 
     // Conversions that emit content before the loop keyword (body-copy or if-guard)
     // must replace from the start of the loop's line so the LI whitespace in the
@@ -478,7 +501,6 @@ char* equiv_convert_loop(const char* source, uint32_t line, uint32_t col,
 
     string_destroy(new_loop);
     parser_destroy(parser);
-    string_destroy(linted);
 
     size_t len = string_length(result);
     char* out = (char*)malloc(len + 1);
@@ -486,3 +508,11 @@ char* equiv_convert_loop(const char* source, uint32_t line, uint32_t col,
     string_destroy(result);
     return out;
 }
+
+char* equiv_convert_loop(const char* source, uint32_t line, uint32_t col,
+                         const char* target_type) {
+    TRACE_BEGIN("equiv_convert_loop");
+    char* result = convert_loop_at(source, line, col, target_type);
+    TRACE_END("equiv_convert_loop");
+    return result;
+}
@@ -0,0 +1,85 @@
+#include "pseudo/io.h"
+#include "pseudo/format.h"
+#include "pseudo/memory.h"
+#include <string.h>
+
+// Text up to this size is NUL-terminated on the stack for ops.write
+#define WRITE_STACK_SIZE 256
+
+void io_init(io_t* io, const io_ops_t* ops, void* ctx) {
+    io->ops = *ops;
+    io->ctx = ctx;
+    io->status = IO_OK;
+    io->output_total = 0;
+    io->output_limit = 0;
+}
+
+void io_set_output_limit(io_t* io, size_t bytes) {
+    if (io) io->output_limit = bytes;
+}
+
+bool io_accept_output(io_t* io, size_t len) {
+    if (io->output_limit &&
+        (io->output_total > io->output_limit || len > io->output_limit - io->output_total)) {
+        io->status = IO_OUTPUT_LIMIT;
+        return false;
+    }
+    io->output_total += len;
+    return true;
+}
+
+void io_write_buf(io_t* io, const char* data, size_t len) {
+    if (!io || len == 0) return;
+
+    if (io->ops.write_buf) {
+        io->ops.write_buf(io, data, len);
+        return;
+    }
+
+    // Adapter for backends that only take NUL-terminated text
+    char stack[WRITE_STACK_SIZE];
+    char* text = len < sizeof(stack) ? stack : mem_alloc(MEM_IO, len + 1);
+    if (!text) return;
+
+    memcpy(text, data, len);
+    text[len] = '\0';
+    io->ops.write(io, text);
+
+    if (text != stack) mem_free(text);
+}
+
+void io_write_i64(io_t* io, int64_t value) {
+    if (!io) return;
+
+    if (io->ops.write_i64) {
+        io->ops.write_i64(io, value);
+        return;
+    }
+
+    char buffer[FORMAT_NUMBER_MAX];
+    io_write_buf(io, buffer, format_i64(buffer, value));
+}
+
+void io_write_f64(io_t* io, double value) {
+    if (!io) return;
+
+    if (io->ops.write_f64) {
+        io->ops.write_f64(io, value);
+        return;
+    }
+
+    char buffer[FORMAT_NUMBER_MAX];
+    io_write_buf(io, buffer, format_f64(buffer, value));
+}
+
+void io_flush(io_t* io) {
+    if (io && io->ops.flush) {
+        io->ops.flush(io);
+    }
+}
+
+void io_destroy(io_t* io) {
+    if (io && io->ops.destroy) {
+        io->ops.destroy(io);
+    }
+}
@@ -1,162 +1,305 @@
 #include "pseudo/io.h"
+#include "pseudo/io_internal.h"
+#include "pseudo/memory.h"
+#include "pseudo/format.h"
 #include <stdlib.h>
 #include <string.h>
 
-typedef struct string_node {
-    char* str;
-    struct string_node* next;
-} string_node_t;
+#define OUTPUT_INITIAL_CAPACITY 4096
+// A buffer grown past this by a burst of output is released once drained
+#define OUTPUT_KEEP_CAPACITY (1024 * 1024)
+
+// One pushed chunk of input. Split blocks (pasted input files) are cut into
+// values lazily and in place: each value is NUL-terminated over its
+// delimiter, so reads never copy. Unsplit blocks are a single value.
+typedef struct input_block {
+    char* data;           // data[len] is always '\0'
+    size_t len;
+    size_t pos;           // Start of the next value
+    bool split;
+    bool host_owned;      // Allocated by the host with malloc, freed with free
+    struct input_block* next;
+} input_block_t;
 
 typedef struct {
-    string_node_t* output_head;
-    string_node_t* output_tail;
-    string_node_t* input_head;
-    string_node_t* input_tail;
+    // Output bytes not yet handed to the host, in one contiguous block.
+    // Every drain takes all of it, so the buffer restarts at offset 0.
+    char* output;
+    size_t output_len;
+    size_t output_cap;
+    size_t output_capacity;  // Undrained bytes that report IO_OUTPUT_FULL (0 = unlimited)
+
+    // Input blocks in push order. A block is freed on the read after its
+    // last value, so the value returned by a read stays valid until then.
+    input_block_t* input_head;
+    input_block_t* input_tail;
+    io_input_mode_t input_mode;
     bool waiting_for_input;
 } buffered_ctx_t;
 
+static bool output_reserve(buffered_ctx_t* ctx, size_t extra) {
+    size_t needed = ctx->output_len + extra + 1;
+    if (needed <= ctx->output_cap) return true;
+
+    size_t capacity = ctx->output_cap ? ctx->output_cap : OUTPUT_INITIAL_CAPACITY;
+    while (capacity < needed) capacity *= 2;
+
+    char* output = mem_realloc(MEM_IO, ctx->output, capacity);
+    if (!output) return false;  // Memory cap reached: the write is dropped
+
+    ctx->output = output;
+    ctx->output_cap = capacity;
+    return true;
+}
+
+// Makes room for `extra` more bytes plus the terminating NUL
+static bool output_prepare(buffered_ctx_t* ctx, size_t extra) {
+    // The previous drain may still point into a huge buffer; drop it now
+    if (ctx->output_len == 0 && ctx->output_cap > OUTPUT_KEEP_CAPACITY) {
+        mem_free(ctx->output);
+        ctx->output = NULL;
+        ctx->output_cap = 0;
+    }
+    return output_reserve(ctx, extra);
+}
+
+// Takes the `len` bytes just placed at the end of the output, unless the
+// output limit refuses them
+static void output_commit(io_t* io, buffered_ctx_t* ctx, size_t len) {
+    if (io_accept_output(io, len)) {
+        ctx->output_len += len;
+        if (ctx->output_capacity && ctx->output_len >= ctx->output_capacity &&
+            io->status == IO_OK) {
+            io->status = IO_OUTPUT_FULL;
+        }
+    }
+    ctx->output[ctx->output_len] = '\0';
+}
+
+static void buffered_write_buf(io_t* io, const char* data, size_t len) {
+    buffered_ctx_t* ctx = (buffered_ctx_t*)io->ctx;
+    if (len == 0 || !output_prepare(ctx, len)) return;
+
+    memcpy(ctx->output + ctx->output_len, data, len);
+    output_commit(io, ctx, len);
+}
+
 static void buffered_write(io_t* io, const char* text) {
     if (!io || !text) return;
+    buffered_write_buf(io, text, strlen(text));
+}
+
+static void buffered_write_i64(io_t* io, int64_t value) {
     buffered_ctx_t* ctx = (buffered_ctx_t*)io->ctx;
+    if (!output_prepare(ctx, FORMAT_NUMBER_MAX)) return;
+    output_commit(io, ctx, format_i64(ctx->output + ctx->output_len, value));
+}
 
-    string_node_t* node = malloc(sizeof(string_node_t));
-    if (!node) return;
+static void buffered_write_f64(io_t* io, double value) {
+    buffered_ctx_t* ctx = (buffered_ctx_t*)io->ctx;
+    if (!output_prepare(ctx, FORMAT_NUMBER_MAX)) return;
+    output_commit(io, ctx, format_f64(ctx->output + ctx->output_len, value));
+}
 
-    node->str = strdup(text);
-    if (!node->str) {
-        free(node);
-        return;
+static void input_block_free(input_block_t* block) {
+    if (block->host_owned) {
+        free(block->data);
+    } else {
+        mem_free(block->data);
     }
-    node->next = NULL;
+    mem_free(block);
+}
 
-    if (ctx->output_tail) {
-        ctx->output_tail->next = node;
-    } else {
-        ctx->output_head = node;
+static void input_clear(buffered_ctx_t* ctx) {
+    input_block_t* block = ctx->input_head;
+    while (block) {
+        input_block_t* next = block->next;
+        input_block_free(block);
+        block = next;
     }
-    ctx->output_tail = node;
+    ctx->input_head = NULL;
+    ctx->input_tail = NULL;
 }
 
-// Maximum input length (inputs longer than this will be truncated)
-#define MAX_INPUT_LENGTH 65536
+// Cuts the next value out of a split block, or returns NULL if none is left
+static const char* input_block_next(input_block_t* block, io_input_mode_t mode) {
+    char* data = block->data;
+    size_t pos = block->pos;
+
+    if (mode == IO_INPUT_TOKENS) {
+        while (pos < block->len && io_is_space(data[pos])) pos++;
+        if (pos >= block->len) {
+            block->pos = block->len;
+            return NULL;
+        }
+        size_t end = pos;
+        while (end < block->len && !io_is_space(data[end])) end++;
+        data[end] = '\0';
+        block->pos = end < block->len ? end + 1 : end;
+        return data + pos;
+    }
+
+    if (pos >= block->len) return NULL;
+    char* nl = memchr(data + pos, '\n', block->len - pos);
+    size_t end = nl ? (size_t)(nl - data) : block->len;
+    data[end] = '\0';
+    block->pos = end < block->len ? end + 1 : end;
+    return data + pos;
+}
 
 static const char* buffered_read(io_t* io) {
     if (!io) return NULL;
     buffered_ctx_t* ctx = (buffered_ctx_t*)io->ctx;
 
-    if (!ctx->input_head) {
-        ctx->waiting_for_input = true;
-        return NULL;  // No input available
-    }
-
-    // Dequeue input
-    string_node_t* node = ctx->input_head;
-    ctx->input_head = node->next;
-    if (!ctx->input_head) {
-        ctx->input_tail = NULL;
-    }
+    while (ctx->input_head) {
+        input_block_t* block = ctx->input_head;
 
-    ctx->waiting_for_input = false;
+        if (block->pos >= block->len && (block->split || block->pos > 0)) {
+            // Exhausted (its last value was returned by the previous read)
+            ctx->input_head = block->next;
+            if (!ctx->input_head) ctx->input_tail = NULL;
+            input_block_free(block);
+            continue;
+        }
 
-    // Use static buffer to avoid requiring caller to free
-    static char input_buffer[MAX_INPUT_LENGTH];
-    strncpy(input_buffer, node->str, sizeof(input_buffer) - 1);
-    input_buffer[sizeof(input_buffer) - 1] = '\0';
+        const char* value;
+        if (block->split) {
+            value = input_block_next(block, ctx->input_mode);
+            if (!value) continue;  // Only delimiters left: freed next round
+        } else {
+            value = block->data;
+            block->pos = block->len + 1;  // Consumed
+        }
 
-    free(node->str);
-    free(node);
+        ctx->waiting_for_input = false;
+        return value;
+    }
 
-    return input_buffer;
+    ctx->waiting_for_input = true;
+    return NULL;  // No input available
 }
 
 static void buffered_destroy(io_t* io) {
     if (!io) return;
     
     buffered_ctx_t* ctx = (buffered_ctx_t*)io->ctx;
-    
-    // Free output queue
-    string_node_t* node = ctx->output_head;
-    while (node) {
-        string_node_t* next = node->next;
-        free(node->str);
-        free(node);
-        node = next;
-    }
-    
-    // Free input queue
-    node = ctx->input_head;
-    while (node) {
-        string_node_t* next = node->next;
-        free(node->str);
-        free(node);
-        node = next;
-    }
-    
-    free(ctx);
-    free(io);
+
+    mem_free(ctx->output);
+
+    input_clear(ctx);
+    mem_free(ctx);
+    mem_free(io);
 }
 
 io_t* io_buffered_create(void) {
-    io_t* io = malloc(sizeof(io_t));
+    io_t* io = mem_alloc(MEM_IO, sizeof(io_t));
     if (!io) return NULL;
     
-    buffered_ctx_t* ctx = calloc(1, sizeof(buffered_ctx_t));
+    buffered_ctx_t* ctx = mem_calloc(MEM_IO, 1, sizeof(buffered_ctx_t));
     if (!ctx) {
-        free(io);
+        mem_free(io);
         return NULL;
     }
     
-    io->ops.write = buffered_write;
-    io->ops.read = buffered_read;
-    io->ops.destroy = buffered_destroy;
-    io->ctx = ctx;
+    // No flush: output is drained by the host
+    io_init(io, &(io_ops_t){
+        .write = buffered_write,
+        .read = buffered_read,
+        .destroy = buffered_destroy,
+        .write_buf = buffered_write_buf,
+        .write_i64 = buffered_write_i64,
+        .write_f64 = buffered_write_f64,
+    }, ctx);
     
     return io;
 }
 
+static void input_append(buffered_ctx_t* ctx, input_block_t* block) {
+    if (ctx->input_tail) {
+        ctx->input_tail->next = block;
+    } else {
+        ctx->input_head = block;
+    }
+    ctx->input_tail = block;
+}
+
 void io_buffered_push_input(io_t* io, const char* value) {
     if (!io || !value) return;
     buffered_ctx_t* ctx = (buffered_ctx_t*)io->ctx;
 
-    string_node_t* node = malloc(sizeof(string_node_t));
-    if (!node) return;
+    input_block_t* block = mem_calloc(MEM_IO, 1, sizeof(input_block_t));
+    if (!block) return;
 
-    node->str = strdup(value);
-    if (!node->str) {
-        free(node);
+    block->data = mem_strdup(MEM_IO, value);
+    if (!block->data) {
+        mem_free(block);
         return;
     }
-    node->next = NULL;
+    block->len = strlen(value);
+    input_append(ctx, block);
+}
+
+bool io_buffered_push_input_block(io_t* io, char* data, size_t len) {
+    if (!io || !data) {
+        free(data);
+        return false;
+    }
+    buffered_ctx_t* ctx = (buffered_ctx_t*)io->ctx;
 
-    if (ctx->input_tail) {
-        ctx->input_tail->next = node;
-    } else {
-        ctx->input_head = node;
+    input_block_t* block = mem_calloc(MEM_IO, 1, sizeof(input_block_t));
+    if (!block) {
+        free(data);
+        return false;
     }
-    ctx->input_tail = node;
+
+    data[len] = '\0';
+    block->data = data;
+    block->len = len;
+    block->split = true;
+    block->host_owned = true;
+    input_append(ctx, block);
+    return true;
+}
+
+void io_buffered_set_input_mode(io_t* io, io_input_mode_t mode) {
+    if (!io) return;
+    ((buffered_ctx_t*)io->ctx)->input_mode = mode;
+}
+
+void io_buffered_set_output_capacity(io_t* io, size_t bytes) {
+    if (!io) return;
+    ((buffered_ctx_t*)io->ctx)->output_capacity = bytes;
 }
 
 char* io_buffered_pop_output(io_t* io) {
-    if (!io) return NULL;
-    buffered_ctx_t* ctx = (buffered_ctx_t*)io->ctx;
+    const char* data;
+    size_t len;
+    if (!io_buffered_drain_output(io, &data, &len)) return NULL;
 
-    if (!ctx->output_head) return NULL;
-    
-    string_node_t* node = ctx->output_head;
-    ctx->output_head = node->next;
-    if (!ctx->output_head) {
-        ctx->output_tail = NULL;
-    }
-    
-    char* str = node->str;
-    free(node);
+    // Plain malloc'd copy so the caller can free() it like every other
+    // buffer the bridge returns
+    char* str = malloc(len + 1);
+    if (str) memcpy(str, data, len + 1);
     return str;  // Caller owns
 }
 
+bool io_buffered_drain_output(io_t* io, const char** data, size_t* len) {
+    if (!io) return false;
+    buffered_ctx_t* ctx = (buffered_ctx_t*)io->ctx;
+
+    if (ctx->output_len == 0) return false;
+
+    *data = ctx->output;
+    *len = ctx->output_len;
+    ctx->output_len = 0;  // The span stays intact until the next write
+    if (io->status == IO_OUTPUT_FULL) io->status = IO_OK;
+    return true;
+}
+
 bool io_buffered_has_output(io_t* io) {
     if (!io) return false;
     buffered_ctx_t* ctx = (buffered_ctx_t*)io->ctx;
-    return ctx->output_head != NULL;
+    return ctx->output_len > 0;
 }
 
 bool io_buffered_needs_input(io_t* io) {
@@ -170,20 +313,11 @@ void io_buffered_clear(io_t* io) {
     buffered_ctx_t* ctx = (buffered_ctx_t*)io->ctx;
     
     // Clear output
-    while (ctx->output_head) {
-        char* str = io_buffered_pop_output(io);
-        free(str);
-    }
-    
+    ctx->output_len = 0;
+    io->status = IO_OK;
+    io->output_total = 0;
+
     // Clear input
-    string_node_t* node = ctx->input_head;
-    while (node) {
-        string_node_t* next = node->next;
-        free(node->str);
-        free(node);
-        node = next;
-    }
-    ctx->input_head = NULL;
-    ctx->input_tail = NULL;
+    input_clear(ctx);
     ctx->waiting_for_input = false;
 }
@@ -0,0 +1,259 @@
+#include "pseudo/io.h"
+#include "pseudo/io_internal.h"
+#include "pseudo/filemap.h"
+#include "pseudo/memory.h"
+#include <string.h>
+#include <stdint.h>
+
+#define NO_MISMATCH SIZE_MAX
+
+typedef struct {
+    io_t* input;
+    io_check_mode_t mode;
+    filemap_t expected;
+    size_t pos;  // Next expected byte to match
+
+    // IO_CHECK_LINES: whitespace written since the last visible character
+    // of the line. It only has to match if more text follows on the line,
+    // so it is compared tentatively and a difference is reported later.
+    size_t pending_len;
+    size_t pending_mismatch;  // Index of the first differing byte, or NO_MISMATCH
+    char pending_preview[IO_CHECK_PREVIEW];
+    size_t pending_preview_len;
+
+    bool in_token;  // IO_CHECK_TOKENS: inside a word of the output
+
+    bool failed;
+    io_check_report_t report;
+} check_ctx_t;
+
+static bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Copies up to the end of the line (or the preview size) from two spans
+static void preview_copy(char* out, const char* a, size_t a_len, const char* b, size_t b_len) {
+    size_t n = 0;
+    for (size_t i = 0; i < a_len && n < IO_CHECK_PREVIEW && a[i] != '\n'; i++) out[n++] = a[i];
+    if (n == a_len) {
+        for (size_t i = 0; i < b_len && n < IO_CHECK_PREVIEW && b[i] != '\n'; i++) out[n++] = b[i];
+    }
+    out[n] = '\0';
+}
+
+// Records the first difference (at `offset` in the expected output; the
+// program wrote `actual` there) and halts the program
+static void check_fail(io_t* io, size_t offset,
+                       const char* pending, size_t pending_len,
+                       const char* actual, size_t actual_len) {
+    check_ctx_t* ctx = (check_ctx_t*)io->ctx;
+    io_check_report_t* report = &ctx->report;
+    const char* exp = ctx->expected.data;
+    size_t exp_len = ctx->expected.len;
+
+    if (offset > exp_len) offset = exp_len;
+    report->match = false;
+    report->offset = offset;
+    report->line = 1;
+    for (const char* p = exp; p && (p = memchr(p, '\n', (size_t)(exp + offset - p))); p++) {
+        report->line++;
+    }
+    report->expected_end = offset == exp_len;
+    preview_copy(report->expected, exp ? exp + offset : NULL, exp_len - offset, NULL, 0);
+    preview_copy(report->actual, pending, pending_len, actual, actual_len);
+
+    ctx->failed = true;
+    io->status = IO_HALT;
+}
+
+static void check_exact(io_t* io, const char* text, size_t len) {
+    check_ctx_t* ctx = (check_ctx_t*)io->ctx;
+    size_t avail = ctx->expected.len - ctx->pos;
+    size_t n = len < avail ? len : avail;
+
+    if (n > 0 && memcmp(ctx->expected.data + ctx->pos, text, n) != 0) {
+        const char* exp = ctx->expected.data + ctx->pos;
+        size_t i = 0;
+        while (exp[i] == text[i]) i++;
+        check_fail(io, ctx->pos + i, NULL, 0, text + i, len - i);
+        return;
+    }
+    if (len > avail) {
+        check_fail(io, ctx->expected.len, NULL, 0, text + n, len - n);
+        return;
+    }
+    ctx->pos += len;
+}
+
+static void check_lines(io_t* io, const char* text, size_t len) {
+    check_ctx_t* ctx = (check_ctx_t*)io->ctx;
+    const char* exp = ctx->expected.data;
+    size_t exp_len = ctx->expected.len;
+
+    for (size_t i = 0; i < len; i++) {
+        char c = text[i];
+
+        if (is_blank(c)) {
+            size_t at = ctx->pos + ctx->pending_len;
+            if (ctx->pending_mismatch == NO_MISMATCH && (at >= exp_len || exp[at] != c)) {
+                ctx->pending_mismatch = ctx->pending_len;
+            }
+            if (ctx->pending_mismatch != NO_MISMATCH &&
+                ctx->pending_preview_len < IO_CHECK_PREVIEW) {
+                ctx->pending_preview[ctx->pending_preview_len++] = c;
+            }
+            ctx->pending_len++;
+            continue;
+        }
+
+        if (c == '\n') {
+            // End of the output line: the expected line may only have
+            // trailing whitespace left (or be past the end of the file)
+            size_t p = ctx->pos;
+            while (p < exp_len && is_blank(exp[p])) p++;
+            if (p < exp_len && exp[p] != '\n') {
+                check_fail(io, p, NULL, 0, text + i, len - i);
+                return;
+            }
+            ctx->pos = p < exp_len ? p + 1 : p;
+        } else if (ctx->pending_mismatch != NO_MISMATCH) {
+            check_fail(io, ctx->pos + ctx->pending_mismatch,
+                       ctx->pending_preview, ctx->pending_preview_len, text + i, len - i);
+            return;
+        } else {
+            size_t at = ctx->pos + ctx->pending_len;
+            if (at >= exp_len || exp[at] != c) {
+                check_fail(io, at, NULL, 0, text + i, len - i);
+                return;
+            }
+            ctx->pos = at + 1;
+        }
+
+        ctx->pending_len = 0;
+        ctx->pending_mismatch = NO_MISMATCH;
+        ctx->pending_preview_len = 0;
+    }
+}
+
+static void check_tokens(io_t* io, const char* text, size_t len) {
+    check_ctx_t* ctx = (check_ctx_t*)io->ctx;
+    const char* exp = ctx->expected.data;
+    size_t exp_len = ctx->expected.len;
+
+    for (size_t i = 0; i < len; i++) {
+        char c = text[i];
+
+        if (io_is_space(c)) {
+            // The expected word must end here too
+            if (ctx->in_token && ctx->pos < exp_len && !io_is_space(exp[ctx->pos])) {
+                check_fail(io, ctx->pos, NULL, 0, text + i, len - i);
+                return;
+            }
+            ctx->in_token = false;
+            continue;
+        }
+
+        if (!ctx->in_token) {
+            while (ctx->pos < exp_len && io_is_space(exp[ctx->pos])) ctx->pos++;
+            ctx->in_token = true;
+        }
+        if (ctx->pos >= exp_len || exp[ctx->pos] != c) {
+            check_fail(io, ctx->pos, NULL, 0, text + i, len - i);
+            return;
+        }
+        ctx->pos++;
+    }
+}
+
+static void check_write_buf(io_t* io, const char* text, size_t len) {
+    check_ctx_t* ctx = (check_ctx_t*)io->ctx;
+    if (ctx->failed || !io_accept_output(io, len)) return;
+
+    switch (ctx->mode) {
+        case IO_CHECK_EXACT:  check_exact(io, text, len);  break;
+        case IO_CHECK_LINES:  check_lines(io, text, len);  break;
+        case IO_CHECK_TOKENS: check_tokens(io, text, len); break;
+    }
+}
+
+static void check_write(io_t* io, const char* text) {
+    check_write_buf(io, text, strlen(text));
+}
+
+static const char* check_read(io_t* io) {
+    check_ctx_t* ctx = (check_ctx_t*)io->ctx;
+    if (!ctx->input) return NULL;
+    const char* value = ctx->input->ops.read(ctx->input);
+    if (!value && ctx->input->status == IO_NO_MEMORY) io->status = IO_NO_MEMORY;
+    return value;
+}
+
+static void check_destroy(io_t* io) {
+    if (!io) return;
+    check_ctx_t* ctx = (check_ctx_t*)io->ctx;
+
+    io_destroy(ctx->input);
+    filemap_close(&ctx->expected);
+    mem_free(ctx);
+    mem_free(io);
+}
+
+io_t* io_check_create(io_t* input, io_check_mode_t mode) {
+    io_t* io = mem_alloc(MEM_IO, sizeof(io_t));
+    if (!io) return NULL;
+
+    check_ctx_t* ctx = mem_calloc(MEM_IO, 1, sizeof(check_ctx_t));
+    if (!ctx) {
+        mem_free(io);
+        return NULL;
+    }
+    ctx->input = input;
+    ctx->mode = mode;
+    ctx->pending_mismatch = NO_MISMATCH;
+    ctx->report.match = true;
+
+    // Numbers go through the generic formatter into write_buf
+    io_init(io, &(io_ops_t){
+        .write = check_write,
+        .read = check_read,
+        .destroy = check_destroy,
+        .write_buf = check_write_buf,
+    }, ctx);
+
+    return io;
+}
+
+bool io_check_open_expected(io_t* io, const char* path) {
+    if (!io || !path) return false;
+    check_ctx_t* ctx = (check_ctx_t*)io->ctx;
+
+    filemap_t expected;
+    if (!filemap_open(&expected, path)) return false;
+
+    filemap_close(&ctx->expected);
+    ctx->expected = expected;
+    ctx->pos = 0;
+    return true;
+}
+
+void io_check_finish(io_t* io, io_check_report_t* report) {
+    check_ctx_t* ctx = (check_ctx_t*)io->ctx;
+    const char* exp = ctx->expected.data;
+    size_t exp_len = ctx->expected.len;
+
+    if (!ctx->failed) {
+        size_t p = ctx->pos;
+        if (ctx->mode == IO_CHECK_TOKENS && ctx->in_token && p < exp_len && !io_is_space(exp[p])) {
+            check_fail(io, p, NULL, 0, NULL, 0);
+        } else {
+            // Whatever is left must be whitespace (or nothing, when exact)
+            if (ctx->mode != IO_CHECK_EXACT) {
+                while (p < exp_len && io_is_space(exp[p])) p++;
+            }
+            if (p < exp_len) check_fail(io, p, NULL, 0, NULL, 0);
+        }
+        if (ctx->failed) ctx->report.actual_end = true;
+    }
+
+    *report = ctx->report;
+}
@@ -0,0 +1,188 @@
+#include "pseudo/io.h"
+#include "pseudo/memory.h"
+#include <string.h>
+
+#define RECORD_INITIAL_CAPACITY 256
+
+typedef struct {
+    io_t* inner;
+    bool muted;
+    bool recording;
+
+    // Every value read from `inner`, NUL-terminated one after another
+    char* data;
+    size_t data_len;
+    size_t data_cap;
+    size_t* offsets;   // Start of each value in data
+    size_t count;
+    size_t capacity;
+    bool lost;         // A value could not be recorded (memory cap)
+
+    size_t position;   // Values read so far; below count, reads replay
+} replay_ctx_t;
+
+static bool record(replay_ctx_t* ctx, const char* value) {
+    size_t len = strlen(value) + 1;
+
+    if (ctx->count == ctx->capacity) {
+        size_t capacity = ctx->capacity ? ctx->capacity * 2 : RECORD_INITIAL_CAPACITY;
+        size_t* offsets = mem_realloc(MEM_IO, ctx->offsets, capacity * sizeof(size_t));
+        if (!offsets) return false;
+        ctx->offsets = offsets;
+        ctx->capacity = capacity;
+    }
+    if (ctx->data_len + len > ctx->data_cap) {
+        size_t capacity = ctx->data_cap ? ctx->data_cap : RECORD_INITIAL_CAPACITY * 16;
+        while (capacity < ctx->data_len + len) capacity *= 2;
+        char* data = mem_realloc(MEM_IO, ctx->data, capacity);
+        if (!data) return false;
+        ctx->data = data;
+        ctx->data_cap = capacity;
+    }
+
+    memcpy(ctx->data + ctx->data_len, value, len);
+    ctx->offsets[ctx->count++] = ctx->data_len;
+    ctx->data_len += len;
+    return true;
+}
+
+static const char* replay_read(io_t* io) {
+    replay_ctx_t* ctx = (replay_ctx_t*)io->ctx;
+
+    if (ctx->position < ctx->count) {
+        return ctx->data + ctx->offsets[ctx->position++];
+    }
+
+    const char* value = ctx->inner->ops.read(ctx->inner);
+    if (!value && ctx->inner->status == IO_NO_MEMORY) io->status = IO_NO_MEMORY;
+    if (!value || !ctx->recording) return value;
+    if (ctx->lost || !record(ctx, value)) {
+        ctx->lost = true;
+        return value;
+    }
+    ctx->position = ctx->count;
+    return ctx->data + ctx->offsets[ctx->count - 1];
+}
+
+// Writes pass through; the inner backend's verdict becomes this one's
+static void replay_write_buf(io_t* io, const char* data, size_t len) {
+    replay_ctx_t* ctx = (replay_ctx_t*)io->ctx;
+    if (ctx->muted) {
+        io->status = IO_OK;
+        return;
+    }
+    io_write_buf(ctx->inner, data, len);
+    io->status = ctx->inner->status;
+}
+
+static void replay_write(io_t* io, const char* text) {
+    replay_write_buf(io, text, strlen(text));
+}
+
+static void replay_write_i64(io_t* io, int64_t value) {
+    replay_ctx_t* ctx = (replay_ctx_t*)io->ctx;
+    if (ctx->muted) {
+        io->status = IO_OK;
+        return;
+    }
+    io_write_i64(ctx->inner, value);
+    io->status = ctx->inner->status;
+}
+
+static void replay_write_f64(io_t* io, double value) {
+    replay_ctx_t* ctx = (replay_ctx_t*)io->ctx;
+    if (ctx->muted) {
+        io->status = IO_OK;
+        return;
+    }
+    io_write_f64(ctx->inner, value);
+    io->status = ctx->inner->status;
+}
+
+static void replay_flush(io_t* io) {
+    replay_ctx_t* ctx = (replay_ctx_t*)io->ctx;
+    io_flush(ctx->inner);
+}
+
+static void replay_destroy(io_t* io) {
+    if (!io) return;
+    replay_ctx_t* ctx = (replay_ctx_t*)io->ctx;
+
+    io_destroy(ctx->inner);
+    mem_free(ctx->data);
+    mem_free(ctx->offsets);
+    mem_free(ctx);
+    mem_free(io);
+}
+
+io_t* io_replay_create(io_t* inner) {
+    if (!inner) return NULL;
+
+    io_t* io = mem_alloc(MEM_IO, sizeof(io_t));
+    if (!io) return NULL;
+
+    replay_ctx_t* ctx = mem_calloc(MEM_IO, 1, sizeof(replay_ctx_t));
+    if (!ctx) {
+        mem_free(io);
+        return NULL;
+    }
+    ctx->inner = inner;
+
+    io_init(io, &(io_ops_t){
+        .write = replay_write,
+        .read = replay_read,
+        .destroy = replay_destroy,
+        .write_buf = replay_write_buf,
+        .write_i64 = replay_write_i64,
+        .write_f64 = replay_write_f64,
+        .flush = replay_flush,
+    }, ctx);
+
+    return io;
+}
+
+bool io_is_replay(const io_t* io) {
+    return io && io->ops.destroy == replay_destroy;
+}
+
+io_t* io_replay_inner(io_t* io) {
+    return io_is_replay(io) ? ((replay_ctx_t*)io->ctx)->inner : NULL;
+}
+
+size_t io_replay_position(const io_t* io) {
+    return io_is_replay(io) ? ((const replay_ctx_t*)io->ctx)->position : 0;
+}
+
+bool io_replay_seek(io_t* io, size_t position) {
+    if (!io_is_replay(io)) return false;
+    replay_ctx_t* ctx = (replay_ctx_t*)io->ctx;
+
+    if (ctx->lost || position > ctx->count) return false;
+    ctx->position = position;
+    return true;
+}
+
+void io_replay_set_muted(io_t* io, bool muted) {
+    if (!io_is_replay(io)) return;
+    ((replay_ctx_t*)io->ctx)->muted = muted;
+    if (muted) io->status = IO_OK;
+}
+
+void io_replay_record(io_t* io, bool enabled) {
+    if (!io_is_replay(io)) return;
+    replay_ctx_t* ctx = (replay_ctx_t*)io->ctx;
+
+    ctx->recording = enabled;
+    ctx->data_len = 0;
+    ctx->count = 0;
+    ctx->position = 0;
+    ctx->lost = false;
+    if (!enabled) {
+        mem_free(ctx->data);
+        mem_free(ctx->offsets);
+        ctx->data = NULL;
+        ctx->offsets = NULL;
+        ctx->data_cap = 0;
+        ctx->capacity = 0;
+    }
+}
@@ -1,35 +1,270 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "pseudo/io.h"
+#include "pseudo/io_internal.h"
+#include "pseudo/format.h"
+#include "pseudo/filemap.h"
+#include "pseudo/memory.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+// Output is collected here and handed to the OS in large chunks
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+
+// Input is read in blocks of this size; the buffer grows for longer tokens
+#define INPUT_BLOCK_SIZE (64 * 1024)
+
+// Input source: either stdin read in blocks into an owned buffer, or a
+// whole file opened read-only. Values are the bytes [start, end).
+typedef struct {
+    char* data;
+    size_t start;
+    size_t end;
+    size_t capacity;      // Owned buffer size (0 for a file)
+    bool eof;
+    bool mapped;          // data is the read-only file below
+    filemap_t file;
+    char* scratch;        // NUL-terminated copy of a value from the file
+    size_t scratch_cap;
+} input_t;
 
 typedef struct {
-    char input_buffer[4096];
+    char output[OUTPUT_BUFFER_SIZE];
+    size_t output_len;
+    bool line_buffered;
+    io_input_mode_t input_mode;
+    input_t input;
 } stdio_ctx_t;
 
-static void stdio_write(io_t* io, const char* text) {
-    (void)io;
-    printf("%s", text);
+#ifndef _WIN32
+// Writes every byte of iov[0..count), retrying short writes and EINTR
+static void write_all(struct iovec* iov, int count) {
+    while (count > 0) {
+        ssize_t n = writev(STDOUT_FILENO, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;  // Broken pipe or closed stdout: drop the output
+        }
+
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+}
+#endif
+
+// Emits the pending buffer followed by `extra` (may be empty) in one call
+static void flush_with(stdio_ctx_t* ctx, const char* extra, size_t extra_len) {
+#ifdef _WIN32
+    // No writev on Windows: fall back to stdio, which is unbuffered here
+    fwrite(ctx->output, 1, ctx->output_len, stdout);
+    fwrite(extra, 1, extra_len, stdout);
     fflush(stdout);
+#else
+    struct iovec iov[2] = {
+        { .iov_base = ctx->output, .iov_len = ctx->output_len },
+        { .iov_base = (void*)extra, .iov_len = extra_len },
+    };
+    write_all(ctx->output_len > 0 ? iov : iov + 1, ctx->output_len > 0 ? 2 : 1);
+#endif
+    ctx->output_len = 0;
 }
 
-static const char* stdio_read(io_t* io) {
+static void stdio_write_buf(io_t* io, const char* data, size_t len) {
+    stdio_ctx_t* ctx = (stdio_ctx_t*)io->ctx;
+    if (!io_accept_output(io, len)) return;
+
+    if (len > sizeof(ctx->output) - ctx->output_len) {
+        // Too big for what is left: pass it straight through
+        flush_with(ctx, data, len);
+        return;
+    }
+
+    memcpy(ctx->output + ctx->output_len, data, len);
+    ctx->output_len += len;
+
+    if (ctx->line_buffered && memchr(data, '\n', len)) {
+        flush_with(ctx, NULL, 0);
+    }
+}
+
+static void stdio_write(io_t* io, const char* text) {
+    stdio_write_buf(io, text, strlen(text));
+}
+
+// Numbers are formatted straight into the output buffer (they never
+// contain a newline, so line buffering is unaffected)
+static char* number_slot(stdio_ctx_t* ctx) {
+    if (sizeof(ctx->output) - ctx->output_len < FORMAT_NUMBER_MAX) {
+        flush_with(ctx, NULL, 0);
+    }
+    return ctx->output + ctx->output_len;
+}
+
+static void stdio_write_i64(io_t* io, int64_t value) {
+    stdio_ctx_t* ctx = (stdio_ctx_t*)io->ctx;
+    size_t len = format_i64(number_slot(ctx), value);
+    if (io_accept_output(io, len)) ctx->output_len += len;
+}
+
+static void stdio_write_f64(io_t* io, double value) {
+    stdio_ctx_t* ctx = (stdio_ctx_t*)io->ctx;
+    size_t len = format_f64(number_slot(ctx), value);
+    if (io_accept_output(io, len)) ctx->output_len += len;
+}
+
+// === Input ===
+
+static long read_stdin(char* buf, size_t size) {
+#ifdef _WIN32
+    return _read(0, buf, size > 0x40000000 ? 0x40000000 : (unsigned)size);
+#else
+    return (long)read(STDIN_FILENO, buf, size);
+#endif
+}
+
+// Reads the next block from stdin, keeping the unconsumed bytes. Returns
+// false at EOF, or with IO_NO_MEMORY when the buffer cannot grow. One spare
+// byte is always kept for the terminating NUL.
+static bool input_fill(io_t* io) {
     stdio_ctx_t* ctx = (stdio_ctx_t*)io->ctx;
-    
-    if (fgets(ctx->input_buffer, sizeof(ctx->input_buffer), stdin)) {
-        // Remove trailing newline
-        size_t len = strlen(ctx->input_buffer);
-        if (len > 0 && ctx->input_buffer[len-1] == '\n') {
-            ctx->input_buffer[len-1] = '\0';
+    input_t* in = &ctx->input;
+    if (in->eof || in->mapped) return false;
+
+    // Prompts must be visible before blocking on input
+    io_stdio_flush(io);
+
+    if (in->start > 0) {
+        memmove(in->data, in->data + in->start, in->end - in->start);
+        in->end -= in->start;
+        in->start = 0;
+    }
+    if (in->capacity - in->end < INPUT_BLOCK_SIZE / 2) {
+        size_t capacity = in->capacity ? in->capacity * 2 : INPUT_BLOCK_SIZE;
+        char* data = mem_realloc(MEM_IO, in->data, capacity);
+        if (!data) {
+            io->status = IO_NO_MEMORY;
+            return false;
+        }
+        in->data = data;
+        in->capacity = capacity;
+    }
+
+    for (;;) {
+        long n = read_stdin(in->data + in->end, in->capacity - in->end - 1);
+        if (n > 0) {
+            in->end += (size_t)n;
+            return true;
         }
-        return ctx->input_buffer;
+        if (n < 0 && errno == EINTR) continue;
+        in->eof = true;
+        return false;
     }
-    
-    return NULL;  // EOF
+}
+
+// Consumes the value [start, start + len) plus its delimiter and returns it
+// NUL-terminated. Stdin values are terminated in place over the delimiter.
+static const char* input_take(io_t* io, size_t len) {
+    input_t* in = &((stdio_ctx_t*)io->ctx)->input;
+    char* value = in->data + in->start;
+    size_t next = in->start + len;
+    in->start = next < in->end ? next + 1 : next;
+
+    if (!in->mapped) {
+        value[len] = '\0';
+        return value;
+    }
+
+    if (len + 1 > in->scratch_cap) {
+        size_t cap = in->scratch_cap ? in->scratch_cap : 256;
+        while (cap < len + 1) cap *= 2;
+        char* scratch = mem_realloc(MEM_IO, in->scratch, cap);
+        if (!scratch) {
+            io->status = IO_NO_MEMORY;
+            return NULL;
+        }
+        in->scratch = scratch;
+        in->scratch_cap = cap;
+    }
+    memcpy(in->scratch, value, len);
+    in->scratch[len] = '\0';
+    return in->scratch;
+}
+
+// One value per line (the trailing newline is dropped)
+static const char* read_line(io_t* io) {
+    input_t* in = &((stdio_ctx_t*)io->ctx)->input;
+    size_t scanned = 0;
+
+    for (;;) {
+        size_t pending = in->end - in->start;
+        if (pending > scanned) {
+            const char* line = in->data + in->start;
+            const char* nl = memchr(line + scanned, '\n', pending - scanned);
+            if (nl) return input_take(io, (size_t)(nl - line));
+        }
+        scanned = pending;
+
+        if (!input_fill(io)) {
+            if (in->start == in->end || io->status == IO_NO_MEMORY) return NULL;  // EOF
+            return input_take(io, in->end - in->start);
+        }
+    }
+}
+
+// One value per whitespace-separated token
+static const char* read_token(io_t* io) {
+    input_t* in = &((stdio_ctx_t*)io->ctx)->input;
+
+    for (;;) {
+        while (in->start < in->end && io_is_space(in->data[in->start])) in->start++;
+        if (in->start < in->end) break;
+        if (!input_fill(io)) return NULL;  // EOF
+    }
+
+    size_t len = 0;
+    for (;;) {
+        while (in->start + len < in->end && !io_is_space(in->data[in->start + len])) len++;
+        if (in->start + len < in->end || !input_fill(io)) break;
+    }
+    if (io->status == IO_NO_MEMORY) return NULL;
+    return input_take(io, len);
+}
+
+static const char* stdio_read(io_t* io) {
+    stdio_ctx_t* ctx = (stdio_ctx_t*)io->ctx;
+    return ctx->input_mode == IO_INPUT_TOKENS ? read_token(io) : read_line(io);
+}
+
+static void input_release(input_t* in) {
+    if (in->mapped) {
+        filemap_close(&in->file);
+    } else {
+        mem_free(in->data);
+    }
+    mem_free(in->scratch);
+    *in = (input_t){ 0 };
 }
 
 static void stdio_destroy(io_t* io) {
     if (!io) return;
+    io_stdio_flush(io);
+    input_release(&((stdio_ctx_t*)io->ctx)->input);
     free(io->ctx);
     free(io);
 }
@@ -37,23 +272,62 @@ static void stdio_destroy(io_t* io) {
 io_t* io_stdio_create(void) {
     io_t* io = malloc(sizeof(io_t));
     if (!io) return NULL;
-    
+
     stdio_ctx_t* ctx = malloc(sizeof(stdio_ctx_t));
     if (!ctx) {
         free(io);
         return NULL;
     }
-    
-    io->ops.write = stdio_write;
-    io->ops.read = stdio_read;
-    io->ops.destroy = stdio_destroy;
-    io->ctx = ctx;
-    
+    ctx->output_len = 0;
+    ctx->line_buffered = false;
+    ctx->input_mode = IO_INPUT_LINES;
+    ctx->input = (input_t){ 0 };
+
+    io_init(io, &(io_ops_t){
+        .write = stdio_write,
+        .read = stdio_read,
+        .destroy = stdio_destroy,
+        .write_buf = stdio_write_buf,
+        .write_i64 = stdio_write_i64,
+        .write_f64 = stdio_write_f64,
+        .flush = io_stdio_flush,
+    }, ctx);
+
     return io;
 }
 
-void io_destroy(io_t* io) {
-    if (io && io->ops.destroy) {
-        io->ops.destroy(io);
+void io_stdio_set_line_buffered(io_t* io, bool enabled) {
+    if (!io) return;
+    stdio_ctx_t* ctx = (stdio_ctx_t*)io->ctx;
+    ctx->line_buffered = enabled;
+    if (enabled) io_stdio_flush(io);
+}
+
+void io_stdio_set_input_mode(io_t* io, io_input_mode_t mode) {
+    if (!io) return;
+    ((stdio_ctx_t*)io->ctx)->input_mode = mode;
+}
+
+bool io_stdio_open_input(io_t* io, const char* path) {
+    if (!io || !path) return false;
+    input_t* in = &((stdio_ctx_t*)io->ctx)->input;
+
+    filemap_t file;
+    if (!filemap_open(&file, path)) return false;
+
+    input_release(in);
+    in->file = file;
+    in->data = (char*)file.data;  // Only ever read: values are copied out
+    in->end = file.len;
+    in->mapped = true;
+    in->eof = true;
+    return true;
+}
+
+void io_stdio_flush(io_t* io) {
+    if (!io) return;
+    stdio_ctx_t* ctx = (stdio_ctx_t*)io->ctx;
+    if (ctx->output_len > 0) {
+        flush_with(ctx, NULL, 0);
     }
 }
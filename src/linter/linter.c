@@ -1,103 +1,143 @@
 #include "pseudo/linter.h"
-#include "pseudo/hashmap.h"
+#include "pseudo/memory.h"
+#include "pseudo/trace.h"
 #include <string.h>
-#include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
 
-static hashmap_t* replacement_map = NULL;
-
-static hashmap_t* get_replacement_map(void) {
-    if (replacement_map) return replacement_map;
-
-    replacement_map = hashmap_create(33);
-
-    #define ADD_MAPPING(k, v) do { \
-        string_t* key = string_create_from(k); \
-        string_t* val = string_create_from(v); \
-        hashmap_set(replacement_map, key, val); \
-        string_destroy(key); \
-        string_destroy(val); \
-    } while(0)
+typedef struct {
+    const char* from;
+    const char* to;
+} replacement_t;
 
+static const replacement_t k_replacements[] = {
     // Symbols
-    ADD_MAPPING("≤", "<=");
-    ADD_MAPPING("", "<=");
-    ADD_MAPPING("≠", "!=");
-    ADD_MAPPING("", "!=");
-    ADD_MAPPING("≥", ">=");
-    ADD_MAPPING("→", "->");
-    ADD_MAPPING("←", "<-");
-    ADD_MAPPING("", "<-");
-    ADD_MAPPING("", "<-");
-    ADD_MAPPING("", "<->");
-    ADD_MAPPING("■", "sf");
+    { "≤", "<=" },
+    { "", "<=" },
+    { "≠", "!=" },
+    { "", "!=" },
+    { "≥", ">=" },
+    { "→", "->" },
+    { "←", "<-" },
+    { "", "<-" },
+    { "", "<-" },
+    { "", "<->" },
+    { "■", "sf" },
     // might remove these
-    ADD_MAPPING("<-->", "<->");
-    ADD_MAPPING("<--->", "<->");
+    { "<-->", "<->" },
+    { "<--->", "<->" },
 
     // Indentation
-    ADD_MAPPING("│ ", "    ");
-    ADD_MAPPING("│", "    ");
-    ADD_MAPPING("| ", "    ");
-    ADD_MAPPING("|", "    ");
+    { "│ ", "    " },
+    { "│", "    " },
+    { "| ", "    " },
+    { "|", "    " },
 
     // Quotes
-    ADD_MAPPING("’", "'");
-    ADD_MAPPING("‘", "'");
-    ADD_MAPPING("”", "\"");
-    ADD_MAPPING("„", "\"");
+    { "’", "'" },
+    { "‘", "'" },
+    { "”", "\"" },
+    { "„", "\"" },
 
     // Box drawing
-    ADD_MAPPING("┌", "");
-    ADD_MAPPING("└", "");
+    { "┌", "" },
+    { "└", "" },
 
     // Romanian diacritics
-    ADD_MAPPING("ă", "a");
-    ADD_MAPPING("â", "a");
-    ADD_MAPPING("î", "i");
-    ADD_MAPPING("ș", "s");
-    ADD_MAPPING("ş", "s");
-    ADD_MAPPING("ț", "t");
-    ADD_MAPPING("ţ", "t");
-
-    #undef ADD_MAPPING
-
-    return replacement_map;
+    { "ă", "a" },
+    { "â", "a" },
+    { "î", "i" },
+    { "ș", "s" },
+    { "ş", "s" },
+    { "ț", "t" },
+    { "ţ", "t" },
+};
+
+#define REPLACEMENT_COUNT (sizeof(k_replacements) / sizeof(k_replacements[0]))
+
+// Byte trie over the `from` strings, built on first use. Node 0 is the
+// root; a zero transition means no edge (the root is never a child).
+#define TRIE_MAX_NODES 128
+
+static struct {
+    bool built;
+    size_t node_count;
+    uint8_t next[TRIE_MAX_NODES][256];
+    int16_t match[TRIE_MAX_NODES];  // Replacement ending here, or -1
+    size_t to_len[REPLACEMENT_COUNT];
+    bool starts[256];               // First bytes of any `from`
+} g_trie;
+
+static void build_trie(void) {
+    g_trie.node_count = 1;
+    g_trie.match[0] = -1;
+
+    for (size_t r = 0; r < REPLACEMENT_COUNT; r++) {
+        const unsigned char* from = (const unsigned char*)k_replacements[r].from;
+        size_t node = 0;
+
+        g_trie.starts[from[0]] = true;
+        // Plain runs are found by scanning for these bytes (see plain_run)
+        assert(from[0] >= 0x80 || from[0] == '<' || from[0] == '|' || from[0] == 0x01);
+
+        for (; *from; from++) {
+            if (!g_trie.next[node][*from]) {
+                assert(g_trie.node_count < TRIE_MAX_NODES);
+                g_trie.match[g_trie.node_count] = -1;
+                g_trie.next[node][*from] = (uint8_t)g_trie.node_count++;
+            }
+            node = g_trie.next[node][*from];
+        }
+        g_trie.match[node] = (int16_t)r;
+        g_trie.to_len[r] = strlen(k_replacements[r].to);
+    }
+    g_trie.built = true;
 }
 
-typedef struct {
-    const string_t* source;
-    size_t pos;
-    const string_t* match_key;
-    const string_t* match_value;
-    size_t match_len;
-} match_ctx_t;
-
-static void find_match(const string_t* key, const string_t* value, void* user_data) {
-    match_ctx_t* ctx = (match_ctx_t*)user_data;
-
-    const char* source_str = string_cstr(ctx->source);
-    const char* key_str = string_cstr(key);
-    size_t key_len = string_length(key);
-    size_t source_len = string_length(ctx->source);
-
-    if (ctx->pos + key_len > source_len) return;
-
-    if (strncmp(source_str + ctx->pos, key_str, key_len) == 0) {
-        if (key_len > ctx->match_len) {
-            ctx->match_key = key;
-            ctx->match_value = value;
-            ctx->match_len = key_len;
+// Longest replacement whose `from` starts at src[0], or -1
+static int longest_match(const char* src, size_t len, size_t* match_len) {
+    int found = -1;
+    size_t node = 0;
+    for (size_t i = 0; i < len; i++) {
+        node = g_trie.next[node][(unsigned char)src[i]];
+        if (!node) break;
+        if (g_trie.match[node] >= 0) {
+            found = g_trie.match[node];
+            *match_len = i + 1;
         }
     }
+    return found;
+}
+
+// Length of the run at src[0] that cannot start a replacement. Scans a word
+// at a time for bytes >= 0x80, '<', '|' and 0x01, then confirms per byte.
+static size_t plain_run(const char* src, size_t len) {
+    const uint64_t ones = 0x0101010101010101ull;
+    const uint64_t highs = 0x8080808080808080ull;
+    size_t i = 0;
+
+    while (i + 8 <= len) {
+        uint64_t w;
+        memcpy(&w, src + i, 8);
+        uint64_t lt = w ^ (ones * '<');
+        uint64_t bar = w ^ (ones * '|');
+        uint64_t one = w ^ ones;
+        uint64_t candidates = w |
+            ((lt - ones) & ~lt) | ((bar - ones) & ~bar) | ((one - ones) & ~one);
+        if (candidates & highs) break;
+        i += 8;
+    }
+    while (i < len && !g_trie.starts[(unsigned char)src[i]]) i++;
+    return i;
 }
 
 // Structural indentation helpers
 
-static bool word_starts(const char* str, const char* word) {
+static bool word_starts(const char* str, size_t len, const char* word) {
     size_t wlen = strlen(word);
-    return strncmp(str, word, wlen) == 0 &&
-           (str[wlen] == '\0' || str[wlen] == ' ' || str[wlen] == '\t');
+    return len >= wlen && memcmp(str, word, wlen) == 0 &&
+           (len == wlen || str[wlen] == ' ' || str[wlen] == '\t');
 }
 
 static bool word_ends(const char* str, size_t len, const char* word) {
@@ -114,7 +154,7 @@ static bool is_dedent_line(const char* line, size_t len) {
     // "sf" alone closes a block
     if (len == 2 && memcmp(line, "sf", 2) == 0) return true;
     // altfel [daca ... atunci] — else / else-if
-    if (word_starts(line, "altfel")) return true;
+    if (word_starts(line, len, "altfel")) return true;
     // pana cand <condition> — end of repeat-until
     if (len >= 9 && memcmp(line, "pana cand", 9) == 0 &&
         (len == 9 || line[9] == ' ')) return true;
@@ -133,17 +173,16 @@ static bool is_indent_line(const char* line, size_t len) {
     // repeta (standalone — start of repeat-until)
     if (len == 6 && memcmp(line, "repeta", 6) == 0) return true;
     // altfel opens its own block
-    if (word_starts(line, "altfel")) return true;
+    if (word_starts(line, len, "altfel")) return true;
     // "sf <name>" — algorithm header, opens the algorithm body
     if (len > 3 && memcmp(line, "sf ", 3) == 0) return true;
     return false;
 }
 
 // Second pass: strip all leading whitespace and reindent based on block structure
-static string_t* structural_indent(const string_t* source) {
-    const char* src = string_cstr(source);
-    size_t src_len = string_length(source);
-    string_t* result = string_create();
+static string_t* structural_indent(const char* src, size_t src_len) {
+    string_t* result = string_create_with_capacity(src_len + 1);
+    if (!result) return NULL;
 
     int depth = 0;
     size_t pos = 0;
@@ -164,24 +203,19 @@ static string_t* structural_indent(const string_t* source) {
         size_t r = raw_len;
         while (r > l && (raw[r-1] == ' ' || raw[r-1] == '\t' || raw[r-1] == '\r')) r--;
 
+        const char* line = raw + l;
         size_t line_len = r - l;
 
         if (need_newline) string_append_char(result, '\n');
         need_newline = true;
 
         if (line_len > 0) {
-            char* line_cstr = malloc(line_len + 1);
-            memcpy(line_cstr, raw + l, line_len);
-            line_cstr[line_len] = '\0';
-
-            if (is_dedent_line(line_cstr, line_len) && depth > 0) depth--;
+            if (is_dedent_line(line, line_len) && depth > 0) depth--;
 
             for (int i = 0; i < depth; i++) string_append_char(result, '\t');
-            string_append_buf(result, raw + l, line_len);
+            string_append_buf(result, line, line_len);
 
-            if (is_indent_line(line_cstr, line_len)) depth++;
-
-            free(line_cstr);
+            if (is_indent_line(line, line_len)) depth++;
         }
 
         if (pos < src_len) pos++;  // skip '\n'
@@ -189,36 +223,401 @@ static string_t* structural_indent(const string_t* source) {
 
     if (string_length(result) > 0) string_append_char(result, '\n');
 
+    if (string_failed(result)) {
+        string_destroy(result);
+        return NULL;
+    }
     return result;
 }
 
-string_t* lint(const string_t* source) {
-    hashmap_t* map = get_replacement_map();
-    string_t* substituted = string_create();
+// True if structural_indent would reproduce src byte for byte: every line
+// ends in '\n', carries exactly its block depth in tabs and no other
+// leading or trailing whitespace, and the text is not a lone empty line
+static bool is_structurally_indented(const char* src, size_t src_len) {
+    if (src_len == 1) return false;
 
-    size_t length = string_length(source);
+    int depth = 0;
+    size_t pos = 0;
 
-    for (size_t i = 0; i < length; ) {
-        match_ctx_t ctx = {
-            .source = source,
-            .pos = i,
-            .match_key = NULL,
-            .match_value = NULL,
-            .match_len = 0
-        };
+    while (pos < src_len) {
+        size_t line_start = pos;
+        while (pos < src_len && src[pos] != '\n') pos++;
+        if (pos == src_len) return false;
+
+        const char* raw = src + line_start;
+        size_t raw_len = pos - line_start;
 
-        hashmap_foreach(map, find_match, &ctx);
+        size_t tabs = 0;
+        while (tabs < raw_len && raw[tabs] == '\t') tabs++;
 
-        if (ctx.match_value) {
-            string_append_string(substituted, ctx.match_value);
-            i += ctx.match_len;
+        const char* line = raw + tabs;
+        size_t line_len = raw_len - tabs;
+
+        if (line_len == 0) {
+            if (tabs > 0) return false;
         } else {
-            string_append_char(substituted, string_at(source, i));
+            char last = line[line_len - 1];
+            if (line[0] == ' ' || last == ' ' || last == '\t' || last == '\r') return false;
+
+            if (is_dedent_line(line, line_len) && depth > 0) depth--;
+            if (tabs != (size_t)depth) return false;
+            if (is_indent_line(line, line_len)) depth++;
+        }
+
+        pos++;  // skip '\n'
+    }
+
+    return true;
+}
+
+// First pass: replaces symbols. Returns NULL if nothing matched (the text
+// is src itself) or the output could not be allocated (*failed).
+static string_t* substitute(const char* src, size_t length, bool* failed) {
+    if (!g_trie.built) build_trie();
+    *failed = false;
+
+    // Created at the first replacement
+    string_t* substituted = NULL;
+    size_t copied = 0;  // Bytes of src already in substituted
+
+    for (size_t i = 0; i < length; ) {
+        i += plain_run(src + i, length - i);
+        if (i == length) break;
+
+        size_t match_len = 0;
+        int r = longest_match(src + i, length - i, &match_len);
+        if (r < 0) {
             i++;
+            continue;
         }
+
+        if (!substituted) {
+            substituted = string_create_with_capacity(length + 1);
+            if (!substituted) {
+                *failed = true;
+                return NULL;
+            }
+        }
+        string_append_buf(substituted, src + copied, i - copied);
+        string_append_buf(substituted, k_replacements[r].to, g_trie.to_len[r]);
+        i += match_len;
+        copied = i;
+    }
+
+    if (!substituted) return NULL;
+    string_append_buf(substituted, src + copied, length - copied);
+    if (string_failed(substituted)) {
+        string_destroy(substituted);
+        *failed = true;
+        return NULL;
     }
+    return substituted;
+}
 
-    string_t* result = structural_indent(substituted);
+static string_t* lint_text(const char* src, size_t length, bool* unchanged) {
+    *unchanged = false;
+
+    bool failed;
+    string_t* substituted = substitute(src, length, &failed);
+    if (failed) return NULL;
+
+    if (!substituted) {
+        if (is_structurally_indented(src, length)) {
+            *unchanged = true;
+            return NULL;
+        }
+        return structural_indent(src, length);
+    }
+
+    string_t* result = structural_indent(string_cstr(substituted), string_length(substituted));
     string_destroy(substituted);
     return result;
-}
\ No newline at end of file
+}
+
+string_t* lint_buf(const char* src, size_t length, bool* unchanged) {
+    TRACE_BEGIN_COUNT("lint", "bytes", length);
+    string_t* result = lint_text(src, length, unchanged);
+    TRACE_END("lint");
+    return result;
+}
+
+string_t* lint_substitute(const char* src, size_t length) {
+    bool failed;
+    string_t* substituted = substitute(src, length, &failed);
+    if (substituted || failed) return substituted;
+    return string_create_from_buf(src, length);
+}
+
+void lint_origin_init(lint_origin_t* origin, const char* source, size_t len) {
+    if (!g_trie.built) build_trie();
+    *origin = (lint_origin_t){ .source = source, .len = len };
+}
+
+// Walks the source the way substitute does, a plain run or a replacement
+// at a time, until the output reaches `offset`
+size_t lint_origin_map(lint_origin_t* origin, size_t offset) {
+    assert(offset >= origin->out);
+    while (origin->in < origin->len) {
+        const char* src = origin->source + origin->in;
+        size_t left = origin->len - origin->in;
+        size_t match_len = 0;
+        int r = longest_match(src, left, &match_len);
+
+        if (r < 0) {
+            size_t run = plain_run(src, left);
+            if (run == 0) run = 1;  // Starts like a symbol but is none
+            if (origin->out + run > offset) break;
+            origin->in += run;
+            origin->out += run;
+        } else {
+            if (origin->out + g_trie.to_len[r] > offset) return origin->in;
+            origin->in += match_len;
+            origin->out += g_trie.to_len[r];
+        }
+    }
+    return origin->in + (offset - origin->out);
+}
+
+string_t* lint(const string_t* source) {
+    const char* src = string_cstr(source);
+    size_t length = string_length(source);
+
+    bool unchanged;
+    string_t* result = lint_buf(src, length, &unchanged);
+    return unchanged ? string_create_from_buf(src, length) : result;
+}
+
+// === Lint session ===
+
+typedef struct {
+    char* text;            // Substituted, without surrounding whitespace
+    uint32_t len;
+    int32_t depth;         // Block depth entering the line
+    int32_t typed_indent;  // Tabs of the typed line if the rest is already linted, else -1
+    bool dedent;
+    bool indent;
+    bool typed_empty;      // Nothing at all was typed on the line
+} lint_line_t;
+
+struct lint_session {
+    lint_line_t* lines;
+    uint32_t count;
+    uint32_t capacity;
+};
+
+// Tabs the line is printed with
+static int32_t line_print_depth(const lint_line_t* line) {
+    if (line->len == 0) return 0;
+    return line->dedent && line->depth > 0 ? line->depth - 1 : line->depth;
+}
+
+static int32_t line_depth_after(const lint_line_t* line) {
+    if (line->len == 0) return line->depth;
+    return line_print_depth(line) + (line->indent ? 1 : 0);
+}
+
+static bool line_init(lint_line_t* line, const char* raw, size_t raw_len) {
+    bool failed;
+    string_t* substituted = substitute(raw, raw_len, &failed);
+    if (failed) return false;
+
+    const char* src = substituted ? string_cstr(substituted) : raw;
+    size_t src_len = substituted ? string_length(substituted) : raw_len;
+
+    size_t l = 0;
+    while (l < src_len && (src[l] == ' ' || src[l] == '\t')) l++;
+    size_t r = src_len;
+    while (r > l && (src[r-1] == ' ' || src[r-1] == '\t' || src[r-1] == '\r')) r--;
+
+    *line = (lint_line_t){ .len = (uint32_t)(r - l), .typed_empty = raw_len == 0 };
+    line->text = mem_alloc(MEM_STRINGS, line->len + 1);
+    if (!line->text) {
+        string_destroy(substituted);
+        return false;
+    }
+    memcpy(line->text, src + l, line->len);
+    line->text[line->len] = '\0';
+
+    line->dedent = line->len > 0 && is_dedent_line(line->text, line->len);
+    line->indent = line->len > 0 && is_indent_line(line->text, line->len);
+
+    // Linted as typed: no substitution, only leading tabs, nothing trailing
+    line->typed_indent = -1;
+    if (!substituted && r == src_len) {
+        size_t tabs = 0;
+        while (tabs < l && src[tabs] == '\t') tabs++;
+        if (tabs == l && (line->len > 0 || tabs == 0)) line->typed_indent = (int32_t)tabs;
+    }
+
+    string_destroy(substituted);
+    return true;
+}
+
+static void free_lines(lint_line_t* lines, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) mem_free(lines[i].text);
+}
+
+// Splits `text` into lines; *count is at least 1
+static lint_line_t* split_lines(const char* text, size_t len, uint32_t* count) {
+    uint32_t lines = 1;
+    for (const char* p = text; (p = memchr(p, '\n', (size_t)(text + len - p))); p++) lines++;
+
+    lint_line_t* result = mem_alloc(MEM_OTHER, lines * sizeof(lint_line_t));
+    if (!result) return NULL;
+
+    size_t pos = 0;
+    for (uint32_t i = 0; i < lines; i++) {
+        const char* nl = memchr(text + pos, '\n', len - pos);
+        size_t end = nl ? (size_t)(nl - text) : len;
+        if (!line_init(&result[i], text + pos, end - pos)) {
+            free_lines(result, i);
+            mem_free(result);
+            return NULL;
+        }
+        pos = end + 1;
+    }
+
+    *count = lines;
+    return result;
+}
+
+// Recomputes entering depths from `start` on. Lines before `settled` are
+// new; past them a line whose cached depth matches again ends the walk.
+// Returns the first line not visited.
+static uint32_t propagate_depth(lint_session_t* session, uint32_t start, uint32_t settled) {
+    lint_line_t* lines = session->lines;
+    int32_t depth = start > 0 ? line_depth_after(&lines[start - 1]) : 0;
+
+    uint32_t i = start;
+    for (; i < session->count; i++) {
+        if (i >= settled && lines[i].depth == depth) break;
+        lines[i].depth = depth;
+        depth = line_depth_after(&lines[i]);
+    }
+    return i;
+}
+
+lint_session_t* lint_session_create(void) {
+    lint_session_t* session = mem_calloc(MEM_OTHER, 1, sizeof(lint_session_t));
+    if (!session) return NULL;
+
+    if (!lint_session_set_text(session, "", 0)) {
+        lint_session_destroy(session);
+        return NULL;
+    }
+    return session;
+}
+
+void lint_session_destroy(lint_session_t* session) {
+    if (!session) return;
+    free_lines(session->lines, session->count);
+    mem_free(session->lines);
+    mem_free(session);
+}
+
+bool lint_session_set_text(lint_session_t* session, const char* text, size_t len) {
+    assert(session);
+    assert(text || len == 0);
+
+    uint32_t count;
+    lint_line_t* lines = split_lines(text ? text : "", len, &count);
+    if (!lines) return false;
+
+    free_lines(session->lines, session->count);
+    mem_free(session->lines);
+    session->lines = lines;
+    session->count = count;
+    session->capacity = count;
+    propagate_depth(session, 0, count);
+    return true;
+}
+
+bool lint_session_replace_lines(lint_session_t* session, uint32_t start_line,
+                                uint32_t old_end_line, const char* text, size_t len,
+                                lint_change_t* change) {
+    assert(session);
+    assert(text || len == 0);
+    if (start_line >= old_end_line || old_end_line > session->count) return false;
+
+    uint32_t new_count;
+    lint_line_t* replacement = split_lines(text ? text : "", len, &new_count);
+    if (!replacement) return false;
+
+    uint32_t old_count = old_end_line - start_line;
+    uint32_t count = session->count - old_count + new_count;
+    if (count > session->capacity) {
+        uint32_t capacity = session->capacity * 2 > count ? session->capacity * 2 : count;
+        lint_line_t* lines = mem_realloc(MEM_OTHER, session->lines, capacity * sizeof(lint_line_t));
+        if (!lines) {
+            free_lines(replacement, new_count);
+            mem_free(replacement);
+            return false;
+        }
+        session->lines = lines;
+        session->capacity = capacity;
+    }
+
+    lint_line_t* lines = session->lines;
+    free_lines(lines + start_line, old_count);
+    memmove(lines + start_line + new_count, lines + old_end_line,
+            (session->count - old_end_line) * sizeof(lint_line_t));
+    memcpy(lines + start_line, replacement, new_count * sizeof(lint_line_t));
+    mem_free(replacement);
+    session->count = count;
+
+    uint32_t new_end = propagate_depth(session, start_line, start_line + new_count);
+    if (change) {
+        *change = (lint_change_t){
+            .first = start_line,
+            .old_end = new_end - new_count + old_count,
+            .new_end = new_end,
+        };
+    }
+    return true;
+}
+
+uint32_t lint_session_line_count(const lint_session_t* session) {
+    assert(session);
+    return session->count;
+}
+
+void lint_session_render_line(const lint_session_t* session, uint32_t line, string_t* out) {
+    assert(session && line < session->count);
+    const lint_line_t* l = &session->lines[line];
+    for (int32_t i = line_print_depth(l); i > 0; i--) string_append_char(out, '\t');
+    string_append_buf(out, l->text, l->len);
+}
+
+bool lint_session_line_linted(const lint_session_t* session, uint32_t line) {
+    assert(session && line < session->count);
+    const lint_line_t* l = &session->lines[line];
+    return l->typed_indent == line_print_depth(l);
+}
+
+bool lint_session_ends_linted(const lint_session_t* session) {
+    assert(session);
+    const lint_line_t* last = &session->lines[session->count - 1];
+    return last->typed_empty || (session->count == 1 && last->len == 0);
+}
+
+string_t* lint_session_text(const lint_session_t* session) {
+    assert(session);
+
+    // As in structural_indent, a final '\n' ends the last line rather
+    // than starting an empty one
+    uint32_t count = session->count;
+    if (session->lines[count - 1].typed_empty) count--;
+
+    string_t* result = string_create();
+    if (!result) return NULL;
+    for (uint32_t i = 0; i < count; i++) {
+        if (i > 0) string_append_char(result, '\n');
+        lint_session_render_line(session, i, result);
+    }
+    if (string_length(result) > 0) string_append_char(result, '\n');
+    if (string_failed(result)) {
+        string_destroy(result);
+        return NULL;
+    }
+    return result;
+}
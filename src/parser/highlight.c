@@ -0,0 +1,233 @@
+#include "pseudo/highlight.h"
+#include "pseudo/memory.h"
+#include <tree_sitter/tree-sitter-pseudo.h>
+#include <string.h>
+#include <assert.h>
+
+// Copy of tree-sitter-pseudo/queries/highlights.scm (test_highlight
+// checks that the two match)
+static const char k_query[] =
+    "; Keywords\n"
+    "[\n"
+    "  \"citeste\"\n"
+    "  \"scrie\"\n"
+    "  \"daca\"\n"
+    "  \"atunci\"\n"
+    "  \"altfel\"\n"
+    "  \"sf\"\n"
+    "  \"pentru\"\n"
+    "  \"executa\"\n"
+    "  \"cat\"\n"
+    "  \"timp\"\n"
+    "  \"repeta\"\n"
+    "  \"pana\"\n"
+    "  \"cand\"\n"
+    "] @keyword\n"
+    "\n"
+    "; Logical operators\n"
+    "[\n"
+    "  \"SAU\"\n"
+    "  \"sau\"\n"
+    "  \"SI\"\n"
+    "  \"si\"\n"
+    "  \"NOT\"\n"
+    "  \"not\"\n"
+    "] @keyword.operator\n"
+    "\n"
+    "; Operators\n"
+    "[\n"
+    "  \"<-\"\n"
+    "  \"<->\"\n"
+    "  \"<-->\"\n"
+    "  \"+\"\n"
+    "  \"-\"\n"
+    "  \"*\"\n"
+    "  \"/\"\n"
+    "  \"%\"\n"
+    "  \"=\"\n"
+    "  \"!=\"\n"
+    "  \"<\"\n"
+    "  \"<=\"\n"
+    "  \">\"\n"
+    "  \">=\"\n"
+    "  \"√\"\n"
+    "] @operator\n"
+    "\n"
+    "; Punctuation\n"
+    "[\n"
+    "  \"(\"\n"
+    "  \")\"\n"
+    "  \"[\"\n"
+    "  \"]\"\n"
+    "] @punctuation.bracket\n"
+    "\n"
+    "[\n"
+    "  \",\"\n"
+    "  \";\"\n"
+    "] @punctuation.delimiter\n"
+    "\n"
+    "; Literals\n"
+    "(number) @number\n"
+    "(string) @string\n"
+    "\n"
+    "; Identifiers\n"
+    "(identifier) @variable\n"
+    "\n"
+    "; Assignment target\n"
+    "(assign\n"
+    "  name: (identifier) @variable.parameter)\n"
+    "\n"
+    "; Swap targets\n"
+    "(swap\n"
+    "  left: (identifier) @variable.parameter\n"
+    "  right: (identifier) @variable.parameter)\n"
+    "\n"
+    "; For loop variable\n"
+    "(for\n"
+    "  var: (identifier) @variable.parameter)\n"
+    "\n"
+    "; Read targets\n"
+    "(read\n"
+    "  names: (name_list\n"
+    "    (identifier) @variable.parameter))\n"
+    "\n"
+    "; Comments\n"
+    "(comment) @comment\n";
+
+static const char* const k_type_names[HL_TYPE_COUNT] = {
+    [HL_KEYWORD] = "keyword",
+    [HL_KEYWORD_OPERATOR] = "keyword.operator",
+    [HL_OPERATOR] = "operator",
+    [HL_PUNCTUATION_BRACKET] = "punctuation.bracket",
+    [HL_PUNCTUATION_DELIMITER] = "punctuation.delimiter",
+    [HL_NUMBER] = "number",
+    [HL_STRING] = "string",
+    [HL_VARIABLE] = "variable",
+    [HL_VARIABLE_PARAMETER] = "variable.parameter",
+    [HL_COMMENT] = "comment",
+};
+
+struct highlighter {
+    TSQuery* query;
+    TSQueryCursor* cursor;
+    highlight_type_t* capture_types;  // By capture index; HL_TYPE_COUNT if unknown
+};
+
+const char* highlight_query_source(void) {
+    return k_query;
+}
+
+const char* highlight_type_name(highlight_type_t type) {
+    return type < HL_TYPE_COUNT ? k_type_names[type] : NULL;
+}
+
+highlighter_t* highlighter_create(void) {
+    highlighter_t* highlighter = mem_calloc(MEM_PARSER, 1, sizeof(highlighter_t));
+    if (!highlighter) return NULL;
+
+    uint32_t error_offset;
+    TSQueryError error;
+    highlighter->query = ts_query_new(tree_sitter_pseudo(), k_query, sizeof(k_query) - 1,
+                                      &error_offset, &error);
+    highlighter->cursor = ts_query_cursor_new();
+    if (!highlighter->query || !highlighter->cursor) {
+        highlighter_destroy(highlighter);
+        return NULL;
+    }
+
+    uint32_t capture_count = ts_query_capture_count(highlighter->query);
+    highlighter->capture_types = mem_alloc(MEM_PARSER, (capture_count + 1) * sizeof(highlight_type_t));
+    if (!highlighter->capture_types) {
+        highlighter_destroy(highlighter);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < capture_count; i++) {
+        uint32_t len;
+        const char* name = ts_query_capture_name_for_id(highlighter->query, i, &len);
+        highlighter->capture_types[i] = HL_TYPE_COUNT;
+        for (int type = 0; type < HL_TYPE_COUNT; type++) {
+            if (strlen(k_type_names[type]) == len && memcmp(k_type_names[type], name, len) == 0) {
+                highlighter->capture_types[i] = (highlight_type_t)type;
+                break;
+            }
+        }
+    }
+
+    return highlighter;
+}
+
+void highlighter_destroy(highlighter_t* highlighter) {
+    if (!highlighter) return;
+    if (highlighter->query) ts_query_delete(highlighter->query);
+    if (highlighter->cursor) ts_query_cursor_delete(highlighter->cursor);
+    mem_free(highlighter->capture_types);
+    mem_free(highlighter);
+}
+
+static bool push_token(highlight_tokens_t* tokens, uint32_t start, uint32_t len, highlight_type_t type) {
+    if (tokens->count == tokens->capacity) {
+        size_t capacity = tokens->capacity ? tokens->capacity * 2 : 64;
+        uint32_t* data = mem_realloc(MEM_PARSER, tokens->data, capacity * 3 * sizeof(uint32_t));
+        if (!data) return false;
+        tokens->data = data;
+        tokens->capacity = capacity;
+    }
+    uint32_t* token = tokens->data + tokens->count * 3;
+    token[0] = start;
+    token[1] = len;
+    token[2] = type;
+    tokens->count++;
+    return true;
+}
+
+bool highlight_range(highlighter_t* highlighter, TSNode root,
+                     uint32_t start_byte, uint32_t end_byte, highlight_tokens_t* tokens) {
+    assert(highlighter && tokens);
+    tokens->count = 0;
+
+    TSQueryCursor* cursor = highlighter->cursor;
+    ts_query_cursor_set_byte_range(cursor, start_byte, end_byte);
+    ts_query_cursor_exec(cursor, highlighter->query, root);
+
+    // Captures come in start order. A node captured by several patterns
+    // takes the last one, as the query lists the specific ones after the
+    // general ones (an assigned identifier is @variable.parameter).
+    uint32_t last_end = 0;
+    uint32_t last_pattern = 0;
+    TSQueryMatch match;
+    uint32_t capture_index;
+    while (ts_query_cursor_next_capture(cursor, &match, &capture_index)) {
+        TSQueryCapture capture = match.captures[capture_index];
+        highlight_type_t type = highlighter->capture_types[capture.index];
+        uint32_t start = ts_node_start_byte(capture.node);
+        uint32_t end = ts_node_end_byte(capture.node);
+        if (type == HL_TYPE_COUNT || end == start) continue;
+
+        if (tokens->count > 0) {
+            uint32_t* last = tokens->data + (tokens->count - 1) * 3;
+            if (last[0] == start && last[1] == end - start) {
+                if (match.pattern_index >= last_pattern) {
+                    last[2] = type;
+                    last_pattern = match.pattern_index;
+                }
+                continue;
+            }
+            if (start < last_end) continue;  // Inside a token already emitted
+        }
+
+        if (!push_token(tokens, start, end - start, type)) return false;
+        last_end = end;
+        last_pattern = match.pattern_index;
+    }
+    return true;
+}
+
+bool highlight_all(highlighter_t* highlighter, TSNode root, highlight_tokens_t* tokens) {
+    return highlight_range(highlighter, root, 0, UINT32_MAX, tokens);
+}
+
+void highlight_tokens_free(highlight_tokens_t* tokens) {
+    if (!tokens) return;
+    mem_free(tokens->data);
+    *tokens = (highlight_tokens_t){0};
+}
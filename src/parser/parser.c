@@ -1,44 +1,77 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "pseudo/parser.h"
 #include "pseudo/parser_errors.h"
+#include "pseudo/tree_walk.h"
 #include "pseudo/string.h"
+#include "pseudo/memory.h"
+#include "pseudo/linter.h"
+#include "pseudo/trace.h"
 #include <tree_sitter/api.h>
 #include <tree_sitter/tree-sitter-pseudo.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
+#include <time.h>
 
 struct parser {
     TSParser* ts_parser;
     TSTree* tree;
-    string_t* source;
+    strview_t source;   // Text of the last parse
+    string_t* owned;    // Buffer behind source when the parser owns it
+
+    // Incremental reparsing: an edited tree seeds the next parse, which
+    // then records where the syntax changed
+    bool edited;
+    TSTree* old_tree;
+    TSRange* changed;
+    uint32_t changed_count;
+
+    // Time-sliced parsing: a parse past its deadline is cut off and
+    // tree-sitter keeps its state for parser_resume
+    uint64_t timeout_micros;
+    uint64_t deadline;
+    bool timed_out;
+    bool pending;
 };
 
 parser_t* parser_create(void) {
-    parser_t* parser = malloc(sizeof(parser_t));
+    mem_install_tree_sitter();
+
+    parser_t* parser = mem_alloc(MEM_PARSER, sizeof(parser_t));
     if (!parser) return NULL;
 
     parser->ts_parser = ts_parser_new();
     if (!parser->ts_parser) {
-        free(parser);
+        mem_free(parser);
         return NULL;
     }
 
     const TSLanguage* lang = tree_sitter_pseudo();
     if (!lang) {
         ts_parser_delete(parser->ts_parser);
-        free(parser);
+        mem_free(parser);
         return NULL;
     }
 
     if (!ts_parser_set_language(parser->ts_parser, lang)) {
         ts_parser_delete(parser->ts_parser);
-        free(parser);
+        mem_free(parser);
         return NULL;
     }
 
     parser->tree = NULL;
-    parser->source = NULL;
+    parser->source = (strview_t){ .data = NULL, .len = 0 };
+    parser->owned = NULL;
+    parser->edited = false;
+    parser->old_tree = NULL;
+    parser->changed = NULL;
+    parser->changed_count = 0;
+    parser->timeout_micros = 0;
+    parser->deadline = 0;
+    parser->timed_out = false;
+    parser->pending = false;
 
     return parser;
 }
@@ -49,17 +82,52 @@ void parser_destroy(parser_t* parser) {
     if (parser->tree) {
         ts_tree_delete(parser->tree);
     }
-    if (parser->source) {
-        string_destroy(parser->source);
+    if (parser->old_tree) {
+        ts_tree_delete(parser->old_tree);
     }
+    if (parser->owned) {
+        string_destroy(parser->owned);
+    }
+    mem_free(parser->changed);
     ts_parser_delete(parser->ts_parser);
-    free(parser);
+    mem_free(parser);
 }
 
-parser_error_t parser_parse(parser_t* parser, const string_t* source) {
-    assert(parser);
-    assert(source);
+// Monotonic, so a wall clock change cannot cut a parse short or stretch it
+static uint64_t now_micros(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
 
+// Progress callback: true stops the parse
+static bool deadline_passed(TSParseState* state) {
+    parser_t* parser = state->payload;
+    if (now_micros() < parser->deadline) return false;
+    parser->timed_out = true;
+    return true;
+}
+
+static const char* read_source(void* payload, uint32_t byte, TSPoint point, uint32_t* bytes_read) {
+    (void)point;
+    const strview_t* source = payload;
+    if (byte >= source->len) {
+        *bytes_read = 0;
+        return "";
+    }
+    *bytes_read = (uint32_t)(source->len - byte);
+    return source->data + byte;
+}
+
+static parser_error_t tree_memory_error(void) {
+    return (parser_error_t){
+        .type = PARSER_ERR_MEMORY,
+        .message = string_create_from("Nu s-a putut aloca memorie pentru arborele sintactic"),
+    };
+}
+
+// Reports the first syntax error of the finished tree
+static parser_error_t check_tree(parser_t* parser) {
     parser_error_t result = {
         .type = PARSER_OK,
         .line = 0,
@@ -67,47 +135,204 @@ parser_error_t parser_parse(parser_t* parser, const string_t* source) {
         .message = NULL
     };
 
-    // Free previous parse
+    TSNode root = ts_tree_root_node(parser->tree);
+    if (!ts_node_has_error(root)) return result;
+
+    error_info_t info = { .found = false };
+    TRACE_BEGIN("find_first_error");
+    find_first_error(root, parser->source.data, &info);
+    TRACE_END("find_first_error");
+
+    if (info.found) {
+        result.type = PARSER_ERR_SYNTAX;
+        result.line = info.point.row;
+        result.column = info.point.column;
+        TRACE_BEGIN("build_error_message");
+        result.message = build_error_message(parser->source, &info);
+        TRACE_END("build_error_message");
+    }
+
+    return result;
+}
+
+// Runs (or resumes) the parse of parser->source, reusing the edited
+// previous tree if there is one
+static parser_error_t run_parse(parser_t* parser) {
+    TSParseOptions options = { .payload = parser, .progress_callback = NULL };
+    if (parser->timeout_micros > 0) {
+        parser->deadline = now_micros() + parser->timeout_micros;
+        options.progress_callback = deadline_passed;
+    }
+    parser->timed_out = false;
+
+    TSInput input = {
+        .payload = &parser->source,
+        .read = read_source,
+        .encoding = TSInputEncodingUTF8,
+        .decode = NULL,
+    };
+    TRACE_BEGIN_COUNT("parser_parse", "bytes", parser->source.len);
+    parser->tree = ts_parser_parse_with_options(parser->ts_parser, parser->old_tree, input, options);
+    TRACE_END_COUNT("parser_parse", "nodes",
+                    parser->tree ? ts_node_descendant_count(ts_tree_root_node(parser->tree)) : 0);
+
+    // Cut off: the old tree must outlive the parse it seeds
+    parser->pending = !parser->tree && parser->timed_out;
+    if (parser->pending) {
+        return (parser_error_t){
+            .type = PARSER_ERR_TIMEOUT,
+            .message = string_create_from("Analiza sintactica a depasit timpul alocat"),
+        };
+    }
+
+    if (parser->old_tree) {
+        if (parser->tree) {
+            parser->changed = ts_tree_get_changed_ranges(parser->old_tree, parser->tree,
+                                                         &parser->changed_count);
+        }
+        ts_tree_delete(parser->old_tree);
+        parser->old_tree = NULL;
+    }
+
+    if (!parser->tree) return tree_memory_error();
+    return check_tree(parser);
+}
+
+// Parses parser->source, which the caller has just set
+static parser_error_t parse_current(parser_t* parser) {
+    if (!parser->source.data) parser->source.data = "";
+    return run_parse(parser);
+}
+
+// Frees the previous parse; an edited tree is kept for parse_current
+static void parser_reset(parser_t* parser) {
+    if (parser->pending) {
+        ts_parser_reset(parser->ts_parser);
+        parser->pending = false;
+        // The abandoned parse's seed only fits the next text if edited to it
+        if (!parser->edited) {
+            ts_tree_delete(parser->old_tree);
+            parser->old_tree = NULL;
+        }
+    }
     if (parser->tree) {
-        ts_tree_delete(parser->tree);
+        if (parser->edited) {
+            parser->old_tree = parser->tree;
+        } else {
+            ts_tree_delete(parser->tree);
+        }
         parser->tree = NULL;
     }
-    if (parser->source) {
-        string_destroy(parser->source);
+    parser->edited = false;
+    mem_free(parser->changed);
+    parser->changed = NULL;
+    parser->changed_count = 0;
+    if (parser->owned) {
+        string_destroy(parser->owned);
+        parser->owned = NULL;
     }
+    parser->source = (strview_t){ .data = NULL, .len = 0 };
+}
 
-    // Copy source
-    parser->source = string_create_from_string(source);
-    if (!parser->source) {
-        result.type = PARSER_ERR_MEMORY;
-        result.message = string_create_from("Nu s-a putut aloca memorie pentru sursa");
-        return result;
+// Drops the previous parse when there is no source to parse
+static parser_error_t source_memory_error(parser_t* parser) {
+    parser_reset(parser);
+    if (parser->old_tree) {
+        ts_tree_delete(parser->old_tree);
+        parser->old_tree = NULL;
     }
+    return (parser_error_t){
+        .type = PARSER_ERR_MEMORY,
+        .message = string_create_from("Nu s-a putut aloca memorie pentru sursa"),
+    };
+}
+
+parser_error_t parser_parse_owned(parser_t* parser, string_t* source) {
+    assert(parser);
+    assert(source);
 
-    // Parse
-    const char* src = string_cstr(parser->source);
-    size_t len = string_length(parser->source);
-    parser->tree = ts_parser_parse_string(parser->ts_parser, NULL, src, len);
+    parser_reset(parser);
+    parser->owned = source;
+    parser->source = string_view(source);
+    return parse_current(parser);
+}
 
-    if (!parser->tree) {
-        result.type = PARSER_ERR_MEMORY;
-        result.message = string_create_from("Nu s-a putut aloca memorie pentru arborele sintactic");
-        return result;
+parser_error_t parser_parse_borrowed(parser_t* parser, const char* source, size_t len) {
+    assert(parser);
+    assert(source || len == 0);
+
+    parser_reset(parser);
+    parser->source = (strview_t){ .data = source, .len = len };
+    return parse_current(parser);
+}
+
+parser_error_t parser_parse(parser_t* parser, const string_t* source) {
+    assert(parser);
+    assert(source);
+
+    string_t* copy = string_create_from_string(source);
+    if (!copy) {
+        return source_memory_error(parser);
     }
+    return parser_parse_owned(parser, copy);
+}
 
-    // Check for syntax errors
-    TSNode root = ts_tree_root_node(parser->tree);
-    error_info_t info = { .found = false };
-    find_first_error(root, string_cstr(parser->source), &info);
+parser_error_t parser_parse_source(parser_t* parser, const char* source, size_t len, bool borrow) {
+    assert(parser);
+    assert(source || len == 0);
 
-    if (info.found) {
-        result.type = PARSER_ERR_SYNTAX;
-        result.line = info.point.row;
-        result.column = info.point.column;
-        result.message = build_error_message(parser->source, &info);
+    bool unchanged;
+    string_t* linted = lint_buf(source, len, &unchanged);
+    if (linted) return parser_parse_owned(parser, linted);
+
+    if (unchanged) {
+        if (borrow) return parser_parse_borrowed(parser, source, len);
+
+        string_t* copy = string_create_from_buf(source, len);
+        if (copy) return parser_parse_owned(parser, copy);
     }
 
-    return result;
+    return source_memory_error(parser);
+}
+
+void parser_set_timeout(parser_t* parser, uint64_t micros) {
+    assert(parser);
+    parser->timeout_micros = micros;
+}
+
+parser_error_t parser_resume(parser_t* parser) {
+    assert(parser);
+    if (parser->pending) return run_parse(parser);
+    if (!parser->tree) return tree_memory_error();
+    return check_tree(parser);
+}
+
+bool parser_pending(parser_t* parser) {
+    assert(parser);
+    return parser->pending;
+}
+
+void parser_edit(parser_t* parser, const TSInputEdit* edit) {
+    assert(parser);
+    assert(edit);
+
+    // While a parse is cut off, its seed tree takes the edit instead; the
+    // next parse starts over from it
+    if (parser->pending && parser->old_tree) {
+        ts_tree_edit(parser->old_tree, edit);
+        parser->edited = true;
+        return;
+    }
+    if (!parser->tree) return;
+
+    ts_tree_edit(parser->tree, edit);
+    parser->edited = true;
+}
+
+const TSRange* parser_changed_ranges(parser_t* parser, uint32_t* count) {
+    assert(parser);
+    *count = parser->changed_count;
+    return parser->changed;
 }
 
 void parser_error_free(parser_error_t* error) {
@@ -123,7 +348,7 @@ TSNode parser_root(parser_t* parser) {
     return ts_tree_root_node(parser->tree);
 }
 
-const string_t* parser_source(parser_t* parser) {
+strview_t parser_source(parser_t* parser) {
     assert(parser);
     return parser->source;
 }
@@ -133,22 +358,35 @@ bool parser_has_error(parser_t* parser) {
     if (!parser->tree) return true;
 
     TSNode root = ts_tree_root_node(parser->tree);
+    if (!ts_node_has_error(root)) return false;
+
     error_info_t info = { .found = false };
-    find_first_error(root, string_cstr(parser->source), &info);
+    find_first_error(root, parser->source.data, &info);
     return info.found;
 }
 
 string_t* parser_node_text(parser_t* parser, TSNode node) {
     assert(parser);
-    assert(parser->source);
+    assert(parser->tree);
 
     uint32_t start = ts_node_start_byte(node);
     uint32_t end = ts_node_end_byte(node);
-    const char* src = string_cstr(parser->source);
+    const char* src = parser->source.data;
 
     return string_create_from_buf(src + start, end - start);
 }
 
+strview_t parser_node_view(parser_t* parser, TSNode node) {
+    assert(parser);
+    assert(parser->tree);
+
+    uint32_t start = ts_node_start_byte(node);
+    uint32_t end = ts_node_end_byte(node);
+    const char* src = parser->source.data;
+
+    return (strview_t){ .data = src + start, .len = end - start };
+}
+
 // Pretty print helper
 static void print_tree_recursive(TSNode node, const char* source, int indent, string_t* out) {
     // Indentation
@@ -185,10 +423,11 @@ static void print_tree_recursive(TSNode node, const char* source, int indent, st
             string_append(out, ")\n");
         } else {
             string_append(out, "\n");
-            for (uint32_t i = 0; i < child_count; i++) {
-                TSNode child = ts_node_child(node, i);
+            child_iter_t it = child_iter_start(node);
+            for (TSNode child; child_iter_next(&it, &child); ) {
                 print_tree_recursive(child, source, indent + 1, out);
             }
+            child_iter_end(&it);
             for (int i = 0; i < indent; i++) {
                 string_append(out, "  ");
             }
@@ -196,22 +435,21 @@ static void print_tree_recursive(TSNode node, const char* source, int indent, st
         }
     } else {
         // Anonymous nodes (keywords, operators) - just recurse into children
-        uint32_t child_count = ts_node_child_count(node);
-        for (uint32_t i = 0; i < child_count; i++) {
-            TSNode child = ts_node_child(node, i);
+        child_iter_t it = child_iter_start(node);
+        for (TSNode child; child_iter_next(&it, &child); ) {
             print_tree_recursive(child, source, indent, out);
         }
+        child_iter_end(&it);
     }
 }
 
 string_t* parser_pretty_tree(parser_t* parser) {
     assert(parser);
     assert(parser->tree);
-    assert(parser->source);
 
     string_t* out = string_create();
     TSNode root = ts_tree_root_node(parser->tree);
-    print_tree_recursive(root, string_cstr(parser->source), 0, out);
+    print_tree_recursive(root, parser->source.data, 0, out);
     return out;
 }
 
@@ -254,20 +492,20 @@ static void print_debug_tree_recursive(TSNode node, const char* source, int inde
     }
     string_append(out, "\n");
 
-    for (uint32_t i = 0; i < child_count; i++) {
-        TSNode child = ts_node_child(node, i);
+    child_iter_t it = child_iter_start(node);
+    for (TSNode child; child_iter_next(&it, &child); ) {
         print_debug_tree_recursive(child, source, indent + 1, out);
     }
+    child_iter_end(&it);
 }
 
 string_t* parser_debug_tree(parser_t* parser) {
     assert(parser);
     assert(parser->tree);
-    assert(parser->source);
 
     string_t* out = string_create();
     TSNode root = ts_tree_root_node(parser->tree);
-    print_debug_tree_recursive(root, string_cstr(parser->source), 0, out);
+    print_debug_tree_recursive(root, parser->source.data, 0, out);
     return out;
 }
 
@@ -320,3 +558,10 @@ string_t* parser_get_identifier(parser_t* parser, TSNode node) {
     assert(parser_node_is_type(node, NODE_IDENTIFIER));
     return parser_node_text(parser, node);
 }
+
+// Get identifier value as a view into the source
+strview_t parser_get_identifier_view(parser_t* parser, TSNode node) {
+    assert(parser);
+    assert(parser_node_is_type(node, NODE_IDENTIFIER));
+    return parser_node_view(parser, node);
+}
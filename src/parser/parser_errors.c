@@ -1,118 +1,115 @@
 #include "pseudo/parser_errors.h"
 #include "pseudo/string.h"
+#include "pseudo/tree_walk.h"
 #include <tree_sitter/api.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdbool.h>
 
 // Helper to find MISSING nodes (more specific errors)
-static void find_missing_node(TSNode node, error_info_t* info) {
+static walk_action_t find_missing_node(TSNode node, void* ctx) {
+    error_info_t* info = ctx;
     if (ts_node_is_missing(node)) {
-        // Only update if this is the first one or earlier in the file
-        if (!info->found) {
-            info->node = node;
-            info->point = ts_node_start_point(node);
-            info->is_missing = true;
-            info->found = true;
-        }
-        return;
+        info->node = node;
+        info->point = ts_node_start_point(node);
+        info->is_missing = true;
+        info->found = true;
+        return WALK_STOP;
     }
 
-    uint32_t child_count = ts_node_child_count(node);
-    for (uint32_t i = 0; i < child_count; i++) {
-        TSNode child = ts_node_child(node, i);
-        find_missing_node(child, info);
-        if (info->found) return;
-    }
+    // Error-free subtrees need no walk
+    return ts_node_has_error(node) ? WALK_CONTINUE : WALK_SKIP;
 }
 
 // Find position after last stmt in ERROR node (where sf should be)
 static TSPoint find_missing_sf_position(TSNode error_node, const char* source) {
     TSPoint best_pos = ts_node_start_point(error_node);
-    uint32_t child_count = ts_node_child_count(error_node);
 
-    // Look for altfel followed by stmt, or atunci followed by stmt
-    for (uint32_t i = 0; i < child_count; i++) {
-        TSNode child = ts_node_child(error_node, i);
+    // Look for altfel followed by stmt, or atunci followed by stmt: the
+    // position is right after the first statement following the keyword
+    bool after_atunci = false;
+    bool after_altfel = false;
+    child_iter_t it = child_iter_start(error_node);
+    for (TSNode child; child_iter_next(&it, &child); ) {
         const char* type = ts_node_type(child);
 
-        // After finding altfel or atunci, look for the next stmt
-        if (strcmp(type, "altfel") == 0 || strcmp(type, "atunci") == 0) {
-            // Find the stmt after this keyword
-            for (uint32_t j = i + 1; j < child_count; j++) {
-                TSNode next = ts_node_child(error_node, j);
-                const char* next_type = ts_node_type(next);
-                if (strcmp(next_type, "stmt") == 0) {
-                    // Position should be right after this statement
-                    best_pos = ts_node_end_point(next);
-                    if (strcmp(type, "altfel") == 0) {
-                        // This is the best position for sf after altfel
-                        return best_pos;
-                    }
-                    break;
-                }
+        if (strcmp(type, "altfel") == 0) after_altfel = true;
+        else if (strcmp(type, "atunci") == 0) after_atunci = true;
+        else if (strcmp(type, "stmt") == 0 && (after_atunci || after_altfel)) {
+            best_pos = ts_node_end_point(child);
+            // This is the best position for sf after altfel
+            if (after_altfel) {
+                child_iter_end(&it);
+                return best_pos;
             }
+            after_atunci = false;
         }
     }
+    child_iter_end(&it);
 
     // Fallback: check if any identifier looks like "pana" - sf should be before it
-    for (uint32_t i = 0; i < child_count; i++) {
-        TSNode child = ts_node_child(error_node, i);
+    it = child_iter_start(error_node);
+    for (TSNode child; child_iter_next(&it, &child); ) {
         const char* type = ts_node_type(child);
         if (strcmp(type, "identifier") == 0) {
             uint32_t start = ts_node_start_byte(child);
             uint32_t end = ts_node_end_byte(child);
             if (end - start == 4 && strncmp(source + start, "pana", 4) == 0) {
                 // sf should be before this pana
-                return ts_node_start_point(child);
+                best_pos = ts_node_start_point(child);
+                break;
             }
         } else if (strcmp(type, "pana") == 0) {
-            return ts_node_start_point(child);
+            best_pos = ts_node_start_point(child);
+            break;
         }
     }
+    child_iter_end(&it);
 
     return best_pos;
 }
 
+typedef struct {
+    const char* source;
+    error_info_t* info;
+} error_search_t;
+
 // Helper to find ERROR nodes (fallback)
-static void find_error_node(TSNode node, const char* source, error_info_t* info) {
+static walk_action_t find_error_node(TSNode node, void* ctx) {
+    error_search_t* search = ctx;
     if (strcmp(ts_node_type(node), "ERROR") == 0) {
-        if (!info->found) {
-            info->node = node;
-            // Try to find a better position based on content
-            info->point = find_missing_sf_position(node, source);
-            info->is_missing = false;
-            info->found = true;
-        }
-        return;
+        search->info->node = node;
+        // Try to find a better position based on content
+        search->info->point = find_missing_sf_position(node, search->source);
+        search->info->is_missing = false;
+        search->info->found = true;
+        return WALK_STOP;
     }
 
-    uint32_t child_count = ts_node_child_count(node);
-    for (uint32_t i = 0; i < child_count; i++) {
-        TSNode child = ts_node_child(node, i);
-        find_error_node(child, source, info);
-        if (info->found) return;
-    }
+    // Error-free subtrees need no walk
+    return ts_node_has_error(node) ? WALK_CONTINUE : WALK_SKIP;
 }
 
 // Find the best error to report - prefer MISSING over ERROR
 void find_first_error(TSNode node, const char* source, error_info_t* info) {
     // First try to find a MISSING node anywhere in the tree
-    find_missing_node(node, info);
+    tree_walk(node, find_missing_node, info);
     if (info->found) return;
 
     // Fall back to ERROR nodes
-    find_error_node(node, source, info);
+    error_search_t search = { .source = source, .info = info };
+    tree_walk(node, find_error_node, &search);
 }
 
 // Extract a specific line from source
-static string_t* get_source_line(const string_t* source, uint32_t line_num) {
-    const char* src = string_cstr(source);
+static string_t* get_source_line(strview_t source, uint32_t line_num) {
+    const char* src = source.data;
+    const char* end = source.data + source.len;
     uint32_t current_line = 0;
     const char* line_start = src;
 
     // Find the start of the requested line
-    while (*src && current_line < line_num) {
+    while (src < end && current_line < line_num) {
         if (*src == '\n') {
             current_line++;
             line_start = src + 1;
@@ -122,7 +119,7 @@ static string_t* get_source_line(const string_t* source, uint32_t line_num) {
 
     // Find the end of the line
     const char* line_end = line_start;
-    while (*line_end && *line_end != '\n') {
+    while (line_end < end && *line_end != '\n') {
         line_end++;
     }
 
@@ -151,40 +148,58 @@ const char* translate_node_type(const char* type) {
     return type;
 }
 
-// Check if an ERROR node contains a specific keyword
-static bool error_contains_keyword(TSNode error_node, const char* source, const char* keyword) {
-    uint32_t child_count = ts_node_child_count(error_node);
-    for (uint32_t i = 0; i < child_count; i++) {
-        TSNode child = ts_node_child(error_node, i);
+enum {
+    KW_DACA    = 1 << 0,
+    KW_ATUNCI  = 1 << 1,
+    KW_ALTFEL  = 1 << 2,
+    KW_REPETA  = 1 << 3,
+    KW_PANA    = 1 << 4,
+    KW_PENTRU  = 1 << 5,
+    KW_EXECUTA = 1 << 6,
+    KW_CAT     = 1 << 7,
+};
+
+static const char* const k_keywords[] = {
+    "daca", "atunci", "altfel", "repeta", "pana", "pentru", "executa", "cat",
+};
+
+// Keywords among the children of an ERROR node, as KW_* bits. Identifiers
+// whose text is a keyword count too.
+static unsigned error_keywords(TSNode error_node, const char* source) {
+    unsigned found = 0;
+    child_iter_t it = child_iter_start(error_node);
+    for (TSNode child; child_iter_next(&it, &child); ) {
         const char* type = ts_node_type(child);
-        if (strcmp(type, keyword) == 0) {
-            return true;
-        }
-        // Also check anonymous nodes (identifiers that match keyword text)
-        if (strcmp(type, "identifier") == 0) {
-            uint32_t start = ts_node_start_byte(child);
-            uint32_t end = ts_node_end_byte(child);
+        uint32_t start = ts_node_start_byte(child);
+        uint32_t end = ts_node_end_byte(child);
+        bool is_identifier = strcmp(type, "identifier") == 0;
+
+        for (size_t k = 0; k < sizeof(k_keywords) / sizeof(k_keywords[0]); k++) {
+            const char* keyword = k_keywords[k];
             size_t len = strlen(keyword);
-            if (end - start == len && strncmp(source + start, keyword, len) == 0) {
-                return true;
+            if (strcmp(type, keyword) == 0 ||
+                (is_identifier && end - start == len && strncmp(source + start, keyword, len) == 0)) {
+                found |= 1u << k;
             }
         }
     }
-    return false;
+    child_iter_end(&it);
+    return found;
 }
 
 // Analyze ERROR node content to suggest what's missing
 static string_t* analyze_error_content(TSNode error_node, const char* source) {
     string_t* suggestion = string_create();
 
-    bool has_daca = error_contains_keyword(error_node, source, "daca");
-    bool has_atunci = error_contains_keyword(error_node, source, "atunci");
-    bool has_altfel = error_contains_keyword(error_node, source, "altfel");
-    bool has_repeta = error_contains_keyword(error_node, source, "repeta");
-    bool has_pana = error_contains_keyword(error_node, source, "pana");
-    bool has_pentru = error_contains_keyword(error_node, source, "pentru");
-    bool has_executa = error_contains_keyword(error_node, source, "executa");
-    bool has_cat = error_contains_keyword(error_node, source, "cat");
+    unsigned keywords = error_keywords(error_node, source);
+    bool has_daca = keywords & KW_DACA;
+    bool has_atunci = keywords & KW_ATUNCI;
+    bool has_altfel = keywords & KW_ALTFEL;
+    bool has_repeta = keywords & KW_REPETA;
+    bool has_pana = keywords & KW_PANA;
+    bool has_pentru = keywords & KW_PENTRU;
+    bool has_executa = keywords & KW_EXECUTA;
+    bool has_cat = keywords & KW_CAT;
 
     // Check for incomplete structures
     if (has_daca && has_atunci) {
@@ -210,7 +225,7 @@ static string_t* analyze_error_content(TSNode error_node, const char* source) {
 }
 
 // Build a detailed error message
-string_t* build_error_message(const string_t* source, error_info_t* info) {
+string_t* build_error_message(strview_t source, error_info_t* info) {
     string_t* msg = string_create();
 
     // Error description
@@ -220,7 +235,7 @@ string_t* build_error_message(const string_t* source, error_info_t* info) {
         string_append(msg, translate_node_type(type));
     } else {
         // Analyze ERROR node content to provide better suggestions
-        string_t* suggestion = analyze_error_content(info->node, string_cstr(source));
+        string_t* suggestion = analyze_error_content(info->node, source.data);
         string_append_string(msg, suggestion);
         string_destroy(suggestion);
     }
@@ -0,0 +1,327 @@
+#include "pseudo/session.h"
+#include "pseudo/linter.h"
+#include "pseudo/string.h"
+#include "pseudo/memory.h"
+#include <string.h>
+#include <assert.h>
+
+struct session {
+    parser_t* parser;
+    string_t* text;        // Substituted document
+    string_t* source;      // The document as given, line for line the same
+    uint32_t line_count;
+
+    // Rows edited since the last update, in current coordinates
+    bool dirty;
+    bool reset;            // Whole document replaced
+    bool resumable;        // The last update ran out of time on this text
+    uint32_t dirty_first;
+    uint32_t dirty_end;    // Exclusive
+
+    row_span_t* rows;      // Result of the last update
+    size_t rows_capacity;
+};
+
+static uint32_t count_lines(const char* text, size_t len) {
+    uint32_t lines = 1;
+    for (const char* p = text; (p = memchr(p, '\n', (size_t)(text + len - p))); p++) {
+        lines++;
+    }
+    return lines;
+}
+
+// Lines [start_line, end_line) of `doc`: *start and *end (before the last
+// line's '\n'), and where the last line starts
+static void locate_lines(const string_t* doc, uint32_t start_line, uint32_t end_line,
+                         size_t* start, size_t* end, size_t* last_line_start) {
+    const char* data = string_cstr(doc);
+    size_t len = string_length(doc);
+    size_t pos = 0;
+    *start = 0;
+    *last_line_start = 0;
+    *end = len;
+    for (uint32_t line = 0; line < end_line; line++) {
+        if (line == start_line) *start = pos;
+        if (line == end_line - 1) *last_line_start = pos;
+        const char* nl = memchr(data + pos, '\n', len - pos);
+        if (!nl) break;
+        pos = (size_t)(nl - data) + 1;
+        if (line == end_line - 1) *end = pos - 1;
+    }
+}
+
+session_t* session_create(void) {
+    session_t* session = mem_calloc(MEM_PARSER, 1, sizeof(session_t));
+    if (!session) return NULL;
+
+    session->parser = parser_create();
+    session->text = string_create();
+    session->source = string_create();
+    if (!session->parser || !session->text || !session->source) {
+        session_destroy(session);
+        return NULL;
+    }
+    session->line_count = 1;
+    return session;
+}
+
+void session_destroy(session_t* session) {
+    if (!session) return;
+    parser_destroy(session->parser);
+    string_destroy(session->text);
+    string_destroy(session->source);
+    mem_free(session->rows);
+    mem_free(session);
+}
+
+bool session_set_text(session_t* session, const char* text, size_t len) {
+    assert(session);
+    assert(text || len == 0);
+
+    string_t* substituted = lint_substitute(text ? text : "", len);
+    string_t* source = string_create_from_buf(text ? text : "", len);
+    if (!substituted || !source) {
+        string_destroy(substituted);
+        string_destroy(source);
+        return false;
+    }
+
+    string_destroy(session->text);
+    string_destroy(session->source);
+    session->text = substituted;
+    session->source = source;
+    session->line_count = count_lines(string_cstr(substituted), string_length(substituted));
+    session->dirty = true;
+    session->reset = true;
+    session->resumable = false;
+    return true;
+}
+
+bool session_replace_lines(session_t* session, uint32_t start_line, uint32_t old_end_line,
+                           const char* text, size_t len) {
+    assert(session);
+    assert(text || len == 0);
+    if (start_line >= old_end_line || old_end_line > session->line_count) return false;
+
+    // The old lines in both copies of the document
+    size_t start, old_end, last_line_start;
+    size_t source_start, source_end, source_last;
+    locate_lines(session->text, start_line, old_end_line, &start, &old_end, &last_line_start);
+    locate_lines(session->source, start_line, old_end_line, &source_start, &source_end,
+                 &source_last);
+
+    // Room for the new source first, so its replace below cannot fail
+    size_t source_len = string_length(session->source) - (source_end - source_start) + len;
+    string_reserve(session->source, source_len + 1);
+    if (string_capacity(session->source) <= source_len) return false;
+
+    string_t* replacement = lint_substitute(text ? text : "", len);
+    if (!replacement) return false;
+
+    const char* new_text = string_cstr(replacement);
+    size_t new_len = string_length(replacement);
+    uint32_t new_lines = count_lines(new_text, new_len);
+    size_t new_last_line_start = new_len;
+    while (new_last_line_start > 0 && new_text[new_last_line_start - 1] != '\n') new_last_line_start--;
+
+    if (!string_replace(session->text, start, old_end - start, new_text, new_len)) {
+        string_destroy(replacement);
+        return false;
+    }
+    string_destroy(replacement);
+    string_replace(session->source, source_start, source_end - source_start, text ? text : "", len);
+
+    if (!session->reset) {
+        parser_edit(session->parser, &(TSInputEdit){
+            .start_byte = (uint32_t)start,
+            .old_end_byte = (uint32_t)old_end,
+            .new_end_byte = (uint32_t)(start + new_len),
+            .start_point = { start_line, 0 },
+            .old_end_point = { old_end_line - 1, (uint32_t)(old_end - last_line_start) },
+            .new_end_point = { start_line + new_lines - 1,
+                               (uint32_t)(new_len - new_last_line_start) },
+        });
+    }
+
+    // Grow the dirty rows to cover the new lines; rows after the edit move
+    uint32_t new_end_line = start_line + new_lines;
+    if (!session->dirty) {
+        session->dirty_first = start_line;
+        session->dirty_end = new_end_line;
+    } else {
+        int64_t delta = (int64_t)new_end_line - (int64_t)old_end_line;
+        if (start_line < session->dirty_first) session->dirty_first = start_line;
+        if (session->dirty_end >= old_end_line) {
+            uint32_t moved = (uint32_t)((int64_t)session->dirty_end + delta);
+            session->dirty_end = moved > new_end_line ? moved : new_end_line;
+        } else {
+            session->dirty_end = new_end_line;
+        }
+    }
+    session->dirty = true;
+    session->resumable = false;
+    session->line_count = session->line_count - (old_end_line - start_line) + new_lines;
+    return true;
+}
+
+static bool push_rows(session_t* session, size_t* count, uint32_t first, uint32_t last) {
+    if (*count == session->rows_capacity) {
+        size_t capacity = session->rows_capacity ? session->rows_capacity * 2 : 8;
+        row_span_t* rows = mem_realloc(MEM_PARSER, session->rows, capacity * sizeof(row_span_t));
+        if (!rows) return false;
+        session->rows = rows;
+        session->rows_capacity = capacity;
+    }
+    session->rows[(*count)++] = (row_span_t){ .first = first, .last = last };
+    return true;
+}
+
+// Sorts the spans by first row and merges overlapping or adjacent ones
+static size_t merge_rows(row_span_t* rows, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        row_span_t span = rows[i];
+        size_t j = i;
+        while (j > 0 && rows[j - 1].first > span.first) {
+            rows[j] = rows[j - 1];
+            j--;
+        }
+        rows[j] = span;
+    }
+
+    size_t merged = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (merged > 0 && rows[i].first <= rows[merged - 1].last + 1) {
+            if (rows[i].last > rows[merged - 1].last) rows[merged - 1].last = rows[i].last;
+        } else {
+            rows[merged++] = rows[i];
+        }
+    }
+    return merged;
+}
+
+bool session_update(session_t* session, const row_span_t** rows, size_t* count) {
+    assert(session);
+    *rows = session->rows;
+    *count = 0;
+    if (!session->dirty) return true;
+
+    strview_t text = string_view(session->text);
+    parser_error_t err = session->resumable
+        ? parser_resume(session->parser)
+        : parser_parse_borrowed(session->parser, text.data, text.len);
+    bool parsed = err.type != PARSER_ERR_MEMORY;
+    bool timed_out = err.type == PARSER_ERR_TIMEOUT;
+    parser_error_free(&err);
+
+    // Out of time: the rows stay dirty and the next update carries on
+    session->resumable = timed_out;
+    if (timed_out) return true;
+
+    // Without a tree there is nothing to diff against: start over next time
+    if (!parsed) {
+        session->reset = true;
+        return false;
+    }
+
+    uint32_t first = session->reset ? 0 : session->dirty_first;
+    uint32_t last = session->reset ? session->line_count - 1 : session->dirty_end - 1;
+    if (!push_rows(session, count, first, last)) {
+        session->reset = true;
+        return false;
+    }
+
+    if (!session->reset) {
+        uint32_t changed_count;
+        const TSRange* changed = parser_changed_ranges(session->parser, &changed_count);
+        for (uint32_t i = 0; i < changed_count; i++) {
+            first = changed[i].start_point.row;
+            last = changed[i].end_point.row;
+            // A range ending at the start of a row does not touch it
+            if (last > first && changed[i].end_point.column == 0) last--;
+            if (!push_rows(session, count, first, last)) {
+                // Out of memory: report every row rather than miss some
+                session->rows[0] = (row_span_t){ .first = 0, .last = session->line_count - 1 };
+                *count = 1;
+                break;
+            }
+        }
+        *count = merge_rows(session->rows, *count);
+    }
+
+    session->dirty = false;
+    session->reset = false;
+    *rows = session->rows;
+    return true;
+}
+
+bool session_pending(session_t* session) {
+    assert(session);
+    return session->resumable;
+}
+
+bool session_dirty(session_t* session) {
+    assert(session);
+    return session->dirty;
+}
+
+static uint32_t utf16_length(const char* text, size_t len) {
+    uint32_t units = 0;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if ((c & 0xC0) != 0x80) units += c >= 0xF0 ? 2 : 1;
+    }
+    return units;
+}
+
+size_t session_place_tokens(session_t* session, const highlight_tokens_t* tokens,
+                            uint32_t start, uint32_t first_row, uint32_t* out) {
+    assert(session);
+    strview_t source = string_view(session->source);
+
+    size_t row_start = 0;
+    for (uint32_t row = 0; row < first_row; row++) {
+        const char* nl = memchr(source.data + row_start, '\n', source.len - row_start);
+        if (!nl) return 0;
+        row_start = (size_t)(nl - source.data) + 1;
+    }
+    lint_origin_t origin;
+    lint_origin_init(&origin, source.data + row_start, source.len - row_start);
+
+    // Tokens are sorted: walk the source once, tracking row and column
+    size_t pos = row_start;
+    uint32_t row = first_row;
+    uint32_t column = 0;
+    size_t count = 0;
+    for (size_t i = 0; i < tokens->count; i++) {
+        const uint32_t* token = tokens->data + i * 3;
+        if (token[0] < start) continue;  // Starts above the first row
+        size_t from = row_start + lint_origin_map(&origin, token[0] - start);
+        size_t to = row_start + lint_origin_map(&origin, token[0] + token[1] - start);
+        for (; pos < from; pos++) {
+            unsigned char c = (unsigned char)source.data[pos];
+            if (c == '\n') {
+                row++;
+                column = 0;
+            } else if ((c & 0xC0) != 0x80) {
+                column += c >= 0xF0 ? 2 : 1;
+            }
+        }
+
+        uint32_t* token_out = out + count++ * 4;
+        token_out[0] = row;
+        token_out[1] = column;
+        token_out[2] = utf16_length(source.data + from, to - from);
+        token_out[3] = token[2];
+    }
+    return count;
+}
+
+parser_t* session_parser(session_t* session) {
+    assert(session);
+    return session->parser;
+}
+
+strview_t session_source(session_t* session) {
+    assert(session);
+    return string_view(session->source);
+}
@@ -0,0 +1,107 @@
+#include "pseudo/tree_walk.h"
+#include "pseudo/memory.h"
+#include <assert.h>
+
+child_iter_t child_iter_start(TSNode parent) {
+    return (child_iter_t){
+        .cursor = ts_tree_cursor_new(parent),
+        .started = false,
+        .done = ts_node_child_count(parent) == 0,
+    };
+}
+
+bool child_iter_next(child_iter_t* it, TSNode* child) {
+    if (it->done) return false;
+
+    bool moved = it->started
+        ? ts_tree_cursor_goto_next_sibling(&it->cursor)
+        : ts_tree_cursor_goto_first_child(&it->cursor);
+    it->started = true;
+    if (!moved) {
+        it->done = true;
+        return false;
+    }
+
+    *child = ts_tree_cursor_current_node(&it->cursor);
+    return true;
+}
+
+void child_iter_end(child_iter_t* it) {
+    ts_tree_cursor_delete(&it->cursor);
+}
+
+// Moves to the next node in pre-order, entering the current node's
+// children if `descend`. False once every node under the root is done.
+static bool goto_next(TSTreeCursor* cursor, bool descend) {
+    if (descend && ts_tree_cursor_goto_first_child(cursor)) return true;
+    while (!ts_tree_cursor_goto_next_sibling(cursor)) {
+        if (!ts_tree_cursor_goto_parent(cursor)) return false;
+    }
+    return true;
+}
+
+bool tree_walk(TSNode root, walk_visit_t visit, void* ctx) {
+    if (ts_node_is_null(root)) return true;
+
+    TSTreeCursor cursor = ts_tree_cursor_new(root);
+    bool completed = true;
+    walk_action_t action;
+    do {
+        action = visit(ts_tree_cursor_current_node(&cursor), ctx);
+        if (action == WALK_STOP) {
+            completed = false;
+            break;
+        }
+    } while (goto_next(&cursor, action == WALK_CONTINUE));
+
+    ts_tree_cursor_delete(&cursor);
+    return completed;
+}
+
+bool node_index_build(node_index_t* index, TSNode root) {
+    assert(index);
+    *index = (node_index_t){ 0 };
+
+    size_t capacity = ts_node_descendant_count(root);
+    index->starts = mem_alloc(MEM_PARSER, capacity * sizeof(uint32_t));
+    index->nodes = mem_alloc(MEM_PARSER, capacity * sizeof(TSNode));
+    if (!index->starts || !index->nodes) {
+        node_index_free(index);
+        return false;
+    }
+
+    // Start bytes never decrease in pre-order, so keeping the first node
+    // at each one leaves the array sorted
+    TSTreeCursor cursor = ts_tree_cursor_new(root);
+    do {
+        TSNode node = ts_tree_cursor_current_node(&cursor);
+        uint32_t start = ts_node_start_byte(node);
+        if ((index->count == 0 || start > index->starts[index->count - 1]) &&
+            index->count < capacity) {
+            index->starts[index->count] = start;
+            index->nodes[index->count] = node;
+            index->count++;
+        }
+    } while (goto_next(&cursor, true));
+    ts_tree_cursor_delete(&cursor);
+    return true;
+}
+
+TSNode node_index_find(const node_index_t* index, uint32_t start_byte) {
+    size_t lo = 0;
+    size_t hi = index->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index->starts[mid] < start_byte) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo < index->count && index->starts[lo] == start_byte) return index->nodes[lo];
+    return (TSNode){ 0 };
+}
+
+void node_index_free(node_index_t* index) {
+    if (!index) return;
+    mem_free(index->starts);
+    mem_free(index->nodes);
+    *index = (node_index_t){ 0 };
+}
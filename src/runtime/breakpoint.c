@@ -0,0 +1,462 @@
+#include "pseudo/debugger.h"
+#include "pseudo/runtime_internal.h"
+#include "pseudo/environment.h"
+#include "pseudo/parser.h"
+#include "pseudo/value.h"
+#include "pseudo/string.h"
+#include "pseudo/memory.h"
+#include <string.h>
+
+// Deepest parse tree a condition may have (eval_expr recurses down it)
+#define COND_MAX_DEPTH 1024
+
+// A condition keeps its own parse, which the interpreter's eval_expr runs
+typedef struct {
+    parser_t* parser;     // NULL: no condition
+    TSNode expr;
+} condition_t;
+
+typedef struct {
+    uint32_t line;
+    uint32_t hit_target;
+    uint32_t hits;
+    condition_t condition;
+} breakpoint_t;
+
+struct breakpoints {
+    breakpoint_t* list;
+    size_t count;
+    size_t capacity;
+};
+
+typedef struct {
+    string_t* name;
+    watch_kind_t kind;
+    value_t* target;          // WATCH_VALUE
+    condition_t condition;    // WATCH_CONDITION
+} watchpoint_t;
+
+struct watchpoints {
+    watchpoint_t* list;
+    size_t count;
+    size_t capacity;
+
+    // The last hit, since the load (runtime_get_watch_hit)
+    bool hit;
+    string_t* hit_name;
+    string_t* hit_old;    // NULL: the write created the variable
+    string_t* hit_new;
+    uint32_t hit_line;
+};
+
+// === Conditions ===
+
+// What a parse error says, by what the expression is for
+typedef struct {
+    const char* invalid;
+    const char* too_complex;
+} cond_messages_t;
+
+static const cond_messages_t k_breakpoint_messages = {
+    "Conditia punctului de oprire nu este o expresie valida",
+    "Conditia punctului de oprire este prea complexa",
+};
+
+static const cond_messages_t k_watch_messages = {
+    "Expresia urmarita nu este valida",
+    "Expresia urmarita este prea complexa",
+};
+
+// The condition is parsed as the value of an assignment, so it is written
+// exactly as in a program. Returns a null node unless that is all there is.
+static TSNode parse_condition(parser_t* parser, const string_t* source) {
+    parser_error_t err = parser_parse_source(parser, string_cstr(source), string_length(source), false);
+    bool parsed = err.type == PARSER_OK;
+    parser_error_free(&err);
+
+    TSNode root = parser_root(parser);
+    if (!parsed || ts_node_named_child_count(root) != 1) return (TSNode){ 0 };
+    TSNode stmt = ts_node_named_child(root, 0);
+    if (!parser_node_is_type(stmt, NODE_STMT)) return (TSNode){ 0 };
+    TSNode assign = ts_node_child(stmt, 0);
+    if (!parser_node_is_type(assign, NODE_ASSIGN)) return (TSNode){ 0 };
+    return parser_child_by_field(assign, "value");
+}
+
+// Whether the tree under `node` is more than `limit` nodes deep
+static bool deeper_than(TSNode node, uint32_t limit) {
+    if (limit == 0) return true;
+    uint32_t count = ts_node_child_count(node);
+    for (uint32_t i = 0; i < count; i++) {
+        if (deeper_than(ts_node_child(node, i), limit - 1)) return true;
+    }
+    return false;
+}
+
+static bool condition_parse(condition_t* condition, const char* text,
+                            const cond_messages_t* messages, string_t** error) {
+    parser_t* parser = parser_create();
+    string_t* source = string_create_from("x <- (");
+    const char* message = NULL;
+    TSNode expr = { 0 };
+
+    if (!parser || !source) {
+        message = value_error_string(VALUE_ERR_MEMORY);
+    } else {
+        string_append(source, text);
+        string_append(source, ")\n");
+        expr = parse_condition(parser, source);
+        if (ts_node_is_null(expr)) {
+            message = messages->invalid;
+        } else if (deeper_than(expr, COND_MAX_DEPTH)) {
+            message = messages->too_complex;
+        }
+    }
+
+    string_destroy(source);
+    if (message) {
+        parser_destroy(parser);
+        if (error) *error = string_create_from(message);
+        return false;
+    }
+    *condition = (condition_t){ .parser = parser, .expr = expr };
+    return true;
+}
+
+static void condition_free(condition_t* condition) {
+    parser_destroy(condition->parser);
+    *condition = (condition_t){ 0 };
+}
+
+// Evaluates `condition` over the program's variables, reading `name` as
+// `as` if `as` is set. The run is left as it was: an error only makes the
+// result NULL.
+static value_t* condition_value(runtime_t* rt, const condition_t* condition,
+                                strview_t name, const value_t* as) {
+    parser_t* program_parser = rt->parser;
+    exec_state_t state = rt->state;
+    string_t* error_msg = rt->error_msg;
+
+    rt->parser = condition->parser;
+    rt->state = EXEC_CONTINUE;
+    rt->error_msg = NULL;
+    rt->probe = true;
+    rt->probe_name = name;
+    rt->probe_value = as;
+
+    value_t* result = eval_expr(rt, condition->expr);
+    if (rt->state == EXEC_ERROR) {
+        value_destroy(result);
+        result = NULL;
+    }
+
+    string_destroy(rt->error_msg);
+    rt->parser = program_parser;
+    rt->state = state;
+    rt->error_msg = error_msg;
+    rt->probe = false;
+    rt->probe_value = NULL;
+    return result;
+}
+
+// A condition that cannot be evaluated holds: it stops the run, so it is noticed
+static bool condition_holds(runtime_t* rt, const condition_t* condition,
+                            strview_t name, const value_t* as) {
+    value_t* result = condition_value(rt, condition, name, as);
+    bool holds = !result || value_to_bool(result);
+    value_destroy(result);
+    return holds;
+}
+
+// === Breakpoint set ===
+
+static breakpoint_t* find_breakpoint(struct breakpoints* set, uint32_t line) {
+    if (!set) return NULL;
+    for (size_t i = 0; i < set->count; i++) {
+        if (set->list[i].line == line) return &set->list[i];
+    }
+    return NULL;
+}
+
+static void set_line_bit(runtime_t* rt, uint32_t line, bool on) {
+    if (on) {
+        rt->break_lines[line >> 6] |= (uint64_t)1 << (line & 63);
+    } else if (line >> 6 < rt->break_words) {
+        rt->break_lines[line >> 6] &= ~((uint64_t)1 << (line & 63));
+    }
+}
+
+// Makes room for `line` in the line bitmap
+static bool reserve_line(runtime_t* rt, uint32_t line) {
+    if (line >> 6 < rt->break_words) return true;
+
+    uint32_t words = rt->break_words ? rt->break_words : 4;
+    while (line >> 6 >= words) words *= 2;
+    uint64_t* bits = mem_realloc(MEM_OTHER, rt->break_lines, words * sizeof(uint64_t));
+    if (!bits) return false;
+    memset(bits + rt->break_words, 0, (words - rt->break_words) * sizeof(uint64_t));
+    rt->break_lines = bits;
+    rt->break_words = words;
+    return true;
+}
+
+// The breakpoint on `line`, added (blank) if there is none
+static breakpoint_t* get_breakpoint(runtime_t* rt, uint32_t line) {
+    struct breakpoints* set = rt->breakpoints;
+    if (!set) {
+        set = mem_calloc(MEM_OTHER, 1, sizeof(struct breakpoints));
+        if (!set) return NULL;
+        rt->breakpoints = set;
+    }
+
+    breakpoint_t* bp = find_breakpoint(set, line);
+    if (bp) return bp;
+
+    if (set->count == set->capacity) {
+        size_t capacity = set->capacity ? set->capacity * 2 : 8;
+        breakpoint_t* list = mem_realloc(MEM_OTHER, set->list, capacity * sizeof(breakpoint_t));
+        if (!list) return NULL;
+        set->list = list;
+        set->capacity = capacity;
+    }
+    bp = &set->list[set->count++];
+    *bp = (breakpoint_t){ .line = line };
+    return bp;
+}
+
+bool runtime_set_breakpoint(runtime_t* rt, uint32_t line, const char* condition,
+                            uint32_t hit_target, string_t** error) {
+    if (error) *error = NULL;
+    if (!rt) return false;
+
+    condition_t parsed = { 0 };
+    if (condition && *condition &&
+        !condition_parse(&parsed, condition, &k_breakpoint_messages, error)) {
+        return false;
+    }
+
+    breakpoint_t* bp = reserve_line(rt, line) ? get_breakpoint(rt, line) : NULL;
+    if (!bp) {
+        condition_free(&parsed);
+        if (error) *error = string_create_from(value_error_string(VALUE_ERR_MEMORY));
+        return false;
+    }
+
+    condition_free(&bp->condition);
+    *bp = (breakpoint_t){ .line = line, .hit_target = hit_target, .condition = parsed };
+    set_line_bit(rt, line, true);
+    return true;
+}
+
+void runtime_clear_breakpoint(runtime_t* rt, uint32_t line) {
+    if (!rt) return;
+    struct breakpoints* set = rt->breakpoints;
+    breakpoint_t* bp = find_breakpoint(set, line);
+    if (!bp) return;
+
+    condition_free(&bp->condition);
+    *bp = set->list[--set->count];
+    set_line_bit(rt, line, false);
+}
+
+void runtime_clear_breakpoints(runtime_t* rt) {
+    if (!rt) return;
+    struct breakpoints* set = rt->breakpoints;
+    if (set) {
+        for (size_t i = 0; i < set->count; i++) condition_free(&set->list[i].condition);
+        mem_free(set->list);
+        mem_free(set);
+        rt->breakpoints = NULL;
+    }
+    mem_free(rt->break_lines);
+    rt->break_lines = NULL;
+    rt->break_words = 0;
+}
+
+uint32_t runtime_get_breakpoint_hits(runtime_t* rt, uint32_t line) {
+    breakpoint_t* bp = rt ? find_breakpoint(rt->breakpoints, line) : NULL;
+    return bp ? bp->hits : 0;
+}
+
+bool breakpoint_hit(runtime_t* rt, uint32_t line) {
+    breakpoint_t* bp = find_breakpoint(rt->breakpoints, line);
+    if (!bp) return false;
+    if (bp->condition.parser && !condition_holds(rt, &bp->condition, (strview_t){ 0 }, NULL)) {
+        return false;
+    }
+    bp->hits++;
+    return bp->hits >= bp->hit_target;
+}
+
+void breakpoints_on_load(runtime_t* rt) {
+    struct breakpoints* set = rt->breakpoints;
+    for (size_t i = 0; set && i < set->count; i++) set->list[i].hits = 0;
+}
+
+// === Watchpoints ===
+
+static watchpoint_t* find_watch(struct watchpoints* set, strview_t name) {
+    if (!set) return NULL;
+    for (size_t i = 0; i < set->count; i++) {
+        if (strview_equals_view(string_view(set->list[i].name), name)) return &set->list[i];
+    }
+    return NULL;
+}
+
+static void free_watch(watchpoint_t* wp) {
+    string_destroy(wp->name);
+    value_destroy(wp->target);
+    condition_free(&wp->condition);
+}
+
+static void clear_hit(struct watchpoints* set) {
+    string_destroy(set->hit_name);
+    string_destroy(set->hit_old);
+    string_destroy(set->hit_new);
+    set->hit_name = set->hit_old = set->hit_new = NULL;
+    set->hit = false;
+}
+
+// Equal values; `strict` also asks for the same type (1 and 1.0 differ)
+static bool same_value(const value_t* a, const value_t* b, bool strict) {
+    if (strict && value_type(a) != value_type(b)) return false;
+    value_error_t err = VALUE_OK;
+    value_t* eq = value_eq(a, b, &err);
+    bool same = eq && err == VALUE_OK && value_to_bool(eq);
+    value_destroy(eq);
+    return same;
+}
+
+static bool watch_fires(runtime_t* rt, const watchpoint_t* wp, strview_t name,
+                        const value_t* old_value, const value_t* new_value) {
+    switch (wp->kind) {
+        case WATCH_CHANGE:
+            return !old_value || !same_value(old_value, new_value, true);
+        case WATCH_VALUE:
+            return same_value(new_value, wp->target, false) &&
+                   !(old_value && same_value(old_value, wp->target, false));
+        case WATCH_CONDITION:
+            return condition_holds(rt, &wp->condition, name, new_value) &&
+                   !(old_value && condition_holds(rt, &wp->condition, name, old_value));
+    }
+    return false;
+}
+
+static void watch_written(strview_t name, const value_t* old_value, const value_t* new_value,
+                          void* user_data) {
+    runtime_t* rt = user_data;
+    if (rt->watches_muted) return;
+    struct watchpoints* set = rt->watchpoints;
+    watchpoint_t* wp = find_watch(set, name);
+    if (!wp || !watch_fires(rt, wp, name, old_value, new_value)) return;
+
+    clear_hit(set);
+    set->hit = true;
+    set->hit_name = string_create_from_view(name);
+    set->hit_old = old_value ? value_to_string(old_value) : NULL;
+    set->hit_new = value_to_string(new_value);
+    set->hit_line = rt->current_line;
+    rt->stop_reason = STOP_WATCH;
+}
+
+// Parses the expression a watch of `kind` takes; a value is computed now
+static bool parse_watch(watchpoint_t* wp, runtime_t* rt, const char* arg, string_t** error) {
+    if (wp->kind == WATCH_CHANGE) return true;
+    if (!condition_parse(&wp->condition, arg ? arg : "", &k_watch_messages, error)) return false;
+    if (wp->kind == WATCH_CONDITION) return true;
+
+    wp->target = condition_value(rt, &wp->condition, (strview_t){ 0 }, NULL);
+    condition_free(&wp->condition);
+    if (!wp->target && error) *error = string_create_from("Valoarea urmarita nu poate fi calculata");
+    return wp->target != NULL;
+}
+
+// Adds `wp` to the set, in place of any watch on the same variable
+static bool add_watch(runtime_t* rt, const watchpoint_t* wp) {
+    struct watchpoints* set = rt->watchpoints;
+    if (!set) {
+        set = mem_calloc(MEM_OTHER, 1, sizeof(struct watchpoints));
+        if (!set) return false;
+        rt->watchpoints = set;
+        env_set_watch_callback(rt->env, watch_written, rt);
+    }
+
+    watchpoint_t* old = find_watch(set, string_view(wp->name));
+    if (old) {
+        free_watch(old);
+        *old = *wp;
+        return true;
+    }
+    if (set->count == set->capacity) {
+        size_t capacity = set->capacity ? set->capacity * 2 : 8;
+        watchpoint_t* list = mem_realloc(MEM_OTHER, set->list, capacity * sizeof(watchpoint_t));
+        if (!list) return false;
+        set->list = list;
+        set->capacity = capacity;
+    }
+    set->list[set->count++] = *wp;
+    return true;
+}
+
+bool runtime_set_watch(runtime_t* rt, const char* name, watch_kind_t kind, const char* arg,
+                       string_t** error) {
+    if (error) *error = NULL;
+    if (!rt || !name) return false;
+    if (!*name) {
+        if (error) *error = string_create_from("Lipseste numele variabilei urmarite");
+        return false;
+    }
+
+    watchpoint_t wp = { .name = string_create_from(name), .kind = kind };
+    if (wp.name && !parse_watch(&wp, rt, arg, error)) {
+        free_watch(&wp);
+        return false;
+    }
+    if (!wp.name || !env_watch(rt->env, string_view(wp.name)) || !add_watch(rt, &wp)) {
+        free_watch(&wp);
+        if (error) *error = string_create_from(value_error_string(VALUE_ERR_MEMORY));
+        return false;
+    }
+    return true;
+}
+
+void runtime_clear_watch(runtime_t* rt, const char* name) {
+    if (!rt || !name) return;
+    struct watchpoints* set = rt->watchpoints;
+    watchpoint_t* wp = find_watch(set, strview_from_cstr(name));
+    if (!wp) return;
+
+    env_unwatch(rt->env, string_view(wp->name));
+    free_watch(wp);
+    *wp = set->list[--set->count];
+}
+
+void runtime_clear_watches(runtime_t* rt) {
+    if (!rt || !rt->watchpoints) return;
+    struct watchpoints* set = rt->watchpoints;
+    for (size_t i = 0; i < set->count; i++) {
+        env_unwatch(rt->env, string_view(set->list[i].name));
+        free_watch(&set->list[i]);
+    }
+    clear_hit(set);
+    mem_free(set->list);
+    mem_free(set);
+    rt->watchpoints = NULL;
+    env_set_watch_callback(rt->env, NULL, NULL);
+}
+
+bool runtime_get_watch_hit(runtime_t* rt, watch_hit_t* hit) {
+    struct watchpoints* set = rt ? rt->watchpoints : NULL;
+    if (!set || !set->hit || !set->hit_name || !set->hit_new) return false;
+    *hit = (watch_hit_t){
+        .name = string_cstr(set->hit_name),
+        .old_value = set->hit_old ? string_cstr(set->hit_old) : NULL,
+        .new_value = string_cstr(set->hit_new),
+        .line = set->hit_line,
+    };
+    return true;
+}
+
+void watches_on_load(runtime_t* rt) {
+    clear_hit(rt->watchpoints);
+}
@@ -3,10 +3,26 @@
 #include "pseudo/environment.h"
 #include "pseudo/value.h"
 #include "pseudo/string.h"
+#include "pseudo/memory.h"
+#include "pseudo/table.h"
+#include "pseudo/format.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+#define NO_NAME UINT32_MAX
+
+// A variable as saved in a snapshot, with its value kept typed
+typedef struct {
+    uint32_t name;           // Index into the name pool
+    value_type_t type;
+    union {
+        int64_t i;
+        double f;
+        string_t* s;
+    } as;
+} saved_var_t;
+
 // Saved frame state for snapshots
 typedef struct {
     frame_type_t type;
@@ -15,26 +31,65 @@ typedef struct {
     int64_t loop_current;
     int64_t loop_end;
     int64_t loop_step;
-    string_t* loop_var;
+    uint32_t loop_var;       // Index into the name pool, or NO_NAME
     bool condition_result;
-    // Store node identity for restoration
-    uint32_t node_id;  // We'll use start byte as ID
+    bool in_else;
+    uint32_t node_id;        // Start byte of the frame's node
+    TSSymbol node_symbol;    // Tells it from other nodes starting there
 } saved_frame_t;
 
-// Snapshot structure definition
+// Snapshot structure definition. A keyframe holds every variable and
+// frame; other snapshots hold the variables written since the previous
+// snapshot and the frames above the ones it shares with it.
 struct runtime_snapshot {
-    var_info_t* variables;
-    size_t var_count;
+    bool keyframe;
+    saved_var_t* vars;
+    uint32_t var_count;
 
     // Execution stack state
+    int kept_frames;
     saved_frame_t* frames;
     int frame_count;
 
     // Other runtime state
     uint32_t read_var_index;
     bool has_pending_read;
+    uint32_t pending_read_id;  // Start byte of the pending read's node
+    TSSymbol pending_read_symbol;
     uint32_t current_line;
     exec_state_t state;
+    uint64_t step;
+
+    size_t bytes;
+};
+
+// Variable names, each stored once; snapshots refer to them by index
+typedef struct {
+    table_t* ids;                  // Name -> index + 1
+    string_t** names;
+    uint32_t count;
+    uint32_t capacity;
+} name_pool_t;
+
+struct snapshot_history {
+    runtime_snapshot_t** records;  // Oldest first
+    size_t count;
+    size_t capacity;
+    int first_id;                  // ID of records[0]
+    size_t bytes;
+
+    // Snapshot the runtime was last saved as or restored to (-1: none), and
+    // the environment tracker of the writes since
+    int at;
+    int tracker;
+    bool force_keyframe;           // A write may be missing from the tracker
+
+    name_pool_t names;
+
+    // Stack as of `at`, and room to build another
+    saved_frame_t frames[MAX_STACK_DEPTH];
+    int frame_count;
+    saved_frame_t scratch[MAX_STACK_DEPTH];
 };
 
 // === Variable Inspection ===
@@ -49,8 +104,11 @@ static void collect_variable(const string_t* name, const value_t* value, void* u
     var_collector_t* collector = (var_collector_t*)user_data;
 
     if (collector->count >= collector->capacity) {
-        collector->capacity = collector->capacity == 0 ? 8 : collector->capacity * 2;
-        collector->vars = realloc(collector->vars, collector->capacity * sizeof(var_info_t));
+        size_t capacity = collector->capacity == 0 ? 8 : collector->capacity * 2;
+        var_info_t* vars = mem_realloc(MEM_OTHER, collector->vars, capacity * sizeof(var_info_t));
+        if (!vars) return;
+        collector->vars = vars;
+        collector->capacity = capacity;
     }
 
     var_info_t* var = &collector->vars[collector->count];
@@ -73,6 +131,14 @@ static void collect_variable(const string_t* name, const value_t* value, void* u
             break;
     }
 
+    // Skip the variable if the memory cap refused any of its strings
+    if (!var->name || !var->value || !var->type) {
+        string_destroy(var->name);
+        string_destroy(var->value);
+        string_destroy(var->type);
+        return;
+    }
+
     collector->count++;
 }
 
@@ -97,7 +163,7 @@ void free_var_info_array(var_info_t* vars, size_t count) {
         string_destroy(vars[i].value);
         string_destroy(vars[i].type);
     }
-    free(vars);
+    mem_free(vars);
 }
 
 // === JSON Serialization ===
@@ -132,6 +198,10 @@ string_t* runtime_get_variables_json(runtime_t* rt) {
     var_info_t* vars = runtime_get_variables(rt, &count);
 
     string_t* json = string_create();
+    if (!json) {
+        free_var_info_array(vars, count);
+        return NULL;
+    }
     string_append_char(json, '[');
 
     for (size_t i = 0; i < count; i++) {
@@ -149,6 +219,10 @@ string_t* runtime_get_variables_json(runtime_t* rt) {
     string_append_char(json, ']');
 
     free_var_info_array(vars, count);
+    if (string_failed(json)) {
+        string_destroy(json);
+        return NULL;
+    }
     return json;
 }
 
@@ -156,97 +230,246 @@ string_t* runtime_get_variables_json(runtime_t* rt) {
 
 static void free_snapshot(runtime_snapshot_t* snap) {
     if (!snap) return;
-    free_var_info_array(snap->variables, snap->var_count);
-    if (snap->frames) {
-        for (int i = 0; i < snap->frame_count; i++) {
-            if (snap->frames[i].loop_var) {
-                string_destroy(snap->frames[i].loop_var);
-            }
+    if (snap->vars) {
+        for (uint32_t i = 0; i < snap->var_count; i++) {
+            if (snap->vars[i].type == VALUE_STRING) string_destroy(snap->vars[i].as.s);
         }
-        free(snap->frames);
+        mem_free(snap->vars);
     }
-    free(snap);
+    mem_free(snap->frames);
+    mem_free(snap);
 }
 
-// Find a node by its start byte (for restoration)
-static TSNode find_node_by_start(TSNode root, uint32_t start_byte) {
-    if (ts_node_start_byte(root) == start_byte) {
-        return root;
+// Find a node by its start byte (for restoration). The index over the
+// program is built at the first restore and lives until the next load.
+static TSNode find_node_by_start(runtime_t* rt, uint32_t start_byte, TSSymbol symbol) {
+    if (!rt->node_index.nodes && !node_index_build(&rt->node_index, rt->program_root)) {
+        return rt->program_root;
     }
 
-    uint32_t count = ts_node_child_count(root);
-    for (uint32_t i = 0; i < count; i++) {
-        TSNode child = ts_node_child(root, i);
-        TSNode found = find_node_by_start(child, start_byte);
-        if (!ts_node_is_null(found) && ts_node_start_byte(found) == start_byte) {
-            return found;
+    TSNode found = node_index_find(&rt->node_index, start_byte);
+    if (ts_node_is_null(found)) return rt->program_root; // Root as fallback
+
+    // Nodes starting at the same byte nest through their first children
+    // (a stmt around a for); take the one of the saved type
+    for (TSNode node = found; !ts_node_is_null(node); node = ts_node_child(node, 0)) {
+        if (ts_node_start_byte(node) != start_byte) break;
+        if (ts_node_symbol(node) == symbol) return node;
+    }
+    return found;
+}
+
+static struct snapshot_history* get_history(runtime_t* rt) {
+    if (rt->history) return rt->history;
+
+    struct snapshot_history* hist = mem_calloc(MEM_OTHER, 1, sizeof(struct snapshot_history));
+    if (!hist) return NULL;
+    hist->names.ids = table_create(16);
+    hist->tracker = env_tracker_create(rt->env);
+    if (!hist->names.ids || hist->tracker < 0) {
+        table_destroy(hist->names.ids, NULL);
+        if (hist->tracker >= 0) env_tracker_destroy(rt->env, hist->tracker);
+        mem_free(hist);
+        return NULL;
+    }
+    hist->at = -1;
+    rt->history = hist;
+    return hist;
+}
+
+// Index of a variable name, adding it at first sight; NO_NAME out of memory
+static uint32_t intern_name(name_pool_t* pool, const string_t* name) {
+    bool inserted;
+    void** slot = table_upsert(pool->ids, string_view(name), &inserted);
+    if (!slot) return NO_NAME;
+    if (!inserted) return (uint32_t)(uintptr_t)*slot - 1;
+
+    if (pool->count == pool->capacity) {
+        uint32_t capacity = pool->capacity ? pool->capacity * 2 : 16;
+        string_t** names = mem_realloc(MEM_OTHER, pool->names, capacity * sizeof(string_t*));
+        if (!names) {
+            table_remove(pool->ids, string_view(name), NULL);
+            return NO_NAME;
         }
+        pool->names = names;
+        pool->capacity = capacity;
+    }
+    string_t* copy = string_create_from_string(name);
+    if (!copy) {
+        table_remove(pool->ids, string_view(name), NULL);
+        return NO_NAME;
     }
+    pool->names[pool->count] = copy;
+    *slot = (void*)(uintptr_t)(pool->count + 1);
+    return pool->count++;
+}
 
-    return root; // Return root as fallback
+static void free_name_pool(name_pool_t* pool) {
+    for (uint32_t i = 0; i < pool->count; i++) {
+        string_destroy(pool->names[i]);
+    }
+    mem_free(pool->names);
+    table_destroy(pool->ids, NULL);
 }
 
-int runtime_create_snapshot(runtime_t* rt) {
-    if (!rt) return -1;
+static bool save_var(name_pool_t* names, saved_var_t* out, const string_t* name,
+                     const value_t* value, size_t* bytes) {
+    out->name = intern_name(names, name);
+    if (out->name == NO_NAME) return false;
+
+    out->type = value_type(value);
+    switch (out->type) {
+        case VALUE_INT:
+            out->as.i = value_as_int(value);
+            break;
+        case VALUE_FLOAT:
+            out->as.f = value_as_float(value);
+            break;
+        case VALUE_STRING:
+            out->as.s = string_create_from_string(value_as_string(value));
+            if (!out->as.s) return false;
+            *bytes += string_length(out->as.s) + 1;
+            break;
+    }
+    return true;
+}
+
+static value_t* load_var(const saved_var_t* var) {
+    switch (var->type) {
+        case VALUE_INT:   return value_create_int(var->as.i);
+        case VALUE_FLOAT: return value_create_float(var->as.f);
+        default:          return value_create_string(var->as.s);
+    }
+}
 
-    runtime_snapshot_t* snap = malloc(sizeof(runtime_snapshot_t));
-    if (!snap) return -1;
+typedef struct {
+    name_pool_t* names;
+    runtime_snapshot_t* snap;
+    bool failed;
+} keyframe_builder_t;
 
-    // Capture variables
-    snap->variables = runtime_get_variables(rt, &snap->var_count);
+static void save_every_var(const string_t* name, const value_t* value, void* user_data) {
+    keyframe_builder_t* builder = user_data;
+    runtime_snapshot_t* snap = builder->snap;
+    if (builder->failed) return;
 
-    // Capture execution stack
-    snap->frame_count = rt->stack_top + 1;
-    if (snap->frame_count > 0) {
-        snap->frames = malloc(snap->frame_count * sizeof(saved_frame_t));
-        for (int i = 0; i < snap->frame_count; i++) {
-            exec_frame_t* f = &rt->exec_stack[i];
-            snap->frames[i].type = f->type;
-            snap->frames[i].phase = f->phase;
-            snap->frames[i].child_idx = f->child_idx;
-            snap->frames[i].loop_current = f->loop_current;
-            snap->frames[i].loop_end = f->loop_end;
-            snap->frames[i].loop_step = f->loop_step;
-            snap->frames[i].loop_var = f->loop_var ? string_create_from_string(f->loop_var) : NULL;
-            snap->frames[i].condition_result = f->condition_result;
-            snap->frames[i].node_id = ts_node_start_byte(f->node);
-        }
+    if (save_var(builder->names, &snap->vars[snap->var_count], name, value, &snap->bytes)) {
+        snap->var_count++;
     } else {
-        snap->frames = NULL;
+        builder->failed = true;
     }
+}
 
-    // Capture other state
-    snap->read_var_index = rt->read_var_index;
-    snap->has_pending_read = rt->has_pending_read;
-    snap->current_line = rt->current_line;
-    snap->state = rt->state;
+static bool save_vars(runtime_t* rt, name_pool_t* names, runtime_snapshot_t* snap,
+                      const uint32_t* changed, size_t changed_count) {
+    size_t capacity = snap->keyframe ? env_size(rt->env) : changed_count;
+    if (capacity == 0) return true;
+
+    snap->vars = mem_alloc(MEM_OTHER, capacity * sizeof(saved_var_t));
+    if (!snap->vars) return false;
+    snap->bytes += capacity * sizeof(saved_var_t);
+
+    if (snap->keyframe) {
+        keyframe_builder_t builder = { .names = names, .snap = snap };
+        env_foreach(rt->env, save_every_var, &builder);
+        return !builder.failed;
+    }
 
-    // Store in circular buffer
-    int id = rt->snapshot_head;
+    for (size_t i = 0; i < changed_count; i++) {
+        const string_t* name;
+        const value_t* value = env_var_at(rt->env, changed[i], &name);
+        if (!value) continue;
+        if (!save_var(names, &snap->vars[snap->var_count], name, value, &snap->bytes)) return false;
+        snap->var_count++;
+    }
+    return true;
+}
 
-    if (rt->snapshots[id]) {
-        free_snapshot(rt->snapshots[id]);
+// Fills `out` with the current stack; false out of memory
+static bool save_frames(runtime_t* rt, name_pool_t* names, saved_frame_t* out) {
+    for (int i = 0; i <= rt->stack_top; i++) {
+        exec_frame_t* f = &rt->exec_stack[i];
+        uint32_t loop_var = NO_NAME;
+        if (f->loop_var) {
+            loop_var = intern_name(names, f->loop_var);
+            if (loop_var == NO_NAME) return false;
+        }
+        out[i] = (saved_frame_t){
+            .type = f->type,
+            .phase = f->phase,
+            .child_idx = f->child_idx,
+            .loop_current = f->loop_current,
+            .loop_end = f->loop_end,
+            .loop_step = f->loop_step,
+            .loop_var = loop_var,
+            .condition_result = f->condition_result,
+            .in_else = f->in_else,
+            .node_id = ts_node_start_byte(f->node),
+            .node_symbol = ts_node_symbol(f->node),
+        };
     }
+    return true;
+}
 
-    rt->snapshots[id] = snap;
-    rt->snapshot_head = (rt->snapshot_head + 1) % MAX_SNAPSHOTS;
+static bool frames_equal(const saved_frame_t* a, const saved_frame_t* b) {
+    return a->type == b->type && a->phase == b->phase && a->child_idx == b->child_idx &&
+           a->loop_current == b->loop_current && a->loop_end == b->loop_end &&
+           a->loop_step == b->loop_step && a->loop_var == b->loop_var &&
+           a->condition_result == b->condition_result && a->in_else == b->in_else &&
+           a->node_id == b->node_id && a->node_symbol == b->node_symbol;
+}
 
-    if (rt->snapshot_count < MAX_SNAPSHOTS) {
-        rt->snapshot_count++;
+// Drops the snapshots after `at` (a restore went back and execution moved on)
+static void drop_future(struct snapshot_history* hist) {
+    size_t keep = hist->at < 0 ? 0 : (size_t)(hist->at - hist->first_id) + 1;
+    while (hist->count > keep) {
+        runtime_snapshot_t* snap = hist->records[--hist->count];
+        hist->bytes -= snap->bytes;
+        free_snapshot(snap);
     }
+}
 
-    return id;
+// Drops the oldest snapshots, a keyframe interval at a time, while over the
+// limit; the newest interval always stays
+static void enforce_limit(runtime_t* rt, struct snapshot_history* hist) {
+    while (rt->history_limit && hist->bytes > rt->history_limit) {
+        size_t next_key = 1;
+        while (next_key < hist->count && !hist->records[next_key]->keyframe) next_key++;
+        if (next_key >= hist->count) return;
+
+        for (size_t i = 0; i < next_key; i++) {
+            hist->bytes -= hist->records[i]->bytes;
+            free_snapshot(hist->records[i]);
+        }
+        memmove(hist->records, hist->records + next_key,
+                (hist->count - next_key) * sizeof(runtime_snapshot_t*));
+        hist->count -= next_key;
+        hist->first_id += (int)next_key;
+    }
 }
 
-bool runtime_restore_snapshot(runtime_t* rt, int snapshot_id) {
-    if (!rt || snapshot_id < 0 || snapshot_id >= MAX_SNAPSHOTS) {
-        return false;
+// Applies a snapshot over the state of the one before it (or anything, for
+// a keyframe); frames go to `stack`
+static void apply_snapshot(runtime_t* rt, const name_pool_t* names, const runtime_snapshot_t* snap,
+                           saved_frame_t* stack, int* depth) {
+    if (snap->keyframe) env_clear(rt->env);
+    bool muted = rt->watches_muted;
+    rt->watches_muted = true;
+    for (uint32_t i = 0; i < snap->var_count; i++) {
+        const saved_var_t* var = &snap->vars[i];
+        env_set(rt->env, names->names[var->name], load_var(var));
     }
+    rt->watches_muted = muted;
 
-    runtime_snapshot_t* snap = rt->snapshots[snapshot_id];
-    if (!snap) return false;
+    if (snap->frame_count > 0) {
+        memcpy(stack + snap->kept_frames, snap->frames,
+               (size_t)snap->frame_count * sizeof(saved_frame_t));
+    }
+    *depth = snap->kept_frames + snap->frame_count;
+}
 
-    // Clear current stack
+// Rebuilds the execution stack from saved frames
+static void load_frames(runtime_t* rt, const name_pool_t* names, const saved_frame_t* frames, int depth) {
     while (rt->stack_top >= 0) {
         exec_frame_t* frame = &rt->exec_stack[rt->stack_top];
         if (frame->loop_var) {
@@ -255,73 +478,200 @@ bool runtime_restore_snapshot(runtime_t* rt, int snapshot_id) {
         }
         rt->stack_top--;
     }
-
-    // Restore execution stack
-    for (int i = 0; i < snap->frame_count; i++) {
+    for (int i = 0; i < depth; i++) {
+        const saved_frame_t* saved = &frames[i];
         rt->stack_top = i;
         exec_frame_t* f = &rt->exec_stack[i];
-        f->type = snap->frames[i].type;
-        f->phase = snap->frames[i].phase;
-        f->child_idx = snap->frames[i].child_idx;
-        f->loop_current = snap->frames[i].loop_current;
-        f->loop_end = snap->frames[i].loop_end;
-        f->loop_step = snap->frames[i].loop_step;
-        f->loop_var = snap->frames[i].loop_var ? string_create_from_string(snap->frames[i].loop_var) : NULL;
-        f->condition_result = snap->frames[i].condition_result;
-        f->node = find_node_by_start(rt->program_root, snap->frames[i].node_id);
-    }
-
-    // Restore other state
+        f->type = saved->type;
+        f->phase = saved->phase;
+        f->child_idx = saved->child_idx;
+        f->loop_current = saved->loop_current;
+        f->loop_end = saved->loop_end;
+        f->loop_step = saved->loop_step;
+        f->loop_var = saved->loop_var != NO_NAME ? string_create_from_string(names->names[saved->loop_var]) : NULL;
+        f->condition_result = saved->condition_result;
+        f->in_else = saved->in_else;
+        f->node = find_node_by_start(rt, saved->node_id, saved->node_symbol);
+    }
+}
+
+// The runtime state outside variables and frames
+static void save_state(runtime_t* rt, runtime_snapshot_t* snap) {
+    snap->read_var_index = rt->read_var_index;
+    snap->has_pending_read = rt->has_pending_read;
+    if (rt->has_pending_read) {
+        snap->pending_read_id = ts_node_start_byte(rt->pending_read_node);
+        snap->pending_read_symbol = ts_node_symbol(rt->pending_read_node);
+    }
+    snap->current_line = rt->current_line;
+    snap->state = rt->state;
+    snap->step = rt->step_count;
+}
+
+static void load_state(runtime_t* rt, const runtime_snapshot_t* snap) {
     rt->read_var_index = snap->read_var_index;
     rt->has_pending_read = snap->has_pending_read;
+    if (snap->has_pending_read) {
+        rt->pending_read_node = find_node_by_start(rt, snap->pending_read_id, snap->pending_read_symbol);
+    }
     rt->current_line = snap->current_line;
     rt->state = snap->state;
+    rt->step_count = snap->step;
+}
 
-    // Restore variables
-    env_clear(rt->env);
-    for (size_t i = 0; i < snap->var_count; i++) {
-        value_t* val = NULL;
-        const char* type_str = string_cstr(snap->variables[i].type);
-        const char* val_str = string_cstr(snap->variables[i].value);
-
-        if (strcmp(type_str, "int") == 0) {
-            val = value_create_int(strtoll(val_str, NULL, 10));
-        } else if (strcmp(type_str, "float") == 0) {
-            val = value_create_float(strtod(val_str, NULL));
-        } else {
-            val = value_create_string_from(val_str);
-        }
+int runtime_create_snapshot(runtime_t* rt) {
+    if (!rt) return -1;
+    struct snapshot_history* hist = get_history(rt);
+    if (!hist) return -1;
+
+    drop_future(hist);
+    if (hist->count == hist->capacity) {
+        size_t capacity = hist->capacity ? hist->capacity * 2 : 64;
+        runtime_snapshot_t** records = mem_realloc(MEM_OTHER, hist->records,
+                                                   capacity * sizeof(runtime_snapshot_t*));
+        if (!records) return -1;
+        hist->records = records;
+        hist->capacity = capacity;
+    }
+
+    const uint32_t* changed;
+    bool cleared;
+    size_t changed_count = env_tracker_take(rt->env, hist->tracker, &changed, &cleared);
 
-        if (val) {
-            env_set(rt->env, snap->variables[i].name, val);
+    size_t since_keyframe = 0;
+    while (since_keyframe < hist->count &&
+           !hist->records[hist->count - 1 - since_keyframe]->keyframe) {
+        since_keyframe++;
+    }
+
+    runtime_snapshot_t* snap = mem_calloc(MEM_OTHER, 1, sizeof(runtime_snapshot_t));
+    if (!snap) {
+        hist->force_keyframe = true;
+        return -1;
+    }
+    snap->bytes = sizeof(runtime_snapshot_t);
+    snap->keyframe = hist->count == 0 || cleared || hist->force_keyframe ||
+                     since_keyframe + 1 >= SNAPSHOT_KEYFRAME_INTERVAL;
+
+    // Capture variables and the frames that changed
+    int depth = rt->stack_top + 1;
+    bool saved = save_vars(rt, &hist->names, snap, changed, changed_count) &&
+                 save_frames(rt, &hist->names, hist->scratch);
+    if (saved) {
+        int kept = 0;
+        if (!snap->keyframe) {
+            while (kept < depth && kept < hist->frame_count &&
+                   frames_equal(&hist->scratch[kept], &hist->frames[kept])) {
+                kept++;
+            }
+        }
+        snap->kept_frames = kept;
+        snap->frame_count = depth - kept;
+        if (snap->frame_count > 0) {
+            snap->frames = mem_alloc(MEM_OTHER, (size_t)snap->frame_count * sizeof(saved_frame_t));
+            saved = snap->frames != NULL;
+            if (saved) {
+                memcpy(snap->frames, hist->scratch + kept, (size_t)snap->frame_count * sizeof(saved_frame_t));
+                snap->bytes += (size_t)snap->frame_count * sizeof(saved_frame_t);
+            }
         }
     }
+    if (!saved) {
+        // The writes taken from the tracker are lost: start over in full
+        free_snapshot(snap);
+        hist->force_keyframe = true;
+        return -1;
+    }
+
+    save_state(rt, snap);
+    hist->records[hist->count++] = snap;
+    hist->bytes += snap->bytes;
+    hist->force_keyframe = false;
+    memcpy(hist->frames, hist->scratch, (size_t)depth * sizeof(saved_frame_t));
+    hist->frame_count = depth;
+    hist->at = hist->first_id + (int)hist->count - 1;
+
+    int id = hist->at;
+    enforce_limit(rt, hist);
+    return id;
+}
+
+// True if nothing ran since the runtime was saved as or restored to `at`
+static bool at_snapshot(runtime_t* rt, struct snapshot_history* hist) {
+    if (hist->at < hist->first_id) return false;
+    const runtime_snapshot_t* snap = hist->records[hist->at - hist->first_id];
+
+    const uint32_t* changed;
+    bool cleared;
+    if (env_tracker_take(rt->env, hist->tracker, &changed, &cleared) > 0 || cleared) return false;
+    if (rt->current_line != snap->current_line || rt->state != snap->state ||
+        rt->read_var_index != snap->read_var_index ||
+        rt->has_pending_read != snap->has_pending_read) {
+        return false;
+    }
+
+    if (rt->stack_top + 1 != hist->frame_count) return false;
+    if (!save_frames(rt, &hist->names, hist->scratch)) return false;
+    for (int i = 0; i < hist->frame_count; i++) {
+        if (!frames_equal(&hist->scratch[i], &hist->frames[i])) return false;
+    }
+    return true;
+}
+
+bool runtime_restore_snapshot(runtime_t* rt, int snapshot_id) {
+    if (!rt || !rt->history) return false;
+    struct snapshot_history* hist = rt->history;
+    if (snapshot_id < hist->first_id || snapshot_id >= hist->first_id + (int)hist->count) {
+        return false;
+    }
+    size_t target = (size_t)(snapshot_id - hist->first_id);
 
-    // Invalidate snapshots after this one
-    int next_pos = (snapshot_id + 1) % MAX_SNAPSHOTS;
-    while (next_pos != rt->snapshot_head && rt->snapshots[next_pos]) {
-        free_snapshot(rt->snapshots[next_pos]);
-        rt->snapshots[next_pos] = NULL;
-        rt->snapshot_count--;
-        next_pos = (next_pos + 1) % MAX_SNAPSHOTS;
+    // Replay from the keyframe at or before the target; stepping forward
+    // from the snapshot the runtime is still at only replays what follows
+    size_t from = target;
+    while (!hist->records[from]->keyframe) from--;
+    int depth = 0;
+    if (hist->at < snapshot_id && hist->at >= hist->first_id + (int)from && at_snapshot(rt, hist)) {
+        from = (size_t)(hist->at - hist->first_id) + 1;
+        memcpy(hist->scratch, hist->frames, (size_t)hist->frame_count * sizeof(saved_frame_t));
+        depth = hist->frame_count;
     }
+    for (size_t i = from; i <= target; i++) {
+        apply_snapshot(rt, &hist->names, hist->records[i], hist->scratch, &depth);
+    }
+
+    // Writes made by the restore are not changes to journal
+    const uint32_t* changed;
+    env_tracker_take(rt->env, hist->tracker, &changed, NULL);
 
-    rt->snapshot_head = (snapshot_id + 1) % MAX_SNAPSHOTS;
+    load_frames(rt, &hist->names, hist->scratch, depth);
+    memcpy(hist->frames, hist->scratch, (size_t)depth * sizeof(saved_frame_t));
+    hist->frame_count = depth;
+    load_state(rt, hist->records[target]);
+    if (rt->timeline) timeline_on_step(rt);
 
+    hist->at = snapshot_id;
     return true;
 }
 
 void runtime_clear_snapshots(runtime_t* rt) {
-    if (!rt) return;
+    if (!rt || !rt->history) return;
+    struct snapshot_history* hist = rt->history;
 
-    for (int i = 0; i < MAX_SNAPSHOTS; i++) {
-        if (rt->snapshots[i]) {
-            free_snapshot(rt->snapshots[i]);
-            rt->snapshots[i] = NULL;
-        }
+    for (size_t i = 0; i < hist->count; i++) {
+        free_snapshot(hist->records[i]);
     }
-    rt->snapshot_head = 0;
-    rt->snapshot_count = 0;
+    mem_free(hist->records);
+    free_name_pool(&hist->names);
+    env_tracker_destroy(rt->env, hist->tracker);
+    mem_free(hist);
+    rt->history = NULL;
+}
+
+void runtime_set_snapshot_history_limit(runtime_t* rt, size_t bytes) {
+    if (!rt) return;
+    rt->history_limit = bytes;
+    if (rt->history) enforce_limit(rt, rt->history);
 }
 
 uint32_t runtime_get_next_line(runtime_t* rt) {
@@ -329,5 +679,348 @@ uint32_t runtime_get_next_line(runtime_t* rt) {
 }
 
 int runtime_get_snapshot_count(runtime_t* rt) {
-    return rt ? rt->snapshot_count : 0;
+    return rt && rt->history ? (int)rt->history->count : 0;
+}
+
+size_t runtime_get_snapshot_bytes(runtime_t* rt) {
+    return rt && rt->history ? rt->history->bytes : 0;
+}
+
+// === Time Travel ===
+
+// Full state at a step, re-executed from to reach the steps after it
+typedef struct {
+    uint64_t step;
+    size_t input_position;     // Values read before the step
+    runtime_snapshot_t* snap;  // A keyframe
+} checkpoint_t;
+
+struct timeline {
+    uint32_t interval;
+    checkpoint_t* checkpoints;  // By step
+    size_t count;
+    size_t capacity;
+    name_pool_t names;
+
+    // Furthest step run so far. Its output has been written, so running
+    // up to it again after going back is muted.
+    uint64_t frontier;
+    bool muted;
+
+    saved_frame_t scratch[MAX_STACK_DEPTH];
+};
+
+static void free_checkpoints(struct timeline* tl) {
+    for (size_t i = 0; i < tl->count; i++) {
+        free_snapshot(tl->checkpoints[i].snap);
+    }
+    tl->count = 0;
+}
+
+// Steps at multiples of the interval get a checkpoint; a muted run stops
+// muting at the frontier
+static void update_mark(runtime_t* rt) {
+    struct timeline* tl = rt->timeline;
+    uint64_t mark = (rt->step_count / tl->interval + 1) * tl->interval;
+    if (tl->muted && tl->frontier < mark) mark = tl->frontier;
+    rt->timeline_mark = mark;
+}
+
+static void set_muted(runtime_t* rt, bool muted) {
+    rt->timeline->muted = muted;
+    io_replay_set_muted(rt->io, muted);
+}
+
+// A checkpoint that cannot be taken is skipped: going back then re-executes
+// from the one before
+static void take_checkpoint(runtime_t* rt, struct timeline* tl) {
+    if (tl->count == tl->capacity) {
+        size_t capacity = tl->capacity ? tl->capacity * 2 : 64;
+        checkpoint_t* checkpoints = mem_realloc(MEM_OTHER, tl->checkpoints, capacity * sizeof(checkpoint_t));
+        if (!checkpoints) return;
+        tl->checkpoints = checkpoints;
+        tl->capacity = capacity;
+    }
+
+    runtime_snapshot_t* snap = mem_calloc(MEM_OTHER, 1, sizeof(runtime_snapshot_t));
+    if (!snap) return;
+    snap->keyframe = true;
+    snap->bytes = sizeof(runtime_snapshot_t);
+
+    int depth = rt->stack_top + 1;
+    bool saved = save_vars(rt, &tl->names, snap, NULL, 0) && save_frames(rt, &tl->names, tl->scratch);
+    if (saved && depth > 0) {
+        snap->frames = mem_alloc(MEM_OTHER, (size_t)depth * sizeof(saved_frame_t));
+        saved = snap->frames != NULL;
+        if (saved) {
+            memcpy(snap->frames, tl->scratch, (size_t)depth * sizeof(saved_frame_t));
+            snap->frame_count = depth;
+            snap->bytes += (size_t)depth * sizeof(saved_frame_t);
+        }
+    }
+    if (!saved) {
+        free_snapshot(snap);
+        return;
+    }
+    save_state(rt, snap);
+
+    tl->checkpoints[tl->count++] = (checkpoint_t){
+        .step = rt->step_count,
+        .input_position = io_replay_position(rt->io),
+        .snap = snap,
+    };
+}
+
+void timeline_on_step(runtime_t* rt) {
+    struct timeline* tl = rt->timeline;
+    if (!tl) {
+        rt->timeline_mark = UINT64_MAX;
+        return;
+    }
+
+    uint64_t step = rt->step_count;
+    if (tl->muted && step >= tl->frontier) set_muted(rt, false);
+    if (step % tl->interval == 0 && (tl->count == 0 || step > tl->checkpoints[tl->count - 1].step)) {
+        take_checkpoint(rt, tl);
+    }
+    update_mark(rt);
+}
+
+// Starts over from the current step: earlier steps cannot be reached
+static void timeline_restart(runtime_t* rt) {
+    struct timeline* tl = rt->timeline;
+    free_checkpoints(tl);
+    io_replay_record(rt->io, true);
+    tl->frontier = rt->step_count;
+    tl->muted = false;
+    take_checkpoint(rt, tl);
+    update_mark(rt);
+}
+
+void timeline_on_load(runtime_t* rt) {
+    if (rt->timeline) timeline_restart(rt);
+}
+
+bool runtime_enable_time_travel(runtime_t* rt, uint32_t interval) {
+    if (!rt || interval == 0 || !io_is_replay(rt->io)) return false;
+    runtime_disable_time_travel(rt);
+
+    struct timeline* tl = mem_calloc(MEM_OTHER, 1, sizeof(struct timeline));
+    if (!tl) return false;
+    tl->names.ids = table_create(16);
+    if (!tl->names.ids) {
+        mem_free(tl);
+        return false;
+    }
+    tl->interval = interval;
+    rt->timeline = tl;
+
+    timeline_restart(rt);
+    if (tl->count == 0) {
+        runtime_disable_time_travel(rt);
+        return false;
+    }
+    return true;
+}
+
+void runtime_disable_time_travel(runtime_t* rt) {
+    if (!rt || !rt->timeline) return;
+    struct timeline* tl = rt->timeline;
+
+    free_checkpoints(tl);
+    mem_free(tl->checkpoints);
+    free_name_pool(&tl->names);
+    mem_free(tl);
+    rt->timeline = NULL;
+    rt->timeline_mark = UINT64_MAX;
+    io_replay_set_muted(rt->io, false);
+    io_replay_record(rt->io, false);
+}
+
+static bool restore_checkpoint(runtime_t* rt, struct timeline* tl, const checkpoint_t* cp) {
+    if (!io_replay_seek(rt->io, cp->input_position)) return false;
+
+    int depth;
+    apply_snapshot(rt, &tl->names, cp->snap, tl->scratch, &depth);
+    load_frames(rt, &tl->names, tl->scratch, depth);
+    load_state(rt, cp->snap);
+
+    // A pause for output or input is not part of the state: the output was
+    // written long ago and the read takes its value from the recording
+    if (rt->state == EXEC_OUTPUT_FULL || rt->state == EXEC_NEEDS_INPUT) rt->state = EXEC_CONTINUE;
+    return true;
+}
+
+bool runtime_goto_step(runtime_t* rt, uint64_t step) {
+    if (!rt || !rt->timeline) return false;
+    struct timeline* tl = rt->timeline;
+    if (rt->step_count > tl->frontier) tl->frontier = rt->step_count;
+
+    // Last checkpoint at or before the step
+    size_t lo = 0, hi = tl->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (tl->checkpoints[mid].step <= step) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) return false;
+
+    // Going forward, the runtime may already be closer than the checkpoint
+    const checkpoint_t* cp = &tl->checkpoints[lo - 1];
+    if (step < rt->step_count || cp->step > rt->step_count) {
+        if (!restore_checkpoint(rt, tl, cp)) return false;
+    }
+
+    set_muted(rt, rt->step_count < tl->frontier);
+    update_mark(rt);
+    runtime_run_to_step(rt, step);
+    return rt->step_count == step;
+}
+
+size_t runtime_get_checkpoint_count(runtime_t* rt) {
+    return rt && rt->timeline ? rt->timeline->count : 0;
+}
+
+// === Packed Step Records ===
+
+#define STEP_RECORD_INITIAL_CAPACITY 1024
+
+struct step_record {
+    int tracker;       // Writes since the last record
+    bool full;         // The next record lists every variable
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+};
+
+void step_record_free(runtime_t* rt) {
+    struct step_record* rec = rt->step_record;
+    if (!rec) return;
+    env_tracker_destroy(rt->env, rec->tracker);
+    mem_free(rec->data);
+    mem_free(rec);
+    rt->step_record = NULL;
+}
+
+static struct step_record* get_step_record(runtime_t* rt) {
+    if (rt->step_record) return rt->step_record;
+
+    struct step_record* rec = mem_calloc(MEM_OTHER, 1, sizeof(struct step_record));
+    if (!rec) return NULL;
+    rec->tracker = env_tracker_create(rt->env);
+    if (rec->tracker < 0) {
+        mem_free(rec);
+        return NULL;
+    }
+    rec->full = true;
+    rt->step_record = rec;
+    return rec;
+}
+
+// Grows the record by `len` bytes; returns the offset they start at
+static bool record_grow(struct step_record* rec, size_t len, uint32_t* offset) {
+    if (rec->size + len > rec->capacity) {
+        size_t capacity = rec->capacity ? rec->capacity : STEP_RECORD_INITIAL_CAPACITY;
+        while (capacity < rec->size + len) capacity *= 2;
+        uint8_t* data = mem_realloc(MEM_OTHER, rec->data, capacity);
+        if (!data) return false;
+        rec->data = data;
+        rec->capacity = capacity;
+    }
+    *offset = (uint32_t)rec->size;
+    rec->size += len;
+    return true;
+}
+
+static bool record_text(struct step_record* rec, const char* text, size_t len,
+                        uint32_t* offset, uint32_t* out_len) {
+    if (!record_grow(rec, len, offset)) return false;
+    if (len > 0) memcpy(rec->data + *offset, text, len);
+    *out_len = (uint32_t)len;
+    return true;
+}
+
+// Fills in entry `index` of the variable list
+static bool record_var(struct step_record* rec, uint32_t index, const string_t* name,
+                       const value_t* value) {
+    step_record_var_t var = { .type = value_type(value) };
+    if (!record_text(rec, string_cstr(name), string_length(name), &var.name_offset, &var.name_len)) {
+        return false;
+    }
+
+    char buffer[FORMAT_NUMBER_MAX];
+    const char* text = buffer;
+    size_t len;
+    switch (var.type) {
+        case VALUE_INT:
+            var.as.i = value_as_int(value);
+            len = format_i64(buffer, var.as.i);
+            break;
+        case VALUE_FLOAT:
+            var.as.f = value_as_float(value);
+            len = format_f64(buffer, var.as.f);
+            break;
+        default:
+            text = string_cstr(value_as_string(value));
+            len = string_length(value_as_string(value));
+            break;
+    }
+    if (!record_text(rec, text, len, &var.text_offset, &var.text_len)) return false;
+
+    memcpy(rec->data + sizeof(step_record_header_t) + index * sizeof(step_record_var_t),
+           &var, sizeof(var));
+    return true;
+}
+
+const step_record_header_t* runtime_get_step_record(runtime_t* rt, bool full) {
+    if (!rt) return NULL;
+    struct step_record* rec = get_step_record(rt);
+    if (!rec) return NULL;
+
+    const uint32_t* changed;
+    bool cleared;
+    size_t changed_count = env_tracker_take(rt->env, rec->tracker, &changed, &cleared);
+    full = full || cleared || rec->full;
+    size_t count = full ? env_size(rt->env) : changed_count;
+
+    // Header and list first, the text after them as it is written
+    rec->size = 0;
+    uint32_t offset;
+    rec->full = true;  // Until this record is complete, the writes taken are lost
+    if (!record_grow(rec, sizeof(step_record_header_t) + count * sizeof(step_record_var_t), &offset)) {
+        return NULL;
+    }
+
+    uint32_t listed = 0;
+    for (size_t i = 0; i < count; i++) {
+        const string_t* name;
+        const value_t* value = env_var_at(rt->env, full ? (uint32_t)i : changed[i], &name);
+        if (!value) continue;
+        if (!record_var(rec, listed, name, value)) return NULL;
+        listed++;
+    }
+
+    step_record_header_t header = {
+        .state = rt->state,
+        .line = runtime_get_next_line(rt),
+        .flags = full ? STEP_RECORD_FULL : 0,
+        .var_count = listed,
+        .step = rt->step_count,
+    };
+    condition_info_t cond = runtime_get_last_condition(rt);
+    if (cond.valid) {
+        header.flags |= STEP_RECORD_CONDITION | (cond.result ? STEP_RECORD_CONDITION_TRUE : 0);
+        if (!record_text(rec, cond.condition_text, strlen(cond.condition_text),
+                         &header.condition_offset, &header.condition_len)) {
+            return NULL;
+        }
+    }
+    header.size = (uint32_t)rec->size;
+    memcpy(rec->data, &header, sizeof(header));
+
+    rec->full = false;
+    return (const step_record_header_t*)rec->data;
 }
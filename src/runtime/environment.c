@@ -1,236 +1,281 @@
 #include "pseudo/environment.h"
 #include "pseudo/string.h"
+#include "pseudo/table.h"
 #include "pseudo/value.h"
-#include <stdlib.h>
-#include <stdint.h>
+#include "pseudo/memory.h"
 #include <string.h>
 #include <assert.h>
 
 #define INITIAL_CAPACITY 16
-#define LOAD_FACTOR 0.7
-
-typedef enum {
-    SLOT_EMPTY,
-    SLOT_OCCUPIED,
-    SLOT_DELETED
-} slot_state_t;
 
 typedef struct {
-    string_t* name;
-    value_t* value;
-    slot_state_t state;
-} env_entry_t;
+    uint32_t* vars;
+    size_t count;
+    size_t capacity;
+    bool cleared;
+} env_tracker_t;
 
 struct environment {
-    env_entry_t* entries;
-    size_t capacity;
-    size_t size;
-    size_t deleted_count;
+    table_t* vars;
+
+    // Change tracking: marks[var] has the bits of the trackers listing var
+    uint8_t tracking;  // Bits of the trackers in use
+    uint8_t* marks;
+    size_t marks_capacity;
+    env_tracker_t trackers[ENV_MAX_TRACKERS];
+
+    // Watches: the names, and watched[var] set for the variables among them
+    table_t* watch_names;  // NULL until the first watch
+    uint8_t* watched;
+    size_t watched_capacity;
+    env_watch_fn on_watch;
+    void* watch_data;
 };
 
-static uint64_t hash_string(const char* str) {
-    uint64_t hash = 14695981039346656037ULL;
-    while (*str) {
-        hash ^= (uint64_t)(unsigned char)(*str++);
-        hash *= 1099511628211ULL;
-    }
-    return hash;
+static void free_value(void* value) {
+    value_destroy(value);
 }
 
-static void env_resize(environment_t* env, size_t new_capacity);
-
 environment_t* env_create(void) {
-    environment_t* env = malloc(sizeof(environment_t));
+    environment_t* env = mem_calloc(MEM_ENV, 1, sizeof(environment_t));
     if (!env) return NULL;
 
-    env->capacity = INITIAL_CAPACITY;
-    env->size = 0;
-    env->deleted_count = 0;
-    env->entries = calloc(INITIAL_CAPACITY, sizeof(env_entry_t));
-
-    if (!env->entries) {
-        free(env);
+    env->vars = table_create(INITIAL_CAPACITY);
+    if (!env->vars) {
+        mem_free(env);
         return NULL;
     }
 
-    for (size_t i = 0; i < INITIAL_CAPACITY; i++) {
-        env->entries[i].state = SLOT_EMPTY;
-        env->entries[i].name = NULL;
-        env->entries[i].value = NULL;
-    }
-
     return env;
 }
 
 void env_destroy(environment_t* env) {
     if (!env) return;
 
-    for (size_t i = 0; i < env->capacity; i++) {
-        if (env->entries[i].state == SLOT_OCCUPIED) {
-            string_destroy(env->entries[i].name);
-            value_destroy(env->entries[i].value);
-        }
+    table_destroy(env->vars, free_value);
+    for (int i = 0; i < ENV_MAX_TRACKERS; i++) {
+        mem_free(env->trackers[i].vars);
     }
-
-    free(env->entries);
-    free(env);
+    mem_free(env->marks);
+    table_destroy(env->watch_names, NULL);
+    mem_free(env->watched);
+    mem_free(env);
 }
 
-static env_entry_t* find_entry(environment_t* env, const string_t* name) {
-    uint64_t hash = hash_string(string_cstr(name));
-    size_t index = hash % env->capacity;
-    size_t start_index = index;
-
-    do {
-        env_entry_t* entry = &env->entries[index];
-
-        if (entry->state == SLOT_EMPTY) {
-            return NULL;
+// Lists `var` with every tracker that does not have it yet. Out of memory
+// the write goes unlisted, as if the tracker had been cleared.
+static void note_write(environment_t* env, size_t var) {
+    if (var >= env->marks_capacity) {
+        size_t capacity = env->marks_capacity ? env->marks_capacity * 2 : 64;
+        while (capacity <= var) capacity *= 2;
+        uint8_t* marks = mem_realloc(MEM_ENV, env->marks, capacity);
+        if (!marks) {
+            for (int i = 0; i < ENV_MAX_TRACKERS; i++) env->trackers[i].cleared = true;
+            return;
         }
+        memset(marks + env->marks_capacity, 0, capacity - env->marks_capacity);
+        env->marks = marks;
+        env->marks_capacity = capacity;
+    }
 
-        if (entry->state == SLOT_OCCUPIED && string_equals_string(entry->name, name)) {
-            return entry;
+    uint8_t pending = env->tracking & (uint8_t)~env->marks[var];
+    if (!pending) return;
+
+    for (int i = 0; i < ENV_MAX_TRACKERS; i++) {
+        if (!(pending & (1u << i))) continue;
+        env_tracker_t* tracker = &env->trackers[i];
+        if (tracker->count == tracker->capacity) {
+            size_t capacity = tracker->capacity ? tracker->capacity * 2 : 16;
+            uint32_t* vars = mem_realloc(MEM_ENV, tracker->vars, capacity * sizeof(uint32_t));
+            if (!vars) {
+                tracker->cleared = true;
+                continue;
+            }
+            tracker->vars = vars;
+            tracker->capacity = capacity;
         }
-
-        index = (index + 1) % env->capacity;
-    } while (index != start_index);
-
-    return NULL;
+        tracker->vars[tracker->count++] = (uint32_t)var;
+        env->marks[var] |= (uint8_t)(1u << i);
+    }
 }
 
-static env_entry_t* find_slot(environment_t* env, const string_t* name) {
-    uint64_t hash = hash_string(string_cstr(name));
-    size_t index = hash % env->capacity;
-    size_t start_index = index;
-    env_entry_t* first_deleted = NULL;
-
-    do {
-        env_entry_t* entry = &env->entries[index];
-
-        if (entry->state == SLOT_EMPTY) {
-            return first_deleted ? first_deleted : entry;
-        }
-
-        if (entry->state == SLOT_DELETED && !first_deleted) {
-            first_deleted = entry;
-        }
-
-        if (entry->state == SLOT_OCCUPIED && string_equals_string(entry->name, name)) {
-            return entry;
-        }
-
-        index = (index + 1) % env->capacity;
-    } while (index != start_index);
+static bool set_watched(environment_t* env, size_t var, bool on) {
+    if (var >= env->watched_capacity) {
+        if (!on) return true;
+        size_t capacity = env->watched_capacity ? env->watched_capacity * 2 : 64;
+        while (capacity <= var) capacity *= 2;
+        uint8_t* watched = mem_realloc(MEM_ENV, env->watched, capacity);
+        if (!watched) return false;
+        memset(watched + env->watched_capacity, 0, capacity - env->watched_capacity);
+        env->watched = watched;
+        env->watched_capacity = capacity;
+    }
+    env->watched[var] = on;
+    return true;
+}
 
-    return first_deleted;
+// A new variable is looked up among the watched names, once. Out of
+// memory it goes unwatched.
+static bool is_watched(environment_t* env, size_t var, strview_t name, bool created) {
+    if (created && table_has(env->watch_names, name)) set_watched(env, var, true);
+    return var < env->watched_capacity && env->watched[var];
 }
 
 void env_set(environment_t* env, const string_t* name, value_t* value) {
-    assert(env != NULL);
     assert(name != NULL);
-    assert(value != NULL);
+    env_set_view(env, string_view(name), value);
+}
 
-    double load_factor = (double)(env->size + env->deleted_count) / env->capacity;
-    if (load_factor > LOAD_FACTOR) {
-        env_resize(env, env->capacity * 2);
+void env_set_view(environment_t* env, strview_t name, value_t* value) {
+    assert(env != NULL);
+    assert(name.data != NULL);
+
+    // A NULL value or a refused insertion means the memory cap was reached;
+    // the runtime reports it after the current step
+    if (!value) return;
+    value_t** slot = (value_t**)table_upsert(env->vars, name, NULL);
+    if (!slot) {
+        value_destroy(value);
+        return;
     }
-
-    env_entry_t* entry = find_slot(env, name);
-    assert(entry != NULL);
-
-    if (entry->state == SLOT_OCCUPIED) {
-        value_destroy(entry->value);
-        entry->value = value;
-    } else {
-        if (entry->state == SLOT_DELETED) {
-            env->deleted_count--;
+    value_t* old = *slot;
+    *slot = value;
+
+    if (env->tracking || env->watch_names) {
+        size_t var = table_slot_index(env->vars, (void**)slot);
+        if (env->tracking) note_write(env, var);
+        if (env->watch_names && env->on_watch && is_watched(env, var, name, old == NULL)) {
+            env->on_watch(name, old, value, env->watch_data);
         }
-        entry->name = string_create_from_string(name);
-        entry->value = value;
-        entry->state = SLOT_OCCUPIED;
-        env->size++;
     }
+    value_destroy(old);
 }
 
 value_t* env_get(environment_t* env, const string_t* name) {
-    assert(env != NULL);
     assert(name != NULL);
+    return env_get_view(env, string_view(name));
+}
 
-    env_entry_t* entry = find_entry(env, name);
-    return entry ? entry->value : NULL;
+value_t* env_get_view(environment_t* env, strview_t name) {
+    assert(env != NULL);
+    assert(name.data != NULL);
+    return table_get(env->vars, name);
 }
 
 bool env_has(environment_t* env, const string_t* name) {
     assert(env != NULL);
     assert(name != NULL);
-
-    return find_entry(env, name) != NULL;
+    return table_has(env->vars, string_view(name));
 }
 
 void env_clear(environment_t* env) {
     assert(env != NULL);
-
-    for (size_t i = 0; i < env->capacity; i++) {
-        if (env->entries[i].state == SLOT_OCCUPIED) {
-            string_destroy(env->entries[i].name);
-            value_destroy(env->entries[i].value);
-            env->entries[i].name = NULL;
-            env->entries[i].value = NULL;
-            env->entries[i].state = SLOT_EMPTY;
-        } else if (env->entries[i].state == SLOT_DELETED) {
-            env->entries[i].state = SLOT_EMPTY;
-        }
+    table_clear(env->vars, free_value);
+
+    // Variable numbers start over
+    if (env->marks) memset(env->marks, 0, env->marks_capacity);
+    if (env->watched) memset(env->watched, 0, env->watched_capacity);
+    for (int i = 0; i < ENV_MAX_TRACKERS; i++) {
+        env->trackers[i].count = 0;
+        env->trackers[i].cleared = true;
     }
-
-    env->size = 0;
-    env->deleted_count = 0;
 }
 
 size_t env_size(environment_t* env) {
     assert(env != NULL);
-    return env->size;
+    return table_size(env->vars);
+}
+
+typedef struct {
+    env_iter_fn callback;
+    void* user_data;
+} foreach_ctx_t;
+
+static void foreach_var(const string_t* name, void* value, void* user_data) {
+    foreach_ctx_t* ctx = user_data;
+    ctx->callback(name, value, ctx->user_data);
 }
 
 void env_foreach(environment_t* env, env_iter_fn callback, void* user_data) {
     assert(env != NULL);
     assert(callback != NULL);
 
-    for (size_t i = 0; i < env->capacity; i++) {
-        if (env->entries[i].state == SLOT_OCCUPIED) {
-            callback(env->entries[i].name, env->entries[i].value, user_data);
-        }
-    }
+    foreach_ctx_t ctx = { .callback = callback, .user_data = user_data };
+    table_foreach(env->vars, foreach_var, &ctx);
 }
 
-static void env_resize(environment_t* env, size_t new_capacity) {
+int env_tracker_create(environment_t* env) {
     assert(env != NULL);
+    for (int i = 0; i < ENV_MAX_TRACKERS; i++) {
+        if (env->tracking & (1u << i)) continue;
+        env->trackers[i].count = 0;
+        env->trackers[i].cleared = false;
+        env->tracking |= (uint8_t)(1u << i);
+        return i;
+    }
+    return -1;
+}
 
-    env_entry_t* old_entries = env->entries;
-    size_t old_capacity = env->capacity;
+void env_tracker_destroy(environment_t* env, int tracker) {
+    assert(env != NULL);
+    if (tracker < 0 || tracker >= ENV_MAX_TRACKERS) return;
 
-    env->entries = calloc(new_capacity, sizeof(env_entry_t));
-    assert(env->entries != NULL);
+    env_tracker_t* t = &env->trackers[tracker];
+    for (size_t i = 0; i < t->count; i++) {
+        env->marks[t->vars[i]] &= (uint8_t)~(1u << tracker);
+    }
+    mem_free(t->vars);
+    *t = (env_tracker_t){0};
+    env->tracking &= (uint8_t)~(1u << tracker);
+}
 
-    env->capacity = new_capacity;
-    env->size = 0;
-    env->deleted_count = 0;
+size_t env_tracker_take(environment_t* env, int tracker, const uint32_t** vars, bool* cleared) {
+    assert(env != NULL);
+    assert(tracker >= 0 && tracker < ENV_MAX_TRACKERS);
 
-    for (size_t i = 0; i < new_capacity; i++) {
-        env->entries[i].state = SLOT_EMPTY;
-        env->entries[i].name = NULL;
-        env->entries[i].value = NULL;
+    env_tracker_t* t = &env->trackers[tracker];
+    for (size_t i = 0; i < t->count; i++) {
+        env->marks[t->vars[i]] &= (uint8_t)~(1u << tracker);
     }
+    size_t count = t->count;
+    *vars = t->vars;
+    if (cleared) *cleared = t->cleared;
+    t->count = 0;
+    t->cleared = false;
+    return count;
+}
 
-    for (size_t i = 0; i < old_capacity; i++) {
-        if (old_entries[i].state == SLOT_OCCUPIED) {
-            // Transfer ownership directly
-            env_entry_t* slot = find_slot(env, old_entries[i].name);
-            slot->name = old_entries[i].name;
-            slot->value = old_entries[i].value;
-            slot->state = SLOT_OCCUPIED;
-            env->size++;
-        }
-    }
+value_t* env_var_at(environment_t* env, uint32_t var, const string_t** name) {
+    assert(env != NULL);
+    void** slot = table_slot_at(env->vars, var, name);
+    return slot ? *slot : NULL;
+}
+
+void env_set_watch_callback(environment_t* env, env_watch_fn callback, void* user_data) {
+    assert(env != NULL);
+    env->on_watch = callback;
+    env->watch_data = user_data;
+}
 
-    free(old_entries);
+bool env_watch(environment_t* env, strview_t name) {
+    assert(env != NULL);
+    if (!env->watch_names && !(env->watch_names = table_create(INITIAL_CAPACITY))) return false;
+    if (!table_upsert(env->watch_names, name, NULL)) return false;
+
+    if (!table_has(env->vars, name)) return true;
+    void** slot = table_upsert(env->vars, name, NULL);
+    return set_watched(env, table_slot_index(env->vars, slot), true);
+}
+
+void env_unwatch(environment_t* env, strview_t name) {
+    assert(env != NULL);
+    if (!env->watch_names || !table_remove(env->watch_names, name, NULL)) return;
+
+    if (table_has(env->vars, name)) {
+        set_watched(env, table_slot_index(env->vars, table_upsert(env->vars, name, NULL)), false);
+    }
+    if (table_size(env->watch_names) == 0) {
+        table_destroy(env->watch_names, NULL);
+        env->watch_names = NULL;
+    }
 }
@@ -1,20 +1,19 @@
 #include "pseudo/runtime.h"
 #include "pseudo/runtime_internal.h"
 #include "pseudo/debugger.h"
+#include "pseudo/profile.h"
 #include "pseudo/parser.h"
 #include "pseudo/environment.h"
 #include "pseudo/value.h"
-#include "pseudo/linter.h"
 #include "pseudo/string.h"
+#include "pseudo/memory.h"
+#include "pseudo/trace.h"
 #include <tree_sitter/api.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
-// Forward declarations
-static value_t* eval_expr(runtime_t* rt, TSNode expr_node);
-
 // === Stack Management ===
 
 static void stack_push(runtime_t* rt, frame_type_t type, TSNode node) {
@@ -52,19 +51,19 @@ static exec_frame_t* stack_top(runtime_t* rt) {
 // === Lifecycle ===
 
 runtime_t* runtime_create(io_t* io) {
-    runtime_t* rt = calloc(1, sizeof(runtime_t));
+    runtime_t* rt = mem_calloc(MEM_OTHER, 1, sizeof(runtime_t));
     if (!rt) return NULL;
 
     rt->parser = parser_create();
     if (!rt->parser) {
-        free(rt);
+        mem_free(rt);
         return NULL;
     }
 
     rt->env = env_create();
     if (!rt->env) {
         parser_destroy(rt->parser);
-        free(rt);
+        mem_free(rt);
         return NULL;
     }
 
@@ -79,11 +78,18 @@ runtime_t* runtime_create(io_t* io) {
     rt->has_condition_info = false;
 
     // Initialize debugger state
-    for (int i = 0; i < MAX_SNAPSHOTS; i++) {
-        rt->snapshots[i] = NULL;
-    }
-    rt->snapshot_head = 0;
-    rt->snapshot_count = 0;
+    rt->history = NULL;
+    rt->history_limit = DEFAULT_SNAPSHOT_HISTORY_LIMIT;
+    rt->step_count = 0;
+    rt->timeline = NULL;
+    rt->timeline_mark = UINT64_MAX;
+    rt->step_record = NULL;
+    rt->breakpoints = NULL;
+    rt->break_lines = NULL;
+    rt->break_words = 0;
+    rt->watchpoints = NULL;
+    rt->watches_muted = false;
+    rt->stop_reason = STOP_NONE;
 
     return rt;
 }
@@ -97,18 +103,24 @@ void runtime_destroy(runtime_t* rt) {
     }
 
     runtime_clear_snapshots(rt);
+    runtime_disable_time_travel(rt);
+    step_record_free(rt);
+    runtime_clear_breakpoints(rt);
+    runtime_clear_watches(rt);
+    node_index_free(&rt->node_index);
     parser_destroy(rt->parser);
     env_destroy(rt->env);
     if (rt->error_msg) string_destroy(rt->error_msg);
     if (rt->last_condition_text) string_destroy(rt->last_condition_text);
-    free(rt);
+    mem_free(rt);
 }
 
 // === Loading ===
 
-bool runtime_load(runtime_t* rt, const char* source) {
+// Lints and parses the program; a borrowed source must outlive the load
+static bool load_source(runtime_t* rt, const char* source, size_t len, bool borrow) {
     assert(rt);
-    assert(source);
+    assert(source || len == 0);
 
     if (rt->error_msg) {
         string_destroy(rt->error_msg);
@@ -120,12 +132,18 @@ bool runtime_load(runtime_t* rt, const char* source) {
         stack_pop(rt);
     }
 
-    string_t* source_str = string_create_from(source);
-    string_t* linted = lint(source_str);
-    string_destroy(source_str);
+    // The index points into the tree about to be replaced
+    node_index_free(&rt->node_index);
 
-    parser_error_t err = parser_parse(rt->parser, linted);
-    string_destroy(linted);
+    parser_error_t err = parser_parse_source(rt->parser, source, len, borrow);
+
+    if (err.type == PARSER_ERR_MEMORY) {
+        parser_error_free(&err);
+        mem_clear_limit_exceeded();
+        rt->error_msg = string_create_from(value_error_string(VALUE_ERR_MEMORY));
+        rt->state = EXEC_ERROR;
+        return false;
+    }
 
     if (err.type != PARSER_OK) {
         rt->error_msg = err.message;
@@ -133,11 +151,16 @@ bool runtime_load(runtime_t* rt, const char* source) {
         return false;
     }
 
+    // Loading is not charged to the program: only later steps can trip the cap
+    mem_clear_limit_exceeded();
+
     rt->program_root = parser_root(rt->parser);
     rt->read_var_index = 0;
     rt->has_pending_read = false;
     rt->stop_requested = false;
     rt->current_line = 0;
+    rt->step_count = 0;
+    rt->stop_reason = STOP_NONE;
     rt->state = EXEC_CONTINUE;
     env_clear(rt->env);
 
@@ -151,11 +174,37 @@ bool runtime_load(runtime_t* rt, const char* source) {
     // Initialize stack with program frame
     stack_push(rt, FRAME_PROGRAM, rt->program_root);
 
+    if (rt->timeline) timeline_on_load(rt);
+    if (rt->breakpoints) breakpoints_on_load(rt);
+    if (rt->watchpoints) watches_on_load(rt);
     return true;
 }
 
+bool runtime_load(runtime_t* rt, const char* source) {
+    assert(source);
+    TRACE_BEGIN("runtime_load");
+    bool loaded = load_source(rt, source, strlen(source), false);
+    TRACE_END("runtime_load");
+    return loaded;
+}
+
+bool runtime_load_view(runtime_t* rt, strview_t source) {
+    TRACE_BEGIN("runtime_load");
+    bool loaded = load_source(rt, source.data, source.len, true);
+    TRACE_END("runtime_load");
+    return loaded;
+}
+
 // === Expression evaluation ===
 
+// An operand that failed comes back NULL and fails its parent too: the
+// first error is the one reported
+static void expr_error(runtime_t* rt, value_error_t err) {
+    if (rt->state == EXEC_ERROR) return;
+    rt->state = EXEC_ERROR;
+    rt->error_msg = string_create_from(value_error_string(err));
+}
+
 static value_t* eval_atom(runtime_t* rt, TSNode atom_node) {
     assert(parser_node_is_type(atom_node, NODE_ATOM));
 
@@ -163,45 +212,56 @@ static value_t* eval_atom(runtime_t* rt, TSNode atom_node) {
     const char* type = ts_node_type(child);
 
     if (strcmp(type, NODE_IDENTIFIER) == 0) {
-        string_t* name = parser_node_text(rt->parser, child);
-        value_t* val = env_get(rt->env, name);
+        strview_t name = parser_node_view(rt->parser, child);
+        if (rt->probe) {
+            // A debugger condition: read only, and `probe_name` as written next
+            if (rt->probe_value && strview_equals_view(name, rt->probe_name)) {
+                return value_clone(rt->probe_value);
+            }
+            value_t* val = env_get_view(rt->env, name);
+            return val ? value_clone(val) : value_create_int(0);
+        }
+        value_t* val = env_get_view(rt->env, name);
         if (!val) {
             val = value_create_int(0);
-            env_set(rt->env, name, val);
+            env_set_view(rt->env, name, val);
         }
-        value_t* copy = value_clone(val);
-        string_destroy(name);
-        return copy;
+        return value_clone(val);
     }
 
     if (strcmp(type, NODE_NUMBER) == 0) {
-        string_t* text = parser_node_text(rt->parser, child);
-        const char* str = string_cstr(text);
+        // strtod/strtoll need a terminated copy; number literals fit on the stack
+        strview_t text = parser_node_view(rt->parser, child);
+        char buf[64];
+        string_t* heap = NULL;
+        const char* str = buf;
+        if (text.len < sizeof(buf)) {
+            memcpy(buf, text.data, text.len);
+            buf[text.len] = '\0';
+        } else {
+            heap = string_create_from_view(text);
+            str = string_cstr(heap);
+        }
 
-        if (strchr(str, '.')) {
-            double val = strtod(str, NULL);
-            string_destroy(text);
-            return value_create_float(val);
+        value_t* val;
+        if (memchr(text.data, '.', text.len)) {
+            val = value_create_float(strtod(str, NULL));
         } else {
-            long long val = strtoll(str, NULL, 10);
-            string_destroy(text);
-            return value_create_int(val);
+            val = value_create_int(strtoll(str, NULL, 10));
         }
+        string_destroy(heap);
+        return val;
     }
 
     if (strcmp(type, NODE_STRING) == 0) {
-        string_t* text = parser_node_text(rt->parser, child);
-        const char* str = string_cstr(text);
-        size_t len = string_length(text);
-        value_t* val = value_create_string_buf(str + 1, len - 2);
-        string_destroy(text);
-        return val;
+        strview_t text = parser_node_view(rt->parser, child);
+        return value_create_string_buf(text.data + 1, text.len - 2);
     }
 
     return NULL;
 }
 
-static value_t* eval_expr(runtime_t* rt, TSNode expr_node) {
+value_t* eval_expr(runtime_t* rt, TSNode expr_node) {
     const char* type = ts_node_type(expr_node);
 
     if (strcmp(type, NODE_EXPR) == 0 && ts_node_child_count(expr_node) == 1) {
@@ -224,10 +284,7 @@ static value_t* eval_expr(runtime_t* rt, TSNode expr_node) {
         value_error_t err = VALUE_OK;
         value_t* result = value_floor(val, &err);
         value_destroy(val);
-        if (err != VALUE_OK) {
-            rt->state = EXEC_ERROR;
-            rt->error_msg = string_create_from(value_error_string(err));
-        }
+        if (err != VALUE_OK) expr_error(rt, err);
         return result;
     }
 
@@ -243,7 +300,7 @@ static value_t* eval_expr(runtime_t* rt, TSNode expr_node) {
         value_t* right_val = eval_expr(rt, right);
         int result = value_to_bool(right_val);
         value_destroy(right_val);
-        return value_create_int(result);
+        return rt->state == EXEC_ERROR ? NULL : value_create_int(result);
     }
 
     if (strcmp(type, NODE_AND_EXPR) == 0) {
@@ -251,14 +308,14 @@ static value_t* eval_expr(runtime_t* rt, TSNode expr_node) {
         value_t* left_val = eval_expr(rt, left);
         if (!value_to_bool(left_val)) {
             value_destroy(left_val);
-            return value_create_int(0);
+            return rt->state == EXEC_ERROR ? NULL : value_create_int(0);
         }
         value_destroy(left_val);
         TSNode right = parser_child_by_field(expr_node, "right");
         value_t* right_val = eval_expr(rt, right);
         int result = value_to_bool(right_val);
         value_destroy(right_val);
-        return value_create_int(result);
+        return rt->state == EXEC_ERROR ? NULL : value_create_int(result);
     }
 
     if (strcmp(type, NODE_ADD_EXPR) == 0 || strcmp(type, NODE_MUL_EXPR) == 0 ||
@@ -267,34 +324,29 @@ static value_t* eval_expr(runtime_t* rt, TSNode expr_node) {
         TSNode op_node = parser_child_by_field(expr_node, "op");
         TSNode right = parser_child_by_field(expr_node, "right");
 
-        string_t* op_str = parser_node_text(rt->parser, op_node);
-        const char* op = string_cstr(op_str);
+        strview_t op = parser_node_view(rt->parser, op_node);
 
         value_t* left_val = eval_expr(rt, left);
         value_t* right_val = eval_expr(rt, right);
         value_t* result = NULL;
         value_error_t err = VALUE_OK;
 
-        if (strcmp(op, "+") == 0) result = value_add(left_val, right_val, &err);
-        else if (strcmp(op, "-") == 0) result = value_sub(left_val, right_val, &err);
-        else if (strcmp(op, "*") == 0) result = value_mul(left_val, right_val, &err);
-        else if (strcmp(op, "/") == 0) result = value_div(left_val, right_val, &err);
-        else if (strcmp(op, "%") == 0) result = value_mod(left_val, right_val, &err);
-        else if (strcmp(op, "=") == 0) result = value_eq(left_val, right_val, &err);
-        else if (strcmp(op, "!=") == 0) result = value_ne(left_val, right_val, &err);
-        else if (strcmp(op, "<") == 0) result = value_lt(left_val, right_val, &err);
-        else if (strcmp(op, "<=") == 0) result = value_le(left_val, right_val, &err);
-        else if (strcmp(op, ">") == 0) result = value_gt(left_val, right_val, &err);
-        else if (strcmp(op, ">=") == 0) result = value_ge(left_val, right_val, &err);
+        if (strview_equals(op, "+")) result = value_add(left_val, right_val, &err);
+        else if (strview_equals(op, "-")) result = value_sub(left_val, right_val, &err);
+        else if (strview_equals(op, "*")) result = value_mul(left_val, right_val, &err);
+        else if (strview_equals(op, "/")) result = value_div(left_val, right_val, &err);
+        else if (strview_equals(op, "%")) result = value_mod(left_val, right_val, &err);
+        else if (strview_equals(op, "=")) result = value_eq(left_val, right_val, &err);
+        else if (strview_equals(op, "!=")) result = value_ne(left_val, right_val, &err);
+        else if (strview_equals(op, "<")) result = value_lt(left_val, right_val, &err);
+        else if (strview_equals(op, "<=")) result = value_le(left_val, right_val, &err);
+        else if (strview_equals(op, ">")) result = value_gt(left_val, right_val, &err);
+        else if (strview_equals(op, ">=")) result = value_ge(left_val, right_val, &err);
 
         value_destroy(left_val);
         value_destroy(right_val);
-        string_destroy(op_str);
 
-        if (err != VALUE_OK) {
-            rt->state = EXEC_ERROR;
-            rt->error_msg = string_create_from(value_error_string(err));
-        }
+        if (err != VALUE_OK) expr_error(rt, err);
 
         return result;
     }
@@ -302,7 +354,7 @@ static value_t* eval_expr(runtime_t* rt, TSNode expr_node) {
     if (strcmp(type, NODE_NOT_EXPR) == 0) {
         TSNode operand = parser_child_by_field(expr_node, "operand");
         value_t* val = eval_expr(rt, operand);
-        value_t* result = value_not(val);
+        value_t* result = rt->state == EXEC_ERROR ? NULL : value_not(val);
         value_destroy(val);
         return result;
     }
@@ -313,10 +365,7 @@ static value_t* eval_expr(runtime_t* rt, TSNode expr_node) {
         value_error_t err = VALUE_OK;
         value_t* result = value_neg(val, &err);
         value_destroy(val);
-        if (err != VALUE_OK) {
-            rt->state = EXEC_ERROR;
-            rt->error_msg = string_create_from(value_error_string(err));
-        }
+        if (err != VALUE_OK) expr_error(rt, err);
         return result;
     }
 
@@ -326,10 +375,7 @@ static value_t* eval_expr(runtime_t* rt, TSNode expr_node) {
         value_error_t err = VALUE_OK;
         value_t* result = value_sqrt(val, &err);
         value_destroy(val);
-        if (err != VALUE_OK) {
-            rt->state = EXEC_ERROR;
-            rt->error_msg = string_create_from(value_error_string(err));
-        }
+        if (err != VALUE_OK) expr_error(rt, err);
         return result;
     }
 
@@ -342,43 +388,42 @@ static void exec_assign(runtime_t* rt, TSNode assign_node) {
     TSNode name_node = parser_child_by_field(assign_node, "name");
     TSNode value_node = parser_child_by_field(assign_node, "value");
 
-    string_t* name = parser_get_identifier(rt->parser, name_node);
+    strview_t name = parser_get_identifier_view(rt->parser, name_node);
     value_t* val = eval_expr(rt, value_node);
 
     if (val && rt->state != EXEC_ERROR) {
-        env_set(rt->env, name, val);
+        env_set_view(rt->env, name, val);
+    } else {
+        value_destroy(val);
     }
-
-    string_destroy(name);
 }
 
 static void exec_swap(runtime_t* rt, TSNode swap_node) {
     TSNode left_node = parser_child_by_field(swap_node, "left");
     TSNode right_node = parser_child_by_field(swap_node, "right");
 
-    string_t* left_name = parser_get_identifier(rt->parser, left_node);
-    string_t* right_name = parser_get_identifier(rt->parser, right_node);
+    strview_t left_name = parser_get_identifier_view(rt->parser, left_node);
+    strview_t right_name = parser_get_identifier_view(rt->parser, right_node);
 
-    value_t* left_val = env_get(rt->env, left_name);
-    value_t* right_val = env_get(rt->env, right_name);
+    value_t* left_val = env_get_view(rt->env, left_name);
+    value_t* right_val = env_get_view(rt->env, right_name);
 
     if (!left_val) {
         left_val = value_create_int(0);
-        env_set(rt->env, left_name, left_val);
-        left_val = env_get(rt->env, left_name);
+        env_set_view(rt->env, left_name, left_val);
+        left_val = env_get_view(rt->env, left_name);
     }
     if (!right_val) {
         right_val = value_create_int(0);
-        env_set(rt->env, right_name, right_val);
-        right_val = env_get(rt->env, right_name);
+        env_set_view(rt->env, right_name, right_val);
+        right_val = env_get_view(rt->env, right_name);
     }
 
-    value_t* temp = value_clone(left_val);
-    env_set(rt->env, left_name, value_clone(right_val));
-    env_set(rt->env, right_name, temp);
+    if (!left_val || !right_val) return;  // Memory cap reached
 
-    string_destroy(left_name);
-    string_destroy(right_name);
+    value_t* temp = value_clone(left_val);
+    env_set_view(rt->env, left_name, value_clone(right_val));
+    env_set_view(rt->env, right_name, temp);
 }
 
 static bool exec_read_one(runtime_t* rt, TSNode read_node) {
@@ -395,34 +440,23 @@ static bool exec_read_one(runtime_t* rt, TSNode read_node) {
             continue;
         }
 
-        string_t* name = parser_get_identifier(rt->parser, child);
         const char* input = rt->io->ops.read(rt->io);
 
+        if (!input && rt->io->status == IO_NO_MEMORY) {
+            if (rt->error_msg) string_destroy(rt->error_msg);
+            rt->error_msg = string_create_from(value_error_string(VALUE_ERR_MEMORY));
+            rt->state = EXEC_ERROR;
+            return false;
+        }
         if (!input) {
             rt->state = EXEC_NEEDS_INPUT;
             rt->has_pending_read = true;
             rt->pending_read_node = read_node;
-            string_destroy(name);
             return false;
         }
 
-        value_t* val;
-        char* endptr;
-
-        long long int_val = strtoll(input, &endptr, 10);
-        if (*endptr == '\0') {
-            val = value_create_int(int_val);
-        } else {
-            double float_val = strtod(input, &endptr);
-            if (*endptr == '\0') {
-                val = value_create_float(float_val);
-            } else {
-                val = value_create_string_from(input);
-            }
-        }
-
-        env_set(rt->env, name, val);
-        string_destroy(name);
+        value_t* val = value_parse(input);
+        env_set_view(rt->env, parser_get_identifier_view(rt->parser, child), val);
 
         rt->read_var_index++;
         var_index++;
@@ -433,30 +467,81 @@ static bool exec_read_one(runtime_t* rt, TSNode read_node) {
     return true;
 }
 
+// Arguments of one scrie are evaluated before any of them is written
+#define WRITE_STACK_VALUES 16
+
+static void write_value(io_t* io, const value_t* val) {
+    switch (value_type(val)) {
+        case VALUE_INT:
+            io_write_i64(io, value_as_int(val));
+            break;
+        case VALUE_FLOAT:
+            io_write_f64(io, value_as_float(val));
+            break;
+        case VALUE_STRING: {
+            const string_t* str = value_as_string(val);
+            io_write_buf(io, string_cstr(str), string_length(str));
+            break;
+        }
+    }
+}
+
 static void exec_write(runtime_t* rt, TSNode write_node) {
     TSNode expr_list = parser_child_by_field(write_node, "values");
+    uint32_t count = ts_node_child_count(expr_list);
 
-    string_t* output = string_create();
+    value_t* stack_values[WRITE_STACK_VALUES];
+    value_t** values = stack_values;
+    if (count > WRITE_STACK_VALUES) {
+        values = mem_alloc(MEM_OTHER, count * sizeof(value_t*));
+        if (!values) return;
+    }
 
-    uint32_t count = ts_node_child_count(expr_list);
+    // An error in any argument suppresses the whole line, as does a line
+    // that went over the memory cap (the step reports the error)
+    uint32_t n = 0;
+    bool ok = true;
     for (uint32_t i = 0; i < count; i++) {
         TSNode child = ts_node_child(expr_list, i);
         if (strcmp(ts_node_type(child), ",") == 0) continue;
 
         value_t* val = eval_expr(rt, child);
         if (!val || rt->state == EXEC_ERROR) {
-            string_destroy(output);
-            return;
+            value_destroy(val);
+            ok = false;
+            break;
         }
+        values[n++] = val;
+    }
 
-        string_t* val_str = value_to_string(val);
-        string_append_string(output, val_str);
-        string_destroy(val_str);
-        value_destroy(val);
+    for (uint32_t i = 0; i < n; i++) {
+        if (ok && !mem_limit_exceeded()) write_value(rt->io, values[i]);
+        value_destroy(values[i]);
     }
 
-    rt->io->ops.write(rt->io, string_cstr(output));
-    string_destroy(output);
+    if (values != stack_values) mem_free(values);
+
+    // The backend can pause or end the program after a write
+    switch (rt->io->status) {
+        case IO_OK:
+            break;
+        case IO_HALT:
+            rt->state = EXEC_DONE;
+            break;
+        case IO_OUTPUT_FULL:
+            rt->state = EXEC_OUTPUT_FULL;
+            break;
+        case IO_OUTPUT_LIMIT:
+            if (rt->error_msg) string_destroy(rt->error_msg);
+            rt->error_msg = string_create_from("Limita de output depasita");
+            rt->state = EXEC_ERROR;
+            break;
+        case IO_NO_MEMORY:
+            if (rt->error_msg) string_destroy(rt->error_msg);
+            rt->error_msg = string_create_from(value_error_string(VALUE_ERR_MEMORY));
+            rt->state = EXEC_ERROR;
+            break;
+    }
 }
 
 // === Find next statement child in a node ===
@@ -500,11 +585,18 @@ static bool exec_simple_stmt(runtime_t* rt, TSNode node) {
 
 // === Condition info helper ===
 
-static void save_condition_info(runtime_t* rt, TSNode cond_node, bool result) {
+// Reuses the condition buffer across steps instead of reallocating it
+static void set_condition_text(runtime_t* rt, strview_t text) {
     if (rt->last_condition_text) {
-        string_destroy(rt->last_condition_text);
+        string_clear(rt->last_condition_text);
+        string_append_view(rt->last_condition_text, text);
+    } else {
+        rt->last_condition_text = string_create_from_view(text);
     }
-    rt->last_condition_text = parser_node_text(rt->parser, cond_node);
+}
+
+static void save_condition_info(runtime_t* rt, TSNode cond_node, bool result) {
+    set_condition_text(rt, parser_node_view(rt->parser, cond_node));
     rt->last_condition_result = result;
     rt->has_condition_info = true;
 }
@@ -653,6 +745,10 @@ static bool step_for(runtime_t* rt, exec_frame_t* frame) {
         rt->current_line = ts_node_start_point(frame->node).row;
 
         frame->loop_var = parser_get_identifier(rt->parser, var_node);
+        if (!frame->loop_var) {
+            stack_pop(rt);
+            return true;  // Visible: memory cap reached
+        }
 
         value_t* start_val = eval_expr(rt, start_node);
         value_t* end_val = eval_expr(rt, end_node);
@@ -674,7 +770,6 @@ static bool step_for(runtime_t* rt, exec_frame_t* frame) {
         env_set(rt->env, frame->loop_var, value_create_int(frame->loop_current));
 
         // Show condition in visualization
-        if (rt->last_condition_text) string_destroy(rt->last_condition_text);
         char buf[128];
         bool will_continue = (frame->loop_step > 0 && frame->loop_current <= frame->loop_end) ||
                              (frame->loop_step < 0 && frame->loop_current >= frame->loop_end);
@@ -683,7 +778,7 @@ static bool step_for(runtime_t* rt, exec_frame_t* frame) {
             string_cstr(frame->loop_var),
             frame->loop_step > 0 ? "<=" : ">=",
             (long long)frame->loop_end);
-        rt->last_condition_text = string_create_from(buf);
+        set_condition_text(rt, strview_from_cstr(buf));
         rt->last_condition_result = will_continue;
         rt->has_condition_info = true;
 
@@ -705,14 +800,13 @@ static bool step_for(runtime_t* rt, exec_frame_t* frame) {
         rt->current_line = ts_node_start_point(frame->node).row;
 
         // Show condition in visualization
-        if (rt->last_condition_text) string_destroy(rt->last_condition_text);
         char buf[128];
         snprintf(buf, sizeof(buf), "%s = %lld, %s %s %lld",
             string_cstr(frame->loop_var), (long long)frame->loop_current,
             string_cstr(frame->loop_var),
             frame->loop_step > 0 ? "<=" : ">=",
             (long long)frame->loop_end);
-        rt->last_condition_text = string_create_from(buf);
+        set_condition_text(rt, strview_from_cstr(buf));
         rt->last_condition_result = continue_loop;
         rt->has_condition_info = true;
 
@@ -921,6 +1015,18 @@ static const frame_step_fn k_step_fns[] = {
     [FRAME_BLOCK]    = step_block,
 };
 
+// Turn an exceeded memory cap into a runtime error. Allocations past the cap
+// only raise a flag (or fail), so the check runs once per internal step.
+static bool check_memory_limit(runtime_t* rt) {
+    if (!mem_limit_exceeded()) return false;
+
+    mem_clear_limit_exceeded();
+    if (rt->error_msg) string_destroy(rt->error_msg);
+    rt->error_msg = string_create_from(value_error_string(VALUE_ERR_MEMORY));
+    rt->state = EXEC_ERROR;
+    return true;
+}
+
 // Internal step that processes one phase. Returns true if a visible action occurred.
 static bool runtime_step_internal(runtime_t* rt) {
     assert(rt);
@@ -937,7 +1043,9 @@ static bool runtime_step_internal(runtime_t* rt) {
 
     // Handle pending read - if successful, this counts as a visible action
     if (rt->has_pending_read) {
-        if (!exec_read_one(rt, rt->pending_read_node)) {
+        bool read_done = exec_read_one(rt, rt->pending_read_node);
+        if (check_memory_limit(rt)) return true;
+        if (!read_done) {
             return true;  // Still waiting for input - visible (shows input prompt)
         }
         // Read completed successfully - advance past the read statement
@@ -953,18 +1061,29 @@ static bool runtime_step_internal(runtime_t* rt) {
         rt->state = EXEC_DONE;
         return true;
     }
-    return k_step_fns[frame->type](rt, frame);
+    bool visible = k_step_fns[frame->type](rt, frame);
+    return check_memory_limit(rt) || visible;
+}
+
+// Called after each visible action. A read that stopped to wait for input
+// has not finished its step; it counts when the input arrives.
+static void count_step(runtime_t* rt) {
+    if (rt->state == EXEC_NEEDS_INPUT) return;
+    rt->step_count++;
+    if (rt->step_count >= rt->timeline_mark) timeline_on_step(rt);
 }
 
 // Public step function - loops until a visible action occurs
 exec_state_t runtime_step(runtime_t* rt) {
     assert(rt);
+    rt->stop_reason = STOP_NONE;
 
     // Keep stepping internally until we do something visible
     // or reach a terminal state (done/error/input)
     while (rt->state == EXEC_CONTINUE) {
         bool visible = runtime_step_internal(rt);
         if (visible || rt->state != EXEC_CONTINUE) {
+            if (visible) count_step(rt);
             break;
         }
     }
@@ -972,6 +1091,102 @@ exec_state_t runtime_step(runtime_t* rt) {
     return rt->state;
 }
 
+int runtime_get_stack_depth(runtime_t* rt) {
+    return rt ? rt->stack_top : -1;
+}
+
+// A stop request ends the run as an error
+static exec_state_t end_run(runtime_t* rt) {
+    if (rt->stop_requested && rt->state == EXEC_CONTINUE) {
+        rt->state = EXEC_ERROR;
+        rt->error_msg = string_create_from("Program stopped");
+    }
+    return rt->state;
+}
+
+exec_state_t runtime_run(runtime_t* rt) {
+    // Fast execution path - runs until done/error/input
+    // Just keep calling step_internal without any overhead
+    rt->stop_reason = STOP_NONE;
+    uint64_t start_steps = rt->step_count;  // The span counts this run's steps only
+    TRACE_BEGIN("execute");
+    while (rt->state == EXEC_CONTINUE && !rt->stop_requested && rt->stop_reason != STOP_WATCH) {
+        if (runtime_step_internal(rt)) count_step(rt);
+    }
+    TRACE_END_COUNT("execute", "steps", rt->step_count - start_steps);
+    return end_run(rt);
+}
+
+// runtime_run with a profile_note after every step
+exec_state_t runtime_run_profiled(runtime_t* rt, profile_t* profile) {
+    assert(rt && profile);
+
+    rt->stop_reason = STOP_NONE;
+    profile_start(profile);
+    while (rt->state == EXEC_CONTINUE && !rt->stop_requested && rt->stop_reason != STOP_WATCH) {
+        if (!runtime_step_internal(rt)) continue;
+        count_step(rt);
+        // Popping the last frame ends the program without running a line
+        if (rt->state == EXEC_DONE && rt->stack_top < 0) break;
+        profile_note(profile, rt->current_line);
+    }
+    return end_run(rt);
+}
+
+exec_state_t runtime_run_to_step(runtime_t* rt, uint64_t step) {
+    assert(rt);
+
+    rt->watches_muted = true;
+    while (rt->state == EXEC_CONTINUE && rt->step_count < step && !rt->stop_requested) {
+        if (runtime_step_internal(rt)) count_step(rt);
+    }
+    rt->watches_muted = false;
+    rt->stop_reason = STOP_NONE;
+    return end_run(rt);
+}
+
+// Where a debugger run stops, besides breakpoints and watches: after a step that
+// leaves the stack no deeper than `depth`, or that was on `line`
+typedef struct {
+    int depth;
+    uint32_t line;
+} run_target_t;
+
+#define NO_DEPTH (-2)          // Below any stack, even an ended one
+#define NO_LINE UINT32_MAX
+
+static exec_state_t run_to_target(runtime_t* rt, run_target_t target) {
+    assert(rt);
+
+    rt->stop_reason = STOP_NONE;
+    while (rt->state == EXEC_CONTINUE && !rt->stop_requested) {
+        if (!runtime_step_internal(rt)) continue;
+        count_step(rt);
+        if (rt->state != EXEC_CONTINUE || rt->stop_reason == STOP_WATCH) break;
+
+        uint32_t line = rt->current_line;
+        if (rt->stack_top <= target.depth || line == target.line) break;
+        if (line >> 6 < rt->break_words && (rt->break_lines[line >> 6] >> (line & 63) & 1) &&
+            breakpoint_hit(rt, line)) {
+            rt->stop_reason = STOP_BREAKPOINT;
+            break;
+        }
+    }
+    return end_run(rt);
+}
+
+exec_state_t runtime_continue(runtime_t* rt) {
+    return run_to_target(rt, (run_target_t){ NO_DEPTH, NO_LINE });
+}
+
+exec_state_t runtime_step_out(runtime_t* rt) {
+    return run_to_target(rt, (run_target_t){ rt->stack_top - 1, NO_LINE });
+}
+
+exec_state_t runtime_run_to_line(runtime_t* rt, uint32_t line) {
+    return run_to_target(rt, (run_target_t){ NO_DEPTH, line });
+}
+
 // Step over - execute until we return to the same or lower stack depth
 exec_state_t runtime_step_over(runtime_t* rt) {
     assert(rt);
@@ -982,34 +1197,23 @@ exec_state_t runtime_step_over(runtime_t* rt) {
     runtime_step(rt);
 
     // If we're still running and went deeper, keep going until we return
-    while (rt->state == EXEC_CONTINUE && rt->stack_top > initial_depth) {
-        runtime_step(rt);
+    if (rt->state == EXEC_CONTINUE && rt->stack_top > initial_depth && rt->stop_reason != STOP_WATCH) {
+        run_to_target(rt, (run_target_t){ initial_depth, NO_LINE });
     }
 
     return rt->state;
 }
 
-int runtime_get_stack_depth(runtime_t* rt) {
-    return rt ? rt->stack_top : -1;
+uint64_t runtime_get_step_count(runtime_t* rt) {
+    return rt ? rt->step_count : 0;
 }
 
-exec_state_t runtime_run(runtime_t* rt) {
-    // Fast execution path - runs until done/error/input
-    // Just keep calling step_internal without any overhead
-    while (rt->state == EXEC_CONTINUE && !rt->stop_requested) {
-        runtime_step_internal(rt);
-    }
-
-    if (rt->stop_requested && rt->state == EXEC_CONTINUE) {
-        rt->state = EXEC_ERROR;
-        rt->error_msg = string_create_from("Program stopped");
-    }
-
-    return rt->state;
+stop_reason_t runtime_get_stop_reason(runtime_t* rt) {
+    return rt ? rt->stop_reason : STOP_NONE;
 }
 
 void runtime_resume(runtime_t* rt) {
-    if (rt && rt->state == EXEC_NEEDS_INPUT) {
+    if (rt && (rt->state == EXEC_NEEDS_INPUT || rt->state == EXEC_OUTPUT_FULL)) {
         rt->state = EXEC_CONTINUE;
     }
 }
@@ -1051,3 +1255,13 @@ condition_info_t runtime_get_last_condition(runtime_t* rt) {
     }
     return info;
 }
+
+void runtime_set_memory_limit(runtime_t* rt, size_t bytes) {
+    (void)rt;
+    mem_set_limit(bytes);
+}
+
+void runtime_get_memory_stats(runtime_t* rt, mem_stats_t* out) {
+    (void)rt;
+    mem_get_stats(out);
+}
@@ -0,0 +1,259 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "pseudo/profile.h"
+#include "pseudo/runtime_internal.h"
+#include "pseudo/parser.h"
+#include "pseudo/tree_walk.h"
+#include "pseudo/memory.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct profile {
+    profile_line_t* lines;
+    uint32_t capacity;
+    profile_line_t total;
+    bool timed;
+    uint64_t last_ns;     // Clock reading at the end of the last step
+};
+
+typedef struct {
+    uint32_t line;        // First line of the loop
+    uint32_t end_line;    // Last
+    uint32_t check_line;  // Where its condition is checked
+    profile_line_t total; // Steps within it
+} loop_info_t;
+
+typedef struct {
+    loop_info_t* list;
+    size_t count;
+    size_t capacity;
+    bool failed;
+} loop_list_t;
+
+profile_t* profile_create(bool timed) {
+    profile_t* profile = mem_calloc(MEM_OTHER, 1, sizeof(profile_t));
+    if (profile) profile->timed = timed;
+    return profile;
+}
+
+void profile_destroy(profile_t* profile) {
+    if (!profile) return;
+    mem_free(profile->lines);
+    mem_free(profile);
+}
+
+static uint64_t clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void profile_start(profile_t* profile) {
+    if (profile->timed) profile->last_ns = clock_ns();
+}
+
+// Out of memory the step only counts in the total
+void profile_note(profile_t* profile, uint32_t line) {
+    uint64_t ns = 0;
+    if (profile->timed) {
+        uint64_t now = clock_ns();
+        ns = now - profile->last_ns;
+        profile->last_ns = now;
+    }
+    profile->total.steps++;
+    profile->total.ns += ns;
+
+    if (line >= profile->capacity) {
+        uint32_t capacity = profile->capacity ? profile->capacity : 64;
+        while (capacity <= line) capacity *= 2;
+        profile_line_t* lines = mem_realloc(MEM_OTHER, profile->lines, capacity * sizeof(profile_line_t));
+        if (!lines) return;
+        memset(lines + profile->capacity, 0, (capacity - profile->capacity) * sizeof(profile_line_t));
+        profile->lines = lines;
+        profile->capacity = capacity;
+    }
+    profile->lines[line].steps++;
+    profile->lines[line].ns += ns;
+}
+
+profile_line_t profile_get_line(const profile_t* profile, uint32_t line) {
+    if (!profile || line >= profile->capacity) return (profile_line_t){ 0 };
+    return profile->lines[line];
+}
+
+profile_line_t profile_get_total(const profile_t* profile) {
+    return profile ? profile->total : (profile_line_t){ 0 };
+}
+
+// === Loops ===
+
+static walk_action_t find_loop(TSNode node, void* ctx) {
+    loop_list_t* loops = ctx;
+    const char* type = ts_node_type(node);
+    bool checks_first = strcmp(type, NODE_FOR) == 0 || strcmp(type, NODE_WHILE) == 0;
+    if (!checks_first && strcmp(type, NODE_DO_WHILE) != 0 && strcmp(type, NODE_REPEAT) != 0) {
+        return WALK_CONTINUE;
+    }
+
+    if (loops->count == loops->capacity) {
+        size_t capacity = loops->capacity ? loops->capacity * 2 : 16;
+        loop_info_t* list = mem_realloc(MEM_OTHER, loops->list, capacity * sizeof(loop_info_t));
+        if (!list) {
+            loops->failed = true;
+            return WALK_STOP;
+        }
+        loops->list = list;
+        loops->capacity = capacity;
+    }
+
+    // A node that takes its line's newline ends at column 0 of the next
+    TSPoint start = ts_node_start_point(node);
+    TSPoint end = ts_node_end_point(node);
+    if (end.column == 0 && end.row > start.row) end.row--;
+    loops->list[loops->count++] = (loop_info_t){
+        .line = start.row,
+        .end_line = end.row,
+        .check_line = checks_first ? start.row : end.row,
+    };
+    return WALK_CONTINUE;
+}
+
+static int hotter_loop(const void* a, const void* b) {
+    const profile_line_t* x = &((const loop_info_t*)a)->total;
+    const profile_line_t* y = &((const loop_info_t*)b)->total;
+    if (x->ns != y->ns) return x->ns < y->ns ? 1 : -1;
+    if (x->steps != y->steps) return x->steps < y->steps ? 1 : -1;
+    return 0;
+}
+
+// The loops of the program, hottest first, with the steps on their lines
+static loop_list_t collect_loops(const profile_t* profile, runtime_t* rt) {
+    loop_list_t loops = { 0 };
+    tree_walk(parser_root(rt->parser), find_loop, &loops);
+
+    for (size_t i = 0; i < loops.count; i++) {
+        loop_info_t* loop = &loops.list[i];
+        for (uint32_t line = loop->line; line <= loop->end_line; line++) {
+            profile_line_t counts = profile_get_line(profile, line);
+            loop->total.steps += counts.steps;
+            loop->total.ns += counts.ns;
+        }
+    }
+    if (loops.count > 1) qsort(loops.list, loops.count, sizeof(loop_info_t), hotter_loop);
+    return loops;
+}
+
+// === Reports ===
+
+static double share(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+static void append_counts(string_t* out, const profile_t* profile, profile_line_t counts) {
+    char buf[96];
+    snprintf(buf, sizeof(buf), "%12llu %6.1f%%", (unsigned long long)counts.steps,
+             share(counts.steps, profile->total.steps));
+    string_append(out, buf);
+    if (profile->timed) {
+        snprintf(buf, sizeof(buf), " %12.3f %6.1f%%", (double)counts.ns / 1e6,
+                 share(counts.ns, profile->total.ns));
+        string_append(out, buf);
+    }
+}
+
+string_t* profile_report(const profile_t* profile, runtime_t* rt) {
+    string_t* out = string_create();
+    if (!out) return NULL;
+
+    char buf[128];
+    snprintf(buf, sizeof(buf), "Profil: %llu pasi", (unsigned long long)profile->total.steps);
+    string_append(out, buf);
+    if (profile->timed) {
+        snprintf(buf, sizeof(buf), ", %.3f ms", (double)profile->total.ns / 1e6);
+        string_append(out, buf);
+    }
+    string_append(out, profile->timed ? "\n\n linie         pasi       %      timp ms       %  sursa\n"
+                                      : "\n\n linie         pasi       %  sursa\n");
+
+    // Every line of the source, with the counts of those that ran
+    strview_t source = parser_source(rt->parser);
+    const char* p = source.data;
+    const char* end = source.data + source.len;
+    for (uint32_t line = 0; p < end; line++) {
+        const char* eol = memchr(p, '\n', (size_t)(end - p));
+        if (!eol) eol = end;
+
+        snprintf(buf, sizeof(buf), "%6u", line + 1);
+        string_append(out, buf);
+        profile_line_t counts = profile_get_line(profile, line);
+        if (counts.steps) {
+            append_counts(out, profile, counts);
+        } else {
+            string_append(out, profile->timed ? "                                          "
+                                              : "                    ");
+        }
+        string_append(out, "  ");
+        string_append_buf(out, p, (size_t)(eol - p));
+        string_append_char(out, '\n');
+        p = eol + 1;
+    }
+
+    loop_list_t loops = collect_loops(profile, rt);
+    if (loops.count > 0) string_append(out, "\nBucle fierbinti:\n");
+    for (size_t i = 0; i < loops.count && i < PROFILE_HOT_LOOPS; i++) {
+        const loop_info_t* loop = &loops.list[i];
+        snprintf(buf, sizeof(buf), "  liniile %u-%u", loop->line + 1, loop->end_line + 1);
+        string_append(out, buf);
+        append_counts(out, profile, loop->total);
+        snprintf(buf, sizeof(buf), "  %llu verificari\n",
+                 (unsigned long long)profile_get_line(profile, loop->check_line).steps);
+        string_append(out, buf);
+    }
+    mem_free(loops.list);
+    if (string_failed(out)) {
+        string_destroy(out);
+        return NULL;
+    }
+    return out;
+}
+
+string_t* profile_json(const profile_t* profile, runtime_t* rt) {
+    string_t* out = string_create();
+    if (!out) return NULL;
+
+    char buf[128];
+    snprintf(buf, sizeof(buf), "{\"timed\":%s,\"steps\":%llu,\"ns\":%llu,\"lines\":[",
+             profile->timed ? "true" : "false", (unsigned long long)profile->total.steps,
+             (unsigned long long)profile->total.ns);
+    string_append(out, buf);
+
+    bool first = true;
+    for (uint32_t line = 0; line < profile->capacity; line++) {
+        const profile_line_t* counts = &profile->lines[line];
+        if (!counts->steps) continue;
+        snprintf(buf, sizeof(buf), "%s[%u,%llu,%llu]", first ? "" : ",", line,
+                 (unsigned long long)counts->steps, (unsigned long long)counts->ns);
+        string_append(out, buf);
+        first = false;
+    }
+
+    string_append(out, "],\"loops\":[");
+    loop_list_t loops = collect_loops(profile, rt);
+    for (size_t i = 0; i < loops.count; i++) {
+        const loop_info_t* loop = &loops.list[i];
+        snprintf(buf, sizeof(buf), "%s{\"line\":%u,\"end\":%u,\"steps\":%llu,\"ns\":%llu,\"checks\":%llu}",
+                 i ? "," : "", loop->line, loop->end_line, (unsigned long long)loop->total.steps,
+                 (unsigned long long)loop->total.ns,
+                 (unsigned long long)profile_get_line(profile, loop->check_line).steps);
+        string_append(out, buf);
+    }
+    mem_free(loops.list);
+    string_append(out, "]}");
+    if (string_failed(out)) {
+        string_destroy(out);
+        return NULL;
+    }
+    return out;
+}
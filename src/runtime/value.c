@@ -1,5 +1,7 @@
 #include "pseudo/value.h"
 #include "pseudo/string.h"
+#include "pseudo/memory.h"
+#include "pseudo/format.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -18,7 +20,7 @@ struct value {
 // Creation
 
 value_t* value_create_int(int64_t val) {
-    value_t* v = malloc(sizeof(value_t));
+    value_t* v = mem_alloc(MEM_VALUES, sizeof(value_t));
     if (!v) return NULL;
     v->type = VALUE_INT;
     v->int_val = val;
@@ -26,7 +28,7 @@ value_t* value_create_int(int64_t val) {
 }
 
 value_t* value_create_float(double val) {
-    value_t* v = malloc(sizeof(value_t));
+    value_t* v = mem_alloc(MEM_VALUES, sizeof(value_t));
     if (!v) return NULL;
     v->type = VALUE_FLOAT;
     v->float_val = val;
@@ -35,12 +37,12 @@ value_t* value_create_float(double val) {
 
 value_t* value_create_string(const string_t* val) {
     if (!val) return NULL;
-    value_t* v = malloc(sizeof(value_t));
+    value_t* v = mem_alloc(MEM_VALUES, sizeof(value_t));
     if (!v) return NULL;
     v->type = VALUE_STRING;
     v->string_val = string_create_from_string(val);
     if (!v->string_val) {
-        free(v);
+        mem_free(v);
         return NULL;
     }
     return v;
@@ -48,12 +50,12 @@ value_t* value_create_string(const string_t* val) {
 
 value_t* value_create_string_from(const char* val) {
     if (!val) return NULL;
-    value_t* v = malloc(sizeof(value_t));
+    value_t* v = mem_alloc(MEM_VALUES, sizeof(value_t));
     if (!v) return NULL;
     v->type = VALUE_STRING;
     v->string_val = string_create_from(val);
     if (!v->string_val) {
-        free(v);
+        mem_free(v);
         return NULL;
     }
     return v;
@@ -77,7 +79,7 @@ void value_destroy(value_t* val) {
     if (val->type == VALUE_STRING) {
         string_destroy(val->string_val);
     }
-    free(val);
+    mem_free(val);
 }
 
 // Type inspection
@@ -154,24 +156,14 @@ double value_to_float(const value_t* val) {
 
 string_t* value_to_string(const value_t* val) {
     if (!val) return NULL;
-    char buffer[64];
-    switch (val->type) {
-        case VALUE_INT:
-            snprintf(buffer, sizeof(buffer), "%" PRId64, val->int_val);
-            return string_create_from(buffer);
-        case VALUE_FLOAT: {
-            if (val->float_val == floor(val->float_val) &&
-                fabs(val->float_val) < 1e15) {
-                snprintf(buffer, sizeof(buffer), "%.0f", val->float_val);
-            } else {
-                snprintf(buffer, sizeof(buffer), "%g", val->float_val);
-            }
-            return string_create_from(buffer);
-        }
-        case VALUE_STRING:
-            return string_create_from_string(val->string_val);
+    if (val->type == VALUE_STRING) {
+        return string_create_from_string(val->string_val);
     }
-    return NULL;
+
+    char buffer[FORMAT_NUMBER_MAX];
+    size_t len = val->type == VALUE_INT ? format_i64(buffer, val->int_val)
+                                        : format_f64(buffer, val->float_val);
+    return string_create_from_buf(buffer, len);
 }
 
 bool value_to_bool(const value_t* val) {
@@ -213,11 +205,20 @@ value_t* value_add(const value_t* a, const value_t* b, value_error_t* err) {
 
     // String concatenation: both must be strings
     if (a->type == VALUE_STRING && b->type == VALUE_STRING) {
-        SET_OK(err);
-        string_t* result = string_create_from_string(a->string_val);
+        size_t len = string_length(a->string_val) + string_length(b->string_val);
+        string_t* result = string_create_with_capacity(len + 1);
+        value_t* v = result ? mem_alloc(MEM_VALUES, sizeof(value_t)) : NULL;
+        if (!v) {
+            string_destroy(result);
+            SET_ERR(err, VALUE_ERR_MEMORY);
+            return NULL;
+        }
+
+        string_append_string(result, a->string_val);
         string_append_string(result, b->string_val);
-        value_t* v = value_create_string(result);
-        string_destroy(result);
+        v->type = VALUE_STRING;
+        v->string_val = result;
+        SET_OK(err);
         return v;
     }
 
@@ -398,6 +399,8 @@ const char* value_error_string(value_error_t err) {
             return "Impartire la zero";
         case VALUE_ERR_NEGATIVE_SQRT:
             return "Nu se poate calcula radicalul unui numar negativ";
+        case VALUE_ERR_MEMORY:
+            return "Limita de memorie depasita";
     }
     return "Eroare necunoscuta";
 }
@@ -406,13 +409,13 @@ const char* value_error_string(value_error_t err) {
 
 value_t* value_create_string_buf(const char* val, size_t len) {
     if (!val) return NULL;
-    value_t* v = malloc(sizeof(value_t));
+    value_t* v = mem_alloc(MEM_VALUES, sizeof(value_t));
     if (!v) return NULL;
     
     v->type = VALUE_STRING;
     v->string_val = string_create_from_buf(val, len);
     if (!v->string_val) {
-        free(v);
+        mem_free(v);
         return NULL;
     }
     
@@ -422,3 +425,75 @@ value_t* value_create_string_buf(const char* val, size_t len) {
 value_t* value_clone(const value_t* val) {
     return value_copy(val);
 }
+
+// Exact powers of ten: a mantissa below 2^53 divided by one of these is
+// correctly rounded, so the fast path matches strtod bit for bit
+static const double k_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+#define FAST_MAX_DIGITS 15
+
+// Scans [-+]digits[.digits] with at most 15 significant digits. Returns
+// false for anything else (exponents, overflow, whitespace, hex, inf...).
+static bool scan_number(const char* p, int64_t* int_out, double* float_out, bool* is_float) {
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    while (*p >= '0' && *p <= '9') {
+        if (++digits > FAST_MAX_DIGITS) return false;
+        mantissa = mantissa * 10 + (uint64_t)(*p++ - '0');
+    }
+
+    if (*p == '\0') {
+        if (digits == 0) return false;
+        *int_out = negative ? -(int64_t)mantissa : (int64_t)mantissa;
+        *is_float = false;
+        return true;
+    }
+
+    if (*p != '.') return false;
+    p++;
+
+    int frac_digits = 0;
+    while (*p >= '0' && *p <= '9') {
+        if (++digits > FAST_MAX_DIGITS) return false;
+        mantissa = mantissa * 10 + (uint64_t)(*p++ - '0');
+        frac_digits++;
+    }
+    if (*p != '\0' || digits == 0) return false;
+
+    double d = (double)mantissa / k_pow10[frac_digits];
+    *float_out = negative ? -d : d;
+    *is_float = true;
+    return true;
+}
+
+value_t* value_parse(const char* text) {
+    if (!text) return NULL;
+
+    int64_t int_val;
+    double float_val;
+    bool is_float;
+    if (scan_number(text, &int_val, &float_val, &is_float)) {
+        return is_float ? value_create_float(float_val) : value_create_int(int_val);
+    }
+
+    // Slow path keeps libc's exact rules (whitespace, exponents, clamping)
+    char* endptr;
+    long long ll = strtoll(text, &endptr, 10);
+    if (*endptr == '\0') {
+        return value_create_int(ll);
+    }
+    double d = strtod(text, &endptr);
+    if (*endptr == '\0') {
+        return value_create_float(d);
+    }
+    return value_create_string_from(text);
+}
@@ -1,5 +1,5 @@
 #include "transpiler_internal.h"
-#include "pseudo/linter.h"
+#include "pseudo/trace.h"
 #include <tree_sitter/api.h>
 #include <stdlib.h>
 #include <string.h>
@@ -58,6 +58,10 @@ static void emit(transpiler_t* ctx, const char* text) {
     string_append(ctx->out, text);
 }
 
+static void emit_view(transpiler_t* ctx, strview_t text) {
+    string_append_view(ctx->out, text);
+}
+
 static void emit_indent(transpiler_t* ctx) {
     for (int i = 0; i < ctx->indent; i++)
         string_append(ctx->out, "    ");
@@ -75,26 +79,26 @@ static void emit_fmt(transpiler_t* ctx, const char* fmt, ...) {
 // ─── Inline declaration helpers (C/C++ only) ─────────────────────────────────
 
 // Emit the C/C++ type keyword for a variable (no trailing space).
-static void emit_var_type(transpiler_t* ctx, const char* var_name) {
-    const char* t = hmap_get_cstr(ctx->var_types, var_name);
+static void emit_var_type(transpiler_t* ctx, strview_t var_name) {
+    const char* t = hmap_get_view(ctx->var_types, var_name);
     if (!t) t = "int";
     if (ctx->ops.is_cpp && strcmp(t, "string") == 0) emit(ctx, "string");
     else if (strcmp(t, "double") == 0)               emit(ctx, "double");
-    else if (strcmp(t, "string") == 0)               emit_fmt(ctx, "char %s[256]", var_name); // special: C string includes name
+    else if (strcmp(t, "string") == 0)               emit_fmt(ctx, "char " SV_FMT "[256]", SV_ARG(var_name)); // special: C string includes name
     else                                              emit(ctx, "int");
 }
 
 // Emit inline declaration prefix for a C/C++ variable if not yet declared.
 // Returns true if the declaration was emitted (caller should NOT emit var name again for C strings).
-static bool maybe_declare(transpiler_t* ctx, const char* var_name) {
+static bool maybe_declare(transpiler_t* ctx, strview_t var_name) {
     if (ctx->ops.is_pascal || !ctx->declared_vars) return false;
-    if (hmap_has_cstr(ctx->declared_vars, var_name)) return false;
-    hmap_set_cstr(ctx->declared_vars, var_name, "1");
-    const char* t = hmap_get_cstr(ctx->var_types, var_name);
+    if (hmap_has_view(ctx->declared_vars, var_name)) return false;
+    hmap_set_view(ctx->declared_vars, var_name, "1");
+    const char* t = hmap_get_view(ctx->var_types, var_name);
     if (!t) t = "int";
     if (!ctx->ops.is_cpp && strcmp(t, "string") == 0) {
         // C char array: special form — caller handles the rest
-        emit_fmt(ctx, "char %s[256]", var_name);
+        emit_fmt(ctx, "char " SV_FMT "[256]", SV_ARG(var_name));
         return true;
     }
     if (ctx->ops.is_cpp && strcmp(t, "string") == 0) emit(ctx, "string ");
@@ -120,75 +124,70 @@ static bool node_is_literal_one(transpiler_t* ctx, TSNode node) {
     if (!ts_node_is_null(cur) && strcmp(ts_node_type(cur), NODE_ATOM) == 0 && ts_node_child_count(cur) > 0)
         cur = ts_node_child(cur, 0);
     if (ts_node_is_null(cur) || strcmp(ts_node_type(cur), NODE_NUMBER) != 0) return false;
-    string_t* text = parser_node_text(ctx->parser, cur);
-    bool is_one = strcmp(string_cstr(text), "1") == 0;
-    string_destroy(text);
-    return is_one;
+    return strview_equals(parser_node_view(ctx->parser, cur), "1");
 }
 
 // Return true if `node` (possibly wrapped in EXPR/ATOM) is the identifier `var_name`.
-static bool node_is_ident(transpiler_t* ctx, TSNode node, const char* var_name) {
+static bool node_is_ident(transpiler_t* ctx, TSNode node, strview_t var_name) {
     TSNode cur = unwrap_expr(node);
     if (!ts_node_is_null(cur) && strcmp(ts_node_type(cur), NODE_ATOM) == 0 && ts_node_child_count(cur) > 0)
         cur = ts_node_child(cur, 0);
     if (ts_node_is_null(cur) || strcmp(ts_node_type(cur), NODE_IDENTIFIER) != 0) return false;
-    string_t* text = parser_node_text(ctx->parser, cur);
-    bool match = strcmp(string_cstr(text), var_name) == 0;
-    string_destroy(text);
-    return match;
+    return strview_equals_view(parser_node_view(ctx->parser, cur), var_name);
 }
 
 // ─── Hoisting helpers (C/C++ scope correctness) ──────────────────────────────
 
 // Emit a standalone variable declaration at current indent and mark as declared.
-static void emit_var_decl(transpiler_t* ctx, const char* n) {
-    const char* t = hmap_get_cstr(ctx->var_types, n);
+static void emit_var_decl(transpiler_t* ctx, strview_t n) {
+    const char* t = hmap_get_view(ctx->var_types, n);
     if (!t) t = "int";
     emit_indent(ctx);
     if (!ctx->ops.is_cpp && strcmp(t, "string") == 0)
-        emit_fmt(ctx, "char %s[256];\n", n);
+        emit_fmt(ctx, "char " SV_FMT "[256];\n", SV_ARG(n));
     else if (ctx->ops.is_cpp && strcmp(t, "string") == 0)
-        emit_fmt(ctx, "string %s;\n", n);
+        emit_fmt(ctx, "string " SV_FMT ";\n", SV_ARG(n));
     else if (strcmp(t, "double") == 0)
-        emit_fmt(ctx, "double %s;\n", n);
+        emit_fmt(ctx, "double " SV_FMT ";\n", SV_ARG(n));
     else
-        emit_fmt(ctx, "int %s;\n", n);
-    hmap_set_cstr(ctx->declared_vars, n, "1");
+        emit_fmt(ctx, "int " SV_FMT ";\n", SV_ARG(n));
+    hmap_set_view(ctx->declared_vars, n, "1");
 }
 
 // Scan `node` recursively; emit declarations for any variable first assigned or
 // read within it that isn't yet in declared_vars.  Stops at NODE_FOR so the loop
 // variable stays in the for-header (for (int i = ...)).  No-op for Pascal.
-static void hoist_vars(transpiler_t* ctx, TSNode node) {
-    if (ts_node_is_null(node) || ctx->ops.is_pascal || !ctx->declared_vars) return;
+static walk_action_t hoist_var(TSNode node, void* data) {
+    transpiler_t* ctx = data;
     const char* type = ts_node_type(node);
 
     if (strcmp(type, NODE_ASSIGN) == 0) {
         TSNode name_node = parser_child_by_field(node, "name");
-        string_t* name   = parser_node_text(ctx->parser, name_node);
-        if (!hmap_has_cstr(ctx->declared_vars, string_cstr(name)))
-            emit_var_decl(ctx, string_cstr(name));
-        string_destroy(name);
-        return;
+        strview_t name   = parser_node_view(ctx->parser, name_node);
+        if (!hmap_has_view(ctx->declared_vars, name))
+            emit_var_decl(ctx, name);
+        return WALK_SKIP;
     }
     if (strcmp(type, NODE_READ) == 0) {
         TSNode names_node = parser_child_by_field(node, "names");
-        uint32_t cnt = ts_node_child_count(names_node);
-        for (uint32_t i = 0; i < cnt; i++) {
-            TSNode child = ts_node_child(names_node, i);
+        child_iter_t it   = child_iter_start(names_node);
+        for (TSNode child; child_iter_next(&it, &child); ) {
             if (strcmp(ts_node_type(child), NODE_IDENTIFIER) != 0) continue;
-            string_t* name = parser_node_text(ctx->parser, child);
-            if (!hmap_has_cstr(ctx->declared_vars, string_cstr(name)))
-                emit_var_decl(ctx, string_cstr(name));
-            string_destroy(name);
+            strview_t name = parser_node_view(ctx->parser, child);
+            if (!hmap_has_view(ctx->declared_vars, name))
+                emit_var_decl(ctx, name);
         }
-        return;
+        child_iter_end(&it);
+        return WALK_SKIP;
     }
-    if (strcmp(type, NODE_FOR) == 0) return; // loop var declared inline in for-header
+    if (strcmp(type, NODE_FOR) == 0) return WALK_SKIP; // loop var declared inline in for-header
+
+    return WALK_CONTINUE;
+}
 
-    uint32_t count = ts_node_child_count(node);
-    for (uint32_t i = 0; i < count; i++)
-        hoist_vars(ctx, ts_node_child(node, i));
+static void hoist_vars(transpiler_t* ctx, TSNode node) {
+    if (ts_node_is_null(node) || ctx->ops.is_pascal || !ctx->declared_vars) return;
+    tree_walk(node, hoist_var, ctx);
 }
 
 // ─── Pass 2: Expression emitter ──────────────────────────────────────────────
@@ -198,11 +197,11 @@ static void gen_expr(transpiler_t* ctx, TSNode node);
 static void gen_atom(transpiler_t* ctx, TSNode atom_node) {
     TSNode child = ts_node_child(atom_node, 0);
     const char* type = ts_node_type(child);
-    string_t* text = parser_node_text(ctx->parser, child);
-    const char* s  = string_cstr(text);
+    strview_t text = parser_node_view(ctx->parser, child);
+    const char* s  = text.data;
 
     if (strcmp(type, NODE_STRING) == 0) {
-        size_t len = string_length(text);
+        size_t len = text.len;
         if (ctx->ops.is_pascal) {
             // Emit single-quoted Pascal string; escape embedded single-quotes as ''
             emit(ctx, "'");
@@ -221,9 +220,8 @@ static void gen_atom(transpiler_t* ctx, TSNode atom_node) {
             emit(ctx, "\"");
         }
     } else {
-        emit(ctx, s);
+        emit_view(ctx, text);
     }
-    string_destroy(text);
 }
 
 static void gen_expr(transpiler_t* ctx, TSNode node) {
@@ -289,14 +287,13 @@ static void gen_expr(transpiler_t* ctx, TSNode node) {
         TSNode left_node = parser_child_by_field(node, "left");
         TSNode op_node   = parser_child_by_field(node, "op");
         TSNode right_node= parser_child_by_field(node, "right");
-        string_t* op_str = parser_node_text(ctx->parser, op_node);
-        const char* op   = string_cstr(op_str);
+        strview_t op     = parser_node_view(ctx->parser, op_node);
 
-        const char* mapped_op = op;
-        if (strcmp(op, "=") == 0)  mapped_op = ctx->ops.eq_op;
-        if (strcmp(op, "!=") == 0) mapped_op = ctx->ops.ne_op;
+        const char* mapped_op = NULL;
+        if (strview_equals(op, "="))  mapped_op = ctx->ops.eq_op;
+        if (strview_equals(op, "!=")) mapped_op = ctx->ops.ne_op;
 
-        if (strcmp(op, "%") == 0) {
+        if (strview_equals(op, "%")) {
             if (ctx->ops.is_pascal) {
                 gen_expr(ctx, left_node);
                 emit(ctx, " mod ");
@@ -318,10 +315,10 @@ static void gen_expr(transpiler_t* ctx, TSNode node) {
             }
         } else {
             gen_expr(ctx, left_node);
-            emit_fmt(ctx, " %s ", mapped_op);
+            if (mapped_op) emit_fmt(ctx, " %s ", mapped_op);
+            else           emit_fmt(ctx, " " SV_FMT " ", SV_ARG(op));
             gen_expr(ctx, right_node);
         }
-        string_destroy(op_str);
         return;
     }
 
@@ -349,9 +346,7 @@ static void gen_expr(transpiler_t* ctx, TSNode node) {
             if (strcmp(ts_node_type(unwrapped), NODE_MUL_EXPR) == 0) {
                 TSNode op_node = parser_child_by_field(unwrapped, "op");
                 if (!ts_node_is_null(op_node)) {
-                    string_t* op_text = parser_node_text(ctx->parser, op_node);
-                    is_div = strcmp(string_cstr(op_text), "/") == 0;
-                    string_destroy(op_text);
+                    is_div = strview_equals(parser_node_view(ctx->parser, op_node), "/");
                 }
             }
             if (is_div) {
@@ -371,14 +366,12 @@ static void gen_expr(transpiler_t* ctx, TSNode node) {
             bool int_div = false;
             if (strcmp(ts_node_type(inner_op), NODE_MUL_EXPR) == 0) {
                 TSNode op_n = parser_child_by_field(inner_op, "op");
-                string_t* op_t = parser_node_text(ctx->parser, op_n);
-                if (strcmp(string_cstr(op_t), "/") == 0) {
+                if (strview_equals(parser_node_view(ctx->parser, op_n), "/")) {
                     TSNode left  = parser_child_by_field(inner_op, "left");
                     TSNode right = parser_child_by_field(inner_op, "right");
                     int_div = (infer_expr_type(ctx, left)  == VAR_INT &&
                                infer_expr_type(ctx, right) == VAR_INT);
                 }
-                string_destroy(op_t);
             }
             if (int_div) {
                 emit(ctx, "(");
@@ -394,9 +387,7 @@ static void gen_expr(transpiler_t* ctx, TSNode node) {
     }
 
     // Fallback: emit source text
-    string_t* text = parser_node_text(ctx->parser, node);
-    emit(ctx, string_cstr(text));
-    string_destroy(text);
+    emit_view(ctx, parser_node_view(ctx->parser, node));
 }
 
 // ─── Statement emitter helpers ────────────────────────────────────────────────
@@ -410,9 +401,9 @@ static void gen_expr(transpiler_t* ctx, TSNode node);
 // Also handles "[var_name / int_expr]" → "var_name /= int_expr;\n".
 // Caller has already emitted indentation; this function emits the rest of the line.
 // Returns false if the pattern doesn't match (caller should emit normally).
-static bool try_emit_compound(transpiler_t* ctx, const char* var_name, TSNode value_node) {
+static bool try_emit_compound(transpiler_t* ctx, strview_t var_name, TSNode value_node) {
     if (ctx->ops.is_pascal || !ctx->declared_vars) return false;
-    if (!hmap_has_cstr(ctx->declared_vars, var_name)) return false;
+    if (!hmap_has_view(ctx->declared_vars, var_name)) return false;
 
     TSNode val = unwrap_expr(value_node);
 
@@ -421,16 +412,13 @@ static bool try_emit_compound(transpiler_t* ctx, const char* var_name, TSNode va
         TSNode inner = unwrap_expr(parser_child_by_field(val, "operand"));
         if (strcmp(ts_node_type(inner), NODE_MUL_EXPR) == 0) {
             TSNode op_n = parser_child_by_field(inner, "op");
-            string_t* op_t = parser_node_text(ctx->parser, op_n);
-            bool is_div = strcmp(string_cstr(op_t), "/") == 0;
-            string_destroy(op_t);
-            if (is_div) {
+            if (strview_equals(parser_node_view(ctx->parser, op_n), "/")) {
                 TSNode left  = parser_child_by_field(inner, "left");
                 TSNode right = parser_child_by_field(inner, "right");
                 if (node_is_ident(ctx, left, var_name) &&
                     infer_expr_type(ctx, left)  == VAR_INT &&
                     infer_expr_type(ctx, right) == VAR_INT) {
-                    emit_fmt(ctx, "%s /= ", var_name);
+                    emit_fmt(ctx, SV_FMT " /= ", SV_ARG(var_name));
                     gen_expr(ctx, right);
                     emit(ctx, ";\n");
                     return true;
@@ -447,15 +435,14 @@ static bool try_emit_compound(transpiler_t* ctx, const char* var_name, TSNode va
     TSNode left_n  = parser_child_by_field(val, "left");
     TSNode op_n    = parser_child_by_field(val, "op");
     TSNode right_n = parser_child_by_field(val, "right");
-    string_t* op_t = parser_node_text(ctx->parser, op_n);
-    const char* op = string_cstr(op_t);
+    strview_t op   = parser_node_view(ctx->parser, op_n);
 
     const char* compound   = NULL;
     bool        commutative = false;
-    if      (strcmp(op, "+") == 0) { compound = "+="; commutative = true; }
-    else if (strcmp(op, "-") == 0) { compound = "-="; }
-    else if (strcmp(op, "*") == 0) { compound = "*="; commutative = true; }
-    else if (strcmp(op, "%") == 0) {
+    if      (strview_equals(op, "+")) { compound = "+="; commutative = true; }
+    else if (strview_equals(op, "-")) { compound = "-="; }
+    else if (strview_equals(op, "*")) { compound = "*="; commutative = true; }
+    else if (strview_equals(op, "%")) {
         var_type_t lt = infer_expr_type(ctx, left_n);
         var_type_t rt = infer_expr_type(ctx, right_n);
         if (lt != VAR_DOUBLE && rt != VAR_DOUBLE) compound = "%=";
@@ -466,20 +453,20 @@ static bool try_emit_compound(transpiler_t* ctx, const char* var_name, TSNode va
         if (node_is_ident(ctx, left_n, var_name)) {
             bool rhs_one = node_is_literal_one(ctx, right_n);
             if (rhs_one && strcmp(compound, "+=") == 0)
-                emit_fmt(ctx, "%s++", var_name);
+                emit_fmt(ctx, SV_FMT "++", SV_ARG(var_name));
             else if (rhs_one && strcmp(compound, "-=") == 0)
-                emit_fmt(ctx, "%s--", var_name);
+                emit_fmt(ctx, SV_FMT "--", SV_ARG(var_name));
             else {
-                emit_fmt(ctx, "%s %s ", var_name, compound);
+                emit_fmt(ctx, SV_FMT " %s ", SV_ARG(var_name), compound);
                 gen_expr(ctx, right_n);
             }
             emit(ctx, ";\n");
             result = true;
         } else if (commutative && node_is_ident(ctx, right_n, var_name)) {
             if (strcmp(compound, "+=") == 0 && node_is_literal_one(ctx, left_n))
-                emit_fmt(ctx, "%s++", var_name);
+                emit_fmt(ctx, SV_FMT "++", SV_ARG(var_name));
             else {
-                emit_fmt(ctx, "%s %s ", var_name, compound);
+                emit_fmt(ctx, SV_FMT " %s ", SV_ARG(var_name), compound);
                 gen_expr(ctx, left_n);
             }
             emit(ctx, ";\n");
@@ -487,13 +474,12 @@ static bool try_emit_compound(transpiler_t* ctx, const char* var_name, TSNode va
         }
     }
 
-    string_destroy(op_t);
     return result;
 }
 
 // Get the C type string for a variable
-static const char* c_type_for(transpiler_t* ctx, const char* var_name) {
-    const char* t = hmap_get_cstr(ctx->var_types, var_name);
+static const char* c_type_for(transpiler_t* ctx, strview_t var_name) {
+    const char* t = hmap_get_view(ctx->var_types, var_name);
     if (!t) return "double";
     if (strcmp(t, "int") == 0) return "int";
     if (strcmp(t, "string") == 0) return ctx->ops.is_cpp ? "string" : "char";
@@ -503,51 +489,43 @@ static const char* c_type_for(transpiler_t* ctx, const char* var_name) {
 static void emit_assign(transpiler_t* ctx, TSNode node) {
     TSNode name_node  = parser_child_by_field(node, "name");
     TSNode value_node = parser_child_by_field(node, "value");
-    string_t* name    = parser_node_text(ctx->parser, name_node);
-    const char* n     = string_cstr(name);
+    strview_t n       = parser_node_view(ctx->parser, name_node);
     emit_indent(ctx);
 
     // C strings use strcpy, not assignment
     if (!ctx->ops.is_pascal && !ctx->ops.is_cpp) {
-        const char* t = hmap_get_cstr(ctx->var_types, n);
+        const char* t = hmap_get_view(ctx->var_types, n);
         if (t && strcmp(t, "string") == 0) {
-            if (!hmap_has_cstr(ctx->declared_vars, n)) {
-                emit_fmt(ctx, "char %s[256] = ", n);
+            if (!hmap_has_view(ctx->declared_vars, n)) {
+                emit_fmt(ctx, "char " SV_FMT "[256] = ", SV_ARG(n));
                 gen_expr(ctx, value_node);
                 emit(ctx, ";\n");
-                hmap_set_cstr(ctx->declared_vars, n, "1");
+                hmap_set_view(ctx->declared_vars, n, "1");
             } else {
-                emit_fmt(ctx, "strcpy(%s, ", n);
+                emit_fmt(ctx, "strcpy(" SV_FMT ", ", SV_ARG(n));
                 gen_expr(ctx, value_node);
                 emit(ctx, ");\n");
             }
-            string_destroy(name);
             return;
         }
     }
 
     // Try compound assignment (x += y, x *= y, x /= y, etc.) for already-declared vars
-    if (try_emit_compound(ctx, n, value_node)) {
-        string_destroy(name);
-        return;
-    }
+    if (try_emit_compound(ctx, n, value_node)) return;
 
     bool was_c_str = maybe_declare(ctx, n);
     (void)was_c_str;
-    emit(ctx, n);
+    emit_view(ctx, n);
     emit_fmt(ctx, " %s ", ctx->ops.assign_op);
     gen_expr(ctx, value_node);
     emit(ctx, ";\n");
-    string_destroy(name);
 }
 
 static void emit_swap(transpiler_t* ctx, TSNode node) {
     TSNode left_node  = parser_child_by_field(node, "left");
     TSNode right_node = parser_child_by_field(node, "right");
-    string_t* left    = parser_node_text(ctx->parser, left_node);
-    string_t* right   = parser_node_text(ctx->parser, right_node);
-    const char* ln    = string_cstr(left);
-    const char* rn    = string_cstr(right);
+    strview_t ln      = parser_node_view(ctx->parser, left_node);
+    strview_t rn      = parser_node_view(ctx->parser, right_node);
     const char* ttype = c_type_for(ctx, ln);
 
     char tmp[32];
@@ -557,9 +535,9 @@ static void emit_swap(transpiler_t* ctx, TSNode node) {
         // Temp var is pre-declared in the var block by collect_swap_temps.
         emit_indent(ctx); emit(ctx, "begin\n");
         ctx->indent++;
-        emit_indent(ctx); emit_fmt(ctx, "%s := %s;\n", tmp, ln);
-        emit_indent(ctx); emit_fmt(ctx, "%s := %s;\n", ln, rn);
-        emit_indent(ctx); emit_fmt(ctx, "%s := %s;\n", rn, tmp);
+        emit_indent(ctx); emit_fmt(ctx, "%s := " SV_FMT ";\n", tmp, SV_ARG(ln));
+        emit_indent(ctx); emit_fmt(ctx, SV_FMT " := " SV_FMT ";\n", SV_ARG(ln), SV_ARG(rn));
+        emit_indent(ctx); emit_fmt(ctx, SV_FMT " := %s;\n", SV_ARG(rn), tmp);
         ctx->indent--;
         emit_indent(ctx); emit(ctx, "end;\n");
     } else {
@@ -567,125 +545,119 @@ static void emit_swap(transpiler_t* ctx, TSNode node) {
         // For C, use the inferred type; for C++ with string use std::swap
         if (ctx->ops.is_cpp && strcmp(ttype, "string") == 0) {
             emit_indent(ctx);
-            emit_fmt(ctx, "swap(%s, %s);\n", ln, rn);
+            emit_fmt(ctx, "swap(" SV_FMT ", " SV_FMT ");\n", SV_ARG(ln), SV_ARG(rn));
         } else {
             // Determine full type string for char array
             bool is_str = (strcmp(ttype, "char") == 0);
             emit_indent(ctx);
             if (is_str)
-                emit_fmt(ctx, "{ char %s[256]; strcpy(%s, %s); strcpy(%s, %s); strcpy(%s, %s); }\n",
-                    tmp, tmp, ln, ln, rn, rn, tmp);
+                emit_fmt(ctx, "{ char %s[256]; strcpy(%s, " SV_FMT "); strcpy(" SV_FMT ", " SV_FMT "); strcpy(" SV_FMT ", %s); }\n",
+                    tmp, tmp, SV_ARG(ln), SV_ARG(ln), SV_ARG(rn), SV_ARG(rn), tmp);
             else
-                emit_fmt(ctx, "{ %s %s = %s; %s = %s; %s = %s; }\n",
-                    ttype, tmp, ln, ln, rn, rn, tmp);
+                emit_fmt(ctx, "{ %s %s = " SV_FMT "; " SV_FMT " = " SV_FMT "; " SV_FMT " = %s; }\n",
+                    ttype, tmp, SV_ARG(ln), SV_ARG(ln), SV_ARG(rn), SV_ARG(rn), tmp);
         }
     }
-    string_destroy(left);
-    string_destroy(right);
 }
 
 static void emit_read(transpiler_t* ctx, TSNode node) {
     TSNode names_node = parser_child_by_field(node, "names");
-    uint32_t count    = ts_node_child_count(names_node);
 
     if (ctx->ops.is_pascal) {
         // Pascal: read(a, b, c);
         emit_indent(ctx);
         emit(ctx, "read(");
         bool first = true;
-        for (uint32_t i = 0; i < count; i++) {
-            TSNode child = ts_node_child(names_node, i);
+        child_iter_t it = child_iter_start(names_node);
+        for (TSNode child; child_iter_next(&it, &child); ) {
             if (strcmp(ts_node_type(child), NODE_IDENTIFIER) != 0) continue;
             if (!first) emit(ctx, ", ");
             first = false;
-            string_t* name = parser_node_text(ctx->parser, child);
-            emit(ctx, string_cstr(name));
-            string_destroy(name);
+            emit_view(ctx, parser_node_view(ctx->parser, child));
         }
+        child_iter_end(&it);
         emit(ctx, ");\n");
     } else if (ctx->ops.is_cpp) {
         // C++: declare undeclared vars first, then cin >> a >> b >> c;
-        for (uint32_t i = 0; i < count; i++) {
-            TSNode child = ts_node_child(names_node, i);
+        child_iter_t it = child_iter_start(names_node);
+        for (TSNode child; child_iter_next(&it, &child); ) {
             if (strcmp(ts_node_type(child), NODE_IDENTIFIER) != 0) continue;
-            string_t* name = parser_node_text(ctx->parser, child);
-            const char* n  = string_cstr(name);
-            if (ctx->declared_vars && !hmap_has_cstr(ctx->declared_vars, n)) {
-                const char* t = hmap_get_cstr(ctx->var_types, n);
+            strview_t n    = parser_node_view(ctx->parser, child);
+            if (ctx->declared_vars && !hmap_has_view(ctx->declared_vars, n)) {
+                const char* t = hmap_get_view(ctx->var_types, n);
                 emit_indent(ctx);
-                if (t && strcmp(t, "string") == 0) emit_fmt(ctx, "string %s;\n", n);
-                else if (t && strcmp(t, "double") == 0) emit_fmt(ctx, "double %s;\n", n);
-                else emit_fmt(ctx, "int %s;\n", n);
-                hmap_set_cstr(ctx->declared_vars, n, "1");
+                if (t && strcmp(t, "string") == 0) emit_fmt(ctx, "string " SV_FMT ";\n", SV_ARG(n));
+                else if (t && strcmp(t, "double") == 0) emit_fmt(ctx, "double " SV_FMT ";\n", SV_ARG(n));
+                else emit_fmt(ctx, "int " SV_FMT ";\n", SV_ARG(n));
+                hmap_set_view(ctx->declared_vars, n, "1");
             }
-            string_destroy(name);
         }
+        child_iter_end(&it);
         emit_indent(ctx);
         emit(ctx, "cin");
-        for (uint32_t i = 0; i < count; i++) {
-            TSNode child = ts_node_child(names_node, i);
+        it = child_iter_start(names_node);
+        for (TSNode child; child_iter_next(&it, &child); ) {
             if (strcmp(ts_node_type(child), NODE_IDENTIFIER) != 0) continue;
-            string_t* name = parser_node_text(ctx->parser, child);
-            emit_fmt(ctx, " >> %s", string_cstr(name));
-            string_destroy(name);
+            emit_fmt(ctx, " >> " SV_FMT, SV_ARG(parser_node_view(ctx->parser, child)));
         }
+        child_iter_end(&it);
         emit(ctx, ";\n");
     } else {
         // C: one scanf per variable, declare inline if needed
-        for (uint32_t i = 0; i < count; i++) {
-            TSNode child = ts_node_child(names_node, i);
+        child_iter_t it = child_iter_start(names_node);
+        for (TSNode child; child_iter_next(&it, &child); ) {
             if (strcmp(ts_node_type(child), NODE_IDENTIFIER) != 0) continue;
-            string_t* name = parser_node_text(ctx->parser, child);
-            const char* n  = string_cstr(name);
-            const char* t  = hmap_get_cstr(ctx->var_types, n);
+            strview_t n    = parser_node_view(ctx->parser, child);
+            const char* t  = hmap_get_view(ctx->var_types, n);
             bool is_str    = t && strcmp(t, "string") == 0;
             bool is_int    = t && strcmp(t, "int") == 0;
-            if (ctx->declared_vars && !hmap_has_cstr(ctx->declared_vars, n)) {
+            if (ctx->declared_vars && !hmap_has_view(ctx->declared_vars, n)) {
                 emit_indent(ctx);
-                if (is_str)       emit_fmt(ctx, "char %s[256];\n", n);
-                else if (is_int)  emit_fmt(ctx, "int %s;\n", n);
-                else              emit_fmt(ctx, "double %s;\n", n);
-                hmap_set_cstr(ctx->declared_vars, n, "1");
+                if (is_str)       emit_fmt(ctx, "char " SV_FMT "[256];\n", SV_ARG(n));
+                else if (is_int)  emit_fmt(ctx, "int " SV_FMT ";\n", SV_ARG(n));
+                else              emit_fmt(ctx, "double " SV_FMT ";\n", SV_ARG(n));
+                hmap_set_view(ctx->declared_vars, n, "1");
             }
             emit_indent(ctx);
-            if (is_str)       emit_fmt(ctx, "scanf(\"%%s\", %s);\n", n);
-            else if (is_int)  emit_fmt(ctx, "scanf(\"%%d\", &%s);\n", n);
-            else              emit_fmt(ctx, "scanf(\"%%lf\", &%s);\n", n);
-            string_destroy(name);
+            if (is_str)       emit_fmt(ctx, "scanf(\"%%s\", " SV_FMT ");\n", SV_ARG(n));
+            else if (is_int)  emit_fmt(ctx, "scanf(\"%%d\", &" SV_FMT ");\n", SV_ARG(n));
+            else              emit_fmt(ctx, "scanf(\"%%lf\", &" SV_FMT ");\n", SV_ARG(n));
         }
+        child_iter_end(&it);
     }
 }
 
 static void emit_write(transpiler_t* ctx, TSNode node) {
     TSNode expr_list = parser_child_by_field(node, "values");
-    uint32_t count   = ts_node_child_count(expr_list);
 
     if (ctx->ops.is_pascal) {
         emit_indent(ctx);
         emit(ctx, "write(");
         bool first = true;
-        for (uint32_t i = 0; i < count; i++) {
-            TSNode child = ts_node_child(expr_list, i);
+        child_iter_t it = child_iter_start(expr_list);
+        for (TSNode child; child_iter_next(&it, &child); ) {
             if (strcmp(ts_node_type(child), ",") == 0) continue;
             if (!first) emit(ctx, ", ");
             first = false;
             gen_expr(ctx, child);
         }
+        child_iter_end(&it);
         emit(ctx, ");\n");
     } else if (ctx->ops.is_cpp) {
         emit_indent(ctx);
         emit(ctx, "cout");
-        for (uint32_t i = 0; i < count; i++) {
-            TSNode child = ts_node_child(expr_list, i);
+        child_iter_t it = child_iter_start(expr_list);
+        for (TSNode child; child_iter_next(&it, &child); ) {
             if (strcmp(ts_node_type(child), ",") == 0) continue;
             emit(ctx, " << ");
             gen_expr(ctx, child);
         }
+        child_iter_end(&it);
         emit(ctx, ";\n");
     } else {
         // C: one printf per expression
-        for (uint32_t i = 0; i < count; i++) {
-            TSNode child = ts_node_child(expr_list, i);
+        child_iter_t it = child_iter_start(expr_list);
+        for (TSNode child; child_iter_next(&it, &child); ) {
             if (strcmp(ts_node_type(child), ",") == 0) continue;
             var_type_t t = infer_expr_type(ctx, child);
             emit_indent(ctx);
@@ -719,25 +691,25 @@ static void emit_write(transpiler_t* ctx, TSNode node) {
                 emit(ctx, ");\n");
             }
         }
+        child_iter_end(&it);
     }
 }
 
 // Emit the body of a control structure (iterates NODE_STMT children)
 static void gen_block(transpiler_t* ctx, TSNode parent) {
-    uint32_t count = ts_node_child_count(parent);
-    for (uint32_t i = 0; i < count; i++) {
-        TSNode child = ts_node_child(parent, i);
+    child_iter_t it = child_iter_start(parent);
+    for (TSNode child; child_iter_next(&it, &child); ) {
         if (!parser_node_is_type(child, NODE_STMT)) continue;
         TSNode actual = ts_node_child(child, 0);
         gen_stmt(ctx, actual);
     }
+    child_iter_end(&it);
 }
 
 // Emit the body of a MULTI_STMT (children are direct statements, no NODE_STMT wrapper)
 static void gen_multi_block(transpiler_t* ctx, TSNode node) {
-    uint32_t count = ts_node_child_count(node);
-    for (uint32_t i = 0; i < count; i++) {
-        TSNode child = ts_node_child(node, i);
+    child_iter_t it = child_iter_start(node);
+    for (TSNode child; child_iter_next(&it, &child); ) {
         const char* t = ts_node_type(child);
         if (strcmp(t, ";") == 0) continue;
         if (strcmp(t, NODE_ASSIGN) == 0 || strcmp(t, NODE_SWAP) == 0 ||
@@ -745,6 +717,7 @@ static void gen_multi_block(transpiler_t* ctx, TSNode node) {
             gen_stmt(ctx, child);
         }
     }
+    child_iter_end(&it);
 }
 
 static void emit_open_block(transpiler_t* ctx) {
@@ -798,19 +771,10 @@ static void gen_stmt(transpiler_t* ctx, TSNode node) {
         emit_open_block(ctx);
 
         // Walk children: emit then-branch, handle altfel, stop at sf
-        uint32_t count = ts_node_child_count(node);
-        bool in_else = false;
-        bool has_else = false;
-        // First pass: check if there's an else branch
-        for (uint32_t i = 0; i < count; i++) {
-            if (strcmp(ts_node_type(ts_node_child(node, i)), "altfel") == 0) { has_else = true; break; }
-        }
-
-        for (uint32_t i = 0; i < count; i++) {
-            TSNode child = ts_node_child(node, i);
+        child_iter_t it = child_iter_start(node);
+        for (TSNode child; child_iter_next(&it, &child); ) {
             const char* ct = ts_node_type(child);
             if (strcmp(ct, "altfel") == 0) {
-                in_else = true;
                 emit_close_block(ctx);
                 if (ctx->ops.is_pascal) emit(ctx, "\n");
                 else emit(ctx, "\n");
@@ -821,14 +785,13 @@ static void gen_stmt(transpiler_t* ctx, TSNode node) {
             }
             if (strcmp(ct, "sf") == 0) break;
             if (!parser_node_is_type(child, NODE_STMT)) continue;
-            (void)in_else;
             TSNode actual = ts_node_child(child, 0);
             gen_stmt(ctx, actual);
         }
+        child_iter_end(&it);
         emit_close_block(ctx);
         if (ctx->ops.is_pascal) emit(ctx, ";");
         emit(ctx, "\n");
-        (void)has_else;
         return;
     }
 
@@ -837,42 +800,39 @@ static void gen_stmt(transpiler_t* ctx, TSNode node) {
         TSNode start_node = parser_child_by_field(node, "start");
         TSNode end_node   = parser_child_by_field(node, "end");
         TSNode step_node  = parser_child_by_field(node, "step");
-        string_t* var     = parser_node_text(ctx->parser, var_node);
-        const char* vn    = string_cstr(var);
+        strview_t vn      = parser_node_view(ctx->parser, var_node);
 
         bool has_step = !ts_node_is_null(step_node);
         // Check if step is a simple literal "1" or "-1"
         bool step_is_one = true;
         bool step_is_neg = false;
         if (has_step) {
-            string_t* step_text = parser_node_text(ctx->parser, step_node);
-            const char* st = string_cstr(step_text);
-            step_is_neg = (strcmp(st, "-1") == 0);
-            step_is_one = (strcmp(st, "1") == 0 || strcmp(st, "-1") == 0);
-            string_destroy(step_text);
+            strview_t st = parser_node_view(ctx->parser, step_node);
+            step_is_neg = strview_equals(st, "-1");
+            step_is_one = strview_equals(st, "1") || step_is_neg;
         }
 
         if (ctx->ops.is_pascal && has_step && !step_is_one) {
             // Pascal can't do arbitrary steps in for — emit while equivalent
             emit_indent(ctx);
-            emit_fmt(ctx, "%s := ", vn);
+            emit_fmt(ctx, SV_FMT " := ", SV_ARG(vn));
             gen_expr(ctx, start_node);
             emit(ctx, ";\n");
             emit_indent(ctx);
             emit(ctx, "while ");
-            emit_fmt(ctx, "%s <= ", vn);
+            emit_fmt(ctx, SV_FMT " <= ", SV_ARG(vn));
             gen_expr(ctx, end_node);
             emit(ctx, " do");
             emit_open_block(ctx);
             gen_block(ctx, node);
-            emit_indent(ctx); emit_fmt(ctx, "%s := %s + ", vn, vn);
+            emit_indent(ctx); emit_fmt(ctx, SV_FMT " := " SV_FMT " + ", SV_ARG(vn), SV_ARG(vn));
             gen_expr(ctx, step_node);
             emit(ctx, ";\n");
             emit_close_block(ctx);
             emit(ctx, ";\n");
         } else if (ctx->ops.is_pascal) {
             emit_indent(ctx);
-            emit_fmt(ctx, "for %s := ", vn);
+            emit_fmt(ctx, "for " SV_FMT " := ", SV_ARG(vn));
             gen_expr(ctx, start_node);
             emit(ctx, step_is_neg ? " downto " : " to ");
             gen_expr(ctx, end_node);
@@ -885,10 +845,8 @@ static void gen_stmt(transpiler_t* ctx, TSNode node) {
             // C / C++
             const char* cmp_op = " <= ";
             if (has_step) {
-                string_t* step_text = parser_node_text(ctx->parser, step_node);
-                const char* st = string_cstr(step_text);
-                if (st[0] == '-') cmp_op = " >= ";
-                string_destroy(step_text);
+                strview_t st = parser_node_view(ctx->parser, step_node);
+                if (st.len > 0 && st.data[0] == '-') cmp_op = " >= ";
             }
             emit_indent(ctx);
             // Always declare the loop variable in the for header so it is
@@ -898,16 +856,16 @@ static void gen_stmt(transpiler_t* ctx, TSNode node) {
                 emit(ctx, "for (int ");
             else
                 emit(ctx, "for (");
-            emit_fmt(ctx, "%s = ", vn);
+            emit_fmt(ctx, SV_FMT " = ", SV_ARG(vn));
             gen_expr(ctx, start_node);
-            emit_fmt(ctx, "; %s%s", vn, cmp_op);
+            emit_fmt(ctx, "; " SV_FMT "%s", SV_ARG(vn), cmp_op);
             gen_expr(ctx, end_node);
             if (!has_step || (step_is_one && !step_is_neg))
-                emit_fmt(ctx, "; %s++", vn);
+                emit_fmt(ctx, "; " SV_FMT "++", SV_ARG(vn));
             else if (step_is_one && step_is_neg)
-                emit_fmt(ctx, "; %s--", vn);
+                emit_fmt(ctx, "; " SV_FMT "--", SV_ARG(vn));
             else {
-                emit_fmt(ctx, "; %s += ", vn);
+                emit_fmt(ctx, "; " SV_FMT " += ", SV_ARG(vn));
                 gen_expr(ctx, step_node);
             }
             emit(ctx, ")");
@@ -916,7 +874,6 @@ static void gen_stmt(transpiler_t* ctx, TSNode node) {
             emit_close_block(ctx);
             emit(ctx, "\n");
         }
-        string_destroy(var);
         return;
     }
 
@@ -1103,28 +1060,31 @@ char* transpile(parser_t* parser, transpile_lang_t lang) {
 
     TSNode root = parser_root(parser);
 
+    TRACE_BEGIN("transpile");
+
     // Pass 1: collect variable declarations
+    TRACE_BEGIN("collect_vars");
     collect_vars(&ctx, root);
+    TRACE_END_COUNT("collect_vars", "vars", hashmap_size(ctx.var_types));
 
     // Pass 1.5 (Pascal only): pre-declare swap temp vars so they appear in the var block
     if (ctx.ops.is_pascal) {
+        TRACE_BEGIN("collect_swap_temps");
         collect_swap_temps(&ctx, root);
+        TRACE_END_COUNT("collect_swap_temps", "temps", ctx.tmp_count);
         ctx.tmp_count = 0;  // Reset so Pass 2 generates the same names in the same order
     }
 
     // Pass 2: emit code
+    TRACE_BEGIN("codegen");
     emit_preamble(&ctx);
 
     // Iterate program-level statements (root has NODE_STMT children)
-    uint32_t count = ts_node_child_count(root);
-    for (uint32_t i = 0; i < count; i++) {
-        TSNode child = ts_node_child(root, i);
-        if (!parser_node_is_type(child, NODE_STMT)) continue;
-        TSNode actual = ts_node_child(child, 0);
-        gen_stmt(&ctx, actual);
-    }
+    gen_block(&ctx, root);
 
     emit_postamble(&ctx);
+    TRACE_END_COUNT("codegen", "bytes", string_length(ctx.out));
+    TRACE_END("transpile");
 
     // Convert to malloc'd char*
     size_t len = string_length(ctx.out);
@@ -1141,19 +1101,14 @@ char* transpile(parser_t* parser, transpile_lang_t lang) {
 char* transpile_source(const char* source, transpile_lang_t lang, char** error_out) {
     if (!source) return NULL;
 
-    string_t* src    = string_create_from(source);
-    string_t* linted = lint(src);
-    string_destroy(src);
-
     parser_t* parser = parser_create();
     if (!parser) {
-        string_destroy(linted);
         if (error_out) *error_out = strdup("Nu s-a putut crea parser-ul");
         return NULL;
     }
 
-    parser_error_t err = parser_parse(parser, linted);
-    string_destroy(linted);
+    // The parser only lives for this call, so it can borrow the source
+    parser_error_t err = parser_parse_source(parser, source, strlen(source), true);
 
     if (err.type != PARSER_OK) {
         if (error_out && err.message) {
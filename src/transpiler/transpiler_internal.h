@@ -5,6 +5,7 @@
 #include "pseudo/hashmap.h"
 #include "pseudo/string.h"
 #include "pseudo/parser.h"
+#include "pseudo/tree_walk.h"
 #include <stdbool.h>
 
 typedef enum { VAR_DOUBLE, VAR_INT, VAR_STRING } var_type_t;
@@ -38,6 +39,9 @@ typedef struct {
 void hmap_set_cstr(hashmap_t* map, const char* key, const char* val);
 const char* hmap_get_cstr(hashmap_t* map, const char* key);
 bool hmap_has_cstr(hashmap_t* map, const char* key);
+void hmap_set_view(hashmap_t* map, strview_t key, const char* val);
+const char* hmap_get_view(hashmap_t* map, strview_t key);
+bool hmap_has_view(hashmap_t* map, strview_t key);
 
 // Variable collection passes (from transpiler_collect.c, used by transpiler.c)
 void collect_vars(transpiler_t* ctx, TSNode node);
@@ -1,8 +1,11 @@
 #include "pseudo/runtime.h"
 #include "pseudo/debugger.h"
+#include "pseudo/profile.h"
 #include "pseudo/linter.h"
 #include "pseudo/transpiler.h"
 #include "pseudo/equivalence.h"
+#include "pseudo/session.h"
+#include "pseudo/highlight.h"
 #include "pseudo/string.h"
 #include "pseudo/io.h"
 #include <emscripten.h>
@@ -10,10 +13,35 @@
 #include <string.h>
 #include <stdio.h>
 
+// Undrained output after which a step returns EXEC_OUTPUT_FULL, so a
+// runaway printer cannot exhaust the tab's memory between drains
+#define DEFAULT_OUTPUT_CAPACITY (1024 * 1024)
+
 static runtime_t* g_runtime = NULL;
-static io_t* g_io = NULL;
+static io_t* g_io = NULL;      // Buffered backend the host talks to
+static io_t* g_replay = NULL;  // Wraps g_io for the runtime (time travel)
 static const char* g_init_error = NULL;
 
+static void append_json_string(string_t* out, const char* s, size_t len) {
+    string_append_char(out, '"');
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c == '"' || c == '\\') {
+            string_append_char(out, '\\');
+            string_append_char(out, (char)c);
+        } else if (c == '\t') {
+            string_append(out, "\\t");
+        } else if (c < 32) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            string_append(out, buf);
+        } else {
+            string_append_char(out, (char)c);
+        }
+    }
+    string_append_char(out, '"');
+}
+
 EMSCRIPTEN_KEEPALIVE
 int pseudo_init(void) {
     g_init_error = NULL;
@@ -22,21 +50,27 @@ int pseudo_init(void) {
         runtime_destroy(g_runtime);
         g_runtime = NULL;
     }
-    if (g_io) {
-        g_io->ops.destroy(g_io);
+    if (g_replay) {
+        io_destroy(g_replay);  // And g_io with it
+        g_replay = NULL;
         g_io = NULL;
     }
 
     g_io = io_buffered_create();
-    if (!g_io) {
+    g_replay = io_replay_create(g_io);
+    if (!g_replay) {
         g_init_error = "Failed to create I/O buffer";
+        io_destroy(g_io);
+        g_io = NULL;
         return 0;
     }
+    io_buffered_set_output_capacity(g_io, DEFAULT_OUTPUT_CAPACITY);
 
-    g_runtime = runtime_create(g_io);
+    g_runtime = runtime_create(g_replay);
     if (!g_runtime) {
         g_init_error = "Failed to create runtime (parser initialization failed)";
-        g_io->ops.destroy(g_io);
+        io_destroy(g_replay);
+        g_replay = NULL;
         g_io = NULL;
         return 0;
     }
@@ -67,12 +101,69 @@ int pseudo_run(void) {
     return (int)runtime_run(g_runtime);
 }
 
+// Profiling: pseudo_profile_start begins a profile (`timed`: also time
+// the lines), pseudo_run_profiled runs like pseudo_run adding to it, and
+// pseudo_get_profile_json reports it (see profile_json)
+static profile_t* g_profile = NULL;
+
+EMSCRIPTEN_KEEPALIVE
+int pseudo_profile_start(int timed) {
+    profile_destroy(g_profile);
+    g_profile = profile_create(timed != 0);
+    return g_profile ? 1 : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int pseudo_run_profiled(void) {
+    if (!g_runtime || !g_profile) return 1; // EXEC_DONE
+    return (int)runtime_run_profiled(g_runtime, g_profile);
+}
+
+// Caller frees with pseudo_free_output
+EMSCRIPTEN_KEEPALIVE
+char* pseudo_get_profile_json(void) {
+    if (!g_runtime || !g_profile) return NULL;
+    string_t* json = profile_json(g_profile, g_runtime);
+    if (!json) return NULL;
+
+    size_t len = string_length(json);
+    char* result = malloc(len + 1);
+    if (result) memcpy(result, string_cstr(json), len + 1);
+    string_destroy(json);
+    return result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void pseudo_profile_stop(void) {
+    profile_destroy(g_profile);
+    g_profile = NULL;
+}
+
 EMSCRIPTEN_KEEPALIVE
 int pseudo_step_over(void) {
     if (!g_runtime) return 1; // EXEC_DONE
     return (int)runtime_step_over(g_runtime);
 }
 
+// Debugger runs: stop at breakpoints, returning EXEC_CONTINUE there
+EMSCRIPTEN_KEEPALIVE
+int pseudo_continue(void) {
+    if (!g_runtime) return 1; // EXEC_DONE
+    return (int)runtime_continue(g_runtime);
+}
+
+EMSCRIPTEN_KEEPALIVE
+int pseudo_step_out(void) {
+    if (!g_runtime) return 1; // EXEC_DONE
+    return (int)runtime_step_out(g_runtime);
+}
+
+EMSCRIPTEN_KEEPALIVE
+int pseudo_run_to_line(int line) {
+    if (!g_runtime || line < 0) return 1; // EXEC_DONE
+    return (int)runtime_run_to_line(g_runtime, (uint32_t)line);
+}
+
 EMSCRIPTEN_KEEPALIVE
 int pseudo_get_stack_depth(void) {
     if (!g_runtime) return -1;
@@ -89,6 +180,50 @@ void pseudo_push_input(const char* value) {
     }
 }
 
+// Whole input text in one call: ptr comes from _malloc with len + 1 bytes
+// and is owned (and eventually freed) by the interpreter from here on
+EMSCRIPTEN_KEEPALIVE
+int pseudo_push_input_block(char* ptr, int len) {
+    if (!g_io || !ptr || len < 0) {
+        free(ptr);
+        return 0;
+    }
+    if (!io_buffered_push_input_block(g_io, ptr, (size_t)len)) return 0;
+    if (g_runtime) {
+        runtime_resume(g_runtime);
+    }
+    return 1;
+}
+
+// 0 = one value per line (default), 1 = one value per whitespace-separated token
+EMSCRIPTEN_KEEPALIVE
+void pseudo_set_input_mode(int tokens) {
+    if (!g_io) return;
+    io_buffered_set_input_mode(g_io, tokens ? IO_INPUT_TOKENS : IO_INPUT_LINES);
+}
+
+// Continue after EXEC_OUTPUT_FULL (once the output has been drained)
+EMSCRIPTEN_KEEPALIVE
+void pseudo_resume(void) {
+    if (g_runtime) {
+        runtime_resume(g_runtime);
+    }
+}
+
+// Undrained bytes that pause the program with EXEC_OUTPUT_FULL (0 = never)
+EMSCRIPTEN_KEEPALIVE
+void pseudo_set_output_capacity(int bytes) {
+    if (!g_io) return;
+    io_buffered_set_output_capacity(g_io, bytes > 0 ? (size_t)bytes : 0);
+}
+
+// Total bytes the program may write before it stops with an error (0 = unlimited)
+EMSCRIPTEN_KEEPALIVE
+void pseudo_set_output_limit(int bytes) {
+    if (!g_io) return;
+    io_set_output_limit(g_io, bytes > 0 ? (size_t)bytes : 0);
+}
+
 EMSCRIPTEN_KEEPALIVE
 int pseudo_has_output(void) {
     if (!g_io) return 0;
@@ -101,6 +236,20 @@ char* pseudo_pop_output(void) {
     return io_buffered_pop_output(g_io);
 }
 
+// Everything written since the last drain in one span: *out_ptr/*out_len
+// point into the output buffer (valid until the next step). Returns the length.
+EMSCRIPTEN_KEEPALIVE
+int pseudo_drain_output(const char** out_ptr, int* out_len) {
+    const char* data = NULL;
+    size_t len = 0;
+    if (g_io) {
+        io_buffered_drain_output(g_io, &data, &len);
+    }
+    if (out_ptr) *out_ptr = data;
+    if (out_len) *out_len = (int)len;
+    return (int)len;
+}
+
 EMSCRIPTEN_KEEPALIVE
 void pseudo_free_output(char* ptr) {
     free(ptr);
@@ -139,6 +288,32 @@ void pseudo_request_stop(void) {
     }
 }
 
+// === Memory accounting ===
+
+// Cap in bytes for the loaded program (0 = unlimited)
+EMSCRIPTEN_KEEPALIVE
+void pseudo_set_memory_limit(int bytes) {
+    if (g_runtime) {
+        runtime_set_memory_limit(g_runtime, bytes > 0 ? (size_t)bytes : 0);
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+int pseudo_get_memory_current(void) {
+    if (!g_runtime) return 0;
+    mem_stats_t stats;
+    runtime_get_memory_stats(g_runtime, &stats);
+    return (int)stats.current;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int pseudo_get_memory_peak(void) {
+    if (!g_runtime) return 0;
+    mem_stats_t stats;
+    runtime_get_memory_stats(g_runtime, &stats);
+    return (int)stats.peak;
+}
+
 // === Debugger exports ===
 
 EMSCRIPTEN_KEEPALIVE
@@ -189,6 +364,157 @@ int pseudo_get_snapshot_count(void) {
     return runtime_get_snapshot_count(g_runtime);
 }
 
+// Breakpoints, by 0-based line. `condition` may be NULL or empty; if it
+// does not compile this returns 0 and pseudo_get_breakpoint_error says why.
+static string_t* g_breakpoint_error = NULL;
+
+EMSCRIPTEN_KEEPALIVE
+int pseudo_set_breakpoint(int line, const char* condition, int hit_target) {
+    if (!g_runtime || line < 0) return 0;
+    string_destroy(g_breakpoint_error);
+    g_breakpoint_error = NULL;
+    return runtime_set_breakpoint(g_runtime, (uint32_t)line, condition,
+                                  hit_target > 0 ? (uint32_t)hit_target : 0,
+                                  &g_breakpoint_error) ? 1 : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+const char* pseudo_get_breakpoint_error(void) {
+    return g_breakpoint_error ? string_cstr(g_breakpoint_error) : NULL;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void pseudo_clear_breakpoint(int line) {
+    if (g_runtime && line >= 0) {
+        runtime_clear_breakpoint(g_runtime, (uint32_t)line);
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+void pseudo_clear_breakpoints(void) {
+    if (g_runtime) {
+        runtime_clear_breakpoints(g_runtime);
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+int pseudo_get_breakpoint_hits(int line) {
+    if (!g_runtime || line < 0) return 0;
+    return (int)runtime_get_breakpoint_hits(g_runtime, (uint32_t)line);
+}
+
+// Watchpoints, by variable name. `kind` is a watch_kind_t, `arg` its
+// expression (unused for WATCH_CHANGE); if refused this returns 0 and
+// pseudo_get_breakpoint_error says why.
+EMSCRIPTEN_KEEPALIVE
+int pseudo_set_watch(const char* name, int kind, const char* arg) {
+    if (!g_runtime || kind < WATCH_CHANGE || kind > WATCH_CONDITION) return 0;
+    string_destroy(g_breakpoint_error);
+    g_breakpoint_error = NULL;
+    return runtime_set_watch(g_runtime, name, (watch_kind_t)kind, arg, &g_breakpoint_error) ? 1 : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void pseudo_clear_watch(const char* name) {
+    if (g_runtime) {
+        runtime_clear_watch(g_runtime, name);
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+void pseudo_clear_watches(void) {
+    if (g_runtime) {
+        runtime_clear_watches(g_runtime);
+    }
+}
+
+// stop_reason_t of the last step or run
+EMSCRIPTEN_KEEPALIVE
+int pseudo_get_stop_reason(void) {
+    if (!g_runtime) return 0; // STOP_NONE
+    return (int)runtime_get_stop_reason(g_runtime);
+}
+
+// Returns {"name":"s","old":"3"|null,"new":"-1","line":n} for the last
+// watch that fired, or NULL if none did. Caller frees with pseudo_free_output.
+EMSCRIPTEN_KEEPALIVE
+char* pseudo_get_watch_hit(void) {
+    watch_hit_t hit;
+    if (!g_runtime || !runtime_get_watch_hit(g_runtime, &hit)) return NULL;
+
+    string_t* json = string_create_from("{\"name\":");
+    if (!json) return NULL;
+    append_json_string(json, hit.name, strlen(hit.name));
+    string_append(json, ",\"old\":");
+    if (hit.old_value) {
+        append_json_string(json, hit.old_value, strlen(hit.old_value));
+    } else {
+        string_append(json, "null");
+    }
+    string_append(json, ",\"new\":");
+    append_json_string(json, hit.new_value, strlen(hit.new_value));
+    char buf[32];
+    snprintf(buf, sizeof(buf), ",\"line\":%u}", hit.line);
+    string_append(json, buf);
+
+    size_t len = string_length(json);
+    char* result = malloc(len + 1);
+    if (result) memcpy(result, string_cstr(json), len + 1);
+    string_destroy(json);
+    return result;
+}
+
+// Time travel: a checkpoint every `interval` steps (0: the default), from
+// the current step and again from the start at every load
+EMSCRIPTEN_KEEPALIVE
+int pseudo_enable_time_travel(int interval) {
+    if (!g_runtime) return 0;
+    uint32_t every = interval > 0 ? (uint32_t)interval : DEFAULT_CHECKPOINT_INTERVAL;
+    return runtime_enable_time_travel(g_runtime, every) ? 1 : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void pseudo_disable_time_travel(void) {
+    if (g_runtime) {
+        runtime_disable_time_travel(g_runtime);
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+int pseudo_goto_step(double step) {
+    if (!g_runtime || step < 0) return 0;
+    return runtime_goto_step(g_runtime, (uint64_t)step) ? 1 : 0;
+}
+
+// A double, as the count can pass what an int holds
+EMSCRIPTEN_KEEPALIVE
+double pseudo_get_step_count(void) {
+    if (!g_runtime) return 0;
+    return (double)runtime_get_step_count(g_runtime);
+}
+
+// Steps (over control structures when `over`) and returns the packed
+// record of the state after it (step_record_header_t in debugger.h). The
+// runtime reuses the buffer: read it before the next call.
+EMSCRIPTEN_KEEPALIVE
+const void* pseudo_step_packed(int over) {
+    if (!g_runtime) return NULL;
+    if (over) {
+        runtime_step_over(g_runtime);
+    } else {
+        runtime_step(g_runtime);
+    }
+    return runtime_get_step_record(g_runtime, false);
+}
+
+// The packed record without stepping, e.g. after a restore or a run;
+// `full` lists every variable
+EMSCRIPTEN_KEEPALIVE
+const void* pseudo_get_step_record(int full) {
+    if (!g_runtime) return NULL;
+    return runtime_get_step_record(g_runtime, full != 0);
+}
+
 EMSCRIPTEN_KEEPALIVE
 void pseudo_set_debug_mode(int enabled) {
     if (g_runtime) {
@@ -255,6 +581,77 @@ char* pseudo_get_all_loops(const char* source) {
     return equiv_get_all_loops(source);
 }
 
+// === Editor session exports ===
+// The editor mirrors its edits into a parser session and reparses
+// incrementally, so only the rows that changed need new decorations.
+
+static session_t* g_session = NULL;
+
+// Each editor reparse gets this much time before yielding to the page
+#define EDITOR_PARSE_SLICE_MICROS 8000
+
+EMSCRIPTEN_KEEPALIVE
+int pseudo_editor_open(const char* text) {
+    if (!text) return 0;
+    if (!g_session) {
+        g_session = session_create();
+        if (!g_session) return 0;
+        parser_set_timeout(session_parser(g_session), EDITOR_PARSE_SLICE_MICROS);
+    }
+    return session_set_text(g_session, text, strlen(text)) ? 1 : 0;
+}
+
+// Lines [start_line, old_end_line) of the previous text became `text`
+// (the new lines joined by '\n'). On 0 the caller reopens the session.
+EMSCRIPTEN_KEEPALIVE
+int pseudo_editor_edit(int start_line, int old_end_line, const char* text) {
+    if (!g_session || !text || start_line < 0 || old_end_line < 0) return 0;
+    return session_replace_lines(g_session, (uint32_t)start_line, (uint32_t)old_end_line,
+                                 text, strlen(text)) ? 1 : 0;
+}
+
+// Reparses and returns {"rows":[[first,last],...],"loops":[...]}: the rows
+// that changed since the last call (inclusive) and the loops starting on
+// them. A reparse that needs more than one time slice returns
+// {"pending":true,...} with no rows; call again to continue it. Caller
+// frees with pseudo_free_output.
+EMSCRIPTEN_KEEPALIVE
+char* pseudo_editor_loops(void) {
+    if (!g_session) return NULL;
+
+    const row_span_t* rows;
+    size_t count;
+    if (!session_update(g_session, &rows, &count)) return NULL;
+    if (session_pending(g_session)) {
+        static const char pending[] = "{\"pending\":true,\"rows\":[],\"loops\":[]}";
+        char* result = malloc(sizeof(pending));
+        if (result) memcpy(result, pending, sizeof(pending));
+        return result;
+    }
+
+    parser_t* parser = session_parser(g_session);
+    char* loops = count > 0 ? equiv_get_loops_in_rows(parser_root(parser), rows, count) : NULL;
+    if (count > 0 && !loops) return NULL;
+
+    string_t* json = string_create();
+    string_append(json, "{\"rows\":[");
+    for (size_t i = 0; i < count; i++) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%s[%u,%u]", i > 0 ? "," : "", rows[i].first, rows[i].last);
+        string_append(json, buf);
+    }
+    string_append(json, "],\"loops\":");
+    string_append(json, loops ? loops : "[]");
+    string_append(json, "}");
+    free(loops);
+
+    size_t len = string_length(json);
+    char* result = malloc(len + 1);
+    if (result) memcpy(result, string_cstr(json), len + 1);
+    string_destroy(json);
+    return result;
+}
+
 EMSCRIPTEN_KEEPALIVE
 char* pseudo_convert_loop(const char* source, int line, int col,
                           const char* target_type) {
@@ -262,27 +659,157 @@ char* pseudo_convert_loop(const char* source, int line, int col,
     return equiv_convert_loop(source, (uint32_t)line, (uint32_t)col, target_type);
 }
 
+// === Highlighting ===
+// Semantic tokens for the editor from the session's tree. Token positions
+// are in the session's text, which matches the editor once lint-on-type
+// has replaced the symbols it substitutes.
+
+static highlighter_t* g_highlighter = NULL;
+static highlight_tokens_t g_highlight_tokens;
+static uint32_t* g_highlight_out = NULL;
+static size_t g_highlight_out_capacity = 0;
+
+// UTF-16 code units (what JS strings index) in `len` bytes of UTF-8
+// Tokens of rows [first_row, last_row]: *out_ptr gets four integers per
+// token, (row, column, length, highlight type) with the column and length
+// in UTF-16 code units, valid until the next call. Returns the token
+// count, or -1 while the session has edits its last update did not parse
+// (update first through pseudo_editor_loops).
+EMSCRIPTEN_KEEPALIVE
+int pseudo_editor_highlights(int first_row, int last_row, const uint32_t** out_ptr) {
+    if (!g_session || !out_ptr || first_row < 0 || last_row < first_row) return -1;
+    if (session_dirty(g_session) || session_pending(g_session)) return -1;
+    if (!g_highlighter) {
+        g_highlighter = highlighter_create();
+        if (!g_highlighter) return -1;
+    }
+
+    parser_t* parser = session_parser(g_session);
+    strview_t text = parser_source(parser);
+
+    // Byte range of the rows
+    uint32_t start = 0;
+    uint32_t row = 0;
+    for (; row < (uint32_t)first_row; row++) {
+        const char* nl = memchr(text.data + start, '\n', text.len - start);
+        if (!nl) break;
+        start = (uint32_t)(nl - text.data) + 1;
+    }
+    if (row < (uint32_t)first_row) {
+        *out_ptr = NULL;
+        return 0;
+    }
+    uint32_t end = start;
+    for (uint32_t r = row; r <= (uint32_t)last_row && end < text.len; r++) {
+        const char* nl = memchr(text.data + end, '\n', text.len - end);
+        end = nl ? (uint32_t)(nl - text.data) + 1 : (uint32_t)text.len;
+    }
+
+    highlight_tokens_t* tokens = &g_highlight_tokens;
+    if (!highlight_range(g_highlighter, parser_root(parser), start, end, tokens)) return -1;
+
+    if (tokens->count * 4 > g_highlight_out_capacity) {
+        uint32_t* out = realloc(g_highlight_out, tokens->count * 4 * sizeof(uint32_t));
+        if (!out) return -1;
+        g_highlight_out = out;
+        g_highlight_out_capacity = tokens->count * 4;
+    }
+
+    // Columns are counted over the editor's text, not the substituted copy
+    size_t count = session_place_tokens(g_session, tokens, start, (uint32_t)first_row,
+                                        g_highlight_out);
+    *out_ptr = g_highlight_out;
+    return (int)count;
+}
+
 // === Linter export ===
 
 EMSCRIPTEN_KEEPALIVE
 char* pseudo_lint(const char* source) {
     if (!source) return NULL;
 
-    string_t* src = string_create_from(source);
-    if (!src) return NULL;
-
-    string_t* linted = lint(src);
-    string_destroy(src);
-
-    if (!linted) return NULL;
+    bool unchanged;
+    size_t source_len = strlen(source);
+    string_t* linted = lint_buf(source, source_len, &unchanged);
+    if (!linted && !unchanged) return NULL;
 
     // Copy to malloc'd buffer for JS to free
-    const char* str = string_cstr(linted);
-    size_t len = string_length(linted);
+    const char* str = linted ? string_cstr(linted) : source;
+    size_t len = linted ? string_length(linted) : source_len;
     char* result = malloc(len + 1);
     if (result) {
-        memcpy(result, str, len + 1);
+        memcpy(result, str, len);
+        result[len] = '\0';
     }
     string_destroy(linted);
     return result;
 }
+
+// === Lint session ===
+// Mirrors the editor like the parser session above, so lint-on-type only
+// relints the lines an edit reaches
+
+static lint_session_t* g_lint_session = NULL;
+
+EMSCRIPTEN_KEEPALIVE
+int pseudo_lint_open(const char* text) {
+    if (!text) return 0;
+    if (!g_lint_session) {
+        g_lint_session = lint_session_create();
+        if (!g_lint_session) return 0;
+    }
+    return lint_session_set_text(g_lint_session, text, strlen(text)) ? 1 : 0;
+}
+
+// Same contract as pseudo_editor_edit
+EMSCRIPTEN_KEEPALIVE
+int pseudo_lint_edit(int start_line, int old_end_line, const char* text) {
+    if (!g_lint_session || !text || start_line < 0 || old_end_line < 0) return 0;
+    return lint_session_replace_lines(g_lint_session, (uint32_t)start_line,
+                                      (uint32_t)old_end_line, text, strlen(text), NULL) ? 1 : 0;
+}
+
+// Returns {"lines":[[line,"text"],...],"newline":bool}: the lines whose
+// linted form differs from what was typed, and whether a final '\n' is
+// missing. Caller frees with pseudo_free_output.
+EMSCRIPTEN_KEEPALIVE
+char* pseudo_lint_fixes(void) {
+    if (!g_lint_session) return NULL;
+
+    string_t* json = string_create();
+    string_t* line = string_create();
+    if (!json || !line) {
+        string_destroy(json);
+        string_destroy(line);
+        return NULL;
+    }
+
+    string_append(json, "{\"lines\":[");
+    uint32_t count = lint_session_line_count(g_lint_session);
+    bool first = true;
+    for (uint32_t i = 0; i < count; i++) {
+        if (lint_session_line_linted(g_lint_session, i)) continue;
+
+        string_clear(line);
+        lint_session_render_line(g_lint_session, i, line);
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%s[%u,", first ? "" : ",", i);
+        string_append(json, buf);
+        append_json_string(json, string_cstr(line), string_length(line));
+        string_append_char(json, ']');
+        first = false;
+    }
+    string_append(json, "],\"newline\":");
+    string_append(json, lint_session_ends_linted(g_lint_session) ? "false}" : "true}");
+    string_destroy(line);
+    if (string_failed(json)) {
+        string_destroy(json);
+        return NULL;
+    }
+
+    size_t len = string_length(json);
+    char* result = malloc(len + 1);
+    if (result) memcpy(result, string_cstr(json), len + 1);
+    string_destroy(json);
+    return result;
+}
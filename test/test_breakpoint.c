@@ -0,0 +1,274 @@
+#include "pseudo/runtime.h"
+#include "pseudo/debugger.h"
+#include "pseudo/io.h"
+#include "pseudo/string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+// Lines are 0-based
+static const char* k_program =
+    "s <- 0\n"                                  // 0
+    "pentru i <- 1, 100000 executa\n"           // 1
+    "    s <- s + i\n"                          // 2
+    "    daca i % 1000 = 0 atunci\n"            // 3
+    "        scrie i\n"                         // 4
+    "    sf\n"                                  // 5
+    "sf\n"                                      // 6
+    "scrie s\n";                                // 7
+
+static runtime_t* debug_runtime(io_t** io) {
+    *io = io_buffered_create();
+    runtime_t* rt = runtime_create(*io);
+    assert(runtime_load(rt, k_program));
+    runtime_set_debug_mode(rt, true);
+    return rt;
+}
+
+static void destroy(runtime_t* rt, io_t* io) {
+    runtime_destroy(rt);
+    io_destroy(io);
+}
+
+static int64_t var_int(runtime_t* rt, const char* name) {
+    size_t count;
+    var_info_t* vars = runtime_get_variables(rt, &count);
+    int64_t value = -1;
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(string_cstr(vars[i].name), name) == 0) value = atoll(string_cstr(vars[i].value));
+    }
+    free_var_info_array(vars, count);
+    return value;
+}
+
+TEST(conditional_breakpoint) {
+    io_t* io;
+    runtime_t* rt = debug_runtime(&io);
+    assert(runtime_set_breakpoint(rt, 2, "i = 50000 sau s < 0", 0, NULL));
+
+    // Stops after the action on the line, as a step onto it would
+    assert(runtime_continue(rt) == EXEC_CONTINUE);
+    assert(runtime_get_next_line(rt) == 2);
+    assert(var_int(rt, "i") == 50000);
+    assert(var_int(rt, "s") == 1250025000);
+    assert(runtime_get_breakpoint_hits(rt, 2) == 1);
+
+    assert(runtime_continue(rt) == EXEC_DONE);
+    assert(runtime_get_breakpoint_hits(rt, 2) == 1);
+
+    // A reload counts the hits again
+    assert(runtime_load(rt, k_program));
+    assert(runtime_get_breakpoint_hits(rt, 2) == 0);
+    assert(runtime_continue(rt) == EXEC_CONTINUE);
+    assert(var_int(rt, "i") == 50000);
+
+    destroy(rt, io);
+}
+
+TEST(hit_target) {
+    io_t* io;
+    runtime_t* rt = debug_runtime(&io);
+    assert(runtime_set_breakpoint(rt, 4, NULL, 3, NULL));
+
+    assert(runtime_continue(rt) == EXEC_CONTINUE);
+    assert(var_int(rt, "i") == 3000);
+    assert(runtime_continue(rt) == EXEC_CONTINUE);
+    assert(var_int(rt, "i") == 4000);
+    assert(runtime_get_breakpoint_hits(rt, 4) == 4);
+
+    runtime_clear_breakpoint(rt, 4);
+    assert(runtime_continue(rt) == EXEC_DONE);
+
+    destroy(rt, io);
+}
+
+TEST(step_out_and_run_to_line) {
+    io_t* io;
+    runtime_t* rt = debug_runtime(&io);
+
+    assert(runtime_run_to_line(rt, 4) == EXEC_CONTINUE);
+    assert(var_int(rt, "i") == 1000);
+
+    // Out of the if: the next step is the loop's check, with i moved on
+    assert(runtime_step_out(rt) == EXEC_CONTINUE);
+    assert(runtime_get_next_line(rt) == 1);
+    assert(var_int(rt, "i") == 1001);
+
+    // Out of the loop: its last check, the one that ends it, is a step
+    assert(runtime_step_out(rt) == EXEC_CONTINUE);
+    assert(runtime_get_next_line(rt) == 1);
+    assert(var_int(rt, "s") == 5000050000);
+    assert(runtime_step(rt) == EXEC_CONTINUE);
+    assert(runtime_get_next_line(rt) == 7);
+
+    assert(runtime_step_out(rt) == EXEC_DONE);
+    destroy(rt, io);
+}
+
+TEST(breakpoints_stop_step_over) {
+    io_t* io;
+    runtime_t* rt = debug_runtime(&io);
+    assert(runtime_set_breakpoint(rt, 4, "i = 7000", 0, NULL));
+
+    assert(runtime_step(rt) == EXEC_CONTINUE);
+    assert(runtime_step_over(rt) == EXEC_CONTINUE);
+    assert(runtime_get_next_line(rt) == 4);
+    assert(var_int(rt, "i") == 7000);
+
+    // From inside the if, over the rest of it: back at the loop's check
+    runtime_clear_breakpoints(rt);
+    assert(runtime_step_over(rt) == EXEC_CONTINUE);
+    assert(runtime_get_next_line(rt) == 1);
+    assert(runtime_continue(rt) == EXEC_DONE);
+
+    destroy(rt, io);
+}
+
+TEST(invalid_condition) {
+    io_t* io;
+    runtime_t* rt = debug_runtime(&io);
+
+    const char* invalid[] = { "i +", "", "1)\nscrie (2", "citeste i" };
+    for (size_t n = 0; n < sizeof(invalid) / sizeof(invalid[0]); n++) {
+        string_t* error = NULL;
+        bool set = runtime_set_breakpoint(rt, 2, invalid[n], 0, &error);
+        if (invalid[n][0] == '\0') {
+            assert(set && !error);  // No condition
+            continue;
+        }
+        assert(!set && error && string_length(error) > 0);
+        string_destroy(error);
+    }
+
+    // A condition that fails to evaluate stops the run
+    assert(runtime_set_breakpoint(rt, 2, "s + \"a\" > 1", 0, NULL));
+    assert(runtime_continue(rt) == EXEC_CONTINUE);
+    assert(var_int(rt, "i") == 1);
+
+    destroy(rt, io);
+}
+
+TEST(watchpoints) {
+    io_t* io;
+    runtime_t* rt = debug_runtime(&io);
+    watch_hit_t hit;
+
+    // Creating the variable is a change
+    assert(runtime_set_watch(rt, "s", WATCH_CHANGE, NULL, NULL));
+    assert(runtime_run(rt) == EXEC_CONTINUE);
+    assert(runtime_get_stop_reason(rt) == STOP_WATCH);
+    assert(runtime_get_watch_hit(rt, &hit));
+    assert(strcmp(hit.name, "s") == 0 && !hit.old_value && strcmp(hit.new_value, "0") == 0);
+    assert(hit.line == 0);
+
+    // A condition fires when it starts to hold, not at every write after
+    assert(runtime_set_watch(rt, "s", WATCH_CONDITION, "s > 1000000", NULL));
+    assert(runtime_run(rt) == EXEC_CONTINUE);
+    assert(runtime_get_watch_hit(rt, &hit));
+    assert(strcmp(hit.old_value, "998991") == 0 && strcmp(hit.new_value, "1000405") == 0);
+    assert(hit.line == 2 && var_int(rt, "i") == 1414);
+
+    // The loop variable, written by the loop
+    assert(runtime_set_watch(rt, "i", WATCH_VALUE, "2 * 1500", NULL));
+    assert(runtime_continue(rt) == EXEC_CONTINUE);
+    assert(runtime_get_stop_reason(rt) == STOP_WATCH);
+    assert(runtime_get_watch_hit(rt, &hit));
+    assert(strcmp(hit.name, "i") == 0 && strcmp(hit.new_value, "3000") == 0 && hit.line == 1);
+
+    runtime_clear_watch(rt, "i");
+    assert(runtime_run(rt) == EXEC_DONE);
+    assert(runtime_get_stop_reason(rt) == STOP_NONE);
+
+    string_t* error = NULL;
+    assert(!runtime_set_watch(rt, "s", WATCH_CONDITION, "s >", &error));
+    assert(error && string_length(error) > 0);
+    string_destroy(error);
+    assert(!runtime_set_watch(rt, "s", WATCH_VALUE, "1 / 0", NULL));
+
+    // Watches outlast a load; the last hit does not
+    assert(runtime_load(rt, k_program));
+    assert(!runtime_get_watch_hit(rt, &hit));
+    assert(runtime_run(rt) == EXEC_CONTINUE && var_int(rt, "i") == 1414);
+    runtime_clear_watches(rt);
+    assert(runtime_run(rt) == EXEC_DONE);
+
+    destroy(rt, io);
+}
+
+// Every operator and literal form, including ones that fail
+static const char* k_expressions[] = {
+    "a + b", "a - 10", "a * b", "a / 2", "7 / 2", "a % 3", "b % 2", "-a", "-2.5",
+    "a = 7", "a != 7", "a < b", "a <= 7", "b > 2", "b >= 3", "a = 7.0",
+    "c = \"ab\"", "c = 'ab'", "c < \"b\"", "c + \"x\"", "\"\"", "0.0",
+    "a > 1 si b < 1", "a > 1 SI b > 1", "a < 1 sau b > 1", "0 SAU 0", "not a", "NOT (a = 3)",
+    "√16", "√(a + 9)", "[b]", "[-b]", "((a + 1) * (b - 1))", "z", "z + 1",
+    "1 / 0", "a % 0", "c + 1", "-c", "√c", "[c]", "c > 1 sau 1",
+};
+
+// A condition is evaluated as the program evaluates the same expression:
+// a breakpoint stops where the program takes the branch (or fails), and a
+// watched value is the one the program computes
+TEST(conditions_match_program) {
+    for (size_t n = 0; n < sizeof(k_expressions) / sizeof(k_expressions[0]); n++) {
+        const char* expr = k_expressions[n];
+        char program[256];
+        snprintf(program, sizeof(program),
+                 "a <- 7\nb <- 2.5\nc <- \"ab\"\n"
+                 "r <- (%s)\n"
+                 "daca r atunci\n    scrie \"da\"\naltfel\n    scrie \"nu\"\nsf\n", expr);
+
+        io_t* io = io_buffered_create();
+        runtime_t* rt = runtime_create(io);
+        assert(runtime_load(rt, program));
+        exec_state_t state = runtime_run(rt);
+        char* out = io_buffered_pop_output(io);
+        bool failed = state == EXEC_ERROR;
+        assert(failed || (state == EXEC_DONE && out));
+        bool truthy = !failed && strcmp(out, "da") == 0;
+        free(out);
+
+        // Line 2 is the last before `r`: the variables are as `r` sees them
+        assert(runtime_load(rt, program));
+        runtime_set_debug_mode(rt, true);
+        assert(runtime_set_breakpoint(rt, 2, expr, 0, NULL));
+        bool stopped = runtime_continue(rt) == EXEC_CONTINUE && runtime_get_next_line(rt) == 2;
+        assert(stopped == (failed || truthy));
+        runtime_clear_breakpoints(rt);
+
+        assert(runtime_load(rt, program));
+        assert(runtime_run_to_line(rt, 2) == EXEC_CONTINUE);
+        bool set = runtime_set_watch(rt, "r", WATCH_VALUE, expr, NULL);
+        assert(set == !failed);
+        if (set) {
+            watch_hit_t hit;
+            assert(runtime_run(rt) == EXEC_CONTINUE && runtime_get_watch_hit(rt, &hit));
+            assert(strcmp(hit.name, "r") == 0 && hit.line == 3);
+        }
+
+        runtime_destroy(rt);
+        io_destroy(io);
+    }
+}
+
+int main(void) {
+    printf("Running breakpoint tests...\n\n");
+
+    RUN_TEST(conditional_breakpoint);
+    RUN_TEST(hit_target);
+    RUN_TEST(step_out_and_run_to_line);
+    RUN_TEST(breakpoints_stop_step_over);
+    RUN_TEST(invalid_condition);
+    RUN_TEST(watchpoints);
+    RUN_TEST(conditions_match_program);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "pseudo/format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+// The printf formatting the kernel replaces
+static void reference_f64(char* buf, double value) {
+    if (value == floor(value) && fabs(value) < 1e15) {
+        snprintf(buf, FORMAT_NUMBER_MAX, "%.0f", value);
+    } else {
+        snprintf(buf, FORMAT_NUMBER_MAX, "%g", value);
+    }
+}
+
+static void check_i64(int64_t value) {
+    char expected[FORMAT_NUMBER_MAX], actual[FORMAT_NUMBER_MAX];
+    snprintf(expected, sizeof(expected), "%" PRId64, value);
+    size_t len = format_i64(actual, value);
+    assert(len == strlen(expected));
+    assert(strcmp(actual, expected) == 0);
+}
+
+static void check_f64(double value) {
+    char expected[FORMAT_NUMBER_MAX], actual[FORMAT_NUMBER_MAX];
+    reference_f64(expected, value);
+    size_t len = format_f64(actual, value);
+    if (strcmp(actual, expected) != 0) {
+        printf("\n  %.17g: expected \"%s\", got \"%s\"\n", value, expected, actual);
+    }
+    assert(strcmp(actual, expected) == 0);
+    assert(len == strlen(expected));
+}
+
+// Deterministic xorshift so failures reproduce
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+TEST(integers) {
+    const int64_t edges[] = {
+        0, 1, -1, 9, 10, 99, 100, 101, 999, 1000, -1000, 123456789,
+        INT64_MAX, INT64_MIN, INT64_MAX - 1, INT64_MIN + 1,
+    };
+    for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) {
+        check_i64(edges[i]);
+    }
+
+    int64_t p = 1;
+    for (int i = 0; i < 18; i++) {
+        check_i64(p - 1);
+        check_i64(p);
+        check_i64(-p);
+        p *= 10;
+    }
+
+    uint64_t state = 88172645463325252ull;
+    for (int i = 0; i < 100000; i++) {
+        uint64_t r = next_random(&state);
+        check_i64((int64_t)r);
+        check_i64((int64_t)(r >> (r % 64)));
+    }
+}
+
+TEST(float_edges) {
+    const double edges[] = {
+        0.0, -0.0, 1.0, -1.0, 0.5, -0.5, 0.1, 0.2, 0.3, 1.0 / 3, 2.0 / 3,
+        3.14159265358979, 2.5, 1e-4, 1e-5, 0.0001234565, 0.00012345,
+        123456.5, 1234567.5, 999999.5, 9999995.0, 0.999999, 0.9999995,
+        1e15, -1e15, 1e15 - 1, 999999999999999.5, 1e16, 1e21, 1e22, 1e23,
+        1.5e300, 1e-300, 5e-324, 1.7976931348623157e308, 1e-17, 1e27, 1e28,
+        INFINITY, -INFINITY, NAN, 0.15, 0.25, 0.35, 1.25e-5, 8.5, 12345.65,
+    };
+    for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) {
+        check_f64(edges[i]);
+        check_f64(-edges[i]);
+    }
+}
+
+TEST(float_random) {
+    uint64_t state = 2463534242ull;
+
+    // Arbitrary bit patterns cover every magnitude
+    for (int i = 0; i < 200000; i++) {
+        uint64_t bits = next_random(&state);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        check_f64(value);
+    }
+
+    // Values typical of programs: short decimals and quotients
+    for (int i = 0; i < 200000; i++) {
+        uint64_t r = next_random(&state);
+        int64_t a = (int64_t)(r % 2000001) - 1000000;
+        int64_t b = (int64_t)((r >> 24) % 1000) + 1;
+        check_f64((double)a / (double)b);
+        check_f64((double)a / 100.0);
+        check_f64((double)a * 1e-7);
+    }
+}
+
+int main(void) {
+    printf("Running format tests...\n\n");
+
+    RUN_TEST(integers);
+    RUN_TEST(float_edges);
+    RUN_TEST(float_random);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "pseudo/highlight.h"
+#include "pseudo/parser.h"
+#include "pseudo/string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+static const char* k_program =
+    "citeste n # numarul\n"
+    "s <- 0\n"
+    "pentru i <- 1, n executa\n"
+    "    daca i % 2 = 0 si i > 2 atunci\n"
+    "        s <- s + [v / i]\n"
+    "    sf\n"
+    "sf\n"
+    "scrie \"suma: \", s";
+
+static parser_t* parse(const char* text) {
+    parser_t* parser = parser_create();
+    parser_error_t err = parser_parse_borrowed(parser, text, strlen(text));
+    assert(err.type == PARSER_OK);
+    return parser;
+}
+
+// Type of the token covering exactly `text` where it appears in `context`
+static int type_at(const highlight_tokens_t* tokens, const char* source,
+                   const char* context, const char* text) {
+    const char* at = strstr(source, context);
+    assert(at);
+    at = strstr(at, text);
+    uint32_t start = (uint32_t)(at - source);
+    for (size_t i = 0; i < tokens->count; i++) {
+        const uint32_t* token = tokens->data + i * 3;
+        if (token[0] == start && token[1] == strlen(text)) return (int)token[2];
+    }
+    return -1;
+}
+
+TEST(query_matches_grammar_file) {
+    FILE* file = fopen("tree-sitter-pseudo/queries/highlights.scm", "rb");
+    assert(file);
+    string_t* expected = string_create();
+    char buf[1024];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) string_append_buf(expected, buf, n);
+    fclose(file);
+
+    assert(strcmp(string_cstr(expected), highlight_query_source()) == 0);
+    string_destroy(expected);
+}
+
+TEST(tokens_follow_the_query) {
+    parser_t* parser = parse(k_program);
+    highlighter_t* highlighter = highlighter_create();
+    assert(highlighter);
+
+    highlight_tokens_t tokens = {0};
+    assert(highlight_all(highlighter, parser_root(parser), &tokens));
+
+    assert(type_at(&tokens, k_program, "citeste", "citeste") == HL_KEYWORD);
+    assert(type_at(&tokens, k_program, "# numarul", "# numarul") == HL_COMMENT);
+    assert(type_at(&tokens, k_program, "s <- 0", "<-") == HL_OPERATOR);
+    assert(type_at(&tokens, k_program, "s <- 0", "0") == HL_NUMBER);
+    assert(type_at(&tokens, k_program, " si ", "si") == HL_KEYWORD_OPERATOR);
+    assert(type_at(&tokens, k_program, "[v", "[") == HL_PUNCTUATION_BRACKET);
+    assert(type_at(&tokens, k_program, "1, n", ",") == HL_PUNCTUATION_DELIMITER);
+    assert(type_at(&tokens, k_program, "\"suma: \"", "\"suma: \"") == HL_STRING);
+
+    // Targets of citeste, <- and pentru are parameters, other uses variables
+    assert(type_at(&tokens, k_program, "citeste n", "n") == HL_VARIABLE_PARAMETER);
+    assert(type_at(&tokens, k_program, "pentru i", "i") == HL_VARIABLE_PARAMETER);
+    assert(type_at(&tokens, k_program, "s <- s", "s") == HL_VARIABLE_PARAMETER);
+    assert(type_at(&tokens, k_program, "1, n", "n") == HL_VARIABLE);
+    assert(type_at(&tokens, k_program, "[v", "v") == HL_VARIABLE);
+    assert(type_at(&tokens, k_program, "/ i", "i") == HL_VARIABLE);
+
+    // Sorted and disjoint
+    for (size_t i = 1; i < tokens.count; i++) {
+        assert(tokens.data[(i - 1) * 3] + tokens.data[(i - 1) * 3 + 1] <= tokens.data[i * 3]);
+    }
+
+    highlight_tokens_free(&tokens);
+    highlighter_destroy(highlighter);
+    parser_destroy(parser);
+}
+
+TEST(range_is_a_slice_of_all) {
+    parser_t* parser = parse(k_program);
+    highlighter_t* highlighter = highlighter_create();
+
+    highlight_tokens_t all = {0};
+    assert(highlight_all(highlighter, parser_root(parser), &all));
+
+    // Every window returns exactly the tokens that overlap it
+    highlight_tokens_t window = {0};
+    uint32_t len = (uint32_t)strlen(k_program);
+    for (uint32_t start = 0; start < len; start += 7) {
+        uint32_t end = start + 20;
+        assert(highlight_range(highlighter, parser_root(parser), start, end, &window));
+
+        size_t expected = 0;
+        for (size_t i = 0; i < all.count; i++) {
+            const uint32_t* token = all.data + i * 3;
+            if (token[0] >= end || token[0] + token[1] <= start) continue;
+            assert(expected < window.count);
+            assert(memcmp(token, window.data + expected * 3, 3 * sizeof(uint32_t)) == 0);
+            expected++;
+        }
+        assert(expected == window.count);
+    }
+
+    highlight_tokens_free(&window);
+    highlight_tokens_free(&all);
+    highlighter_destroy(highlighter);
+    parser_destroy(parser);
+}
+
+int main(void) {
+    printf("Running highlighting tests...\n\n");
+
+    RUN_TEST(query_matches_grammar_file);
+    RUN_TEST(tokens_follow_the_query);
+    RUN_TEST(range_is_a_slice_of_all);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "pseudo/runtime.h"
+#include "pseudo/io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+// Runs `source` to its end and checks it stops with `error` after writing
+// `output` (everything before the failing statement)
+static void expect_error(const char* source, const char* output, const char* error) {
+    io_t* io = io_buffered_create();
+    runtime_t* rt = runtime_create(io);
+    assert(runtime_load(rt, source));
+
+    assert(runtime_run(rt) == EXEC_ERROR);
+    assert(strcmp(runtime_get_error(rt), error) == 0);
+    char* out = io_buffered_pop_output(io);
+    assert(strcmp(out ? out : "", output) == 0);
+    free(out);
+
+    runtime_destroy(rt);
+    io_destroy(io);
+}
+
+TEST(nested_type_error) {
+    // The failed sum fails the comparison; its error is reported once
+    expect_error("s <- 1\nscrie s\nscrie s + \"a\" > 1\nscrie 2\n", "1", "Tipuri incompatibile");
+}
+
+TEST(first_error_wins) {
+    // The division fails first; the sum it was part of is not a type error
+    expect_error("scrie 1 / 0 + \"a\"\n", "", "Impartire la zero");
+    expect_error("x <- √(0 - 4) * [\"a\"]\n", "", "Nu se poate calcula radicalul unui numar negativ");
+}
+
+TEST(failed_operand_fails_logic) {
+    // sau, si and not do not turn a failed operand into a value
+    expect_error("x <- 5 > \"a\" sau 1\nscrie x\n", "", "Tipuri incompatibile");
+    expect_error("x <- 1 / 0 si 1\nscrie x\n", "", "Impartire la zero");
+    expect_error("daca not (1 % 0) atunci\n    scrie 1\nsf\n", "", "Impartire la zero");
+}
+
+int main(void) {
+    printf("Running interpreter tests...\n\n");
+
+    RUN_TEST(nested_type_error);
+    RUN_TEST(first_error_wins);
+    RUN_TEST(failed_operand_fails_logic);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
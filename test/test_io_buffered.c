@@ -0,0 +1,208 @@
+#include "pseudo/io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+// Queues `text` as a block, copied into a malloc'd buffer as the host would
+static void push_block(io_t* io, const char* text) {
+    size_t len = strlen(text);
+    char* data = malloc(len + 1);
+    assert(data);
+    memcpy(data, text, len);
+    assert(io_buffered_push_input_block(io, data, len));
+}
+
+// Reads the next value and checks it is `expected` (NULL for no input)
+static void expect_read(io_t* io, const char* expected) {
+    const char* value = io->ops.read(io);
+    if (!expected) {
+        assert(value == NULL);
+        assert(io_buffered_needs_input(io));
+        return;
+    }
+    assert(value && strcmp(value, expected) == 0);
+    assert(!io_buffered_needs_input(io));
+}
+
+TEST(block_lines) {
+    io_t* io = io_buffered_create();
+
+    // Blank lines are values; the last line needs no newline
+    push_block(io, "1\n\nabc def\n\n7");
+    expect_read(io, "1");
+    expect_read(io, "");
+    expect_read(io, "abc def");
+    expect_read(io, "");
+    expect_read(io, "7");
+    expect_read(io, NULL);
+
+    // A final newline does not add an empty value
+    push_block(io, "x\ny\n");
+    expect_read(io, "x");
+    expect_read(io, "y");
+    expect_read(io, NULL);
+
+    // Whitespace is kept as the line's value
+    push_block(io, "  \n\t");
+    expect_read(io, "  ");
+    expect_read(io, "\t");
+    expect_read(io, NULL);
+
+    io_destroy(io);
+}
+
+TEST(block_tokens) {
+    io_t* io = io_buffered_create();
+    io_buffered_set_input_mode(io, IO_INPUT_TOKENS);
+
+    push_block(io, "  1 2\n\n\t3\r\n  -4.5  ");
+    expect_read(io, "1");
+    expect_read(io, "2");
+    expect_read(io, "3");
+    expect_read(io, "-4.5");
+    expect_read(io, NULL);
+
+    // A whitespace-only block has no values and is skipped
+    push_block(io, " \n\t \n");
+    push_block(io, "last");
+    expect_read(io, "last");
+    expect_read(io, NULL);
+
+    push_block(io, "");
+    expect_read(io, NULL);
+
+    io_destroy(io);
+}
+
+TEST(mixed_push) {
+    io_t* io = io_buffered_create();
+
+    // Values keep push order and never span two blocks
+    io_buffered_push_input(io, "first");
+    push_block(io, "1\n2");
+    io_buffered_push_input(io, "");
+    push_block(io, "3\n");
+    io_buffered_push_input(io, "a b");
+    expect_read(io, "first");
+    expect_read(io, "1");
+    expect_read(io, "2");
+    expect_read(io, "");
+    expect_read(io, "3");
+    expect_read(io, "a b");
+    expect_read(io, NULL);
+
+    // Single values are not split in tokens mode
+    io_buffered_set_input_mode(io, IO_INPUT_TOKENS);
+    push_block(io, "4 5");
+    io_buffered_push_input(io, "6 7");
+    push_block(io, "   ");
+    io_buffered_push_input(io, "8");
+    expect_read(io, "4");
+    expect_read(io, "5");
+    expect_read(io, "6 7");
+    expect_read(io, "8");
+    expect_read(io, NULL);
+
+    // Cleared input is gone, and reading resumes with new pushes
+    push_block(io, "9 10");
+    expect_read(io, "9");
+    io_buffered_clear(io);
+    expect_read(io, NULL);
+    io_buffered_push_input(io, "11");
+    expect_read(io, "11");
+
+    io_destroy(io);
+}
+
+TEST(pop_returns_all_pending) {
+    io_t* io = io_buffered_create();
+    assert(io_buffered_pop_output(io) == NULL);
+
+    io->ops.write(io, "suma: ");
+    io_write_i64(io, -42);
+    io_write_buf(io, "\n", 1);
+    io_write_f64(io, 2.5);
+    assert(io_buffered_has_output(io));
+
+    char* out = io_buffered_pop_output(io);
+    assert(out && strcmp(out, "suma: -42\n2.5") == 0);
+    free(out);
+    assert(!io_buffered_has_output(io));
+    assert(io_buffered_pop_output(io) == NULL);
+
+    // A span bigger than the initial buffer comes out whole as well
+    for (int i = 0; i < 1000; i++) io->ops.write(io, "0123456789");
+    out = io_buffered_pop_output(io);
+    assert(out && strlen(out) == 10000 && strncmp(out + 9990, "0123456789", 10) == 0);
+    free(out);
+
+    io_destroy(io);
+}
+
+TEST(output_capacity) {
+    io_t* io = io_buffered_create();
+    io_buffered_set_output_capacity(io, 8);
+
+    io->ops.write(io, "1234");
+    assert(io->status == IO_OK);
+    io->ops.write(io, "56789");
+    assert(io->status == IO_OUTPUT_FULL);
+
+    // Writes past the capacity are kept; the drain takes them all and clears the status
+    io->ops.write(io, "ab");
+    const char* data;
+    size_t len;
+    assert(io_buffered_drain_output(io, &data, &len));
+    assert(len == 11 && strcmp(data, "123456789ab") == 0);
+    assert(io->status == IO_OK);
+    assert(!io_buffered_drain_output(io, &data, &len));
+
+    io->ops.write(io, "12345678");
+    assert(io->status == IO_OUTPUT_FULL);
+    char* out = io_buffered_pop_output(io);
+    assert(out && strcmp(out, "12345678") == 0);
+    free(out);
+    assert(io->status == IO_OK);
+
+    // The total output limit wins over the capacity and is not cleared by a drain
+    io_buffered_clear(io);
+    io_set_output_limit(io, 6);
+    io->ops.write(io, "1234");
+    assert(io->status == IO_OK);
+    io->ops.write(io, "567");
+    assert(io->status == IO_OUTPUT_LIMIT);
+    out = io_buffered_pop_output(io);
+    assert(out && strcmp(out, "1234") == 0);
+    free(out);
+    assert(io->status == IO_OUTPUT_LIMIT);
+
+    // No capacity: never full
+    io_buffered_clear(io);
+    io_set_output_limit(io, 0);
+    io_buffered_set_output_capacity(io, 0);
+    for (int i = 0; i < 100; i++) io->ops.write(io, "0123456789");
+    assert(io->status == IO_OK);
+
+    io_destroy(io);
+}
+
+int main(void) {
+    printf("Running buffered I/O tests...\n\n");
+
+    RUN_TEST(block_lines);
+    RUN_TEST(block_tokens);
+    RUN_TEST(mixed_push);
+    RUN_TEST(pop_returns_all_pending);
+    RUN_TEST(output_capacity);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
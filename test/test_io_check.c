@@ -0,0 +1,110 @@
+#include "pseudo/io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+static const char* k_expected_path = "build/test_io_check_expected.txt";
+
+// Writes `expected` to a file, feeds `chunks` (NULL-terminated) to a checker
+// and returns its report
+static io_check_report_t run_check(io_check_mode_t mode, const char* expected,
+                                   const char* const* chunks) {
+    FILE* file = fopen(k_expected_path, "wb");
+    assert(file);
+    fputs(expected, file);
+    fclose(file);
+
+    io_t* io = io_check_create(NULL, mode);
+    assert(io_check_open_expected(io, k_expected_path));
+    for (const char* const* chunk = chunks; *chunk && io->status == IO_OK; chunk++) {
+        io->ops.write(io, *chunk);
+    }
+
+    io_check_report_t report;
+    io_check_finish(io, &report);
+    io_destroy(io);
+    remove(k_expected_path);
+    return report;
+}
+
+TEST(exact_match_and_mismatch) {
+    const char* const out[] = { "12", " ", "34", NULL };
+    assert(run_check(IO_CHECK_EXACT, "12 34", out).match);
+
+    io_check_report_t report = run_check(IO_CHECK_EXACT, "12 35", out);
+    assert(!report.match);
+    assert(report.offset == 4);
+    assert(report.line == 1);
+    assert(strcmp(report.expected, "5") == 0);
+    assert(strcmp(report.actual, "4") == 0);
+
+    // A missing trailing newline is a difference when exact
+    report = run_check(IO_CHECK_EXACT, "12 34\n", out);
+    assert(!report.match && report.actual_end && report.offset == 5);
+}
+
+TEST(lines_ignores_trailing_whitespace) {
+    const char* const out[] = { "a b  ", "\n", "c", NULL };
+    assert(run_check(IO_CHECK_LINES, "a b\nc\n\n\n", out).match);
+    assert(run_check(IO_CHECK_LINES, "a b \t\r\nc", out).match);
+
+    // Whitespace inside a line still counts
+    const char* const inner[] = { "a  b\n", NULL };
+    io_check_report_t report = run_check(IO_CHECK_LINES, "a b\n", inner);
+    assert(!report.match);
+    assert(report.offset == 2);
+    assert(strcmp(report.actual, " b") == 0);
+
+    // Extra text on a later line reports that line
+    const char* const extra[] = { "a b\nc\nd", NULL };
+    report = run_check(IO_CHECK_LINES, "a b\nc\n", extra);
+    assert(!report.match && report.line == 3 && report.expected_end);
+}
+
+TEST(tokens_ignores_layout) {
+    const char* const out[] = { "1", " ", "2", "\n", "3", NULL };
+    assert(run_check(IO_CHECK_TOKENS, "1\n2   3\n", out).match);
+
+    // A word that is only a prefix of the expected one is a difference
+    const char* const prefix[] = { "1 2 3", NULL };
+    io_check_report_t report = run_check(IO_CHECK_TOKENS, "1 2 34", prefix);
+    assert(!report.match && report.actual_end && report.offset == 5);
+}
+
+TEST(mismatch_halts) {
+    const char* const out[] = { "1 ", "9 ", "3 ", NULL };
+
+    FILE* file = fopen(k_expected_path, "wb");
+    fputs("1 2 3", file);
+    fclose(file);
+
+    io_t* io = io_check_create(NULL, IO_CHECK_TOKENS);
+    assert(io_check_open_expected(io, k_expected_path));
+    io->ops.write(io, out[0]);
+    assert(io->status == IO_OK);
+    io->ops.write(io, out[1]);
+    assert(io->status == IO_HALT);
+
+    io_destroy(io);
+    remove(k_expected_path);
+}
+
+int main(void) {
+    printf("Running output checker tests...\n\n");
+
+    RUN_TEST(exact_match_and_mismatch);
+    RUN_TEST(lines_ignores_trailing_whitespace);
+    RUN_TEST(tokens_ignores_layout);
+    RUN_TEST(mismatch_halts);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
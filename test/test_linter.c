@@ -1,6 +1,8 @@
 #include "pseudo/linter.h"
 #include "pseudo/string.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
 #include <string.h>
 #include <assert.h>
 
@@ -24,6 +26,18 @@ static void assert_lint_equals(const char* input, const char* expected) {
 
     string_destroy(input_str);
     string_destroy(result);
+
+    // Linted text is a fixed point, recognized without a copy
+    bool unchanged = false;
+    assert(lint_buf(expected, strlen(expected), &unchanged) == NULL);
+    assert(unchanged);
+}
+
+static bool lint_keeps(const char* input) {
+    bool unchanged = false;
+    string_t* result = lint_buf(input, strlen(input), &unchanged);
+    string_destroy(result);
+    return unchanged;
 }
 
 TEST(no_replacements) {
@@ -259,6 +273,159 @@ TEST(full_pseudocode_example) {
     );
 }
 
+TEST(unchanged_detection) {
+    assert(lint_keeps("daca x atunci\n\tscrie x\nsf\n"));
+    assert(lint_keeps("a\n\nb\n"));
+    assert(!lint_keeps("a"));              // No final newline
+    assert(!lint_keeps("\n"));             // Lints to nothing
+    assert(!lint_keeps("a \n"));           // Trailing space
+    assert(!lint_keeps("\ta\n"));          // Indent without a block
+    assert(!lint_keeps("daca x atunci\nscrie x\nsf\n"));
+    assert(!lint_keeps("x <- 1\ny ← 2\n"));
+}
+
+// === Lint session ===
+
+#define MAX_LINES 64
+
+static const char* k_fragments[] = {
+    "daca x > 0 atunci", "altfel", "sf", "scrie x", "  x ← x - 1", "",
+    "cat timp x > 0 executa", "repeta", "pana cand x = 0", "\t\ty <- 2  ",
+    "│ │ scrie y", "executa", "cat timp y < 3", "citeste x", " ",
+};
+
+typedef struct {
+    char* lines[MAX_LINES];
+    uint32_t count;
+} doc_t;
+
+static string_t* doc_join(const doc_t* doc, uint32_t first, uint32_t end) {
+    string_t* text = string_create();
+    for (uint32_t i = first; i < end; i++) {
+        if (i > first) string_append_char(text, '\n');
+        string_append(text, doc->lines[i]);
+    }
+    return text;
+}
+
+static void doc_replace(doc_t* doc, uint32_t first, uint32_t end, char** lines, uint32_t count) {
+    for (uint32_t i = first; i < end; i++) free(doc->lines[i]);
+    memmove(doc->lines + first + count, doc->lines + end, (doc->count - end) * sizeof(char*));
+    memcpy(doc->lines + first, lines, count * sizeof(char*));
+    doc->count = doc->count - (end - first) + count;
+}
+
+static char* render_line(const lint_session_t* session, uint32_t line) {
+    string_t* text = string_create();
+    lint_session_render_line(session, line, text);
+    char* result = strdup(string_cstr(text));
+    string_destroy(text);
+    return result;
+}
+
+TEST(session_matches_lint) {
+    lint_session_t* session = lint_session_create();
+    doc_t doc = { .lines = { strdup("") }, .count = 1 };
+    doc_t out = { .lines = { strdup("") }, .count = 1 };  // Rendered lines, kept by changes
+    unsigned seed = 12345;
+
+    for (int step = 0; step < 2000; step++) {
+        seed = seed * 1103515245 + 12345;
+        uint32_t first = (seed >> 8) % doc.count;
+        uint32_t end = first + 1 + (seed >> 16) % 2;
+        if (end > doc.count) end = doc.count;
+        uint32_t count = 1 + (seed >> 20) % 3;
+        if (doc.count - (end - first) + count > MAX_LINES) count = 1;
+
+        char* lines[3];
+        for (uint32_t i = 0; i < count; i++) {
+            seed = seed * 1103515245 + 12345;
+            size_t n = sizeof(k_fragments) / sizeof(k_fragments[0]);
+            lines[i] = strdup(k_fragments[(seed >> 12) % n]);
+        }
+        doc_t edit = { .count = count };
+        memcpy(edit.lines, lines, count * sizeof(char*));
+        string_t* text = doc_join(&edit, 0, count);
+
+        lint_change_t change;
+        assert(lint_session_replace_lines(session, first, end, string_cstr(text),
+                                          string_length(text), &change));
+        string_destroy(text);
+        doc_replace(&doc, first, end, lines, count);
+
+        // Applying the change to the previous output gives the new output
+        assert(change.first == first && change.new_end >= first + count);
+        char* rendered[MAX_LINES];
+        for (uint32_t i = change.first; i < change.new_end; i++) {
+            rendered[i - change.first] = render_line(session, i);
+        }
+        doc_replace(&out, change.first, change.old_end, rendered, change.new_end - change.first);
+        assert(out.count == doc.count);
+        for (uint32_t i = 0; i < out.count; i++) {
+            char* line = render_line(session, i);
+            assert(strcmp(line, out.lines[i]) == 0);
+            free(line);
+        }
+
+        string_t* source = doc_join(&doc, 0, doc.count);
+        string_t* expected = lint(source);
+        string_t* actual = lint_session_text(session);
+        assert(string_equals_string(expected, actual));
+
+        // Fixing the lines not yet linted (and the ending) gives lint's text
+        bool linted = lint_session_ends_linted(session);
+        for (uint32_t i = 0; i < doc.count; i++) {
+            if (!lint_session_line_linted(session, i)) linted = false;
+        }
+        assert(linted == string_equals_string(source, expected));
+
+        string_destroy(source);
+        string_destroy(expected);
+        string_destroy(actual);
+    }
+
+    for (uint32_t i = 0; i < doc.count; i++) free(doc.lines[i]);
+    for (uint32_t i = 0; i < out.count; i++) free(out.lines[i]);
+    lint_session_destroy(session);
+}
+
+TEST(session_relints_locally) {
+    const char* program =
+        "citeste x\n"
+        "daca x > 0 atunci\n"
+        "\tscrie x\n"
+        "sf\n"
+        "scrie 0\n";
+    lint_session_t* session = lint_session_create();
+    assert(lint_session_set_text(session, program, strlen(program)));
+
+    // Typing inside a line touches only that line
+    lint_change_t change;
+    assert(lint_session_replace_lines(session, 2, 3, "    scrie x + 1", 15, &change));
+    assert(change.first == 2 && change.old_end == 3 && change.new_end == 3);
+    assert(!lint_session_line_linted(session, 2));
+
+    // Opening a block (left unclosed) reindents every line after it
+    assert(lint_session_replace_lines(session, 0, 1, "cat timp x > 0 executa", 22, &change));
+    assert(change.first == 0 && change.new_end == 6);
+
+    string_t* text = lint_session_text(session);
+    assert(strcmp(string_cstr(text),
+                  "cat timp x > 0 executa\n"
+                  "\tdaca x > 0 atunci\n"
+                  "\t\tscrie x + 1\n"
+                  "\tsf\n"
+                  "\tscrie 0\n") == 0);
+    string_destroy(text);
+
+    // Out of range edits leave the session as it was
+    assert(!lint_session_replace_lines(session, 3, 3, "x", 1, &change));
+    assert(!lint_session_replace_lines(session, 0, 99, "x", 1, &change));
+    assert(lint_session_line_count(session) == 6);
+
+    lint_session_destroy(session);
+}
+
 int main(void) {
     printf("Running linter tests...\n\n");
 
@@ -300,6 +467,9 @@ int main(void) {
     RUN_TEST(structural_nested);
     RUN_TEST(structural_pipes_in_context);
     RUN_TEST(full_pseudocode_example);
+    RUN_TEST(unchanged_detection);
+    RUN_TEST(session_matches_lint);
+    RUN_TEST(session_relints_locally);
 
     printf("\nAll tests passed\n");
     return 0;
@@ -0,0 +1,117 @@
+#include "pseudo/memory.h"
+#include "pseudo/string.h"
+#include "pseudo/io.h"
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+TEST(tracks_current_and_peak) {
+    mem_stats_t before, after;
+    mem_get_stats(&before);
+
+    char* a = mem_alloc(MEM_VALUES, 100);
+    char* b = mem_alloc(MEM_IO, 50);
+    mem_get_stats(&after);
+    assert(after.current == before.current + 150);
+    assert(after.subsystem[MEM_VALUES] == before.subsystem[MEM_VALUES] + 100);
+    assert(after.subsystem[MEM_IO] == before.subsystem[MEM_IO] + 50);
+
+    a = mem_realloc(MEM_VALUES, a, 300);
+    mem_free(b);
+    mem_get_stats(&after);
+    assert(after.current == before.current + 300);
+    assert(after.peak >= before.current + 350);
+
+    mem_free(a);
+    mem_get_stats(&after);
+    assert(after.current == before.current);
+}
+
+TEST(limit_raises_flag_then_refuses) {
+    mem_stats_t stats;
+    mem_get_stats(&stats);
+    mem_set_limit(stats.current + 1024);
+
+    // Over the cap but within the slack: allowed, flag raised
+    char* a = mem_alloc(MEM_OTHER, 2048);
+    assert(a != NULL);
+    assert(mem_limit_exceeded());
+
+    // Far past the cap: refused
+    assert(mem_alloc(MEM_OTHER, 16 * 1024 * 1024) == NULL);
+
+    mem_free(a);
+    mem_clear_limit_exceeded();
+    mem_set_limit(0);
+    assert(!mem_limit_exceeded());
+}
+
+TEST(string_append_survives_refusal) {
+    string_t* str = string_create_from("abc");
+
+    mem_stats_t stats;
+    mem_get_stats(&stats);
+    mem_set_limit(stats.current + 64);
+
+    static char big[256 * 1024];
+    memset(big, 'x', sizeof(big));
+    string_append_buf(str, big, sizeof(big));
+
+    // The append is dropped, the string stays usable and says so
+    assert(strcmp(string_cstr(str), "abc") == 0);
+    assert(mem_limit_exceeded());
+    assert(string_failed(str));
+    string_append_char(str, 'd');
+    assert(string_failed(str) && strcmp(string_cstr(str), "abcd") == 0);
+
+    mem_clear_limit_exceeded();
+    mem_set_limit(0);
+    string_clear(str);
+    assert(!string_failed(str));
+    string_destroy(str);
+}
+
+TEST(stdio_input_refusal) {
+    // One value bigger than the cap allows
+    const char* path = "build/test_memory_input.txt";
+    FILE* file = fopen(path, "wb");
+    assert(file);
+    static char big[256 * 1024];
+    memset(big, 'x', sizeof(big));
+    fwrite(big, 1, sizeof(big), file);
+    fclose(file);
+
+    io_t* io = io_stdio_create();
+    assert(io_stdio_open_input(io, path));
+    mem_stats_t stats;
+    mem_get_stats(&stats);
+    mem_set_limit(stats.current + 64);
+
+    // Not the end of the input: the reader reports the memory error
+    assert(io->ops.read(io) == NULL);
+    assert(io->status == IO_NO_MEMORY);
+
+    mem_clear_limit_exceeded();
+    mem_set_limit(0);
+    io_destroy(io);
+    remove(path);
+}
+
+int main(void) {
+    printf("Running memory tests...\n\n");
+
+    RUN_TEST(tracks_current_and_peak);
+    RUN_TEST(limit_raises_flag_then_refuses);
+    RUN_TEST(string_append_survives_refusal);
+    RUN_TEST(stdio_input_refusal);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
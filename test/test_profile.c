@@ -0,0 +1,107 @@
+#include "pseudo/runtime.h"
+#include "pseudo/profile.h"
+#include "pseudo/io.h"
+#include "pseudo/string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+// Lines are 0-based
+static const char* k_program =
+    "s <- 0\n"                                  // 0
+    "pentru i <- 1, 100 executa\n"              // 1
+    "    s <- s + i\n"                          // 2
+    "    daca i % 10 = 0 atunci\n"              // 3
+    "        scrie i\n"                         // 4
+    "    sf\n"                                  // 5
+    "sf\n"                                      // 6
+    "scrie s\n";                                // 7
+
+TEST(line_counts) {
+    io_t* io = io_buffered_create();
+    runtime_t* rt = runtime_create(io);
+    assert(runtime_load(rt, k_program));
+    profile_t* profile = profile_create(false);
+
+    assert(runtime_run_profiled(rt, profile) == EXEC_DONE);
+    assert(profile_get_line(profile, 0).steps == 1);
+    assert(profile_get_line(profile, 1).steps == 101);  // The last check ends the loop
+    assert(profile_get_line(profile, 2).steps == 100);
+    assert(profile_get_line(profile, 4).steps == 10);
+    assert(profile_get_line(profile, 5).steps == 0);
+    assert(profile_get_line(profile, 1000).steps == 0);
+
+    // Every step is on some line, as runtime_step counts them, but the one ending the program
+    uint64_t sum = 0;
+    for (uint32_t line = 0; line < 10; line++) sum += profile_get_line(profile, line).steps;
+    assert(sum == profile_get_total(profile).steps);
+    assert(sum + 1 == runtime_get_step_count(rt));
+    assert(profile_get_total(profile).ns == 0);
+
+    string_t* json = profile_json(profile, rt);
+    assert(json);
+    assert(strstr(string_cstr(json), "[2,100,0]"));
+    assert(strstr(string_cstr(json), "{\"line\":1,\"end\":6,\"steps\":"));
+    assert(strstr(string_cstr(json), "\"checks\":101}"));
+    string_destroy(json);
+
+    string_t* report = profile_report(profile, rt);
+    assert(report && strstr(string_cstr(report), "liniile 2-7"));
+    string_destroy(report);
+
+    profile_destroy(profile);
+    runtime_destroy(rt);
+    io_destroy(io);
+}
+
+TEST(single_statement) {
+    io_t* io = io_buffered_create();
+    runtime_t* rt = runtime_create(io);
+    assert(runtime_load(rt, "scrie 1"));
+    profile_t* profile = profile_create(false);
+
+    // The end of the program is not a step of its own
+    assert(runtime_run_profiled(rt, profile) == EXEC_DONE);
+    assert(profile_get_total(profile).steps == 1);
+    assert(profile_get_line(profile, 0).steps == 1);
+
+    profile_destroy(profile);
+    runtime_destroy(rt);
+    io_destroy(io);
+}
+
+TEST(timed_run) {
+    io_t* io = io_buffered_create();
+    runtime_t* rt = runtime_create(io);
+    assert(runtime_load(rt, k_program));
+    profile_t* profile = profile_create(true);
+
+    assert(runtime_run_profiled(rt, profile) == EXEC_DONE);
+    profile_line_t total = profile_get_total(profile);
+    uint64_t ns = 0;
+    for (uint32_t line = 0; line < 10; line++) ns += profile_get_line(profile, line).ns;
+    assert(total.ns > 0 && ns == total.ns);
+
+    profile_destroy(profile);
+    runtime_destroy(rt);
+    io_destroy(io);
+}
+
+int main(void) {
+    printf("Running profile tests...\n\n");
+
+    RUN_TEST(line_counts);
+    RUN_TEST(single_statement);
+    RUN_TEST(timed_run);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
@@ -0,0 +1,257 @@
+#include "pseudo/session.h"
+#include "pseudo/parser.h"
+#include "pseudo/string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+static const char* k_program =
+    "citeste n\n"
+    "s <- 0\n"
+    "pentru i <- 1, n executa\n"
+    "    s <- s + i\n"
+    "sf\n"
+    "scrie s";
+
+static const row_span_t* update(session_t* session, size_t* count) {
+    const row_span_t* rows;
+    assert(session_update(session, &rows, count));
+    return rows;
+}
+
+// The incremental tree must match a parse from scratch of the same text
+static void assert_matches_fresh_parse(session_t* session) {
+    parser_t* incremental = session_parser(session);
+    strview_t text = parser_source(incremental);
+
+    parser_t* fresh = parser_create();
+    parser_error_t err = parser_parse_borrowed(fresh, text.data, text.len);
+    parser_error_free(&err);
+
+    string_t* expected = parser_pretty_tree(fresh);
+    string_t* actual = parser_pretty_tree(incremental);
+    assert(string_equals_string(expected, actual));
+
+    string_destroy(expected);
+    string_destroy(actual);
+    parser_destroy(fresh);
+}
+
+static bool rows_cover(const row_span_t* rows, size_t count, uint32_t row) {
+    for (size_t i = 0; i < count; i++) {
+        if (rows[i].first <= row && row <= rows[i].last) return true;
+    }
+    return false;
+}
+
+TEST(open_reports_every_row) {
+    session_t* session = session_create();
+    assert(session_set_text(session, k_program, strlen(k_program)));
+
+    size_t count;
+    const row_span_t* rows = update(session, &count);
+    assert(count == 1 && rows[0].first == 0 && rows[0].last == 5);
+
+    // Nothing edited since
+    update(session, &count);
+    assert(count == 0);
+
+    session_destroy(session);
+}
+
+TEST(edits_match_fresh_parse) {
+    session_t* session = session_create();
+    assert(session_set_text(session, k_program, strlen(k_program)));
+    size_t count;
+    update(session, &count);
+
+    // Change a line inside the loop body
+    const char* body = "    s <- s + i * i";
+    assert(session_replace_lines(session, 3, 4, body, strlen(body)));
+    const row_span_t* rows = update(session, &count);
+    assert(rows_cover(rows, count, 3));
+    assert(!rows_cover(rows, count, 0));
+    assert_matches_fresh_parse(session);
+
+    // Split one line into a new loop; symbols are substituted as in lint
+    const char* loop = "cat timp s > 100 executa\n    s ← s - 100\nsf";
+    assert(session_replace_lines(session, 1, 2, loop, strlen(loop)));
+    assert(session_replace_lines(session, 4, 5, "s <- 0", 6));
+    rows = update(session, &count);
+    for (uint32_t row = 1; row <= 4; row++) assert(rows_cover(rows, count, row));
+    assert_matches_fresh_parse(session);
+    assert(strstr(parser_source(session_parser(session)).data, "s <- s - 100"));
+
+    // Delete lines
+    assert(session_replace_lines(session, 1, 4, "s <- 0", 6));
+    update(session, &count);
+    assert_matches_fresh_parse(session);
+
+    // Bad ranges leave the session untouched
+    assert(!session_replace_lines(session, 2, 2, "x", 1));
+    assert(!session_replace_lines(session, 0, 99, "x", 1));
+
+    session_destroy(session);
+}
+
+TEST(typing_a_line) {
+    session_t* session = session_create();
+    assert(session_set_text(session, k_program, strlen(k_program)));
+    size_t count;
+    update(session, &count);
+
+    // Open an empty last line, then type into it a character at a time
+    assert(session_replace_lines(session, 5, 6, "scrie s\n", 8));
+    const char* line = "daca s > 10 atunci scrie 1 altfel scrie 2 sf";
+    size_t len = strlen(line);
+    for (size_t i = 1; i <= len; i++) {
+        assert(session_replace_lines(session, 6, 7, line, i));
+        if (i % 5 == 0 || i == len) {
+            const row_span_t* rows = update(session, &count);
+            assert(rows_cover(rows, count, 6));
+            assert(!rows_cover(rows, count, 0));
+            assert_matches_fresh_parse(session);
+        }
+    }
+
+    session_destroy(session);
+}
+
+static string_t* big_program(int loops) {
+    string_t* text = string_create();
+    string_append(text, "s <- 0\n");
+    for (int i = 0; i < loops; i++) {
+        string_append(text, "pentru i <- 1, 10 executa\n    s <- s + i\nsf\n");
+    }
+    string_append(text, "scrie s");
+    return text;
+}
+
+TEST(timed_out_parse_resumes) {
+    string_t* text = big_program(2000);
+    parser_t* parser = parser_create();
+    parser_set_timeout(parser, 1);
+
+    // Each call gets a microsecond: the parse takes many slices
+    parser_error_t err = parser_parse_borrowed(parser, string_cstr(text), string_length(text));
+    int slices = 1;
+    while (err.type == PARSER_ERR_TIMEOUT) {
+        assert(parser_pending(parser));
+        parser_error_free(&err);
+        err = parser_resume(parser);
+        slices++;
+    }
+    assert(err.type == PARSER_OK);
+    assert(slices > 1 && !parser_pending(parser));
+
+    parser_t* fresh = parser_create();
+    parser_error_t fresh_err = parser_parse(fresh, text);
+    assert(fresh_err.type == PARSER_OK);
+    string_t* expected = parser_pretty_tree(fresh);
+    string_t* actual = parser_pretty_tree(parser);
+    assert(string_equals_string(expected, actual));
+
+    string_destroy(expected);
+    string_destroy(actual);
+    parser_destroy(fresh);
+    parser_destroy(parser);
+    string_destroy(text);
+}
+
+TEST(edit_during_sliced_update) {
+    string_t* text = big_program(2000);
+    session_t* session = session_create();
+    assert(session_set_text(session, string_cstr(text), string_length(text)));
+    size_t count;
+    update(session, &count);
+
+    // Edits arriving while an update is cut off restart it from there
+    parser_set_timeout(session_parser(session), 1);
+    assert(session_replace_lines(session, 2, 3, "    s <- s + 2 * i", 18));
+    update(session, &count);
+    assert(session_pending(session) && count == 0);
+    assert(session_replace_lines(session, 0, 1, "s <- 1", 6));
+
+    const row_span_t* rows = update(session, &count);
+    while (session_pending(session)) rows = update(session, &count);
+    assert(rows_cover(rows, count, 0) && rows_cover(rows, count, 2));
+    assert_matches_fresh_parse(session);
+
+    session_destroy(session);
+    string_destroy(text);
+}
+
+// Finds the placed token at (row, column), NULL if none starts there
+static const uint32_t* placed_at(const uint32_t* placed, size_t count,
+                                 uint32_t row, uint32_t column) {
+    for (size_t i = 0; i < count; i++) {
+        if (placed[i * 4] == row && placed[i * 4 + 1] == column) return placed + i * 4;
+    }
+    return NULL;
+}
+
+TEST(tokens_keep_editor_columns) {
+    session_t* session = session_create();
+    const char* text = "scrie 1\nx \xE2\x86\x90 5 + y";  // x ← 5 + y
+    assert(session_set_text(session, text, strlen(text)));
+    size_t count;
+    update(session, &count);
+
+    // The parsed row is "x <- 5 + y": the glyph is one column there but two here
+    parser_t* parser = session_parser(session);
+    strview_t parsed = parser_source(parser);
+    uint32_t start = (uint32_t)(strchr(parsed.data, '\n') - parsed.data) + 1;
+    highlighter_t* highlighter = highlighter_create();
+    highlight_tokens_t tokens = {0};
+    assert(highlight_range(highlighter, parser_root(parser), start, (uint32_t)parsed.len, &tokens));
+    uint32_t* placed = malloc(tokens.count * 4 * sizeof(uint32_t));
+    size_t placed_count = session_place_tokens(session, &tokens, start, 1, placed);
+    assert(placed_count == tokens.count);
+
+    const uint32_t* arrow = placed_at(placed, placed_count, 1, 2);
+    assert(arrow && arrow[2] == 1);
+    const uint32_t* five = placed_at(placed, placed_count, 1, 4);
+    assert(five && five[2] == 1 && five[3] == HL_NUMBER);
+    const uint32_t* plus = placed_at(placed, placed_count, 1, 6);
+    assert(plus && plus[2] == 1 && plus[3] == HL_OPERATOR);
+    const uint32_t* y = placed_at(placed, placed_count, 1, 8);
+    assert(y && y[2] == 1 && y[3] == HL_VARIABLE);
+
+    // An edit keeps the editor's text in step: the glyph now comes later
+    const char* line = "ab \xE2\x86\x90 5 + y";
+    assert(session_replace_lines(session, 1, 2, line, strlen(line)));
+    update(session, &count);
+    parsed = parser_source(parser);
+    assert(highlight_range(highlighter, parser_root(parser), start, (uint32_t)parsed.len, &tokens));
+    placed = realloc(placed, tokens.count * 4 * sizeof(uint32_t));
+    placed_count = session_place_tokens(session, &tokens, start, 1, placed);
+    assert(placed_at(placed, placed_count, 1, 3) && placed_at(placed, placed_count, 1, 9));
+    assert(!placed_at(placed, placed_count, 1, 10));
+
+    free(placed);
+    highlight_tokens_free(&tokens);
+    highlighter_destroy(highlighter);
+    session_destroy(session);
+}
+
+int main(void) {
+    printf("Running parser session tests...\n\n");
+
+    RUN_TEST(open_reports_every_row);
+    RUN_TEST(edits_match_fresh_parse);
+    RUN_TEST(typing_a_line);
+    RUN_TEST(timed_out_parse_resumes);
+    RUN_TEST(edit_during_sliced_update);
+    RUN_TEST(tokens_keep_editor_columns);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
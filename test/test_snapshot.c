@@ -0,0 +1,385 @@
+#include "pseudo/runtime.h"
+#include "pseudo/debugger.h"
+#include "pseudo/io.h"
+#include "pseudo/string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+// Nested frames, a loop variable, floats that lose digits as text, and a
+// variable created late
+static const char* k_program =
+    "x <- 1\n"
+    "s <- \"\"\n"
+    "pentru i <- 1, 300 executa\n"
+    "    x <- x / 3 + i\n"
+    "    daca i % 7 = 0 atunci\n"
+    "        s <- s + \"a\"\n"
+    "    altfel\n"
+    "        cat timp x > 1000 executa\n"
+    "            x <- x / 2\n"
+    "        sf\n"
+    "    sf\n"
+    "    daca i = 150 atunci\n"
+    "        y <- x * 7\n"
+    "    sf\n"
+    "    scrie x * 1000000000000\n"
+    "sf\n"
+    "scrie s, \" \", y";
+
+typedef struct {
+    int id;
+    uint32_t line;
+    string_t* vars;
+    size_t output;  // Output written before the snapshot
+} record_t;
+
+typedef struct {
+    io_t* io;
+    runtime_t* rt;
+    string_t* output;
+    record_t* records;
+    size_t count;
+} trace_t;
+
+static void drain(trace_t* trace) {
+    const char* data;
+    size_t len;
+    if (io_buffered_drain_output(trace->io, &data, &len)) string_append_buf(trace->output, data, len);
+}
+
+// Steps the whole program, taking a snapshot before every step
+static trace_t record_run(void) {
+    trace_t trace = { .io = io_buffered_create(), .output = string_create() };
+    trace.rt = runtime_create(trace.io);
+    assert(runtime_load(trace.rt, k_program));
+    runtime_set_debug_mode(trace.rt, true);
+
+    size_t capacity = 0;
+    for (;;) {
+        if (trace.count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            trace.records = realloc(trace.records, capacity * sizeof(record_t));
+        }
+        record_t* r = &trace.records[trace.count++];
+        r->id = runtime_create_snapshot(trace.rt);
+        assert(r->id == (int)trace.count - 1);
+        r->line = runtime_get_next_line(trace.rt);
+        r->vars = runtime_get_variables_json(trace.rt);
+        r->output = string_length(trace.output);
+
+        exec_state_t state = runtime_step(trace.rt);
+        drain(&trace);
+        if (state == EXEC_DONE) break;
+        assert(state == EXEC_CONTINUE);
+    }
+    return trace;
+}
+
+static void free_trace(trace_t* trace) {
+    for (size_t i = 0; i < trace->count; i++) string_destroy(trace->records[i].vars);
+    free(trace->records);
+    runtime_destroy(trace->rt);
+    io_destroy(trace->io);
+    string_destroy(trace->output);
+}
+
+static void assert_at(trace_t* trace, size_t index) {
+    record_t* r = &trace->records[index];
+    assert(runtime_get_next_line(trace->rt) == r->line);
+    string_t* vars = runtime_get_variables_json(trace->rt);
+    assert(string_equals_string(vars, r->vars));
+    string_destroy(vars);
+}
+
+TEST(restore_any_snapshot) {
+    trace_t trace = record_run();
+    assert(trace.count > 1500);
+    assert(runtime_get_snapshot_count(trace.rt) == (int)trace.count);
+
+    // Backwards one at a time, forwards again, then jumps
+    for (size_t i = trace.count; i-- > 0; ) {
+        assert(runtime_restore_snapshot(trace.rt, trace.records[i].id));
+        assert_at(&trace, i);
+    }
+    for (size_t i = 0; i < trace.count; i++) {
+        assert(runtime_restore_snapshot(trace.rt, trace.records[i].id));
+        assert_at(&trace, i);
+    }
+    srand(7);
+    for (int n = 0; n < 500; n++) {
+        size_t i = (size_t)rand() % trace.count;
+        assert(runtime_restore_snapshot(trace.rt, trace.records[i].id));
+        assert_at(&trace, i);
+    }
+    assert(!runtime_restore_snapshot(trace.rt, (int)trace.count));
+
+    free_trace(&trace);
+}
+
+TEST(resume_after_restore) {
+    trace_t trace = record_run();
+    string_t* expected = string_create_from_string(trace.output);
+
+    // Running on from a snapshot writes exactly what the first run wrote
+    // from there: frames and float values come back bit for bit
+    size_t points[] = { 1, trace.count / 3, trace.count / 2, trace.count - 2 };
+    for (size_t p = 0; p < sizeof(points) / sizeof(points[0]); p++) {
+        record_t* r = &trace.records[points[p]];
+        assert(runtime_restore_snapshot(trace.rt, r->id));
+        string_clear(trace.output);
+
+        assert(runtime_run(trace.rt) == EXEC_DONE);
+        drain(&trace);
+        assert(string_length(trace.output) == string_length(expected) - r->output);
+        assert(memcmp(string_cstr(trace.output), string_cstr(expected) + r->output,
+                      string_length(trace.output)) == 0);
+    }
+
+    string_destroy(expected);
+    free_trace(&trace);
+}
+
+TEST(new_snapshot_drops_the_future) {
+    trace_t trace = record_run();
+
+    assert(runtime_restore_snapshot(trace.rt, trace.records[100].id));
+    assert(runtime_step(trace.rt) == EXEC_CONTINUE);
+    int id = runtime_create_snapshot(trace.rt);
+    assert(id == trace.records[101].id);
+    assert(runtime_get_snapshot_count(trace.rt) == 102);
+    assert_at(&trace, 101);
+
+    assert(runtime_restore_snapshot(trace.rt, trace.records[50].id));
+    assert_at(&trace, 50);
+    assert(!runtime_restore_snapshot(trace.rt, trace.records[102].id));
+
+    free_trace(&trace);
+}
+
+TEST(history_limit_drops_oldest) {
+    io_t* io = io_buffered_create();
+    runtime_t* rt = runtime_create(io);
+    assert(runtime_load(rt, k_program));
+    runtime_set_debug_mode(rt, true);
+    runtime_set_snapshot_history_limit(rt, 64 * 1024);
+
+    int last = -1;
+    for (int n = 0; n < 1500; n++) {
+        last = runtime_create_snapshot(rt);
+        assert(last == n);
+        assert(runtime_step(rt) == EXEC_CONTINUE);
+        const char* data;
+        size_t len;
+        io_buffered_drain_output(io, &data, &len);
+    }
+    assert(runtime_get_snapshot_bytes(rt) <= 64 * 1024);
+    int count = runtime_get_snapshot_count(rt);
+    assert(count >= SNAPSHOT_KEYFRAME_INTERVAL && count < 1500);
+
+    assert(!runtime_restore_snapshot(rt, 0));
+    assert(runtime_restore_snapshot(rt, last - count + 1));
+    assert(runtime_restore_snapshot(rt, last));
+
+    runtime_destroy(rt);
+    io_destroy(io);
+}
+
+// Reads inside the loop, so going back must not ask for input again
+static const char* k_reading_program =
+    "citeste n\n"
+    "s <- 0\n"
+    "pentru i <- 1, n executa\n"
+    "    citeste v\n"
+    "    s <- s + v / 7\n"
+    "    scrie s\n"
+    "sf\n";
+
+static const char* k_reading_input = "40\n3\n1\n4\n1\n5\n9\n2\n6\n5\n3\n5\n8\n9\n7\n9\n3\n2\n3\n8\n4\n"
+                                     "6\n2\n6\n4\n3\n3\n8\n3\n2\n7\n9\n5\n0\n2\n8\n8\n4\n1\n9\n7\n";
+
+static runtime_t* replay_runtime(io_t** io, const char* program, const char* input) {
+    io_t* inner = io_buffered_create();
+    if (input) {
+        size_t len = strlen(input);
+        char* block = malloc(len + 1);
+        memcpy(block, input, len + 1);
+        assert(io_buffered_push_input_block(inner, block, len));
+    }
+    *io = io_replay_create(inner);
+    runtime_t* rt = runtime_create(*io);
+    assert(runtime_load(rt, program));
+    runtime_set_debug_mode(rt, true);
+    return rt;
+}
+
+static size_t drained(io_t* io) {
+    const char* data;
+    size_t len;
+    return io_buffered_drain_output(io_replay_inner(io), &data, &len) ? len : 0;
+}
+
+TEST(goto_step_matches_stepping) {
+    io_t* io;
+    runtime_t* rt = replay_runtime(&io, k_reading_program, k_reading_input);
+    assert(runtime_enable_time_travel(rt, 16));
+
+    // State after each step, stepping normally
+    string_t* vars[512];
+    uint32_t lines[512];
+    size_t steps = 0;
+    for (;;) {
+        assert(runtime_get_step_count(rt) == steps);
+        vars[steps] = runtime_get_variables_json(rt);
+        lines[steps] = runtime_get_next_line(rt);
+        exec_state_t state = runtime_step(rt);
+        steps++;
+        drained(io);
+        if (state == EXEC_DONE) break;
+        assert(state == EXEC_CONTINUE && steps < 511);
+    }
+    vars[steps] = runtime_get_variables_json(rt);
+    lines[steps] = runtime_get_next_line(rt);
+    assert(runtime_get_checkpoint_count(rt) == steps / 16 + 1);
+
+    // Every step back from the end, then random jumps both ways
+    srand(11);
+    for (size_t n = 0; n < 2 * steps; n++) {
+        size_t step = n < steps ? steps - n : (size_t)rand() % (steps + 1);
+        assert(runtime_goto_step(rt, step));
+        assert(runtime_get_step_count(rt) == step);
+        assert(runtime_get_next_line(rt) == lines[step]);
+        string_t* now = runtime_get_variables_json(rt);
+        assert(string_equals_string(now, vars[step]));
+        string_destroy(now);
+        assert(!io_buffered_needs_input(io_replay_inner(io)));
+    }
+    assert(!runtime_goto_step(rt, steps + 1));
+
+    for (size_t i = 0; i <= steps; i++) string_destroy(vars[i]);
+    runtime_destroy(rt);
+    io_destroy(io);
+}
+
+TEST(goto_step_does_not_repeat_output) {
+    io_t* io;
+    runtime_t* rt = replay_runtime(&io, k_reading_program, k_reading_input);
+    assert(runtime_enable_time_travel(rt, 16));
+
+    assert(runtime_run(rt) == EXEC_DONE);
+    uint64_t end = runtime_get_step_count(rt);
+    size_t total = drained(io);
+    assert(total > 0);
+
+    // Back to the middle, then on to the end: nothing new to show
+    assert(runtime_goto_step(rt, end / 2));
+    assert(runtime_run(rt) == EXEC_DONE);
+    assert(runtime_get_step_count(rt) == end);
+    assert(drained(io) == 0);
+
+    // A reload starts over, output included
+    assert(runtime_load(rt, k_reading_program));
+    assert(runtime_get_checkpoint_count(rt) == 1);
+    char* block = malloc(strlen(k_reading_input) + 1);
+    strcpy(block, k_reading_input);
+    assert(io_buffered_push_input_block(io_replay_inner(io), block, strlen(block)));
+    assert(runtime_run(rt) == EXEC_DONE);
+    assert(drained(io) == total);
+
+    runtime_destroy(rt);
+    io_destroy(io);
+}
+
+TEST(time_travel_needs_replay_io) {
+    io_t* io = io_buffered_create();
+    runtime_t* rt = runtime_create(io);
+    assert(runtime_load(rt, k_program));
+    assert(!runtime_enable_time_travel(rt, 16));
+    assert(!runtime_goto_step(rt, 0));
+    runtime_destroy(rt);
+    io_destroy(io);
+}
+
+// Entry `index` of a record, with its name and text
+static const step_record_var_t* record_var(const step_record_header_t* rec, uint32_t index,
+                                           const char* name, const char* text) {
+    assert(index < rec->var_count);
+    const uint8_t* base = (const uint8_t*)rec;
+    const step_record_var_t* var = (const step_record_var_t*)(base + sizeof(*rec)) + index;
+    assert(var->name_len == strlen(name) && memcmp(base + var->name_offset, name, var->name_len) == 0);
+    assert(var->text_len == strlen(text) && memcmp(base + var->text_offset, text, var->text_len) == 0);
+    return var;
+}
+
+TEST(step_record_lists_changes) {
+    io_t* io = io_buffered_create();
+    runtime_t* rt = runtime_create(io);
+    assert(runtime_load(rt, "a <- 1\nb <- 2.5\nc <- \"x\"\na <- a + 1\ndaca a > 1 atunci\n    c <- \"yz\"\nsf\n"));
+    runtime_set_debug_mode(rt, true);
+
+    const step_record_header_t* rec = runtime_get_step_record(rt, false);
+    assert(rec->flags == STEP_RECORD_FULL && rec->var_count == 0);
+    assert(runtime_get_step_record(rt, false)->flags == 0);
+
+    assert(runtime_step(rt) == EXEC_CONTINUE);
+    rec = runtime_get_step_record(rt, false);
+    assert(rec->flags == 0 && rec->var_count == 1 && rec->step == 1);
+    assert(rec->state == EXEC_CONTINUE && rec->line == runtime_get_next_line(rt));
+    const step_record_var_t* var = record_var(rec, 0, "a", "1");
+    assert(var->type == VALUE_INT && var->as.i == 1);
+
+    assert(runtime_step(rt) == EXEC_CONTINUE);
+    assert(runtime_step(rt) == EXEC_CONTINUE);
+    assert(runtime_step(rt) == EXEC_CONTINUE);
+    rec = runtime_get_step_record(rt, false);
+    assert(rec->var_count == 3);  // In order of first write since the last record
+    var = record_var(rec, 0, "b", "2.5");
+    assert(var->type == VALUE_FLOAT && var->as.f == 2.5);
+    record_var(rec, 1, "c", "x");
+    record_var(rec, 2, "a", "2");
+
+    // The condition comes with the step that evaluated it
+    assert(runtime_step(rt) == EXEC_CONTINUE);
+    rec = runtime_get_step_record(rt, false);
+    assert(rec->var_count == 0);
+    assert(rec->flags == (STEP_RECORD_CONDITION | STEP_RECORD_CONDITION_TRUE));
+    assert(rec->condition_len == 5 && memcmp((const uint8_t*)rec + rec->condition_offset, "a > 1", 5) == 0);
+
+    runtime_step(rt);
+    rec = runtime_get_step_record(rt, true);
+    assert(rec->flags & STEP_RECORD_FULL);
+    assert(rec->var_count == 3);
+    record_var(rec, 2, "c", "yz");
+
+    // A reload empties the environment: the host starts over
+    assert(runtime_load(rt, "z <- 3"));
+    rec = runtime_get_step_record(rt, false);
+    assert(rec->flags == STEP_RECORD_FULL && rec->var_count == 0 && rec->step == 0);
+
+    runtime_destroy(rt);
+    io_destroy(io);
+}
+
+int main(void) {
+    printf("Running debugger snapshot and time travel tests...\n\n");
+
+    RUN_TEST(restore_any_snapshot);
+    RUN_TEST(resume_after_restore);
+    RUN_TEST(new_snapshot_drops_the_future);
+    RUN_TEST(history_limit_drops_oldest);
+    RUN_TEST(goto_step_matches_stepping);
+    RUN_TEST(goto_step_does_not_repeat_output);
+    RUN_TEST(time_travel_needs_replay_io);
+    RUN_TEST(step_record_lists_changes);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
@@ -0,0 +1,33 @@
+#include "pseudo/string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+// A view may hold a NUL (source text can)
+TEST(strview_equals_embedded_nul) {
+    const char source[] = { 'a', '\0', 'b' };
+    strview_t view = { .data = source, .len = sizeof(source) };
+    assert(!strview_equals(view, "a"));
+
+    view.len = 1;
+    assert(strview_equals(view, "a"));
+    assert(!strview_equals(view, "ab"));
+    assert(strview_equals((strview_t){ .data = "", .len = 0 }, ""));
+}
+
+int main(void) {
+    printf("Running string tests...\n\n");
+
+    RUN_TEST(strview_equals_embedded_nul);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
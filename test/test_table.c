@@ -0,0 +1,189 @@
+#include "pseudo/table.h"
+#include "pseudo/string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+static strview_t key_for(char* buf, size_t size, int i) {
+    snprintf(buf, size, "var_%d", i);
+    return strview_from_cstr(buf);
+}
+
+static void count_entry(const string_t* key, void* value, void* user_data) {
+    (void)key;
+    (void)value;
+    (*(int*)user_data)++;
+}
+
+TEST(insert_and_get) {
+    table_t* t = table_create(0);
+    int a = 1, b = 2;
+
+    bool inserted = false;
+    *table_upsert(t, strview_from_cstr("a"), &inserted) = &a;
+    assert(inserted);
+    *table_upsert(t, strview_from_cstr("b"), &inserted) = &b;
+    assert(inserted);
+
+    assert(table_get(t, strview_from_cstr("a")) == &a);
+    assert(table_get(t, strview_from_cstr("b")) == &b);
+    assert(table_get(t, strview_from_cstr("c")) == NULL);
+    assert(table_size(t) == 2);
+
+    table_destroy(t, NULL);
+}
+
+TEST(upsert_existing_keeps_slot) {
+    table_t* t = table_create(0);
+    int a = 1;
+
+    *table_upsert(t, strview_from_cstr("x"), NULL) = &a;
+    bool inserted = true;
+    void** slot = table_upsert(t, strview_from_cstr("x"), &inserted);
+    assert(!inserted);
+    assert(*slot == &a);
+    assert(table_size(t) == 1);
+
+    table_destroy(t, NULL);
+}
+
+TEST(borrowed_key_not_terminated) {
+    table_t* t = table_create(0);
+    int a = 1;
+
+    *table_upsert(t, strview_from_cstr("abc"), NULL) = &a;
+
+    // View into a larger buffer: only the first three bytes are the key
+    const char* source = "abcdef";
+    strview_t view = { .data = source, .len = 3 };
+    assert(table_get(t, view) == &a);
+
+    view.len = 2;
+    assert(table_get(t, view) == NULL);
+
+    table_destroy(t, NULL);
+}
+
+TEST(grow_and_remove) {
+    table_t* t = table_create(0);
+    static int values[2000];
+    char buf[32];
+
+    for (int i = 0; i < 2000; i++) {
+        values[i] = i;
+        *table_upsert(t, key_for(buf, sizeof(buf), i), NULL) = &values[i];
+    }
+    assert(table_size(t) == 2000);
+    assert(table_capacity(t) >= 2000);
+
+    for (int i = 0; i < 2000; i += 2) {
+        assert(table_remove(t, key_for(buf, sizeof(buf), i), NULL));
+    }
+    assert(!table_remove(t, key_for(buf, sizeof(buf), 0), NULL));
+    assert(table_size(t) == 1000);
+
+    for (int i = 0; i < 2000; i++) {
+        int* v = table_get(t, key_for(buf, sizeof(buf), i));
+        if (i % 2 == 0) {
+            assert(v == NULL);
+        } else {
+            assert(v && *v == i);
+        }
+    }
+
+    int count = 0;
+    table_foreach(t, count_entry, &count);
+    assert(count == 1000);
+
+    table_destroy(t, NULL);
+}
+
+TEST(reinsert_after_remove_reuses_holes) {
+    table_t* t = table_create(0);
+    static int value = 7;
+    char buf[32];
+
+    // Repeated insert/remove must not grow the table without bound
+    for (int round = 0; round < 100; round++) {
+        for (int i = 0; i < 10; i++) {
+            *table_upsert(t, key_for(buf, sizeof(buf), i), NULL) = &value;
+        }
+        for (int i = 0; i < 10; i++) {
+            assert(table_remove(t, key_for(buf, sizeof(buf), i), NULL));
+        }
+    }
+    assert(table_size(t) == 0);
+    assert(table_capacity(t) == 16);
+
+    table_destroy(t, NULL);
+}
+
+static void collect_order(const string_t* key, void* value, void* user_data) {
+    (void)value;
+    string_t* out = user_data;
+    string_append_string(out, key);
+    string_append_char(out, ',');
+}
+
+TEST(foreach_insertion_order) {
+    table_t* t = table_create(0);
+    static int value = 0;
+    const char* names[] = { "n", "s", "i", "x", "aux" };
+
+    for (size_t i = 0; i < 5; i++) {
+        *table_upsert(t, strview_from_cstr(names[i]), NULL) = &value;
+    }
+    table_remove(t, strview_from_cstr("i"), NULL);
+
+    string_t* order = string_create();
+    table_foreach(t, collect_order, order);
+    assert(strcmp(string_cstr(order), "n,s,x,aux,") == 0);
+
+    string_destroy(order);
+    table_destroy(t, NULL);
+}
+
+TEST(clear_frees_values) {
+    table_t* t = table_create(0);
+
+    for (int i = 0; i < 50; i++) {
+        char buf[32];
+        *table_upsert(t, key_for(buf, sizeof(buf), i), NULL) = malloc(16);
+    }
+    table_clear(t, free);
+    assert(table_size(t) == 0);
+    assert(table_get(t, strview_from_cstr("var_3")) == NULL);
+
+    table_destroy(t, free);
+}
+
+TEST(hash_depends_on_length) {
+    const char* s = "abcdefghijklmnop";
+    assert(table_hash(s, 8) != table_hash(s, 9));
+    assert(table_hash(s, 0) != table_hash(s, 1));
+    assert(table_hash(s, 16) == table_hash("abcdefghijklmnop", 16));
+}
+
+int main(void) {
+    printf("Running table tests...\n\n");
+
+    RUN_TEST(insert_and_get);
+    RUN_TEST(upsert_existing_keeps_slot);
+    RUN_TEST(borrowed_key_not_terminated);
+    RUN_TEST(grow_and_remove);
+    RUN_TEST(reinsert_after_remove_reuses_holes);
+    RUN_TEST(foreach_insertion_order);
+    RUN_TEST(clear_frees_values);
+    RUN_TEST(hash_depends_on_length);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
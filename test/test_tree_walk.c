@@ -0,0 +1,179 @@
+#include "pseudo/tree_walk.h"
+#include "pseudo/parser.h"
+#include "pseudo/transpiler.h"
+#include "pseudo/runtime.h"
+#include "pseudo/debugger.h"
+#include "pseudo/io.h"
+#include "pseudo/string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("Running test_%s...", #name); \
+    test_##name(); \
+    printf(" PASSED\n"); \
+} while(0)
+
+// Four times the program may take at most this many times as long. Linear
+// work gives about 4, quadratic about 16; the slack absorbs timer noise.
+#define MAX_GROWTH 9.0
+
+static const char* k_program =
+    "citeste n\n"
+    "daca n > 0 atunci\n"
+    "    scrie n, \" \", n * 2\n"
+    "altfel\n"
+    "    scrie \"nimic\"\n"
+    "sf\n";
+
+// `count` statements in a row, and a scrie of `count` values
+static string_t* wide_program(int count) {
+    string_t* text = string_create();
+    string_append(text, "s <- 0\n");
+    for (int i = 0; i < count; i++) {
+        string_append(text, "s <- s + 1\n");
+    }
+    string_append(text, "scrie s");
+    for (int i = 0; i < count; i++) {
+        string_append(text, ", s");
+    }
+    return text;
+}
+
+static double seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double transpile_time(int count) {
+    string_t* text = wide_program(count);
+    parser_t* parser = parser_create();
+    parser_error_t err = parser_parse(parser, text);
+    assert(err.type == PARSER_OK);
+
+    double best = 0;
+    for (int run = 0; run < 3; run++) {
+        double start = seconds();
+        char* out = transpile(parser, TRANSPILE_C);
+        double elapsed = seconds() - start;
+        assert(out);
+        free(out);
+        if (run == 0 || elapsed < best) best = elapsed;
+    }
+
+    parser_destroy(parser);
+    string_destroy(text);
+    return best;
+}
+
+// Steps to the end of the statements, then restores a snapshot repeatedly
+static double restore_time(int count) {
+    string_t* text = wide_program(count);
+    io_t* io = io_buffered_create();
+    runtime_t* rt = runtime_create(io);
+    assert(runtime_load(rt, string_cstr(text)));
+    runtime_set_debug_mode(rt, true);
+    for (int i = 0; i < count; i++) {
+        assert(runtime_step(rt) == EXEC_CONTINUE);
+    }
+    int snapshot = runtime_create_snapshot(rt);
+    assert(snapshot >= 0);
+    uint32_t line = runtime_get_next_line(rt);
+
+    double start = seconds();
+    for (int i = 0; i < 200; i++) {
+        assert(runtime_restore_snapshot(rt, snapshot));
+    }
+    double elapsed = seconds() - start;
+    assert(runtime_get_next_line(rt) == line);
+
+    runtime_destroy(rt);
+    io_destroy(io);
+    string_destroy(text);
+    return elapsed;
+}
+
+static walk_action_t count_node(TSNode node, void* ctx) {
+    (void)node;
+    (*(uint32_t*)ctx)++;
+    return WALK_CONTINUE;
+}
+
+TEST(walk_visits_every_node) {
+    parser_t* parser = parser_create();
+    parser_error_t err = parser_parse_borrowed(parser, k_program, strlen(k_program));
+    assert(err.type == PARSER_OK);
+    TSNode root = parser_root(parser);
+
+    uint32_t visited = 0;
+    assert(tree_walk(root, count_node, &visited));
+    assert(visited == ts_node_descendant_count(root));
+
+    child_iter_t it = child_iter_start(root);
+    uint32_t i = 0;
+    for (TSNode child; child_iter_next(&it, &child); i++) {
+        assert(ts_node_eq(child, ts_node_child(root, i)));
+    }
+    child_iter_end(&it);
+    assert(i == ts_node_child_count(root));
+
+    parser_destroy(parser);
+}
+
+// The index must agree with the outermost node found by a recursive search
+static TSNode find_outermost(TSNode node, uint32_t start_byte) {
+    if (ts_node_start_byte(node) == start_byte) return node;
+    uint32_t count = ts_node_child_count(node);
+    for (uint32_t i = 0; i < count; i++) {
+        TSNode found = find_outermost(ts_node_child(node, i), start_byte);
+        if (!ts_node_is_null(found)) return found;
+    }
+    return (TSNode){0};
+}
+
+TEST(index_finds_outermost_node) {
+    parser_t* parser = parser_create();
+    parser_error_t err = parser_parse_borrowed(parser, k_program, strlen(k_program));
+    assert(err.type == PARSER_OK);
+    TSNode root = parser_root(parser);
+
+    node_index_t index;
+    assert(node_index_build(&index, root));
+    for (uint32_t byte = 0; byte <= strlen(k_program); byte++) {
+        TSNode expected = find_outermost(root, byte);
+        TSNode actual = node_index_find(&index, byte);
+        assert(ts_node_is_null(expected) ? ts_node_is_null(actual) : ts_node_eq(expected, actual));
+    }
+    node_index_free(&index);
+
+    parser_destroy(parser);
+}
+
+TEST(transpile_scales_linearly) {
+    double small = transpile_time(2000);
+    double large = transpile_time(8000);
+    assert(large < small * MAX_GROWTH);
+}
+
+TEST(restore_scales_linearly) {
+    double small = restore_time(2000);
+    double large = restore_time(8000);
+    assert(large < small * MAX_GROWTH);
+}
+
+int main(void) {
+    printf("Running tree traversal tests...\n\n");
+
+    RUN_TEST(walk_visits_every_node);
+    RUN_TEST(index_finds_outermost_node);
+    RUN_TEST(transpile_scales_linearly);
+    RUN_TEST(restore_scales_linearly);
+
+    printf("\nAll tests passed\n");
+    return 0;
+}
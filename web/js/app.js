@@ -173,6 +173,8 @@ scrie n + 1`;
         { token: 'delimiter', foreground: 'ebdbb2' },
         { token: 'delimiter.bracket', foreground: 'fe8019' },
         { token: 'delimiter.parenthesis', foreground: 'ebdbb2' },
+        { token: 'punctuation.bracket', foreground: 'fe8019' },
+        { token: 'punctuation.delimiter', foreground: 'ebdbb2' },
         { token: 'variable', foreground: '83a598' },
         { token: 'function', foreground: 'fabd2f' },
         { token: 'type', foreground: 'fabd2f' },
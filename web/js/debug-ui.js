@@ -83,6 +83,17 @@
       }
     }
 
+    // Hand all pending program output to the console in one WASM crossing
+    let drainSlots = 0;
+    function drainOutput() {
+      if (!drainSlots) drainSlots = Module._malloc(8);
+      const len = Module._pseudo_drain_output(drainSlots, drainSlots + 4);
+      if (len > 0) {
+        const ptr = Module.getValue(drainSlots, '*');
+        appendToConsole(Module.UTF8ToString(ptr, len), 'output');
+      }
+    }
+
     // Run or debug code
     async function runCode(debug = false) {
       if (isRunning) return;
@@ -162,15 +173,7 @@
       const STEPS_PER_FRAME = 2000;
       let stepCount = 0;
 
-      const processOutput = () => {
-        while (Module._pseudo_has_output()) {
-          const ptr = Module._pseudo_pop_output();
-          if (!ptr) continue;
-          const output = Module.UTF8ToString(ptr);
-          Module._pseudo_free_output(ptr);
-          appendToConsole(output, 'output');
-        }
-      };
+      const processOutput = drainOutput;
 
       // Remove oldest output lines so at most MAX_OUTPUT_LINES remain.
       // Called after the rAF yield so flushOutputBuffer has already run.
@@ -181,11 +184,20 @@
         for (let i = 0; i < excess; i++) lines[i].remove();
       };
 
-      // 0 = EXEC_CONTINUE, 1 = EXEC_DONE, 2 = EXEC_NEEDS_INPUT, 3 = EXEC_ERROR
+      // 0 = EXEC_CONTINUE, 1 = EXEC_DONE, 2 = EXEC_NEEDS_INPUT, 3 = EXEC_ERROR,
+      // 4 = EXEC_OUTPUT_FULL
       while (!stopRequested) {
         const result = Module._pseudo_step();
         processOutput();
 
+        if (result === 4) {
+          // Output drained above; let the page render it before going on
+          await new Promise(resolve => requestAnimationFrame(resolve));
+          trimConsole();
+          Module._pseudo_resume();
+          continue;
+        }
+
         if (result === 1) {
           appendToConsole('Program terminat.', 'system');
           stopCode(true);
@@ -225,16 +237,7 @@
     async function debugStepIntoHandler() {
       if (!debugger_ || !isDebugging) return;
 
-      const processOutput = () => {
-        while (Module._pseudo_has_output()) {
-          const ptr = Module._pseudo_pop_output();
-          if (ptr) {
-            const output = Module.UTF8ToString(ptr);
-            Module._pseudo_free_output(ptr);
-            appendToConsole(output, 'output');
-          }
-        }
-      };
+      const processOutput = drainOutput;
 
       const result = debugger_.stepInto();
       processOutput();
@@ -274,24 +277,30 @@
       debugStepInto.disabled = true;
       debugContinue.disabled = true;
 
-      const processOutput = () => {
-        while (Module._pseudo_has_output()) {
-          const ptr = Module._pseudo_pop_output();
-          if (ptr) {
-            const output = Module.UTF8ToString(ptr);
-            Module._pseudo_free_output(ptr);
-            appendToConsole(output, 'output');
-          }
-        }
-      };
+      const processOutput = drainOutput;
 
-      // Run until done/error/input using the fast run function
-      const result = Module._pseudo_run();
+      // Run at full speed until a breakpoint, done/error or input, pausing
+      // to render whenever the output buffer fills up
+      let result = debugger_.continueToBreakpoint();
       processOutput();
+      while (result === 4 && !stopRequested) {
+        await new Promise(resolve => requestAnimationFrame(resolve));
+        Module._pseudo_resume();
+        result = debugger_.continueToBreakpoint();
+        processOutput();
+      }
 
       // Get final state
       const variables = debugger_.getVariables();
       updateDebugUI(variables, [], null);
+
+      if (result === 0) {
+        // Stopped at a breakpoint: stepping goes on from here
+        highlightDebugLine(debugger_.getNextLine());
+        debugStepInto.disabled = false;
+        debugContinue.disabled = false;
+        return;
+      }
       clearDebugHighlight();
 
       // 0 = EXEC_CONTINUE, 1 = EXEC_DONE, 2 = EXEC_NEEDS_INPUT, 3 = EXEC_ERROR
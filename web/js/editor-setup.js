@@ -64,41 +64,84 @@
 
     btnBacMode.addEventListener('click', toggleBacMode);
 
+    // Line range of a content change: lines [first, oldEnd) of the previous
+    // text became `text`. Null when the whole model was replaced.
+    function editedLines(e) {
+      if (e.isFlush) return null;
+
+      // One line range covering every change of the event
+      let first = Infinity, oldLast = -1, delta = 0;
+      for (const c of e.changes) {
+        first = Math.min(first, c.range.startLineNumber - 1);
+        oldLast = Math.max(oldLast, c.range.endLineNumber - 1);
+        delta += c.text.split('\n').length - 1 - (c.range.endLineNumber - c.range.startLineNumber);
+      }
+      const model = editor.getModel();
+      const newLast = oldLast + delta;
+      const text = model.getValueInRange(
+        new monaco.Range(first + 1, 1, newLast + 1, model.getLineMaxColumn(newLast + 1)));
+      return { first, oldEnd: oldLast + 1, text };
+    }
+
+    // Lint keeps a session mirroring the editor, like the loop glyphs: each
+    // edit relints only the lines it reaches, and linting applies just the
+    // lines that differ from their linted form.
+    let lintSessionOpen = false;
+
+    function openLintSession() {
+      const ptr = Module.allocateUTF8(editor.getValue());
+      lintSessionOpen = Module._pseudo_lint_open(ptr) === 1;
+      Module._free(ptr);
+    }
+
+    function recordLintEdit(edit) {
+      if (!lintSessionOpen) return;
+      if (!edit) { lintSessionOpen = false; return; }
+
+      const ptr = Module.allocateUTF8(edit.text);
+      lintSessionOpen = Module._pseudo_lint_edit(edit.first, edit.oldEnd, ptr) === 1;
+      Module._free(ptr);
+    }
+
     // Lint function
     function lintCode() {
       const activeFile = files.find(f => f.id === activeFileId);
       if (!activeFile) return;
 
-      const source = editor.getValue();
-      const sourcePtr = Module.allocateUTF8(source);
-      const resultPtr = Module._pseudo_lint(sourcePtr);
-      Module._free(sourcePtr);
+      if (!lintSessionOpen) openLintSession();
+      if (!lintSessionOpen) return;
 
-      if (resultPtr) {
-        const linted = Module.UTF8ToString(resultPtr);
-        Module._pseudo_free_output(resultPtr);
+      const resultPtr = Module._pseudo_lint_fixes();
+      if (!resultPtr) { lintSessionOpen = false; return; }
+      const fixes = JSON.parse(Module.UTF8ToString(resultPtr));
+      Module._pseudo_free_output(resultPtr);
 
-        if (linted !== source) {
-          // Save cursor position
-          const position = editor.getPosition();
+      const model = editor.getModel();
+      const lastLine = model.getLineCount();
+      const edits = fixes.lines.map(([line, text]) => ({
+        range: new monaco.Range(line + 1, 1, line + 1, model.getLineMaxColumn(line + 1)),
+        text,
+      }));
+      if (fixes.newline) {
+        const lastEdit = edits.find(edit => edit.range.startLineNumber === lastLine);
+        const end = model.getLineMaxColumn(lastLine);
+        if (lastEdit) lastEdit.text += '\n';
+        else edits.push({ range: new monaco.Range(lastLine, end, lastLine, end), text: '\n' });
+      }
 
-          // Update editor content
-          editor.setValue(linted);
+      if (edits.length > 0) {
+        // The edits come back through recordLintEdit like typing does
+        editor.pushUndoStop();
+        editor.executeEdits('lint', edits);
+        editor.pushUndoStop();
 
-          // Restore cursor position
-          if (position) {
-            editor.setPosition(position);
-            editor.revealPositionInCenter(position);
-          }
+        // Update file content
+        activeFile.content = editor.getValue();
+        saveState();
 
-          // Update file content
-          activeFile.content = linted;
-          saveState();
-
-          appendToConsole('Lint: cod normalizat.', 'system');
-        } else {
-          appendToConsole('Lint: nicio modificare necesară.', 'system');
-        }
+        appendToConsole('Lint: cod normalizat.', 'system');
+      } else {
+        appendToConsole('Lint: nicio modificare necesară.', 'system');
       }
     }
 
@@ -144,6 +187,43 @@
         }
       });
 
+      // Semantic tokens from the grammar's highlight query, over the
+      // session's tree and only for the rows on screen. Monarch above
+      // colors the text until the first parse and while one is running.
+      // Legend order is highlight_type_t in highlight.h.
+      let highlightSlot = 0;
+      monaco.languages.registerDocumentRangeSemanticTokensProvider('pseudocode', {
+        getLegend: () => ({
+          tokenTypes: ['keyword', 'keyword.operator', 'operator', 'punctuation.bracket',
+                       'punctuation.delimiter', 'number', 'string', 'variable',
+                       'variable.parameter', 'comment'],
+          tokenModifiers: [],
+        }),
+        provideDocumentRangeSemanticTokens: (model, range) => {
+          if (!Module || !Module._pseudo_editor_highlights) return null;
+          clearTimeout(editor._loopGlyphTimeout);
+          if (!updateLoopGlyphs()) return null;
+
+          if (!highlightSlot) highlightSlot = Module._malloc(4);
+          const count = Module._pseudo_editor_highlights(
+            range.startLineNumber - 1, range.endLineNumber - 1, highlightSlot);
+          if (count < 0) return null;
+
+          // (row, column, length, type) → Monaco's relative encoding
+          const tokens = new Uint32Array(Module.HEAPU32.buffer,
+                                         Module.getValue(highlightSlot, '*'), count * 4);
+          const data = new Uint32Array(count * 5);
+          let row = 0, column = 0;
+          for (let i = 0; i < count; i++) {
+            const [r, c, len, type] = tokens.subarray(i * 4, i * 4 + 4);
+            data.set([r - row, r === row ? c - column : c, len, type, 0], i * 5);
+            row = r;
+            column = c;
+          }
+          return { data };
+        },
+      });
+
       monaco.languages.setLanguageConfiguration('pseudocode', {
         comments: {
           lineComment: '#',
@@ -174,6 +254,7 @@
         value: '',
         language: 'pseudocode',
         theme: 'gruvbox-dark',
+        'semanticHighlighting.enabled': true,
         fontFamily: "'JetBrains Mono', monospace",
         fontSize: 14,
         lineHeight: 1.6,
@@ -240,8 +321,11 @@
       setTimeout(() => { updateAllDecorations(); updateLoopGlyphs(); }, 100);
 
       // Listen for content changes to auto-save and update decorations
-      editor.onDidChangeModelContent(() => {
+      editor.onDidChangeModelContent((e) => {
         debouncedSave();
+        const edit = editedLines(e);
+        recordLoopEdit(edit);
+        recordLintEdit(edit);
         if (bacModeEnabled) {
           clearTimeout(editor._decorationUpdateTimeout);
           editor._decorationUpdateTimeout = setTimeout(updateAllDecorations, 150);
@@ -1,34 +1,80 @@
     // ── Loop equivalence ───────────────────────────────────────────────────
 
     let loopDecorations = [];
-    let loopMetaMap = {};   // monacoLine (1-indexed) → {type, start_line, end_line}
+    let loopTypes = new Map();  // decoration id → loop type
+    let loopSessionOpen = false;
     const loopPopup = document.getElementById('loop-convert-popup');
     let popupSourceLine = -1;  // 0-indexed line of the active popup's loop
 
-    function updateLoopGlyphs() {
-      if (!wasmReady || !Module || !Module._pseudo_get_all_loops || !editor) return;
-      const src = editor.getValue();
-      const ptr = Module.allocateUTF8(src);
-      const resPtr = Module._pseudo_get_all_loops(ptr);
+    // The C side keeps a parser session mirroring the editor: edits are
+    // forwarded as line ranges, reparsed incrementally, and only the rows
+    // that changed get their glyphs recomputed (the rest move with Monaco).
+    function openLoopSession() {
+      const ptr = Module.allocateUTF8(editor.getValue());
+      loopSessionOpen = Module._pseudo_editor_open(ptr) === 1;
       Module._free(ptr);
-      if (!resPtr) { loopDecorations = editor.deltaDecorations(loopDecorations, []); return; }
+    }
+
+    function recordLoopEdit(edit) {
+      if (!loopSessionOpen) return;
+      if (!edit) { loopSessionOpen = false; return; }
+
+      const ptr = Module.allocateUTF8(edit.text);
+      loopSessionOpen = Module._pseudo_editor_edit(edit.first, edit.oldEnd, ptr) === 1;
+      Module._free(ptr);
+    }
+
+    // Returns true once the session's tree matches the editor
+    function updateLoopGlyphs() {
+      if (!wasmReady || !Module || !Module._pseudo_editor_loops || !editor) return false;
+      if (!loopSessionOpen) {
+        openLoopSession();
+        if (!loopSessionOpen) return false;
+      }
+      const resPtr = Module._pseudo_editor_loops();
+      if (!resPtr) { loopSessionOpen = false; return false; }
       const json = Module.UTF8ToString(resPtr);
       Module._pseudo_free_output(resPtr);
 
-      let loops;
-      try { loops = JSON.parse(json); } catch (_) { return; }
-
-      loopMetaMap = {};
-      loopDecorations = editor.deltaDecorations(loopDecorations,
-        loops.map(l => {
-          const monacoLine = l.start_line + 1;
-          loopMetaMap[monacoLine] = l;
-          return {
-            range: new monaco.Range(monacoLine, 1, monacoLine, 1),
-            options: { glyphMarginClassName: 'loop-glyph' }
-          };
-        })
+      let result;
+      try { result = JSON.parse(json); } catch (_) { return false; }
+      if (result.pending) {
+        // Large document: the parse goes on in slices between frames
+        clearTimeout(editor._loopGlyphTimeout);
+        editor._loopGlyphTimeout = setTimeout(updateLoopGlyphs, 0);
+        return false;
+      }
+      if (!result.rows.length) return true;
+
+      const model = editor.getModel();
+      const changed = line => result.rows.some(([a, b]) => line >= a && line <= b);
+      const stale = loopDecorations.filter(id => {
+        const range = model.getDecorationRange(id);
+        return !range || changed(range.startLineNumber - 1);
+      });
+
+      const added = editor.deltaDecorations(stale,
+        result.loops.map(l => ({
+          range: new monaco.Range(l.start_line + 1, 1, l.start_line + 1, 1),
+          options: { glyphMarginClassName: 'loop-glyph' }
+        }))
       );
+      stale.forEach(id => loopTypes.delete(id));
+      added.forEach((id, i) => loopTypes.set(id, result.loops[i].type));
+      loopDecorations = loopDecorations.filter(id => !stale.includes(id)).concat(added);
+      return true;
+    }
+
+    // Loop whose glyph sits on monacoLine (1-indexed), or null
+    function loopAtLine(monacoLine) {
+      const model = editor.getModel();
+      for (const id of loopDecorations) {
+        const range = model.getDecorationRange(id);
+        if (range && range.startLineNumber === monacoLine) {
+          return { type: loopTypes.get(id), start_line: monacoLine - 1 };
+        }
+      }
+      return null;
     }
 
     function hideLoopPopup() {
@@ -37,7 +83,7 @@
     }
 
     function showLoopPopup(monacoLine, x, y) {
-      const meta = loopMetaMap[monacoLine];
+      const meta = loopAtLine(monacoLine);
       if (!meta) return;
       popupSourceLine = meta.start_line;  // 0-indexed
 
@@ -88,7 +134,7 @@
         monacoLine = Math.floor((e.clientY - rect.top + editor.getScrollTop()) / lineHeight) + 1;
       }
 
-      if (!monacoLine || !loopMetaMap[monacoLine]) return;
+      if (!monacoLine || !loopAtLine(monacoLine)) return;
       showLoopPopup(monacoLine, e.clientX, e.clientY);
     });
 
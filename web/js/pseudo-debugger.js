@@ -1,11 +1,22 @@
+    // Layout of the packed step record (step_record_header_t and
+    // step_record_var_t in include/pseudo/debugger.h)
+    const STEP_RECORD_HEADER_SIZE = 40;
+    const STEP_RECORD_VAR_SIZE = 32;
+    const STEP_RECORD_FULL = 1;
+    const STEP_RECORD_CONDITION = 2;
+    const STEP_RECORD_CONDITION_TRUE = 4;
+    const STEP_RECORD_TYPES = ['int', 'float', 'string'];
+    const stepRecordText = new TextDecoder();
+
     // PseudoDebugger class for step-through debugging
     class PseudoDebugger {
       constructor(wasm) {
         this.wasm = wasm;
-        this.stateHistory = [];      // Array of {snapshotId, line, variables}
+        this.stateHistory = [];      // Array of {snapshotId, line, conditionInfo}
         this.currentHistoryIndex = -1;
-        this.maxHistory = 100;
-        this.previousVariables = {};
+        this.maxHistory = 10000;     // The runtime also drops its oldest snapshots past a memory limit
+        this.variables = new Map();  // Name -> {name, value, type}, kept in step by the records
+        this.line = 0;
         this.isAtEnd = false;
         this.isProgramDone = false;
       }
@@ -13,26 +24,65 @@
       reset() {
         this.stateHistory = [];
         this.currentHistoryIndex = -1;
-        this.previousVariables = {};
         this.isAtEnd = false;
         this.isProgramDone = false;
         if (this.wasm) {
           this.wasm._pseudo_clear_snapshots();
+          this.readRecord(this.wasm._pseudo_get_step_record(1));
+        }
+      }
+
+      // Applies a packed step record: only the variables written since the
+      // previous one are listed, unless it is a full record. Returns the
+      // state, line and condition it holds and the variables whose value
+      // changed.
+      readRecord(ptr) {
+        if (!ptr) return { state: 3, line: this.line, conditionInfo: { valid: false }, changedVars: [] };
+
+        // The heap may have grown since the last record: take fresh views
+        const buffer = this.wasm.HEAPU32.buffer;
+        const view = new DataView(buffer, ptr);
+        const bytes = new Uint8Array(buffer, ptr, view.getUint32(0, true));
+        const text = (at) => stepRecordText.decode(
+          bytes.subarray(view.getUint32(at, true), view.getUint32(at, true) + view.getUint32(at + 4, true)));
+
+        const flags = view.getUint32(12, true);
+        const previous = this.variables;
+        if (flags & STEP_RECORD_FULL) this.variables = new Map();
+
+        const changedVars = [];
+        const count = view.getUint32(24, true);
+        for (let i = 0; i < count; i++) {
+          const at = STEP_RECORD_HEADER_SIZE + i * STEP_RECORD_VAR_SIZE;
+          const name = text(at);
+          const value = text(at + 12);
+          const old = previous.get(name);
+          if (!old || old.value !== value) changedVars.push(name);
+          this.variables.set(name, { name, value, type: STEP_RECORD_TYPES[view.getUint32(at + 8, true)] });
         }
+
+        this.line = view.getUint32(8, true);
+        const conditionInfo = (flags & STEP_RECORD_CONDITION)
+          ? { valid: true, text: text(16), result: (flags & STEP_RECORD_CONDITION_TRUE) !== 0 }
+          : { valid: false };
+        return { state: view.getUint32(4, true), line: this.line, conditionInfo, changedVars };
+      }
+
+      // Brings the variables up to date after the runtime moved without a
+      // record (a restore or a run)
+      sync() {
+        if (!this.wasm) return;
+        this.readRecord(this.wasm._pseudo_get_step_record(0));
       }
 
       getVariables() {
         if (!this.wasm) return [];
-        const ptr = this.wasm._pseudo_get_variables_json();
-        if (!ptr) return [];
-        const json = this.wasm.UTF8ToString(ptr);
-        this.wasm._pseudo_free_output(ptr);
-        try {
-          return JSON.parse(json);
-        } catch (e) {
-          console.error('Failed to parse variables JSON:', e);
-          return [];
-        }
+        this.sync();
+        return this.currentVariables();
+      }
+
+      currentVariables() {
+        return Array.from(this.variables.values());
       }
 
       getNextLine() {
@@ -66,110 +116,118 @@
 
       restoreSnapshot(id) {
         if (!this.wasm) return false;
-        return this.wasm._pseudo_restore_snapshot(id) === 1;
+        if (this.wasm._pseudo_restore_snapshot(id) !== 1) return false;
+        this.sync();
+        return true;
       }
 
-      // Execute one statement and save state
-      stepInto() {
-        if (!this.wasm || this.isProgramDone) return { done: true };
-
-        // If we stepped back and are now stepping forward through history
-        if (this.currentHistoryIndex < this.stateHistory.length - 1) {
-          this.currentHistoryIndex++;
-          const state = this.stateHistory[this.currentHistoryIndex];
-          this.restoreSnapshot(state.snapshotId);
-          return {
-            done: false,
-            line: state.line,
-            variables: state.variables,
-            changedVars: this.getChangedVars(state.variables)
-          };
-        }
-
-        // Create snapshot before executing
-        const snapshotId = this.createSnapshot();
-        const line = this.getNextLine();
-
-        // Execute one step
-        const result = this.wasm._pseudo_step();
+      // Breakpoints, by 0-based line (hitTarget: stop from that hit on).
+      // Returns null, or why the condition does not compile.
+      setBreakpoint(line, condition = '', hitTarget = 0) {
+        if (!this.wasm) return null;
+        const conditionPtr = condition ? this.wasm.allocateUTF8(condition) : 0;
+        const ok = this.wasm._pseudo_set_breakpoint(line, conditionPtr, hitTarget);
+        if (conditionPtr) this.wasm._free(conditionPtr);
+        if (ok) return null;
+        const error = this.wasm._pseudo_get_breakpoint_error();
+        return error ? this.wasm.UTF8ToString(error) : 'eroare necunoscuta';
+      }
 
-        // Get state after execution
-        const variables = this.getVariables();
-        const changedVars = this.getChangedVars(variables);
-        const conditionInfo = this.getConditionInfo();
+      clearBreakpoint(line) {
+        if (this.wasm) this.wasm._pseudo_clear_breakpoint(line);
+      }
 
-        // Save to history
-        const stateEntry = { snapshotId, line, variables, conditionInfo };
+      // Watchpoints, by variable name. kind: 0 = any change, 1 = becomes
+      // the value of `arg`, 2 = `arg` (an expression) starts to hold.
+      // Returns null, or why the watch was refused.
+      setWatch(name, kind = 0, arg = '') {
+        if (!this.wasm) return null;
+        const namePtr = this.wasm.allocateUTF8(name);
+        const argPtr = arg ? this.wasm.allocateUTF8(arg) : 0;
+        const ok = this.wasm._pseudo_set_watch(namePtr, kind, argPtr);
+        this.wasm._free(namePtr);
+        if (argPtr) this.wasm._free(argPtr);
+        if (ok) return null;
+        const error = this.wasm._pseudo_get_breakpoint_error();
+        return error ? this.wasm.UTF8ToString(error) : 'eroare necunoscuta';
+      }
 
-        if (this.stateHistory.length >= this.maxHistory) {
-          this.stateHistory.shift();
-        }
-        this.stateHistory.push(stateEntry);
-        this.currentHistoryIndex = this.stateHistory.length - 1;
+      clearWatch(name) {
+        if (!this.wasm) return;
+        const namePtr = this.wasm.allocateUTF8(name);
+        this.wasm._pseudo_clear_watch(namePtr);
+        this.wasm._free(namePtr);
+      }
 
-        // Update previous variables for change detection
-        this.previousVariables = {};
-        for (const v of variables) {
-          this.previousVariables[v.name] = v.value;
-        }
+      // Why the last step or run stopped: 0 = where asked, 1 = a
+      // breakpoint, 2 = a watch (see lastWatchHit)
+      stopReason() {
+        return this.wasm ? this.wasm._pseudo_get_stop_reason() : 0;
+      }
 
-        // 0 = EXEC_CONTINUE, 1 = EXEC_DONE, 2 = EXEC_NEEDS_INPUT, 3 = EXEC_ERROR
-        const isDone = result === 1;
-        const needsInput = result === 2;
-        const hasError = result === 3;
+      // {name, old, new, line} of the last watch that fired (old is null
+      // when the write created the variable), or null
+      lastWatchHit() {
+        if (!this.wasm) return null;
+        const ptr = this.wasm._pseudo_get_watch_hit();
+        if (!ptr) return null;
+        const json = this.wasm.UTF8ToString(ptr);
+        this.wasm._pseudo_free_output(ptr);
+        return JSON.parse(json);
+      }
 
-        if (isDone) {
-          this.isProgramDone = true;
-        }
+      // Runs at full speed until a breakpoint or watch (0 = EXEC_CONTINUE)
+      // or the program stops; no history is kept on the way
+      continueToBreakpoint() {
+        if (!this.wasm) return 1;
+        return this.wasm._pseudo_continue();
+      }
 
-        return {
-          done: isDone,
-          needsInput,
-          hasError,
-          line: this.getNextLine(),
-          variables,
-          changedVars,
-          conditionInfo
-        };
+      // Execute one statement and save state
+      stepInto() {
+        return this.advance(false);
       }
 
       // Execute and step over control structures
       stepOver() {
+        return this.advance(true);
+      }
+
+      advance(over) {
         if (!this.wasm || this.isProgramDone) return { done: true };
 
         // If we stepped back and are now stepping forward through history
         if (this.currentHistoryIndex < this.stateHistory.length - 1) {
-          return this.stepInto(); // Just use normal step through history
+          this.currentHistoryIndex++;
+          const state = this.stateHistory[this.currentHistoryIndex];
+          this.restoreSnapshot(state.snapshotId);
+          return {
+            done: false,
+            line: state.line,
+            variables: this.currentVariables(),
+            changedVars: []
+          };
         }
 
         // Create snapshot before executing
         const snapshotId = this.createSnapshot();
-        const line = this.getNextLine();
-
-        // Execute step over (runs until same or lower depth)
-        const result = this.wasm._pseudo_step_over();
+        const line = this.line;
 
-        // Get state after execution
-        const variables = this.getVariables();
-        const changedVars = this.getChangedVars(variables);
-        const conditionInfo = this.getConditionInfo();
+        // Execute, reading back only what the step changed
+        const record = this.readRecord(this.wasm._pseudo_step_packed(over ? 1 : 0));
+        const conditionInfo = record.conditionInfo;
 
         // Save to history
-        const stateEntry = { snapshotId, line, variables, conditionInfo };
-
         if (this.stateHistory.length >= this.maxHistory) {
           this.stateHistory.shift();
         }
-        this.stateHistory.push(stateEntry);
+        this.stateHistory.push({ snapshotId, line, conditionInfo });
         this.currentHistoryIndex = this.stateHistory.length - 1;
 
-        // Update previous variables for change detection
-        this.previousVariables = {};
-        for (const v of variables) {
-          this.previousVariables[v.name] = v.value;
-        }
-
-        // Check execution state
+        // 0 = EXEC_CONTINUE, 1 = EXEC_DONE, 2 = EXEC_NEEDS_INPUT, 3 = EXEC_ERROR,
+        // 4 = EXEC_OUTPUT_FULL (the step finished; the caller drains the output)
+        const result = record.state;
+        if (result === 4) this.wasm._pseudo_resume();
         const isDone = result === 1;
         const needsInput = result === 2;
         const hasError = result === 3;
@@ -182,27 +240,37 @@
           done: isDone,
           needsInput,
           hasError,
-          line: this.getNextLine(),
-          variables,
-          changedVars,
+          line: record.line,
+          variables: this.currentVariables(),
+          changedVars: record.changedVars,
           conditionInfo
         };
       }
 
+      // The runtime dropped the snapshots up to `index` to stay under its
+      // memory limit; forget them here too
+      forgetBefore(index) {
+        this.stateHistory.splice(0, index + 1);
+        this.currentHistoryIndex = Math.max(this.currentHistoryIndex - (index + 1), 0);
+      }
+
       // Go back one step
       stepBack() {
         if (this.currentHistoryIndex <= 0) return null;
 
+        const state = this.stateHistory[this.currentHistoryIndex - 1];
+        if (!this.restoreSnapshot(state.snapshotId)) {
+          this.forgetBefore(this.currentHistoryIndex - 1);
+          return null;
+        }
         this.currentHistoryIndex--;
-        const state = this.stateHistory[this.currentHistoryIndex];
-        this.restoreSnapshot(state.snapshotId);
 
         // Reset program done flag since we went back
         this.isProgramDone = false;
 
         return {
           line: state.line,
-          variables: state.variables,
+          variables: this.currentVariables(),
           changedVars: [],
           conditionInfo: state.conditionInfo || { valid: false }
         };
@@ -222,7 +290,7 @@
         return {
           done: false,
           line: state.line,
-          variables: state.variables,
+          variables: this.currentVariables(),
           changedVars: []
         };
       }
@@ -231,9 +299,12 @@
       jumpToStep(index) {
         if (index < 0 || index >= this.stateHistory.length) return null;
 
-        this.currentHistoryIndex = index;
         const state = this.stateHistory[index];
-        this.restoreSnapshot(state.snapshotId);
+        if (!this.restoreSnapshot(state.snapshotId)) {
+          this.forgetBefore(index);
+          return null;
+        }
+        this.currentHistoryIndex = index;
 
         // Reset program done flag if we jumped back
         if (index < this.stateHistory.length - 1) {
@@ -242,21 +313,11 @@
 
         return {
           line: state.line,
-          variables: state.variables,
+          variables: this.currentVariables(),
           changedVars: []
         };
       }
 
-      getChangedVars(currentVars) {
-        const changed = [];
-        for (const v of currentVars) {
-          if (this.previousVariables[v.name] !== v.value) {
-            changed.push(v.name);
-          }
-        }
-        return changed;
-      }
-
       canStepBack() {
         return this.currentHistoryIndex > 0;
       }
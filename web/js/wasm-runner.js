@@ -13,9 +13,13 @@ class PseudoInterpreter {
     this._load = null;
     this._step = null;
     this._pushInput = null;
+    this._pushInputBlock = null;
+    this._setInputMode = null;
+    this._resume = null;
+    this._setOutputLimit = null;
     this._hasOutput = null;
-    this._popOutput = null;
-    this._freeOutput = null;
+    this._drain = null;
+    this._drainSlots = 0;
     this._getError = null;
     this._getLine = null;
     this._reset = null;
@@ -37,9 +41,13 @@ class PseudoInterpreter {
     this._load = this.module.cwrap('pseudo_load', 'number', ['string']);
     this._step = this.module.cwrap('pseudo_step', 'number', []);
     this._pushInput = this.module.cwrap('pseudo_push_input', null, ['string']);
+    this._pushInputBlock = this.module.cwrap('pseudo_push_input_block', 'number', ['number', 'number']);
+    this._setInputMode = this.module.cwrap('pseudo_set_input_mode', null, ['number']);
+    this._resume = this.module.cwrap('pseudo_resume', null, []);
+    this._setOutputLimit = this.module.cwrap('pseudo_set_output_limit', null, ['number']);
     this._hasOutput = this.module.cwrap('pseudo_has_output', 'number', []);
-    this._popOutput = this.module.cwrap('pseudo_pop_output', 'number', []);
-    this._freeOutput = this.module.cwrap('pseudo_free_output', null, ['number']);
+    this._drain = this.module.cwrap('pseudo_drain_output', 'number', ['number', 'number']);
+    this._drainSlots = this.module._malloc(8);
     this._getError = this.module.cwrap('pseudo_get_error', 'string', []);
     this._getLine = this.module.cwrap('pseudo_get_line', 'number', []);
     this._reset = this.module.cwrap('pseudo_reset', null, []);
@@ -65,6 +73,9 @@ class PseudoInterpreter {
    * @param {function(string)} options.onError - Called on errors
    * @param {function(number)} options.onStep - Called on each step in debug mode
    * @param {boolean} options.debug - Enable debug mode
+   * @param {string} options.input - Whole input text, consumed before asking onNeedsInput
+   * @param {string} options.inputMode - 'lines' (default) or 'tokens'
+   * @param {number} options.maxOutput - Stop with an error after this many bytes (0 = no limit)
    */
   async run(code, options = {}) {
     if (!this.initialized) {
@@ -81,6 +92,9 @@ class PseudoInterpreter {
       onError = () => {},
       onStep = () => {},
       debug = false,
+      input = null,
+      inputMode = 'lines',
+      maxOutput = 0,
     } = options;
 
     this.running = true;
@@ -99,25 +113,25 @@ class PseudoInterpreter {
       return;
     }
 
+    this._setInputMode(inputMode === 'tokens' ? 1 : 0);
+    this._setOutputLimit(maxOutput);
+    if (input !== null) {
+      this.pushInputBlock(input);
+    }
+
     // Execution state constants
     const EXEC_CONTINUE = 0;
     const EXEC_DONE = 1;
     const EXEC_NEEDS_INPUT = 2;
     const EXEC_ERROR = 3;
+    const EXEC_OUTPUT_FULL = 4;
 
     let stepCount = 0;
 
     // Main execution loop
     while (!this.stopRequested) {
       // Drain any pending output
-      while (this._hasOutput()) {
-        const ptr = this._popOutput();
-        if (ptr) {
-          const text = this.module.UTF8ToString(ptr);
-          this._freeOutput(ptr);
-          onOutput(text);
-        }
-      }
+      this._drainOutput(onOutput);
 
       // Execute one step
       const state = this._step();
@@ -131,14 +145,7 @@ class PseudoInterpreter {
       // Handle state
       if (state === EXEC_DONE) {
         // Drain final output
-        while (this._hasOutput()) {
-          const ptr = this._popOutput();
-          if (ptr) {
-            const text = this.module.UTF8ToString(ptr);
-            this._freeOutput(ptr);
-            onOutput(text);
-          }
-        }
+        this._drainOutput(onOutput);
         break;
       }
 
@@ -148,16 +155,17 @@ class PseudoInterpreter {
         break;
       }
 
+      if (state === EXEC_OUTPUT_FULL) {
+        // Hand the full buffer over, let the page render, then go on
+        this._drainOutput(onOutput);
+        await this._yield();
+        this._resume();
+        continue;
+      }
+
       if (state === EXEC_NEEDS_INPUT) {
         // Drain any pending output before requesting input
-        while (this._hasOutput()) {
-          const ptr = this._popOutput();
-          if (ptr) {
-            const text = this.module.UTF8ToString(ptr);
-            this._freeOutput(ptr);
-            onOutput(text);
-          }
-        }
+        this._drainOutput(onOutput);
         // Request input from JS
         const inputValue = await onNeedsInput();
         if (this.stopRequested) break;
@@ -179,6 +187,30 @@ class PseudoInterpreter {
     this.running = false;
   }
 
+  /**
+   * Hand a whole input text to the interpreter in one call. The buffer is
+   * allocated here and owned by the C side from then on (no copy is made).
+   * @param {string} text - Input text, split into values by the input mode
+   */
+  pushInputBlock(text) {
+    const len = this.module.lengthBytesUTF8(text);
+    const ptr = this.module._malloc(len + 1);
+    this.module.stringToUTF8(text, ptr, len + 1);
+    return this._pushInputBlock(ptr, len) === 1;
+  }
+
+  /**
+   * Pass everything the program printed since the last drain to onOutput
+   * as a single string (one WASM call, one decode)
+   */
+  _drainOutput(onOutput) {
+    const len = this._drain(this._drainSlots, this._drainSlots + 4);
+    if (len > 0) {
+      const ptr = this.module.getValue(this._drainSlots, '*');
+      onOutput(this.module.UTF8ToString(ptr, len));
+    }
+  }
+
   /**
    * Stop the current execution
    */